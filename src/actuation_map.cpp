@@ -0,0 +1,254 @@
+#include "include/actuation_map.hpp"
+#include <Eigen/Dense>
+#include <stdexcept>
+
+namespace fm {
+
+    /**
+     * @brief Constructor for the actuation_map class.
+     *
+     * Tendon excursions (tendon shortening) are l = R^T theta and motor shaft angles are phi = M l, so the
+     * motor-joint velocity Jacobian is M R^T. By virtual work the force chain runs the other way:
+     * f = M^T tau_motor and tau = R f. All products and pseudo-inverses are formed here, once, so every
+     * mapping afterwards is a single matrix-vector or matrix-matrix product.
+     *
+     * @param tendon_routing_matrix Routing matrix R (joints x tendons).
+     * @param motor_shaft_matrix Motor shaft matrix M (motors x tendons).
+     */
+    actuation_map::actuation_map(const Eigen::MatrixXd& tendon_routing_matrix, const Eigen::MatrixXd& motor_shaft_matrix)
+        : tendon_routing_matrix(tendon_routing_matrix),
+          motor_shaft_matrix(motor_shaft_matrix)
+    {
+        this->precompute();
+    }
+
+    /**
+     * @brief Constructor for the actuation_map class from a finger model.
+     * @param finger Finger model providing the tendon routing and motor shaft matrices.
+     */
+    actuation_map::actuation_map(const finger_model<>& finger)
+        : tendon_routing_matrix(finger.get_tendon_routing_matrix()),
+          motor_shaft_matrix(finger.get_motor_shaft_matrix())
+    {
+        this->precompute();
+    }
+
+    /**
+     * @brief Validate the matrices and form the cached products.
+     */
+    void actuation_map::precompute() {
+        if (this->tendon_routing_matrix.size() == 0 || this->motor_shaft_matrix.size() == 0) {
+            throw std::invalid_argument("tendon_routing_matrix and motor_shaft_matrix must not be empty");
+        }
+        if (this->motor_shaft_matrix.cols() != this->tendon_routing_matrix.cols()) {
+            throw std::invalid_argument("motor_shaft_matrix must have one column per tendon");
+        }
+
+        this->motor_joint_jacobian = this->motor_shaft_matrix * this->tendon_routing_matrix.transpose();
+        this->joint_motor_jacobian = this->motor_joint_jacobian.completeOrthogonalDecomposition().pseudoInverse();
+        this->tendon_joint_map = this->tendon_routing_matrix.transpose().completeOrthogonalDecomposition().pseudoInverse();
+        this->motor_tendon_map = this->motor_shaft_matrix.completeOrthogonalDecomposition().pseudoInverse();
+        this->tension_motor_torque_map = this->motor_tendon_map.transpose();
+        this->motor_offsets = Eigen::VectorXd::Zero(this->motor_shaft_matrix.rows());
+    }
+
+    ////////////////////////////////////////////////////////////
+    // Setter functions
+    ////////////////////////////////////////////////////////////
+
+    /**
+     * @brief Set the motor shaft angles that correspond to zero joint angles.
+     * @param motor_offsets Motor shaft angle offsets in radians.
+     */
+    void actuation_map::set_motor_offsets(const Eigen::VectorXd& motor_offsets) {
+        if (motor_offsets.size() != this->motor_shaft_matrix.rows()) {
+            throw std::invalid_argument("motor_offsets must have one element per motor");
+        }
+        this->motor_offsets = motor_offsets;
+    }
+
+    ////////////////////////////////////////////////////////////
+    // Getter functions
+    ////////////////////////////////////////////////////////////
+
+    /**
+     * @brief Get the motor shaft angle offsets.
+     * @return Vector of motor offsets.
+     */
+    const Eigen::VectorXd& actuation_map::get_motor_offsets() const {
+        return motor_offsets;
+    }
+
+    /**
+     * @brief Get the Jacobian mapping joint velocities to motor shaft velocities, M R^T.
+     * @return Matrix (motors x joints).
+     */
+    const Eigen::MatrixXd& actuation_map::get_motor_joint_jacobian() const {
+        return motor_joint_jacobian;
+    }
+
+    /**
+     * @brief Get the least squares inverse of the motor-joint Jacobian.
+     * @return Matrix (joints x motors).
+     */
+    const Eigen::MatrixXd& actuation_map::get_joint_motor_jacobian() const {
+        return joint_motor_jacobian;
+    }
+
+    /**
+     * @brief Get the number of joints.
+     * @return Number of joints.
+     */
+    int actuation_map::get_num_joints() const {
+        return static_cast<int>(tendon_routing_matrix.rows());
+    }
+
+    /**
+     * @brief Get the number of tendons.
+     * @return Number of tendons.
+     */
+    int actuation_map::get_num_tendons() const {
+        return static_cast<int>(tendon_routing_matrix.cols());
+    }
+
+    /**
+     * @brief Get the number of motors.
+     * @return Number of motors.
+     */
+    int actuation_map::get_num_motors() const {
+        return static_cast<int>(motor_shaft_matrix.rows());
+    }
+
+    ////////////////////////////////////////////////////////////
+    // Position mappings
+    ////////////////////////////////////////////////////////////
+
+    /**
+     * @brief Map joint angles to tendon excursions.
+     * @param joint_angles Joint angles in radians.
+     * @return Tendon excursions.
+     */
+    Eigen::VectorXd actuation_map::joint_to_tendon(const Eigen::VectorXd& joint_angles) const {
+        return tendon_routing_matrix.transpose() * joint_angles;
+    }
+
+    /**
+     * @brief Map tendon excursions to motor shaft angles.
+     * @param tendon_excursions Tendon excursions.
+     * @return Motor shaft angles in radians.
+     */
+    Eigen::VectorXd actuation_map::tendon_to_motor(const Eigen::VectorXd& tendon_excursions) const {
+        return motor_shaft_matrix * tendon_excursions + motor_offsets;
+    }
+
+    /**
+     * @brief Map joint angles to motor shaft angles.
+     * @param joint_angles Joint angles in radians.
+     * @return Motor shaft angles in radians, ready to send as BLDC_Drive angle targets.
+     */
+    Eigen::VectorXd actuation_map::joint_to_motor(const Eigen::VectorXd& joint_angles) const {
+        return motor_joint_jacobian * joint_angles + motor_offsets;
+    }
+
+    /**
+     * @brief Map joint angles to motor shaft angles through configuration-dependent moment arms.
+     * @param joint_angles Joint angles in radians.
+     * @param routing Compiled routing model providing the tendon excursions.
+     * @return Motor shaft angles in radians.
+     */
+    Eigen::VectorXd actuation_map::joint_to_motor(const Eigen::VectorXd& joint_angles, const tendon_routing_model& routing) const {
+        Eigen::VectorXd excursions(routing.get_num_tendons());
+        routing.tendon_excursions(joint_angles, excursions);
+        return this->tendon_to_motor(excursions);
+    }
+
+    /**
+     * @brief Map motor shaft angles to tendon excursions (least squares when motors do not span the tendons).
+     * @param motor_angles Motor shaft angles in radians.
+     * @return Tendon excursions.
+     */
+    Eigen::VectorXd actuation_map::motor_to_tendon(const Eigen::VectorXd& motor_angles) const {
+        return motor_tendon_map * (motor_angles - motor_offsets);
+    }
+
+    /**
+     * @brief Map tendon excursions to joint angles (least squares for redundant tendons).
+     * @param tendon_excursions Tendon excursions.
+     * @return Joint angles in radians.
+     */
+    Eigen::VectorXd actuation_map::tendon_to_joint(const Eigen::VectorXd& tendon_excursions) const {
+        return tendon_joint_map * tendon_excursions;
+    }
+
+    /**
+     * @brief Map motor shaft angles to joint angles.
+     * @param motor_angles Motor shaft angles in radians.
+     * @return Joint angles in radians.
+     */
+    Eigen::VectorXd actuation_map::motor_to_joint(const Eigen::VectorXd& motor_angles) const {
+        return joint_motor_jacobian * (motor_angles - motor_offsets);
+    }
+
+    ////////////////////////////////////////////////////////////
+    // Force mappings
+    ////////////////////////////////////////////////////////////
+
+    /**
+     * @brief Map motor torques to joint torques, tau = R M^T tau_motor.
+     * @param motor_torques Motor torques.
+     * @return Joint torques.
+     */
+    Eigen::VectorXd actuation_map::joint_torques_from_motor_torques(const Eigen::VectorXd& motor_torques) const {
+        return motor_joint_jacobian.transpose() * motor_torques;
+    }
+
+    /**
+     * @brief Map motor torques to tendon tensions, f = M^T tau_motor.
+     * @param motor_torques Motor torques.
+     * @return Tendon tensions.
+     */
+    Eigen::VectorXd actuation_map::tendon_tensions_from_motor_torques(const Eigen::VectorXd& motor_torques) const {
+        return motor_shaft_matrix.transpose() * motor_torques;
+    }
+
+    /**
+     * @brief Map tendon tensions, e.g. from tendon_tension_solver, to the motor torques that produce them.
+     * @param tendon_tensions Tendon tensions.
+     * @return Motor torques.
+     */
+    Eigen::VectorXd actuation_map::motor_torques_from_tendon_tensions(const Eigen::VectorXd& tendon_tensions) const {
+        return tension_motor_torque_map * tendon_tensions;
+    }
+
+    ////////////////////////////////////////////////////////////
+    // Batched trajectory mappings
+    ////////////////////////////////////////////////////////////
+
+    /**
+     * @brief Convert a whole joint trajectory to a motor setpoint stream in one matrix product.
+     * @param joint_trajectory Joint angles (joints x samples).
+     * @param motor_trajectory Output motor shaft angles (motors x samples).
+     */
+    void actuation_map::joint_to_motor(const Eigen::Ref<const Eigen::MatrixXd>& joint_trajectory, Eigen::Ref<Eigen::MatrixXd> motor_trajectory) const {
+        if (joint_trajectory.rows() != this->get_num_joints() || motor_trajectory.rows() != this->get_num_motors() ||
+            motor_trajectory.cols() != joint_trajectory.cols()) {
+            throw std::invalid_argument("trajectory shapes must be joints x samples and motors x samples");
+        }
+        motor_trajectory.noalias() = this->motor_joint_jacobian * joint_trajectory;
+        motor_trajectory.colwise() += this->motor_offsets;
+    }
+
+    /**
+     * @brief Convert a whole motor trajectory back to joint angles in one matrix product.
+     * @param motor_trajectory Motor shaft angles (motors x samples).
+     * @param joint_trajectory Output joint angles (joints x samples).
+     */
+    void actuation_map::motor_to_joint(const Eigen::Ref<const Eigen::MatrixXd>& motor_trajectory, Eigen::Ref<Eigen::MatrixXd> joint_trajectory) const {
+        if (motor_trajectory.rows() != this->get_num_motors() || joint_trajectory.rows() != this->get_num_joints() ||
+            motor_trajectory.cols() != joint_trajectory.cols()) {
+            throw std::invalid_argument("trajectory shapes must be motors x samples and joints x samples");
+        }
+        joint_trajectory.noalias() = this->joint_motor_jacobian * (motor_trajectory.colwise() - this->motor_offsets);
+    }
+
+}
@@ -0,0 +1,191 @@
+#include "include/cartesian_trajectory.hpp"
+#include "include/open_chain_kinematics.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace fm {
+
+    namespace {
+
+        // Smallest step before a path counts as leaving the workspace
+        const double min_step = 1e-6;
+
+        // exp(fraction [xi]) for a twist xi = S theta
+        Eigen::Matrix4d scaled_exponential(const Eigen::Matrix<double, 6, 1>& xi, double fraction) {
+            const double theta = xi.head<3>().norm();
+            if (theta < 1e-12) {
+                Eigen::Matrix4d T = Eigen::Matrix4d::Identity();
+                T.block<3, 1>(0, 3) = fraction * xi.tail<3>();
+                return T;
+            }
+            return rigid_body_motion::Screw_Exponential(xi / theta, fraction * theta);
+        }
+
+    }
+
+    /**
+     * @brief Constructor for the cartesian_trajectory class.
+     * @param finger Finger model with space frame screw axes and a home fingertip frame; copied.
+     */
+    cartesian_trajectory::cartesian_trajectory(const finger_model<>& finger)
+        : finger(finger),
+          path(cartesian_path::screw),
+          position_only(false),
+          tolerance(1e-4)
+    {
+    }
+
+    ////////////////////////////////////////////////////////////
+    // Setter functions
+    ////////////////////////////////////////////////////////////
+
+    void cartesian_trajectory::set_path(cartesian_path path) {
+        this->path = path;
+    }
+
+    /**
+     * @brief Solve for the fingertip position only, for targets whose orientation the finger cannot reach.
+     * @param position_only Ignore the orientation of the path.
+     */
+    void cartesian_trajectory::set_position_only(bool position_only) {
+        this->position_only = position_only;
+    }
+
+    /**
+     * @brief Set how far the fingertip may stray from the ideal path.
+     * @param tolerance Positive distance (m).
+     */
+    void cartesian_trajectory::set_tolerance(double tolerance) {
+        if (!(tolerance > 0.0) || !std::isfinite(tolerance)) {
+            throw std::invalid_argument("tolerance must be positive and finite");
+        }
+        this->tolerance = tolerance;
+    }
+
+    ////////////////////////////////////////////////////////////
+    // Getter functions
+    ////////////////////////////////////////////////////////////
+
+    cartesian_path cartesian_trajectory::get_path() const {
+        return this->path;
+    }
+
+    bool cartesian_trajectory::get_position_only() const {
+        return this->position_only;
+    }
+
+    double cartesian_trajectory::get_tolerance() const {
+        return this->tolerance;
+    }
+
+    ////////////////////////////////////////////////////////////
+    // Member functions
+    ////////////////////////////////////////////////////////////
+
+    /**
+     * @brief Pose at a fraction of the path between two poses.
+     * @param start Pose at fraction 0.
+     * @param goal Pose at fraction 1.
+     * @param fraction Path parameter in [0, 1].
+     * @param path Constant screw, or straight line with geodesic rotation.
+     * @return Pose.
+     */
+    Eigen::Matrix4d cartesian_trajectory::interpolate(const Eigen::Matrix4d& start, const Eigen::Matrix4d& goal, double fraction, cartesian_path path) {
+        const Eigen::Matrix4d relative = rigid_body_motion::Transform_Inverse(start) * goal;
+        if (path == cartesian_path::screw) {
+            return start * scaled_exponential(rigid_body_motion::Screw_Logarithm(relative), fraction);
+        }
+        Eigen::Matrix4d rotation = Eigen::Matrix4d::Identity();
+        rotation.block<3, 3>(0, 0) = relative.block<3, 3>(0, 0);
+        Eigen::Matrix<double, 6, 1> xi = rigid_body_motion::Screw_Logarithm(rotation);
+        xi.tail<3>().setZero();
+        Eigen::Matrix4d pose = start * scaled_exponential(xi, fraction);
+        pose.block<3, 1>(0, 3) = (1.0 - fraction) * start.block<3, 1>(0, 3) + fraction * goal.block<3, 1>(0, 3);
+        return pose;
+    }
+
+    /**
+     * @brief Joint waypoints that keep the fingertip within the tolerance of the path to a goal pose.
+     * @param start_angles Joint angles at the start of the path; the path starts at their fingertip pose.
+     * @param goal Goal fingertip pose in the space frame.
+     * @return Waypoints, with the solve count, solve rate and largest deviation found.
+     */
+    cartesian_plan cartesian_trajectory::plan(const Eigen::Ref<const Eigen::VectorXd>& start_angles, const Eigen::Matrix4d& goal) {
+        const int n = this->finger.get_num_joints();
+        if (start_angles.size() != n) {
+            throw std::invalid_argument("start angles must have one entry per joint");
+        }
+        using joint_vector = finger_model<>::joint_vector;
+        const joint_vector lower = this->finger.get_joint_lower_limits();
+        const joint_vector upper = this->finger.get_joint_upper_limits();
+        this->finger.set_joint_angles(start_angles);
+        const Eigen::Matrix4d start = this->finger.get_fingertip_pose_space();
+
+        cartesian_plan result;
+        std::vector<double> fractions(1, 0.0);
+        std::vector<joint_vector> waypoints(1, joint_vector(start_angles));
+        joint_vector rate = joint_vector::Zero(n);   // d angles / d fraction of the last accepted step
+        double step = 0.25;
+        double a = 0.0;
+        while (a < 1.0) {
+            const double b = std::min(1.0, a + step);
+            step = b - a;
+            const joint_vector& q_a = waypoints.back();
+            this->finger.set_joint_angles(q_a + step * rate);
+            const Eigen::Matrix4d target = interpolate(start, goal, b, this->path);
+            const auto solve_start = std::chrono::steady_clock::now();
+            const joint_vector q_b = this->position_only ? this->finger.inverse_kinematics_position(target.block<3, 1>(0, 3))
+                                                         : this->finger.inverse_kinematics_space(target);
+            result.solve_seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - solve_start).count();
+            result.ik_solves++;
+
+            double error = this->deviation(start, goal, b, q_b);
+            for (double f : {0.25, 0.5, 0.75}) {
+                error = std::max(error, this->deviation(start, goal, a + f * step, q_a + f * (q_b - q_a)));
+            }
+            if (!(error <= this->tolerance)) {
+                result.rejected_steps++;
+                step *= std::isfinite(error) ? std::min(0.5, std::max(0.1, 0.9 * std::sqrt(this->tolerance / error))) : 0.1;
+                if (step < min_step) {
+                    throw std::runtime_error("fingertip path leaves the workspace at s = " + std::to_string(a));
+                }
+                continue;
+            }
+            if ((q_b.array() < lower.array()).any() || (q_b.array() > upper.array()).any()) {
+                throw std::runtime_error("fingertip path leaves the joint limits at s = " + std::to_string(b));
+            }
+            rate = (q_b - q_a) / step;
+            fractions.push_back(b);
+            waypoints.push_back(q_b);
+            result.max_deviation = std::max(result.max_deviation, error);
+            step *= std::min(2.0, std::max(1.0, 0.9 * std::sqrt(this->tolerance / std::max(error, 1e-3 * this->tolerance))));
+            a = b;
+        }
+
+        result.fractions = Eigen::Map<const Eigen::VectorXd>(fractions.data(), static_cast<Eigen::Index>(fractions.size()));
+        result.joint_angles.resize(n, static_cast<Eigen::Index>(waypoints.size()));
+        for (std::size_t k = 0; k < waypoints.size(); k++) {
+            result.joint_angles.col(static_cast<Eigen::Index>(k)) = waypoints[k];
+        }
+        result.solves_per_second = result.solve_seconds > 0.0 ? result.ik_solves / result.solve_seconds : 0.0;
+        return result;
+    }
+
+    ////////////////////////////////////////////////////////////
+    // Private functions
+    ////////////////////////////////////////////////////////////
+
+    /**
+     * @brief Fingertip distance from the ideal path point at a fraction.
+     */
+    double cartesian_trajectory::deviation(const Eigen::Matrix4d& start, const Eigen::Matrix4d& goal, double fraction,
+                                           const finger_model<>::joint_vector& joint_angles) {
+        this->finger.set_joint_angles(joint_angles);
+        return (this->finger.fingertip_position_space() - interpolate(start, goal, fraction, this->path).block<3, 1>(0, 3)).norm();
+    }
+
+}
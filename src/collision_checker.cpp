@@ -0,0 +1,580 @@
+#include "include/collision_checker.hpp"
+#include "include/open_chain_kinematics.hpp"
+#include <Eigen/Dense>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+namespace fm {
+
+    /**
+     * @brief Constructor for the collision_checker class.
+     *
+     * Defaults to no clearance, a 0.1 mm contact tolerance and 10000 advancement steps per trajectory.
+     */
+    collision_checker::collision_checker()
+        : num_joints(0),
+          clearance(0.0),
+          tolerance(1e-4),
+          max_iterations(10000),
+          hierarchy_dirty(true),
+          distance_tests(0)
+    {
+    }
+
+    ////////////////////////////////////////////////////////////
+    // Setter functions
+    ////////////////////////////////////////////////////////////
+
+    /**
+     * @brief Add the link capsules of a finger; links without geometry (zero radius) are skipped.
+     *
+     * Adjacent links of the finger touch at their joint and its first link sits on the palm, so those
+     * pairs are ignored. For conservative advancement every body stores, per joint up to its link, a
+     * bound on its distance from the joint axis: the chain of distances between points on consecutive
+     * joint axes, which are rigid, plus the reach of the capsule from its own joint.
+     *
+     * @param finger Finger model with revolute space screw axes and link geometry set.
+     * @param palm_to_base Pose of the finger's space frame in the palm frame.
+     * @return Finger index; its joints follow those of the fingers added before it.
+     */
+    int collision_checker::add_finger(const finger_model<>& finger, const Eigen::Matrix4d& palm_to_base) {
+        const auto& S_list = finger.get_home_position_screw_axes_space();
+        const int n = static_cast<int>(S_list.cols());
+        std::vector<Eigen::Vector3d> joint_points(n);
+        for (int i = 0; i < n; i++) {
+            if (std::abs(S_list.col(i).head<3>().norm() - 1.0) > 1e-6) {
+                throw std::invalid_argument("collision_checker supports revolute joints only");
+            }
+            // For a unit axis w, v = -w x q, so w x v is the point of the axis closest to the origin
+            joint_points[i] = S_list.col(i).head<3>().cross(S_list.col(i).tail<3>());
+        }
+
+        finger_entry entry;
+        entry.screw_axes = S_list;
+        entry.palm_to_base = palm_to_base;
+        entry.first_joint = this->num_joints;
+        entry.link_bodies.fill(-1);
+        const int f = static_cast<int>(this->fingers.size());
+        for (int k = 0; k < n; k++) {
+            const link_geometry& geometry = finger.get_link_geometry(k);
+            if (!(geometry.radius > 0.0)) {
+                continue;
+            }
+            body_entry body;
+            body.finger = f;
+            body.link = k;
+            body.home.a = geometry.start;
+            body.home.b = geometry.end;
+            body.home.radius = geometry.radius;
+            body.reach.setZero();
+            double chain = std::max((geometry.start - joint_points[k]).norm(), (geometry.end - joint_points[k]).norm()) + geometry.radius;
+            for (int i = k; i >= 0; i--) {
+                body.reach(i) = chain;
+                if (i > 0) {
+                    chain += (joint_points[i] - joint_points[i - 1]).norm();
+                }
+            }
+            entry.link_bodies[k] = static_cast<int>(this->bodies.size());
+            this->bodies.push_back(body);
+        }
+        this->fingers.push_back(entry);
+        this->num_joints += n;
+
+        // Grow the ignore matrix and add the default pairs
+        const int count = static_cast<int>(this->bodies.size());
+        std::vector<char> grown(static_cast<std::size_t>(count) * count, 0);
+        const int previous = static_cast<int>(std::lround(std::sqrt(static_cast<double>(this->ignored_pairs.size()))));
+        for (int a = 0; a < previous; a++) {
+            for (int b = 0; b < previous; b++) {
+                grown[a * count + b] = this->ignored_pairs[a * previous + b];
+            }
+        }
+        this->ignored_pairs.swap(grown);
+        for (int a = previous; a < count; a++) {
+            for (int b = 0; b < count; b++) {
+                const body_entry& other = this->bodies[b];
+                bool adjacent = other.finger == f && std::abs(other.link - this->bodies[a].link) <= 1;
+                bool on_palm = other.finger < 0 && this->bodies[a].link == 0;
+                if (adjacent || on_palm) {
+                    this->ignore_pair(a, b);
+                }
+            }
+        }
+        this->capsules.resize(count);
+        this->motion.assign(count, 0.0);
+        this->hierarchy_dirty = true;
+        return f;
+    }
+
+    /**
+     * @brief Add a capsule fixed in the palm frame. Pairs with other palm capsules and with the first
+     * link of every finger are ignored.
+     * @param geometry Capsule in the palm frame.
+     * @return Body index.
+     */
+    int collision_checker::add_palm_capsule(const capsule& geometry) {
+        if (!(geometry.radius > 0.0) || !geometry.a.allFinite() || !geometry.b.allFinite()) {
+            throw std::invalid_argument("palm capsule must have finite ends and a positive radius");
+        }
+        body_entry body;
+        body.finger = -1;
+        body.link = -1;
+        body.home = geometry;
+        body.reach.setZero();
+        this->bodies.push_back(body);
+
+        const int count = static_cast<int>(this->bodies.size());
+        std::vector<char> grown(static_cast<std::size_t>(count) * count, 0);
+        for (int a = 0; a + 1 < count; a++) {
+            for (int b = 0; b + 1 < count; b++) {
+                grown[a * count + b] = this->ignored_pairs[a * (count - 1) + b];
+            }
+        }
+        this->ignored_pairs.swap(grown);
+        for (int b = 0; b < count; b++) {
+            if (this->bodies[b].finger < 0 || this->bodies[b].link == 0) {
+                this->ignore_pair(count - 1, b);
+            }
+        }
+        this->capsules.resize(count);
+        this->motion.assign(count, 0.0);
+        this->hierarchy_dirty = true;
+        return count - 1;
+    }
+
+    /**
+     * @brief Exclude a pair of bodies from every check, e.g. links that overlap by design.
+     * @param body_a First body.
+     * @param body_b Second body.
+     */
+    void collision_checker::ignore_pair(int body_a, int body_b) {
+        const int count = static_cast<int>(this->bodies.size());
+        if (body_a < 0 || body_a >= count || body_b < 0 || body_b >= count) {
+            throw std::invalid_argument("body index is out of range");
+        }
+        this->ignored_pairs[body_a * count + body_b] = 1;
+        this->ignored_pairs[body_b * count + body_a] = 1;
+    }
+
+    /**
+     * @brief Set the distance below which two bodies count as colliding.
+     * @param clearance Non-negative clearance.
+     */
+    void collision_checker::set_clearance(double clearance) {
+        if (!(clearance >= 0.0)) {
+            throw std::invalid_argument("clearance must be non-negative");
+        }
+        this->clearance = clearance;
+    }
+
+    /**
+     * @brief Set how close to the clearance advancement stops and reports a contact.
+     * @param tolerance Positive tolerance.
+     */
+    void collision_checker::set_tolerance(double tolerance) {
+        if (!(tolerance > 0.0)) {
+            throw std::invalid_argument("tolerance must be positive");
+        }
+        this->tolerance = tolerance;
+    }
+
+    /**
+     * @brief Set the number of advancement steps after which a trajectory is reported as colliding.
+     * @param max_iterations Positive step limit.
+     */
+    void collision_checker::set_max_iterations(long max_iterations) {
+        if (max_iterations <= 0) {
+            throw std::invalid_argument("max_iterations must be positive");
+        }
+        this->max_iterations = max_iterations;
+    }
+
+    ////////////////////////////////////////////////////////////
+    // Getter functions
+    ////////////////////////////////////////////////////////////
+
+    int collision_checker::get_num_fingers() const {
+        return static_cast<int>(this->fingers.size());
+    }
+
+    /**
+     * @brief Total number of joints; joint vectors stack the fingers in the order they were added.
+     */
+    int collision_checker::get_num_joints() const {
+        return this->num_joints;
+    }
+
+    int collision_checker::get_num_bodies() const {
+        return static_cast<int>(this->bodies.size());
+    }
+
+    /**
+     * @brief Finger a body belongs to, -1 for palm capsules.
+     */
+    int collision_checker::get_body_finger(int body) const {
+        if (body < 0 || body >= static_cast<int>(this->bodies.size())) {
+            throw std::invalid_argument("body index is out of range");
+        }
+        return this->bodies[body].finger;
+    }
+
+    /**
+     * @brief Link a body belongs to, -1 for palm capsules.
+     */
+    int collision_checker::get_body_link(int body) const {
+        if (body < 0 || body >= static_cast<int>(this->bodies.size())) {
+            throw std::invalid_argument("body index is out of range");
+        }
+        return this->bodies[body].link;
+    }
+
+    /**
+     * @brief Body capsules in the palm frame at the last update.
+     */
+    const std::vector<capsule>& collision_checker::get_body_capsules() const {
+        return this->capsules;
+    }
+
+    /**
+     * @brief Number of exact capsule distance evaluations since the checker was created.
+     */
+    long collision_checker::get_num_distance_tests() const {
+        return this->distance_tests;
+    }
+
+    ////////////////////////////////////////////////////////////
+    // Member functions
+    ////////////////////////////////////////////////////////////
+
+    /**
+     * @brief Place the body capsules at the given joint angles and refit the hierarchy.
+     *
+     * The hierarchy is built top-down from the first placement after bodies are added and only refit
+     * afterwards, since links stay grouped by finger as the hand moves.
+     *
+     * @param joint_angles Joint angles of all fingers.
+     */
+    void collision_checker::update(const Eigen::Ref<const Eigen::VectorXd>& joint_angles) {
+        if (joint_angles.size() != this->num_joints) {
+            throw std::invalid_argument("joint_angles must have one element per joint of all fingers");
+        }
+        if (this->bodies.empty()) {
+            throw std::runtime_error("no bodies have been added");
+        }
+
+        for (const finger_entry& finger : this->fingers) {
+            Eigen::Matrix4d T = finger.palm_to_base;
+            for (int k = 0; k < finger.screw_axes.cols(); k++) {
+                T = T * rigid_body_motion::Screw_Exponential(finger.screw_axes.col(k), joint_angles(finger.first_joint + k));
+                const int b = finger.link_bodies[k];
+                if (b >= 0) {
+                    this->capsules[b].a = T.block<3, 3>(0, 0) * this->bodies[b].home.a + T.block<3, 1>(0, 3);
+                    this->capsules[b].b = T.block<3, 3>(0, 0) * this->bodies[b].home.b + T.block<3, 1>(0, 3);
+                    this->capsules[b].radius = this->bodies[b].home.radius;
+                }
+            }
+        }
+        for (std::size_t b = 0; b < this->bodies.size(); b++) {
+            if (this->bodies[b].finger < 0) {
+                this->capsules[b] = this->bodies[b].home;
+            }
+        }
+
+        if (this->hierarchy_dirty) {
+            this->build_hierarchy();
+        }
+        // Children follow their parents, so a reverse sweep refits bottom-up
+        for (int i = static_cast<int>(this->nodes.size()) - 1; i >= 0; i--) {
+            bvh_node& node = this->nodes[i];
+            if (node.body >= 0) {
+                node.bounds = this->capsules[node.body].bounds();
+                node.motion = this->motion[node.body];
+                node.radius = this->capsules[node.body].radius;
+            } else {
+                const bvh_node& left = this->nodes[node.left];
+                const bvh_node& right = this->nodes[node.right];
+                node.bounds.min = left.bounds.min.cwiseMin(right.bounds.min);
+                node.bounds.max = left.bounds.max.cwiseMax(right.bounds.max);
+                node.motion = std::max(left.motion, right.motion);
+                node.radius = std::max(left.radius, right.radius);
+            }
+        }
+    }
+
+    /**
+     * @brief Smallest distance between the surfaces of two checked bodies.
+     * @param joint_angles Joint angles of all fingers.
+     * @param body_a Output first body of the closest pair, -1 if no pair is checked.
+     * @param body_b Output second body of the closest pair.
+     * @return Distance, negative when penetrating; infinity if no pair is checked.
+     */
+    double collision_checker::distance(const Eigen::Ref<const Eigen::VectorXd>& joint_angles, int& body_a, int& body_b) {
+        std::fill(this->motion.begin(), this->motion.end(), 0.0);
+        this->update(joint_angles);
+        pair_query result{std::numeric_limits<double>::infinity(), std::numeric_limits<double>::infinity(), -1, -1, false};
+        this->query(result);
+        body_a = result.body_a;
+        body_b = result.body_b;
+        return result.slack + this->clearance;
+    }
+
+    /**
+     * @brief Whether two checked bodies are closer than the clearance plus the tolerance.
+     * @param joint_angles Joint angles of all fingers.
+     * @return True on collision.
+     */
+    bool collision_checker::in_collision(const Eigen::Ref<const Eigen::VectorXd>& joint_angles) {
+        std::fill(this->motion.begin(), this->motion.end(), 0.0);
+        this->update(joint_angles);
+        pair_query result{std::numeric_limits<double>::infinity(), std::numeric_limits<double>::infinity(), -1, -1, true};
+        this->query(result);
+        return result.slack <= this->tolerance;
+    }
+
+    /**
+     * @brief Check the straight joint space motion between two configurations.
+     * @param start Joint angles at the start.
+     * @param end Joint angles at the end.
+     * @return First contact, if any.
+     */
+    collision_report collision_checker::check_segment(const Eigen::Ref<const Eigen::VectorXd>& start, const Eigen::Ref<const Eigen::VectorXd>& end) {
+        Eigen::MatrixXd waypoints(start.size(), 2);
+        waypoints << start, end;
+        return this->check_trajectory(waypoints);
+    }
+
+    /**
+     * @brief Check a piecewise linear joint trajectory for the first contact with conservative advancement.
+     *
+     * Along a segment every point of link k moves at most sum_i |dtheta_i| r_ik, with r_ik the reach bound
+     * from add_finger. Each step evaluates the pairs at the current configuration through the hierarchy
+     * and advances by the larger of two safe steps: within the segment, the smallest pair slack over
+     * that pair's motion bound; and across segments, the smallest slack spent at the rate of the two
+     * fastest bodies of each segment, so quiet stretches of a long trajectory are crossed in one step.
+     * Advancement stops when a pair comes within the tolerance of the clearance.
+     *
+     * @param waypoints Joint angles of all fingers, one column per waypoint.
+     * @return First contact; segment -1 if the trajectory is free.
+     */
+    collision_report collision_checker::check_trajectory(const Eigen::Ref<const Eigen::MatrixXd>& waypoints) {
+        if (waypoints.rows() != this->num_joints || waypoints.cols() < 1) {
+            throw std::invalid_argument("waypoints must have one row per joint of all fingers and at least one column");
+        }
+        const long segments = waypoints.cols() - 1;
+        collision_report report;
+        if (segments == 0) {
+            report.collision = this->in_collision(waypoints.col(0));
+            report.segment = report.collision ? 0 : -1;
+            report.iterations = 1;
+            return report;
+        }
+
+        std::vector<double> scratch(this->bodies.size());
+        long s = 0;
+        double t = 0.0;
+        this->segment_motion(waypoints.col(0), waypoints.col(1), this->motion);
+        Eigen::VectorXd q(this->num_joints);
+        while (report.iterations < this->max_iterations) {
+            report.iterations++;
+            q = (1.0 - t) * waypoints.col(s) + t * waypoints.col(s + 1);
+            this->update(q);
+            pair_query result{std::numeric_limits<double>::infinity(), std::numeric_limits<double>::infinity(), -1, -1, true};
+            this->query(result);
+            if (result.slack <= this->tolerance) {
+                report.collision = true;
+                report.segment = s;
+                report.time = t;
+                report.body_a = result.body_a;
+                report.body_b = result.body_b;
+                report.distance = result.slack;
+                return report;
+            }
+
+            // Spend the smallest slack across segments at the rate of the fastest pair
+            long s_next = s;
+            double t_next = t, budget = result.slack;
+            while (s_next < segments) {
+                const double rate = this->segment_motion(waypoints.col(s_next), waypoints.col(s_next + 1), scratch);
+                const double need = rate * (1.0 - t_next);
+                if (budget < need) {
+                    t_next += budget / rate;
+                    break;
+                }
+                budget -= need;
+                s_next++;
+                t_next = 0.0;
+            }
+            // Within the segment the pairwise bound is tighter
+            if (s_next == s) {
+                t_next = std::max(t_next, t + result.ratio);
+                if (t_next >= 1.0) {
+                    s_next = s + 1;
+                    t_next = 0.0;
+                }
+            }
+            if (s_next >= segments) {
+                return report;
+            }
+            if (s_next != s) {
+                this->segment_motion(waypoints.col(s_next), waypoints.col(s_next + 1), this->motion);
+            }
+            s = s_next;
+            t = t_next;
+        }
+
+        // Out of steps; most likely grazing along the clearance, so report it as a contact
+        report.collision = true;
+        report.segment = s;
+        report.time = t;
+        return report;
+    }
+
+    ////////////////////////////////////////////////////////////
+    // Private functions
+    ////////////////////////////////////////////////////////////
+
+    /**
+     * @brief Build the hierarchy top-down over the current capsules.
+     */
+    void collision_checker::build_hierarchy() {
+        std::vector<int> order(this->bodies.size());
+        for (std::size_t b = 0; b < order.size(); b++) {
+            order[b] = static_cast<int>(b);
+        }
+        this->nodes.clear();
+        this->nodes.reserve(2 * order.size());
+        this->build_node(order, 0, static_cast<int>(order.size()));
+        this->hierarchy_dirty = false;
+    }
+
+    /**
+     * @brief Build the subtree over bodies [begin, end), split at the median capsule center along the
+     * widest axis of the centers.
+     * @return Node index.
+     */
+    int collision_checker::build_node(std::vector<int>& order, int begin, int end) {
+        const int index = static_cast<int>(this->nodes.size());
+        this->nodes.push_back({aabb(), 0.0, 0.0, -1, -1, -1});
+        if (end - begin == 1) {
+            this->nodes[index].body = order[begin];
+            return index;
+        }
+
+        auto center = [this](int b) { return 0.5 * (this->capsules[b].a + this->capsules[b].b); };
+        Eigen::Vector3d low = center(order[begin]), high = low;
+        for (int i = begin + 1; i < end; i++) {
+            low = low.cwiseMin(center(order[i]));
+            high = high.cwiseMax(center(order[i]));
+        }
+        Eigen::Index axis;
+        (high - low).maxCoeff(&axis);
+        const int middle = (begin + end) / 2;
+        std::nth_element(order.begin() + begin, order.begin() + middle, order.begin() + end,
+                         [&](int a, int b) { return center(a)(axis) < center(b)(axis); });
+        const int left = this->build_node(order, begin, middle);
+        const int right = this->build_node(order, middle, end);
+        this->nodes[index].left = left;
+        this->nodes[index].right = right;
+        return index;
+    }
+
+    /**
+     * @brief Motion bound of every body along a segment and the rate of the two fastest bodies.
+     * @param start Joint angles at the start.
+     * @param end Joint angles at the end.
+     * @param motion Output largest displacement of any point of each body over the segment.
+     * @return Sum of the two largest motion bounds, an upper bound for any pair.
+     */
+    double collision_checker::segment_motion(const Eigen::Ref<const Eigen::VectorXd>& start, const Eigen::Ref<const Eigen::VectorXd>& end, std::vector<double>& motion) const {
+        double first = 0.0, second = 0.0;
+        for (std::size_t b = 0; b < this->bodies.size(); b++) {
+            const body_entry& body = this->bodies[b];
+            double bound = 0.0;
+            if (body.finger >= 0) {
+                const int first_joint = this->fingers[body.finger].first_joint;
+                for (int i = 0; i <= body.link; i++) {
+                    bound += std::abs(end(first_joint + i) - start(first_joint + i)) * body.reach(i);
+                }
+            }
+            motion[b] = bound;
+            if (bound > first) {
+                second = first;
+                first = bound;
+            } else if (bound > second) {
+                second = bound;
+            }
+        }
+        return first + second;
+    }
+
+    void collision_checker::query(pair_query& result) {
+        if (!this->nodes.empty()) {
+            this->query_nodes(0, 0, result);
+        }
+    }
+
+    /**
+     * @brief Visit the pairs of bodies below two nodes, pruning node pairs whose box distance can improve
+     * neither the smallest slack nor the smallest slack over motion.
+     */
+    void collision_checker::query_nodes(int a, int b, pair_query& result) {
+        if (result.stop_at_contact && result.slack <= this->tolerance) {
+            return;
+        }
+        const bvh_node& A = this->nodes[a];
+        const bvh_node& B = this->nodes[b];
+        if (a == b) {
+            if (A.body < 0) {
+                this->query_nodes(A.left, A.left, result);
+                this->query_nodes(A.right, A.right, result);
+                this->query_nodes(A.left, A.right, result);
+            }
+            return;
+        }
+
+        // Separated boxes bound the distance from below; overlapping ones only the penetration depth
+        double gap = A.bounds.distance(B.bounds);
+        gap = (gap > 0.0 ? gap : -A.radius - B.radius) - this->clearance;
+        const double rate = A.motion + B.motion;
+        if (gap >= result.slack && (rate <= 0.0 || gap >= result.ratio * rate)) {
+            return;
+        }
+        if (A.body >= 0 && B.body >= 0) {
+            if (this->ignored(A.body, B.body)) {
+                return;
+            }
+            double s, t;
+            const capsule& ca = this->capsules[A.body];
+            const capsule& cb = this->capsules[B.body];
+            const double slack = geometry::segment_segment_distance(ca.a, ca.b, cb.a, cb.b, s, t) - ca.radius - cb.radius - this->clearance;
+            this->distance_tests++;
+            if (slack < result.slack) {
+                result.slack = slack;
+                result.body_a = A.body;
+                result.body_b = B.body;
+            }
+            if (rate > 0.0) {
+                result.ratio = std::min(result.ratio, slack / rate);
+            }
+            return;
+        }
+
+        // Descend into the inner node with the larger box
+        const bool split_a = B.body >= 0 || (A.body < 0 && (A.bounds.max - A.bounds.min).squaredNorm() >= (B.bounds.max - B.bounds.min).squaredNorm());
+        if (split_a) {
+            this->query_nodes(A.left, b, result);
+            this->query_nodes(A.right, b, result);
+        } else {
+            this->query_nodes(a, B.left, result);
+            this->query_nodes(a, B.right, result);
+        }
+    }
+
+    bool collision_checker::ignored(int body_a, int body_b) const {
+        return this->ignored_pairs[body_a * this->bodies.size() + body_b] != 0;
+    }
+
+}
@@ -0,0 +1,261 @@
+#include "include/collision_geometry.hpp"
+#include <Eigen/Dense>
+#include <algorithm>
+#include <cmath>
+
+namespace fm {
+
+    ////////////////////////////////////////////////////////////
+    // Bounding boxes
+    ////////////////////////////////////////////////////////////
+
+    /**
+     * @brief Check whether two axis-aligned boxes overlap.
+     * @param other Other box.
+     * @return True if the boxes overlap or touch.
+     */
+    bool aabb::overlaps(const aabb& other) const {
+        return (min.array() <= other.max.array()).all() && (other.min.array() <= max.array()).all();
+    }
+
+    /**
+     * @brief Grow the box by a margin on every side.
+     * @param margin Margin in meters.
+     * @return Inflated box.
+     */
+    aabb aabb::inflated(double margin) const {
+        aabb result;
+        result.min = min.array() - margin;
+        result.max = max.array() + margin;
+        return result;
+    }
+
+    /**
+     * @brief Distance between two axis-aligned boxes.
+     * @param other Other box.
+     * @return Euclidean gap between the boxes, zero if they overlap.
+     */
+    double aabb::distance(const aabb& other) const {
+        Eigen::Vector3d gap = (other.min - max).cwiseMax(min - other.max).cwiseMax(0.0);
+        return gap.norm();
+    }
+
+    /**
+     * @brief Bounding box of a capsule.
+     * @return Axis-aligned bounding box.
+     */
+    aabb capsule::bounds() const {
+        aabb result;
+        result.min = a.cwiseMin(b).array() - radius;
+        result.max = a.cwiseMax(b).array() + radius;
+        return result;
+    }
+
+    /**
+     * @brief Bounding box of a sphere.
+     * @return Axis-aligned bounding box.
+     */
+    aabb sphere::bounds() const {
+        aabb result;
+        result.min = center.array() - radius;
+        result.max = center.array() + radius;
+        return result;
+    }
+
+    /**
+     * @brief Bounding box of an oriented box.
+     * @return Axis-aligned bounding box.
+     */
+    aabb box::bounds() const {
+        Eigen::Vector3d extent = rotation.cwiseAbs() * half_extents;
+        aabb result;
+        result.min = center - extent;
+        result.max = center + extent;
+        return result;
+    }
+
+    namespace geometry {
+
+        /**
+         * @brief Closest point on a segment to a point.
+         * @param a Segment start.
+         * @param b Segment end.
+         * @param p Query point.
+         * @param t Output segment parameter of the closest point in [0, 1].
+         * @return Closest point.
+         */
+        Eigen::Vector3d closest_point_on_segment(const Eigen::Vector3d& a, const Eigen::Vector3d& b, const Eigen::Vector3d& p, double& t) {
+            Eigen::Vector3d d = b - a;
+            double length_squared = d.squaredNorm();
+            t = length_squared > 1e-24 ? std::min(std::max((p - a).dot(d) / length_squared, 0.0), 1.0) : 0.0;
+            return a + t * d;
+        }
+
+        /**
+         * @brief Distance between two segments and the parameters of their closest points.
+         * @param p0 First segment start.
+         * @param p1 First segment end.
+         * @param q0 Second segment start.
+         * @param q1 Second segment end.
+         * @param s Output parameter on the first segment.
+         * @param t Output parameter on the second segment.
+         * @return Distance between the segments.
+         */
+        double segment_segment_distance(const Eigen::Vector3d& p0, const Eigen::Vector3d& p1, const Eigen::Vector3d& q0, const Eigen::Vector3d& q1,
+                                        double& s, double& t) {
+            const double eps = 1e-24;
+            Eigen::Vector3d d1 = p1 - p0, d2 = q1 - q0, r = p0 - q0;
+            double a = d1.squaredNorm(), e = d2.squaredNorm(), f = d2.dot(r);
+
+            if (a <= eps && e <= eps) {
+                s = t = 0.0;
+            } else if (a <= eps) {
+                s = 0.0;
+                t = std::min(std::max(f / e, 0.0), 1.0);
+            } else {
+                double c = d1.dot(r);
+                if (e <= eps) {
+                    t = 0.0;
+                    s = std::min(std::max(-c / a, 0.0), 1.0);
+                } else {
+                    double b = d1.dot(d2), denom = a * e - b * b;
+                    s = denom > eps ? std::min(std::max((b * f - c * e) / denom, 0.0), 1.0) : 0.0;
+                    t = (b * s + f) / e;
+                    if (t < 0.0) {
+                        t = 0.0;
+                        s = std::min(std::max(-c / a, 0.0), 1.0);
+                    } else if (t > 1.0) {
+                        t = 1.0;
+                        s = std::min(std::max((b - c) / a, 0.0), 1.0);
+                    }
+                }
+            }
+            return ((p0 + s * d1) - (q0 + t * d2)).norm();
+        }
+
+        /**
+         * @brief Signed distance from a point to an oriented box.
+         * @param b Box.
+         * @param p Query point.
+         * @param normal Output outward surface normal at the closest point.
+         * @return Signed distance; negative inside the box.
+         */
+        double box_signed_distance(const box& b, const Eigen::Vector3d& p, Eigen::Vector3d& normal) {
+            Eigen::Vector3d q = b.rotation.transpose() * (p - b.center);
+            Eigen::Vector3d d = q.cwiseAbs() - b.half_extents;
+
+            if ((d.array() > 0.0).any()) {
+                Eigen::Vector3d outside = q - q.cwiseMax(-b.half_extents).cwiseMin(b.half_extents);
+                double distance = outside.norm();
+                normal = b.rotation * (outside / distance);
+                return distance;
+            }
+
+            int axis;
+            double distance = d.maxCoeff(&axis);
+            Eigen::Vector3d local = Eigen::Vector3d::Zero();
+            local(axis) = q(axis) >= 0.0 ? 1.0 : -1.0;
+            normal = b.rotation * local;
+            return distance;
+        }
+
+        /**
+         * @brief Signed distance between a capsule and a half-space.
+         * @param c Capsule.
+         * @param pl Plane.
+         * @param point Output deepest point on the capsule surface.
+         * @param normal Output plane normal.
+         * @return Signed distance.
+         */
+        double capsule_plane(const capsule& c, const plane& pl, Eigen::Vector3d& point, Eigen::Vector3d& normal) {
+            double da = pl.normal.dot(c.a) - pl.offset;
+            double db = pl.normal.dot(c.b) - pl.offset;
+            normal = pl.normal;
+            point = (da <= db ? c.a : c.b) - c.radius * pl.normal;
+            return std::min(da, db) - c.radius;
+        }
+
+        /**
+         * @brief Signed distance between a capsule and a sphere.
+         * @param c Capsule.
+         * @param s Sphere.
+         * @param point Output deepest point on the capsule surface.
+         * @param normal Output normal from the sphere toward the capsule.
+         * @return Signed distance.
+         */
+        double capsule_sphere(const capsule& c, const sphere& s, Eigen::Vector3d& point, Eigen::Vector3d& normal) {
+            double t;
+            Eigen::Vector3d x = closest_point_on_segment(c.a, c.b, s.center, t);
+            Eigen::Vector3d v = x - s.center;
+            double distance = v.norm();
+            normal = distance > 1e-12 ? Eigen::Vector3d(v / distance) : Eigen::Vector3d::UnitZ();
+            point = x - c.radius * normal;
+            return distance - c.radius - s.radius;
+        }
+
+        /**
+         * @brief Signed distance between a capsule and an oriented box.
+         *
+         * The signed distance to a convex set is a convex function, so its minimum along the capsule
+         * segment is found with a golden-section search.
+         *
+         * @param c Capsule.
+         * @param b Box.
+         * @param point Output deepest point on the capsule surface.
+         * @param normal Output normal from the box toward the capsule.
+         * @return Signed distance.
+         */
+        double capsule_box(const capsule& c, const box& b, Eigen::Vector3d& point, Eigen::Vector3d& normal) {
+            const double ratio = 0.5 * (std::sqrt(5.0) - 1.0);
+            Eigen::Vector3d d = c.b - c.a, n;
+            double lo = 0.0, hi = 1.0;
+            double t1 = hi - ratio * (hi - lo), t2 = lo + ratio * (hi - lo);
+            double f1 = box_signed_distance(b, c.a + t1 * d, n), f2 = box_signed_distance(b, c.a + t2 * d, n);
+            for (int i = 0; i < 40; i++) {
+                if (f1 <= f2) {
+                    hi = t2; t2 = t1; f2 = f1;
+                    t1 = hi - ratio * (hi - lo);
+                    f1 = box_signed_distance(b, c.a + t1 * d, n);
+                } else {
+                    lo = t1; t1 = t2; f1 = f2;
+                    t2 = lo + ratio * (hi - lo);
+                    f2 = box_signed_distance(b, c.a + t2 * d, n);
+                }
+            }
+
+            // The minimum of a convex function can sit at an endpoint
+            double best_t = 0.5 * (lo + hi);
+            double best = box_signed_distance(b, c.a + best_t * d, normal);
+            for (double t : {0.0, 1.0}) {
+                double f = box_signed_distance(b, c.a + t * d, n);
+                if (f < best) {
+                    best = f;
+                    best_t = t;
+                    normal = n;
+                }
+            }
+            point = c.a + best_t * d - c.radius * normal;
+            return best - c.radius;
+        }
+
+        /**
+         * @brief Signed distance between two capsules.
+         * @param c0 First capsule.
+         * @param c1 Second capsule.
+         * @param point Output deepest point on the surface of the first capsule.
+         * @param normal Output normal from the second capsule toward the first.
+         * @return Signed distance.
+         */
+        double capsule_capsule(const capsule& c0, const capsule& c1, Eigen::Vector3d& point, Eigen::Vector3d& normal) {
+            double s, t;
+            double distance = segment_segment_distance(c0.a, c0.b, c1.a, c1.b, s, t);
+            Eigen::Vector3d p = c0.a + s * (c0.b - c0.a);
+            Eigen::Vector3d q = c1.a + t * (c1.b - c1.a);
+            normal = distance > 1e-12 ? Eigen::Vector3d((p - q) / distance) : Eigen::Vector3d::UnitZ();
+            point = p - c0.radius * normal;
+            return distance - c0.radius - c1.radius;
+        }
+
+    }
+
+}
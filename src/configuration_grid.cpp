@@ -0,0 +1,105 @@
+#include "include/configuration_grid.hpp"
+#include <Eigen/Dense>
+#include <stdexcept>
+
+namespace fm {
+
+    /**
+     * @brief Constructor for the configuration_grid class.
+     * @param joint_min Lower joint limits.
+     * @param joint_max Upper joint limits.
+     * @param samples Number of samples along every joint (1 samples the lower limit only).
+     */
+    configuration_grid::configuration_grid(const Eigen::VectorXd& joint_min, const Eigen::VectorXd& joint_max, const Eigen::VectorXi& samples)
+        : joint_min(joint_min),
+          joint_max(joint_max),
+          samples(samples),
+          num_points(1)
+    {
+        if (joint_min.size() < 1 || joint_max.size() != joint_min.size() || samples.size() != joint_min.size()) {
+            throw std::invalid_argument("joint_min, joint_max and samples must have one element per joint");
+        }
+        if ((samples.array() < 1).any() || (joint_max.array() < joint_min.array()).any()) {
+            throw std::invalid_argument("samples must be positive and joint_max must not be below joint_min");
+        }
+
+        this->spacing.resize(joint_min.size());
+        for (int j = 0; j < joint_min.size(); j++) {
+            this->spacing(j) = samples(j) > 1 ? (joint_max(j) - joint_min(j)) / (samples(j) - 1) : 0.0;
+            this->num_points *= samples(j);
+        }
+    }
+
+    ////////////////////////////////////////////////////////////
+    // Getter functions
+    ////////////////////////////////////////////////////////////
+
+    /**
+     * @brief Get the lower joint limits.
+     * @return Vector of lower limits.
+     */
+    const Eigen::VectorXd& configuration_grid::get_joint_min() const {
+        return joint_min;
+    }
+
+    /**
+     * @brief Get the upper joint limits.
+     * @return Vector of upper limits.
+     */
+    const Eigen::VectorXd& configuration_grid::get_joint_max() const {
+        return joint_max;
+    }
+
+    /**
+     * @brief Get the number of samples along every joint.
+     * @return Vector of sample counts.
+     */
+    const Eigen::VectorXi& configuration_grid::get_samples() const {
+        return samples;
+    }
+
+    /**
+     * @brief Get the number of joints.
+     * @return Number of joints.
+     */
+    int configuration_grid::get_num_joints() const {
+        return static_cast<int>(joint_min.size());
+    }
+
+    /**
+     * @brief Get the total number of grid points.
+     * @return Number of grid points.
+     */
+    long configuration_grid::size() const {
+        return num_points;
+    }
+
+    ////////////////////////////////////////////////////////////
+    // Member functions
+    ////////////////////////////////////////////////////////////
+
+    /**
+     * @brief Get the joint angles of a grid point without allocating.
+     * @param index Grid point index.
+     * @param joint_angles Output joint angles.
+     */
+    void configuration_grid::point(long index, Eigen::Ref<Eigen::VectorXd> joint_angles) const {
+        for (int j = 0; j < this->joint_min.size(); j++) {
+            long k = index % this->samples(j);
+            index /= this->samples(j);
+            joint_angles(j) = this->joint_min(j) + k * this->spacing(j);
+        }
+    }
+
+    /**
+     * @brief Get the joint angles of a grid point.
+     * @param index Grid point index.
+     * @return Joint angles.
+     */
+    Eigen::VectorXd configuration_grid::point(long index) const {
+        Eigen::VectorXd joint_angles(this->joint_min.size());
+        this->point(index, joint_angles);
+        return joint_angles;
+    }
+
+}
@@ -0,0 +1,247 @@
+#include "include/contact_model.hpp"
+#include <Eigen/Dense>
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+namespace fm {
+
+    /**
+     * @brief Constructor for the contact_model class.
+     *
+     * Every link is modelled as a capsule from its joint to the next joint, the last link ending at the
+     * fingertip. Joint points at the home configuration are recovered from the space screw axes.
+     *
+     * @param finger Finger model with screw axes and home frame set.
+     * @param link_radii Capsule radius of every link.
+     * @param parameters Contact stiffness, damping and friction.
+     */
+    contact_model::contact_model(const finger_model<>& finger, const Eigen::VectorXd& link_radii, const contact_parameters& parameters)
+        : finger(finger),
+          link_radii(link_radii),
+          parameters(parameters),
+          narrow_phase_tests(0)
+    {
+        const auto& S_list = finger.get_home_position_screw_axes_space();
+        if (S_list.cols() != link_radii.size()) {
+            throw std::invalid_argument("link_radii must have one element per joint");
+        }
+        for (int i = 0; i < S_list.cols(); i++) {
+            Eigen::Matrix<double, 6, 1> screw = S_list.col(i);
+            // For a revolute joint with unit axis w, v = -w x q, so w x v is the point of the axis closest to the origin
+            this->home_joint_points.push_back(screw.head<3>().cross(screw.tail<3>()));
+        }
+
+        const int n = finger.get_num_joints();
+        this->link_capsules.resize(n);
+        this->joint_torques = Eigen::VectorXd::Zero(n);
+        this->set_contact_parameters(parameters);
+    }
+
+    ////////////////////////////////////////////////////////////
+    // Setter functions
+    ////////////////////////////////////////////////////////////
+
+    /**
+     * @brief Add a half-space obstacle such as the testbed table.
+     * @param object Plane.
+     * @return Object index.
+     */
+    int contact_model::add_plane(const plane& object) {
+        this->planes.push_back(object);
+        this->objects.push_back({shape::plane, static_cast<int>(this->planes.size()) - 1, aabb()});
+        return static_cast<int>(this->objects.size()) - 1;
+    }
+
+    /**
+     * @brief Add a spherical object.
+     * @param object Sphere.
+     * @return Object index.
+     */
+    int contact_model::add_sphere(const sphere& object) {
+        this->spheres.push_back(object);
+        this->objects.push_back({shape::sphere, static_cast<int>(this->spheres.size()) - 1, object.bounds()});
+        return static_cast<int>(this->objects.size()) - 1;
+    }
+
+    /**
+     * @brief Add a box object such as a load cell platen.
+     * @param object Box.
+     * @return Object index.
+     */
+    int contact_model::add_box(const box& object) {
+        this->boxes.push_back(object);
+        this->objects.push_back({shape::box, static_cast<int>(this->boxes.size()) - 1, object.bounds()});
+        return static_cast<int>(this->objects.size()) - 1;
+    }
+
+    /**
+     * @brief Set the contact parameters.
+     * @param parameters Contact stiffness, damping and friction.
+     */
+    void contact_model::set_contact_parameters(const contact_parameters& parameters) {
+        if (parameters.stiffness <= 0.0 || parameters.damping < 0.0 || parameters.friction_coefficient < 0.0 || parameters.slip_velocity <= 0.0) {
+            throw std::invalid_argument("contact parameters must be non-negative with positive stiffness and slip velocity");
+        }
+        this->parameters = parameters;
+    }
+
+    ////////////////////////////////////////////////////////////
+    // Getter functions
+    ////////////////////////////////////////////////////////////
+
+    /**
+     * @brief Get the link capsules of the last update.
+     * @return Vector of capsules, one per link.
+     */
+    const std::vector<capsule>& contact_model::get_link_capsules() const {
+        return link_capsules;
+    }
+
+    /**
+     * @brief Get the active contacts of the last evaluation.
+     * @return Vector of contact points.
+     */
+    const std::vector<contact_point>& contact_model::get_contacts() const {
+        return contacts;
+    }
+
+    /**
+     * @brief Get the total force the finger applies on an object, i.e. a simulated load cell reading.
+     * @param object Object index.
+     * @return Force on the object.
+     */
+    Eigen::Vector3d contact_model::get_object_force(int object) const {
+        Eigen::Vector3d force = Eigen::Vector3d::Zero();
+        for (const auto& c : contacts) {
+            if (c.object == object) {
+                force -= c.force;
+            }
+        }
+        return force;
+    }
+
+    /**
+     * @brief Get the number of exact capsule-object tests of the last evaluation.
+     * @return Number of narrow phase tests.
+     */
+    int contact_model::get_num_narrow_phase_tests() const {
+        return narrow_phase_tests;
+    }
+
+    ////////////////////////////////////////////////////////////
+    // Member functions
+    ////////////////////////////////////////////////////////////
+
+    /**
+     * @brief Place the link capsules and space Jacobian columns at the given joint angles.
+     * @param joint_angles Joint angles.
+     */
+    void contact_model::update_link_capsules(const Eigen::VectorXd& joint_angles) {
+        const int n = this->finger.get_num_joints();
+        if (joint_angles.size() != n) {
+            throw std::invalid_argument("joint_angles must have one element per joint");
+        }
+
+        // A joint point stays on its own axis, so link i's frame carries it to the capsule start
+        Eigen::Matrix4d T;
+        this->finger.space_jacobian(joint_angles, this->space_jacobian, &T);
+        this->finger.link_frames_space(joint_angles, this->link_frames);
+        for (int i = 0; i < n; i++) {
+            const Eigen::Matrix4d& frame = this->link_frames[i];
+            this->link_capsules[i].a = frame.block<3, 3>(0, 0) * this->home_joint_points[i] + frame.block<3, 1>(0, 3);
+            this->link_capsules[i].radius = this->link_radii(i);
+            if (i > 0) {
+                this->link_capsules[i - 1].b = this->link_capsules[i].a;
+            }
+        }
+        this->link_capsules[n - 1].b = T.block<3, 1>(0, 3);
+    }
+
+    /**
+     * @brief Detect contacts and compute the resulting joint torques.
+     *
+     * The broad phase rejects an object when its bounding box misses the box around all links, then
+     * tests each link's box, so the narrow phase only runs for links near an object. Each contact
+     * pushes the link out with a penalty force k * depth - c * v_n (never pulling) and opposes sliding
+     * with Coulomb friction mu * F_n, regularized below the slip velocity.
+     *
+     * @param joint_angles Joint angles.
+     * @param joint_velocities Joint velocities.
+     * @return Joint torques produced by the contacts.
+     */
+    const Eigen::VectorXd& contact_model::evaluate(const Eigen::VectorXd& joint_angles, const Eigen::VectorXd& joint_velocities) {
+        const int n = this->finger.get_num_joints();
+        if (joint_velocities.size() != n) {
+            throw std::invalid_argument("joint_velocities must have one element per joint");
+        }
+
+        this->update_link_capsules(joint_angles);
+        this->contacts.clear();
+        this->joint_torques.setZero();
+        this->narrow_phase_tests = 0;
+
+        aabb finger_bounds = this->link_capsules[0].bounds();
+        for (int k = 1; k < n; k++) {
+            aabb link_bounds = this->link_capsules[k].bounds();
+            finger_bounds.min = finger_bounds.min.cwiseMin(link_bounds.min);
+            finger_bounds.max = finger_bounds.max.cwiseMax(link_bounds.max);
+        }
+
+        for (int o = 0; o < static_cast<int>(this->objects.size()); o++) {
+            const object_entry& object = this->objects[o];
+            if (object.kind != shape::plane && !object.bounds.overlaps(finger_bounds)) {
+                continue;
+            }
+
+            for (int k = 0; k < n; k++) {
+                const capsule& link = this->link_capsules[k];
+                if (object.kind != shape::plane && !object.bounds.overlaps(link.bounds())) {
+                    continue;
+                }
+
+                this->narrow_phase_tests++;
+                contact_point c;
+                double distance = 0.0;
+                switch (object.kind) {
+                case shape::plane:
+                    distance = geometry::capsule_plane(link, this->planes[object.index], c.point, c.normal);
+                    break;
+                case shape::sphere:
+                    distance = geometry::capsule_sphere(link, this->spheres[object.index], c.point, c.normal);
+                    break;
+                case shape::box:
+                    distance = geometry::capsule_box(link, this->boxes[object.index], c.point, c.normal);
+                    break;
+                }
+                if (distance >= 0.0) {
+                    continue;
+                }
+
+                c.link = k;
+                c.object = o;
+                c.depth = -distance;
+
+                // Velocity of the contact point, carried by joints 0..k
+                Eigen::Vector3d velocity = Eigen::Vector3d::Zero();
+                for (int i = 0; i <= k; i++) {
+                    velocity += (this->space_jacobian.block<3, 1>(3, i) + this->space_jacobian.block<3, 1>(0, i).cross(c.point)) * joint_velocities(i);
+                }
+                double normal_velocity = c.normal.dot(velocity);
+                Eigen::Vector3d tangential_velocity = velocity - normal_velocity * c.normal;
+
+                double normal_force = std::max(0.0, this->parameters.stiffness * c.depth - this->parameters.damping * normal_velocity);
+                double slip = std::sqrt(tangential_velocity.squaredNorm() + this->parameters.slip_velocity * this->parameters.slip_velocity);
+                c.force = normal_force * c.normal - (this->parameters.friction_coefficient * normal_force / slip) * tangential_velocity;
+
+                for (int i = 0; i <= k; i++) {
+                    this->joint_torques(i) += c.force.dot(this->space_jacobian.block<3, 1>(3, i) + this->space_jacobian.block<3, 1>(0, i).cross(c.point));
+                }
+                this->contacts.push_back(c);
+            }
+        }
+
+        return this->joint_torques;
+    }
+
+}
@@ -0,0 +1,593 @@
+#include "include/design_sweep.hpp"
+#include "include/configuration_grid.hpp"
+#include "include/open_chain_kinematics.hpp"
+#include "include/tendon_tension_solver.hpp"
+#include "include/workspace_force_map.hpp"
+#include <Eigen/Dense>
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+#include <thread>
+
+namespace fm {
+
+    namespace {
+
+        // Candidates claimed by a thread at a time
+        constexpr long batch_candidates = 8;
+
+        // Force grid points evaluated between dominance checks
+        constexpr int points_per_check = 4;
+
+        std::uint64_t splitmix64(std::uint64_t x) {
+            x += 0x9E3779B97F4A7C15ull;
+            x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+            x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+            return x ^ (x >> 31);
+        }
+
+        /**
+         * @brief Fingertip position and position Jacobian J_p (3xn) from the finger's space Jacobian.
+         */
+        void position_jacobian(const finger_model<>& finger, const Eigen::VectorXd& joint_angles, Eigen::Vector3d& position,
+                               Eigen::Matrix<double, 3, Eigen::Dynamic, 0, 3, max_finger_joints>& J) {
+            finger_model<>::jacobian_matrix space_jacobian;
+            Eigen::Matrix4d T;
+            finger.space_jacobian(joint_angles, space_jacobian, &T);
+            position = T.block<3, 1>(0, 3);
+            J.resize(3, space_jacobian.cols());
+            for (int i = 0; i < space_jacobian.cols(); i++) {
+                J.col(i) = space_jacobian.block<3, 1>(3, i) + space_jacobian.block<3, 1>(0, i).cross(position);
+            }
+        }
+
+    }
+
+    /**
+     * @brief Whether design a is at least as good as b in every objective and better in one.
+     * @param a Scores of the first design.
+     * @param b Scores of the second design.
+     * @return True if a dominates b.
+     */
+    bool dominates(const design_scores& a, const design_scores& b) {
+        bool no_worse = a.workspace_area >= b.workspace_area && a.force_capacity >= b.force_capacity &&
+                        a.dexterity >= b.dexterity && a.tension_peak <= b.tension_peak;
+        bool better = a.workspace_area > b.workspace_area || a.force_capacity > b.force_capacity ||
+                      a.dexterity > b.dexterity || a.tension_peak < b.tension_peak;
+        return no_worse && better;
+    }
+
+    /**
+     * @brief Constructor for the design_sweep class.
+     *
+     * Every parameter starts fixed at the base finger's value, and the joint range at the base finger's
+     * joint limits. By default each free parameter is enumerated at 3 levels, the kinematic scores use
+     * 12 and the force scores 4 grid samples per joint, forces are probed along the six signed axes,
+     * tensions are evaluated for a 1 N reference force and the workspace area is counted on 2 mm cells.
+     *
+     * @param base Finger model with space screw axes, home frame and tendon routing matrix set.
+     * @param min_tension Minimum tendon tension (pretension).
+     * @param max_tension Maximum tendon tension, finite and above min_tension.
+     */
+    design_sweep::design_sweep(const finger_model<>& base, double min_tension, double max_tension)
+        : base(base),
+          link_vectors(home_link_vectors(base)),
+          min_tension(min_tension),
+          max_tension(max_tension),
+          min_lengths(base.get_link_lengths()),
+          max_lengths(base.get_link_lengths()),
+          min_moment_arms(base.get_tendon_routing_matrix()),
+          max_moment_arms(base.get_tendon_routing_matrix()),
+          levels(3),
+          num_random_candidates(0),
+          seed(0),
+          joint_min(base.get_joint_lower_limits()),
+          joint_max(base.get_joint_upper_limits()),
+          kinematic_samples(12),
+          force_samples(4),
+          reference_force(1.0),
+          cell_size(0.002),
+          force_tolerance(0.05),
+          num_rejected(0)
+    {
+        if (base.get_tendon_routing_matrix().cols() < 1) {
+            throw std::invalid_argument("base finger must have a tendon routing matrix");
+        }
+        if (!std::isfinite(max_tension) || max_tension <= min_tension) {
+            throw std::invalid_argument("max_tension must be finite and greater than min_tension");
+        }
+        this->directions.resize(3, 6);
+        this->directions << 1, -1, 0, 0, 0, 0,
+                            0, 0, 1, -1, 0, 0,
+                            0, 0, 0, 0, 1, -1;
+    }
+
+    ////////////////////////////////////////////////////////////
+    // Setter functions
+    ////////////////////////////////////////////////////////////
+
+    /**
+     * @brief Set the range of every link length; the geometry distal to a link moves along its link vector.
+     * @param min_lengths Smallest length of every link.
+     * @param max_lengths Largest length of every link.
+     */
+    void design_sweep::set_link_length_range(const Eigen::VectorXd& min_lengths, const Eigen::VectorXd& max_lengths) {
+        const int n = this->base.get_num_joints();
+        if (min_lengths.size() != n || max_lengths.size() != n || (min_lengths.array() < 0.0).any() || (max_lengths.array() < min_lengths.array()).any()) {
+            throw std::invalid_argument("link length range must have one non-negative, ordered entry per joint");
+        }
+        for (int i = 0; i < n; i++) {
+            if (max_lengths(i) > min_lengths(i) && this->link_vectors.col(i).norm() < 1e-9) {
+                throw std::invalid_argument("link " + std::to_string(i) + " has no link vector to vary its length along");
+            }
+        }
+        this->min_lengths = min_lengths;
+        this->max_lengths = max_lengths;
+    }
+
+    /**
+     * @brief Set the range of every entry of the tendon routing matrix.
+     * @param min_moment_arms Smallest moment arms, joints by tendons.
+     * @param max_moment_arms Largest moment arms, joints by tendons.
+     */
+    void design_sweep::set_moment_arm_range(const Eigen::MatrixXd& min_moment_arms, const Eigen::MatrixXd& max_moment_arms) {
+        if (min_moment_arms.rows() != this->base.get_num_joints() || min_moment_arms.cols() < 1 || min_moment_arms.cols() > max_finger_tendons ||
+            max_moment_arms.rows() != min_moment_arms.rows() || max_moment_arms.cols() != min_moment_arms.cols() ||
+            (max_moment_arms.array() < min_moment_arms.array()).any()) {
+            throw std::invalid_argument("moment arm range must be two ordered joints by tendons matrices");
+        }
+        this->min_moment_arms = min_moment_arms;
+        this->max_moment_arms = max_moment_arms;
+    }
+
+    /**
+     * @brief Enumerate every combination of the free parameters at evenly spaced levels.
+     * @param levels Levels per parameter; 1 takes the middle of every range.
+     */
+    void design_sweep::set_enumeration(int levels) {
+        if (levels < 1) {
+            throw std::invalid_argument("levels must be positive");
+        }
+        this->levels = levels;
+        this->num_random_candidates = 0;
+    }
+
+    /**
+     * @brief Sample the free parameters uniformly instead of enumerating them.
+     * @param num_candidates Number of candidates.
+     * @param seed Seed; candidate k depends only on the seed and k.
+     */
+    void design_sweep::set_random_samples(long num_candidates, std::uint64_t seed) {
+        if (num_candidates < 1) {
+            throw std::invalid_argument("num_candidates must be positive");
+        }
+        this->num_random_candidates = num_candidates;
+        this->seed = seed;
+    }
+
+    /**
+     * @brief Set the joint range the scores are evaluated over.
+     */
+    void design_sweep::set_joint_range(const Eigen::VectorXd& joint_min, const Eigen::VectorXd& joint_max) {
+        if (joint_min.size() != this->base.get_num_joints() || joint_max.size() != joint_min.size() || !joint_min.allFinite() ||
+            !joint_max.allFinite() || (joint_max.array() < joint_min.array()).any()) {
+            throw std::invalid_argument("joint range must have one finite, ordered entry per joint");
+        }
+        this->joint_min = joint_min;
+        this->joint_max = joint_max;
+    }
+
+    /**
+     * @brief Set the grid resolution of the kinematic scores (area, dexterity) and of the force scores.
+     * @param kinematic_samples Samples per joint for the kinematic scores.
+     * @param force_samples Samples per joint for force capacity and tension peak.
+     */
+    void design_sweep::set_grid_samples(int kinematic_samples, int force_samples) {
+        if (kinematic_samples < 1 || force_samples < 1) {
+            throw std::invalid_argument("grid samples must be positive");
+        }
+        this->kinematic_samples = kinematic_samples;
+        this->force_samples = force_samples;
+    }
+
+    /**
+     * @brief Set the fingertip force directions, one per column; they are normalized.
+     */
+    void design_sweep::set_directions(const Eigen::Matrix3Xd& directions) {
+        if (directions.cols() < 1 || (directions.colwise().norm().array() == 0.0).any()) {
+            throw std::invalid_argument("directions must contain at least one non-zero column");
+        }
+        this->directions = directions.colwise().normalized();
+    }
+
+    /**
+     * @brief Set the fingertip force magnitude the tension peak is evaluated for.
+     */
+    void design_sweep::set_reference_force(double reference_force) {
+        if (!(reference_force > 0.0)) {
+            throw std::invalid_argument("reference_force must be positive");
+        }
+        this->reference_force = reference_force;
+    }
+
+    /**
+     * @brief Set the cell size of the workspace area count.
+     */
+    void design_sweep::set_cell_size(double cell_size) {
+        if (!(cell_size > 0.0)) {
+            throw std::invalid_argument("cell_size must be positive");
+        }
+        this->cell_size = cell_size;
+    }
+
+    /**
+     * @brief Set the accuracy of the maximum force search.
+     */
+    void design_sweep::set_force_tolerance(double force_tolerance) {
+        if (!(force_tolerance > 0.0)) {
+            throw std::invalid_argument("force_tolerance must be positive");
+        }
+        this->force_tolerance = force_tolerance;
+    }
+
+    ////////////////////////////////////////////////////////////
+    // Getter functions
+    ////////////////////////////////////////////////////////////
+
+    /**
+     * @brief Number of candidates in the sweep, saturating at the largest long.
+     */
+    long design_sweep::get_num_candidates() const {
+        if (this->num_random_candidates > 0) {
+            return this->num_random_candidates;
+        }
+        const int free = static_cast<int>((this->max_lengths.array() > this->min_lengths.array()).count() +
+                                          (this->max_moment_arms.array() > this->min_moment_arms.array()).count());
+        long count = 1;
+        for (int k = 0; k < free; k++) {
+            if (count > std::numeric_limits<long>::max() / this->levels) {
+                return std::numeric_limits<long>::max();
+            }
+            count *= this->levels;
+        }
+        return count;
+    }
+
+    /**
+     * @brief Number of candidates of the last run abandoned before all their scores were computed.
+     */
+    long design_sweep::get_num_rejected() const {
+        return this->num_rejected.load();
+    }
+
+    /**
+     * @brief Non-dominated candidates of the last run, ordered by candidate index.
+     */
+    const std::vector<design_candidate>& design_sweep::get_pareto_front() const {
+        return this->pareto_front;
+    }
+
+    ////////////////////////////////////////////////////////////
+    // Member functions
+    ////////////////////////////////////////////////////////////
+
+    /**
+     * @brief Parameters of one candidate.
+     *
+     * Free parameters (link lengths first, then moment arms column by column) are either the digits
+     * of the index in base levels, or uniform values hashed from the seed, the index and the parameter.
+     *
+     * @param index Candidate index.
+     * @return Candidate with link lengths and routing matrix set and zero scores.
+     */
+    design_candidate design_sweep::candidate(long index) const {
+        if (index < 0 || index >= this->get_num_candidates()) {
+            throw std::out_of_range("candidate index out of range");
+        }
+        design_candidate result;
+        result.index = index;
+        result.link_lengths = this->min_lengths;
+        result.tendon_routing_matrix = this->min_moment_arms;
+
+        long remaining = index;
+        std::uint64_t parameter = 0;
+        auto value = [&](double low, double high) {
+            if (this->num_random_candidates > 0) {
+                std::uint64_t bits = splitmix64(this->seed ^ splitmix64(static_cast<std::uint64_t>(index) * 64 + parameter++));
+                return low + (high - low) * ((bits >> 11) * 0x1.0p-53);
+            }
+            long digit = remaining % this->levels;
+            remaining /= this->levels;
+            return this->levels == 1 ? 0.5 * (low + high) : low + (high - low) * digit / (this->levels - 1);
+        };
+        for (int i = 0; i < result.link_lengths.size(); i++) {
+            if (this->max_lengths(i) > this->min_lengths(i)) {
+                result.link_lengths(i) = value(this->min_lengths(i), this->max_lengths(i));
+            }
+        }
+        for (int t = 0; t < result.tendon_routing_matrix.cols(); t++) {
+            for (int i = 0; i < result.tendon_routing_matrix.rows(); i++) {
+                if (this->max_moment_arms(i, t) > this->min_moment_arms(i, t)) {
+                    result.tendon_routing_matrix(i, t) = value(this->min_moment_arms(i, t), this->max_moment_arms(i, t));
+                }
+            }
+        }
+        return result;
+    }
+
+    /**
+     * @brief Build the finger model of a candidate.
+     *
+     * A link whose length changes by d translates the distal screw axes and the home frame by d along
+     * its unit link vector: S_j <- Ad_{Trans(d u_i)} S_j for j > i and M <- Trans(d u_i) M.
+     *
+     * @param candidate Candidate parameters.
+     * @return Finger model with screw axes, link lengths and routing matrix of the candidate.
+     */
+    finger_model<> design_sweep::build_finger(const design_candidate& candidate) const {
+        const int n = this->base.get_num_joints();
+        Eigen::Matrix<double, 6, Eigen::Dynamic> S = this->base.get_home_position_screw_axes_space();
+        Eigen::Matrix4d M = this->base.get_home_position_body_frame();
+        for (int i = 0; i < n; i++) {
+            double length = this->link_vectors.col(i).norm();
+            if (length < 1e-9 || candidate.link_lengths(i) == this->base.get_link_lengths()(i)) {
+                continue;
+            }
+            Eigen::Matrix4d shift = Eigen::Matrix4d::Identity();
+            shift.block<3, 1>(0, 3) = (candidate.link_lengths(i) - length) / length * this->link_vectors.col(i);
+            for (int j = i + 1; j < n; j++) {
+                S.col(j) = rigid_body_motion::Adjoint_Twist(shift, S.col(j));
+            }
+            M = shift * M;
+        }
+        Eigen::Matrix<double, 6, Eigen::Dynamic> B(6, n);
+        Eigen::Matrix4d M_inv = rigid_body_motion::Transform_Inverse(M);
+        for (int i = 0; i < n; i++) {
+            B.col(i) = rigid_body_motion::Adjoint_Twist(M_inv, S.col(i));
+        }
+
+        finger_model<> finger(this->base);
+        finger.set_link_lengths(candidate.link_lengths);
+        finger.set_home_position_body_frame(M);
+        finger.set_home_position_screw_axes_space(S);
+        finger.set_home_position_screw_axes_body(B);
+        finger.set_tendon_routing_matrix(candidate.tendon_routing_matrix);
+        return finger;
+    }
+
+    /**
+     * @brief Compute all scores of a candidate without early rejection.
+     * @param candidate Candidate parameters.
+     * @return Scores.
+     */
+    design_scores design_sweep::score(const design_candidate& candidate) const {
+        this->check_ranges();
+        design_candidate scored = candidate;
+        this->evaluate(scored, [](const design_scores&) { return false; });
+        return scored.scores;
+    }
+
+    /**
+     * @brief Score every candidate on several threads and keep the Pareto front.
+     *
+     * Threads claim small batches of candidates from a shared counter. A candidate is abandoned as soon
+     * as an optimistic bound on its scores is dominated by the current front; the front only ever
+     * holds evaluated designs, so no candidate that belongs to the final front is abandoned and the
+     * result is the same for any number of threads.
+     *
+     * @param num_threads Number of threads, 0 for one per hardware thread.
+     */
+    void design_sweep::run(int num_threads) {
+        this->check_ranges();
+        this->pareto_front.clear();
+        this->num_rejected = 0;
+        const long candidates = this->get_num_candidates();
+
+        if (num_threads <= 0) {
+            num_threads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+        }
+        num_threads = static_cast<int>(std::max(1L, std::min<long>(num_threads, candidates)));
+
+        std::atomic<long> next(0);
+        std::vector<std::thread> workers;
+        for (int t = 0; t < num_threads; t++) {
+            workers.emplace_back([this, &next, candidates]() {
+                auto dominated = [this](const design_scores& bound) { return this->is_dominated(bound); };
+                for (long begin = next.fetch_add(batch_candidates); begin < candidates; begin = next.fetch_add(batch_candidates)) {
+                    long end = std::min(candidates, begin + batch_candidates);
+                    for (long index = begin; index < end; index++) {
+                        design_candidate current = this->candidate(index);
+                        if (this->evaluate(current, dominated)) {
+                            this->insert(current);
+                        } else {
+                            this->num_rejected++;
+                        }
+                    }
+                }
+            });
+        }
+        for (auto& worker : workers) {
+            worker.join();
+        }
+        std::sort(this->pareto_front.begin(), this->pareto_front.end(),
+                  [](const design_candidate& a, const design_candidate& b) { return a.index < b.index; });
+    }
+
+    /**
+     * @brief Write the Pareto front as CSV: index, link lengths, moment arms (column by column) and scores.
+     * @param path Output file path.
+     */
+    void design_sweep::write_pareto_front(const std::string& path) const {
+        std::ofstream file(path);
+        if (!file) {
+            throw std::runtime_error("could not open " + path + " for writing");
+        }
+        const int n = static_cast<int>(this->min_lengths.size());
+        const int tendons = static_cast<int>(this->min_moment_arms.cols());
+        file << "index";
+        for (int i = 0; i < n; i++) {
+            file << ",link_length_" << i;
+        }
+        for (int t = 0; t < tendons; t++) {
+            for (int i = 0; i < n; i++) {
+                file << ",moment_arm_" << i << "_" << t;
+            }
+        }
+        file << ",workspace_area,force_capacity,dexterity,tension_peak\n";
+        file.precision(9);
+        for (const design_candidate& design : this->pareto_front) {
+            file << design.index;
+            for (int i = 0; i < n; i++) {
+                file << "," << design.link_lengths(i);
+            }
+            for (int t = 0; t < tendons; t++) {
+                for (int i = 0; i < n; i++) {
+                    file << "," << design.tendon_routing_matrix(i, t);
+                }
+            }
+            file << "," << design.scores.workspace_area << "," << design.scores.force_capacity << ","
+                 << design.scores.dexterity << "," << design.scores.tension_peak << "\n";
+        }
+        if (!file) {
+            throw std::runtime_error("failed writing " + path);
+        }
+    }
+
+    /**
+     * @brief Score a candidate, stopping early when an optimistic bound is dominated.
+     *
+     * The kinematic scores come first from FK and position Jacobians over the kinematic grid:
+     * - workspace area: fingertip positions projected on the plane normal to the first joint axis,
+     *   counted on square cells
+     * - dexterity: mean over the grid of sigma_d / sigma_1 of J_p, with d the largest rank J_p reaches
+     *   (2 for a planar finger), from the closed-form eigenvalues of J_p J_p^T
+     * The force scores are then accumulated point by point over the force grid; their running minimum
+     * force and maximum tension only get worse, so together with the kinematic scores they bound the
+     * final scores from above and are checked against the front every few points.
+     *
+     * @param candidate Candidate; its scores are filled in.
+     * @param dominated Returns true when a bound is dominated by the front.
+     * @return False if the candidate was abandoned.
+     */
+    bool design_sweep::evaluate(design_candidate& candidate, const std::function<bool(const design_scores&)>& dominated) const {
+        const finger_model<> finger = this->build_finger(candidate);
+        const int n = finger.get_num_joints();
+        const Eigen::Vector3d first_axis = finger.get_home_position_screw_axes_space().block<3, 1>(0, 0);
+        design_scores& scores = candidate.scores;
+
+        // Plane normal to the first joint axis, or to the z axis for a prismatic first joint
+        Eigen::Vector3d normal = first_axis.norm() > 0.5 ? first_axis : Eigen::Vector3d::UnitZ();
+        Eigen::Vector3d u = normal.unitOrthogonal(), v = normal.cross(u);
+
+        configuration_grid kinematic_grid(this->joint_min, this->joint_max, Eigen::VectorXi::Constant(n, this->kinematic_samples));
+        const long kinematic_points = kinematic_grid.size();
+        std::vector<std::uint64_t> cells(kinematic_points);
+        Eigen::Matrix3Xd squared_singular_values(3, kinematic_points);
+        Eigen::VectorXd joint_angles(n);
+        Eigen::Vector3d position;
+        Eigen::Matrix<double, 3, Eigen::Dynamic, 0, 3, max_finger_joints> J;
+        Eigen::SelfAdjointEigenSolver<Eigen::Matrix3d> eigen;
+        int rank = 0;
+        for (long k = 0; k < kinematic_points; k++) {
+            kinematic_grid.point(k, joint_angles);
+            position_jacobian(finger, joint_angles, position, J);
+            std::int64_t a = static_cast<std::int64_t>(std::floor(position.dot(u) / this->cell_size));
+            std::int64_t b = static_cast<std::int64_t>(std::floor(position.dot(v) / this->cell_size));
+            cells[k] = static_cast<std::uint64_t>(a) << 32 ^ (static_cast<std::uint64_t>(b) & 0xFFFFFFFFull);
+
+            eigen.computeDirect(J * J.transpose(), Eigen::EigenvaluesOnly);
+            squared_singular_values.col(k) = eigen.eigenvalues().reverse().cwiseMax(0.0);
+            const double largest = squared_singular_values(0, k);
+            rank = std::max<int>(rank, static_cast<int>((squared_singular_values.col(k).array() > 1e-10 * largest).count()));
+        }
+        std::sort(cells.begin(), cells.end());
+        scores.workspace_area = static_cast<double>(std::unique(cells.begin(), cells.end()) - cells.begin()) * this->cell_size * this->cell_size;
+        scores.dexterity = 0.0;
+        if (rank > 0) {
+            for (long k = 0; k < kinematic_points; k++) {
+                const double largest = squared_singular_values(0, k);
+                scores.dexterity += largest > 0.0 ? std::sqrt(squared_singular_values(rank - 1, k) / largest) : 0.0;
+            }
+            scores.dexterity /= kinematic_points;
+        }
+
+        scores.force_capacity = std::numeric_limits<double>::infinity();
+        scores.tension_peak = this->min_tension;
+        if (dominated(scores)) {
+            return false;
+        }
+
+        const Eigen::MatrixXd& routing = candidate.tendon_routing_matrix;
+        workspace_force_map force_map(finger, Eigen::VectorXd::Ones(routing.cols()), this->min_tension, this->max_tension);
+        force_map.set_directions(this->directions);
+        force_map.set_force_tolerance(this->force_tolerance);
+        tendon_tension_solver limited_solver(routing, this->min_tension, this->max_tension);
+        tendon_tension_solver reference_solver(routing, this->min_tension);
+
+        configuration_grid force_grid(this->joint_min, this->joint_max, Eigen::VectorXi::Constant(n, this->force_samples));
+        Eigen::Vector3f force_position;
+        Eigen::VectorXf max_forces(this->directions.cols());
+        Eigen::VectorXf stiffness(6);
+        for (long k = 0; k < force_grid.size(); k++) {
+            force_grid.point(k, joint_angles);
+            force_map.evaluate(finger, joint_angles, limited_solver, force_position, max_forces, stiffness);
+            scores.force_capacity = std::min(scores.force_capacity, static_cast<double>(max_forces.minCoeff()));
+
+            position_jacobian(finger, joint_angles, position, J);
+            for (int d = 0; d < this->directions.cols(); d++) {
+                tendon_tension_solver::torque_vector torques = J.transpose() * (this->reference_force * this->directions.col(d));
+                if (torques.norm() < 1e-12) {
+                    continue;
+                }
+                const auto& tensions = reference_solver.solve(torques);
+                double peak = reference_solver.get_torque_residual() <= 1e-6 * (1.0 + torques.norm()) ? tensions.maxCoeff() : std::numeric_limits<double>::infinity();
+                scores.tension_peak = std::max(scores.tension_peak, peak);
+            }
+            if (k % points_per_check == 0 && k + 1 < force_grid.size() && dominated(scores)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /**
+     * @brief Whether any member of the current front dominates a score bound.
+     */
+    bool design_sweep::is_dominated(const design_scores& bound) {
+        std::lock_guard<std::mutex> lock(this->pareto_mutex);
+        for (const design_candidate& member : this->pareto_front) {
+            if (dominates(member.scores, bound)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /**
+     * @brief Add an evaluated candidate to the front unless it is dominated, removing members it dominates.
+     */
+    void design_sweep::insert(const design_candidate& candidate) {
+        std::lock_guard<std::mutex> lock(this->pareto_mutex);
+        for (const design_candidate& member : this->pareto_front) {
+            if (dominates(member.scores, candidate.scores)) {
+                return;
+            }
+        }
+        this->pareto_front.erase(std::remove_if(this->pareto_front.begin(), this->pareto_front.end(),
+                                                [&candidate](const design_candidate& member) { return dominates(candidate.scores, member.scores); }),
+                                 this->pareto_front.end());
+        this->pareto_front.push_back(candidate);
+    }
+
+    /**
+     * @brief Check that the joint range can be gridded.
+     */
+    void design_sweep::check_ranges() const {
+        if (!this->joint_min.allFinite() || !this->joint_max.allFinite()) {
+            throw std::runtime_error("the base finger has unbounded joints; call set_joint_range first");
+        }
+    }
+
+}
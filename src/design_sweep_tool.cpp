@@ -0,0 +1,43 @@
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <string>
+#include "include/design_sweep.hpp"
+#include "include/finger_description.hpp"
+
+/**
+ * @brief Random design sweep around a finger description, writing the Pareto front as CSV.
+ *
+ * Usage: design_sweep_tool <description.yaml> <pareto.csv> <candidates> [variation]
+ * Every link length and non-zero moment arm varies by up to +-variation (default 0.25) of its value.
+ */
+int main(int argc, char *argv[]) {
+    if (argc < 4 || argc > 5) {
+        std::cerr << "usage: " << argv[0] << " <description.yaml> <pareto.csv> <candidates> [variation]" << std::endl;
+        return 2;
+    }
+    try {
+        const long candidates = std::stol(argv[3]);
+        const double variation = argc == 5 ? std::stod(argv[4]) : 0.25;
+        fm::finger_model<> base = fm::load_finger_description(argv[1]);
+        fm::design_sweep sweep(base, 1.0, 40.0);
+
+        Eigen::VectorXd lengths = base.get_link_lengths();
+        sweep.set_link_length_range((1.0 - variation) * lengths, (1.0 + variation) * lengths);
+        Eigen::MatrixXd arms = base.get_tendon_routing_matrix();
+        sweep.set_moment_arm_range(arms.cwiseMin((1.0 - variation) * arms).cwiseMin((1.0 + variation) * arms),
+                                   arms.cwiseMax((1.0 - variation) * arms).cwiseMax((1.0 + variation) * arms));
+        sweep.set_random_samples(candidates, 1);
+
+        auto start = std::chrono::steady_clock::now();
+        sweep.run();
+        double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        sweep.write_pareto_front(argv[2]);
+        std::cout << candidates << " candidates in " << elapsed << " s, " << sweep.get_num_rejected() << " rejected early, "
+                  << sweep.get_pareto_front().size() << " on the Pareto front" << std::endl;
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
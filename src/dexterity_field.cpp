@@ -0,0 +1,553 @@
+#include "include/dexterity_field.hpp"
+#include "include/lane_kinematics.hpp"
+#include <Eigen/Dense>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace fm {
+
+    namespace {
+
+        // Refinement lattice coordinates are packed into 12 bits per joint
+        constexpr int coordinate_bits = 12;
+
+        using lattice_point = std::array<int, max_finger_joints>;
+
+        std::uint64_t lattice_key(const lattice_point& point, int n) {
+            std::uint64_t key = 0;
+            for (int j = 0; j < n; j++) {
+                key = key << coordinate_bits | static_cast<std::uint64_t>(point[j]);
+            }
+            return key;
+        }
+
+        // Cell of the refinement lattice: lower corner and edge length in lattice units
+        struct lattice_cell
+        {
+            lattice_point lower;
+            int size;
+        };
+
+    }
+
+    /**
+     * @brief Constructor for the dexterity_field class.
+     *
+     * The task dimension d, the number of singular values the measures use, defaults to the rank of the
+     * position Jacobian at a generic configuration, e.g. 2 for a planar finger whose J J^T is singular
+     * everywhere. Refinement is off until set_refinement is called.
+     *
+     * @param finger Finger model with space screw axes and home frame set.
+     */
+    dexterity_field::dexterity_field(const finger_model<>& finger)
+        : screw_axes(finger.get_home_position_screw_axes_space()),
+          home_tip(finger.get_home_position_body_frame().block<3, 1>(0, 3)),
+          max_depth(0),
+          threshold(0.1),
+          refinement_measure(dexterity_measure::manipulability)
+    {
+        const int n = finger.get_num_joints();
+        finger_model<> generic(finger);
+        Eigen::VectorXd angles(n);
+        for (int i = 0; i < n; i++) {
+            angles(i) = 0.3 + 0.17 * i;
+        }
+        generic.set_joint_angles(angles);
+        const auto& J = generic.get_finger_space_jacobian();
+        const Eigen::Vector3d p = generic.get_fingertip_pose_space().block<3, 1>(0, 3);
+        Eigen::Matrix<double, 3, Eigen::Dynamic> J_p(3, n);
+        for (int i = 0; i < n; i++) {
+            J_p.col(i) = J.block<3, 1>(3, i) + J.block<3, 1>(0, i).cross(p);
+        }
+        Eigen::JacobiSVD<Eigen::Matrix<double, 3, Eigen::Dynamic>> svd(J_p);
+        const auto& sigma = svd.singularValues();
+        this->task_dimension = std::max(1, static_cast<int>((sigma.array() > 1e-9 * sigma(0)).count()));
+    }
+
+    ////////////////////////////////////////////////////////////
+    // Setter functions
+    ////////////////////////////////////////////////////////////
+
+    /**
+     * @brief Set the number of singular values d the measures are taken over.
+     *
+     * Manipulability is sigma_1 ... sigma_d (sqrt(det(J J^T)) for d = 3), the condition number
+     * sigma_1 / sigma_d and the minimum singular value sigma_d.
+     *
+     * @param task_dimension 1 to 3, at most the number of joints.
+     */
+    void dexterity_field::set_task_dimension(int task_dimension) {
+        if (task_dimension < 1 || task_dimension > 3 || task_dimension > this->screw_axes.cols()) {
+            throw std::invalid_argument("task_dimension must be between 1 and min(3, joints)");
+        }
+        this->task_dimension = task_dimension;
+    }
+
+    /**
+     * @brief Enable adaptive refinement of the grid.
+     *
+     * A grid cell is split into 2^n children when the measure varies across its corners by more than
+     * threshold times the measure's range over the grid, repeated up to max_depth times.
+     *
+     * @param max_depth Number of refinement levels, 0 to disable.
+     * @param threshold Relative variation that triggers a split.
+     * @param measure Measure the variation is taken of.
+     */
+    void dexterity_field::set_refinement(int max_depth, double threshold, dexterity_measure measure) {
+        if (max_depth < 0 || max_depth > 8 || !(threshold > 0.0)) {
+            throw std::invalid_argument("max_depth must be between 0 and 8 and threshold positive");
+        }
+        this->max_depth = max_depth;
+        this->threshold = threshold;
+        this->refinement_measure = measure;
+    }
+
+    ////////////////////////////////////////////////////////////
+    // Getter functions
+    ////////////////////////////////////////////////////////////
+
+    /**
+     * @brief Get the number of singular values d the measures are taken over.
+     * @return Task dimension, 1 to 3.
+     */
+    int dexterity_field::get_task_dimension() const {
+        return this->task_dimension;
+    }
+
+    /**
+     * @brief Get the grid of the last compute.
+     * @return Configuration grid.
+     */
+    configuration_grid dexterity_field::get_grid() const {
+        if (this->grid_samples.size() == 0) {
+            throw std::runtime_error("no field has been computed");
+        }
+        return configuration_grid(this->grid_min, this->grid_max, this->grid_samples);
+    }
+
+    /**
+     * @brief Number of grid points; they come first in every result, in grid order.
+     */
+    long dexterity_field::get_num_grid_points() const {
+        return this->grid_samples.size() == 0 ? 0 : this->get_grid().size();
+    }
+
+    /**
+     * @brief Number of evaluated points, grid points followed by refinement points.
+     */
+    long dexterity_field::get_num_points() const {
+        return this->joint_angles.cols();
+    }
+
+    /**
+     * @brief Joint angles of every evaluated point, one column per point.
+     */
+    const Eigen::MatrixXd& dexterity_field::get_joint_angles() const {
+        return this->joint_angles;
+    }
+
+    /**
+     * @brief Fingertip position of every evaluated point.
+     */
+    const Eigen::Matrix3Xf& dexterity_field::get_positions() const {
+        return this->positions;
+    }
+
+    /**
+     * @brief Manipulability sigma_1 ... sigma_d of every evaluated point.
+     */
+    const Eigen::VectorXf& dexterity_field::get_manipulability() const {
+        return this->manipulability;
+    }
+
+    /**
+     * @brief Condition number of every evaluated point, infinity at singular configurations.
+     */
+    const Eigen::VectorXf& dexterity_field::get_condition_number() const {
+        return this->condition_number;
+    }
+
+    /**
+     * @brief Smallest of the d singular values of every evaluated point, zero at singular configurations.
+     */
+    const Eigen::VectorXf& dexterity_field::get_min_singular_value() const {
+        return this->min_singular_value;
+    }
+
+    ////////////////////////////////////////////////////////////
+    // Member functions
+    ////////////////////////////////////////////////////////////
+
+    /**
+     * @brief Evaluate the fields over a configuration grid and refine where they change steeply.
+     *
+     * The grid is evaluated first. Each refinement level then collects the cells to split and the new
+     * corners of their children, numbered on a lattice 2^max_depth times finer than the grid so shared
+     * corners are evaluated once, and evaluates the new points. Point evaluation is split across
+     * threads; the selection of cells is serial and in a fixed order, so the result does not depend
+     * on the number of threads.
+     *
+     * @param grid Configuration grid.
+     * @param num_threads Number of threads, 0 for one per hardware thread.
+     */
+    void dexterity_field::compute(const configuration_grid& grid, int num_threads) {
+        const int n = static_cast<int>(this->screw_axes.cols());
+        if (grid.get_num_joints() != n) {
+            throw std::invalid_argument("grid must have one dimension per joint");
+        }
+        const int scale = 1 << this->max_depth;
+        if (this->max_depth > 0 && (grid.get_samples().array() * scale >= (1 << coordinate_bits)).any()) {
+            throw std::invalid_argument("grid is too fine for the refinement depth");
+        }
+        if (num_threads <= 0) {
+            num_threads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+        }
+
+        const long points = grid.size();
+        this->grid_min = grid.get_joint_min();
+        this->grid_max = grid.get_joint_max();
+        this->grid_samples = grid.get_samples();
+        this->joint_angles.resize(n, points);
+        for (long k = 0; k < points; k++) {
+            grid.point(k, this->joint_angles.col(k));
+        }
+        this->evaluate_parallel(this->joint_angles, 0, num_threads);
+        if (this->max_depth == 0) {
+            return;
+        }
+
+        // Lattice coordinates of the grid points, first joint fastest as in the grid
+        std::unordered_map<std::uint64_t, long> index;
+        std::vector<lattice_cell> cells;
+        for (long k = 0; k < points; k++) {
+            lattice_point point{};
+            long remainder = k;
+            bool lower_corner = true;
+            for (int j = 0; j < n; j++) {
+                int i = static_cast<int>(remainder % this->grid_samples(j));
+                remainder /= this->grid_samples(j);
+                point[j] = i * scale;
+                lower_corner = lower_corner && (i + 1 < this->grid_samples(j) || this->grid_samples(j) == 1);
+            }
+            index.emplace(lattice_key(point, n), k);
+            if (lower_corner) {
+                cells.push_back({point, scale});
+            }
+        }
+
+        // Variation is measured relative to the finite range of the measure over the grid
+        const Eigen::VectorXf& grid_values = this->field(this->refinement_measure);
+        float low = std::numeric_limits<float>::infinity(), high = -low;
+        for (long k = 0; k < points; k++) {
+            if (std::isfinite(grid_values(k))) {
+                low = std::min(low, grid_values(k));
+                high = std::max(high, grid_values(k));
+            }
+        }
+        const double split_variation = this->threshold * std::max(static_cast<double>(high - low), 1e-300);
+
+        Eigen::VectorXd spacing(n);
+        for (int j = 0; j < n; j++) {
+            spacing(j) = this->grid_samples(j) > 1 ? (this->grid_max(j) - this->grid_min(j)) / ((this->grid_samples(j) - 1) * static_cast<double>(scale)) : 0.0;
+        }
+
+        for (int level = 0; level < this->max_depth && !cells.empty(); level++) {
+            const Eigen::VectorXf& values = this->field(this->refinement_measure);
+            const long begin = this->joint_angles.cols();
+            std::vector<lattice_cell> children;
+            std::vector<lattice_point> new_points;
+            for (const lattice_cell& cell : cells) {
+                // Corners over the joints the grid spans
+                float cell_low = std::numeric_limits<float>::infinity(), cell_high = -cell_low;
+                bool any_infinite = false, any_finite = false;
+                for (int corner = 0; corner < (1 << n); corner++) {
+                    lattice_point point = cell.lower;
+                    bool valid = true;
+                    for (int j = 0; j < n; j++) {
+                        if (corner >> j & 1) {
+                            valid = valid && this->grid_samples(j) > 1;
+                            point[j] += cell.size;
+                        }
+                    }
+                    if (!valid) {
+                        continue;
+                    }
+                    float value = values(index.at(lattice_key(point, n)));
+                    if (std::isfinite(value)) {
+                        any_finite = true;
+                        cell_low = std::min(cell_low, value);
+                        cell_high = std::max(cell_high, value);
+                    } else {
+                        any_infinite = true;
+                    }
+                }
+                if (!(any_infinite && any_finite) && cell_high - cell_low <= split_variation) {
+                    continue;
+                }
+
+                // Children and the corners they add, on a 3^n lattice of half-size steps
+                const int half = cell.size / 2;
+                int count = 1;
+                for (int j = 0; j < n; j++) {
+                    count *= this->grid_samples(j) > 1 ? 3 : 1;
+                }
+                for (int m = 0; m < count; m++) {
+                    lattice_point point = cell.lower;
+                    bool lower_corner = true;
+                    int remainder = m;
+                    for (int j = 0; j < n; j++) {
+                        if (this->grid_samples(j) > 1) {
+                            point[j] += half * (remainder % 3);
+                            lower_corner = lower_corner && remainder % 3 < 2;
+                            remainder /= 3;
+                        }
+                    }
+                    if (lower_corner) {
+                        children.push_back({point, half});
+                    }
+                    if (index.emplace(lattice_key(point, n), begin + static_cast<long>(new_points.size())).second) {
+                        new_points.push_back(point);
+                    }
+                }
+            }
+            if (new_points.empty()) {
+                break;
+            }
+
+            const long added = static_cast<long>(new_points.size());
+            this->joint_angles.conservativeResize(n, begin + added);
+            for (long k = 0; k < added; k++) {
+                for (int j = 0; j < n; j++) {
+                    this->joint_angles(j, begin + k) = this->grid_min(j) + new_points[k][j] * spacing(j);
+                }
+            }
+            this->evaluate_parallel(this->joint_angles, begin, num_threads);
+            cells = std::move(children);
+        }
+    }
+
+    /**
+     * @brief Evaluate the fields at a batch of configurations.
+     *
+     * Configurations are processed a lane block at a time. The product of exponentials runs joint by
+     * joint on a lane_transform, giving the space Jacobian columns (w_i', v_i') and the
+     * fingertip p; the position Jacobian columns are v_i' + w_i' x p. The eigenvalues of the 3x3 J_p J_p^T
+     * come from symmetric_eigenvalues, so no SVD is taken.
+     *
+     * @param joint_angles Joint angles, one column per configuration.
+     * @param positions Output fingertip positions.
+     * @param manipulability Output manipulability.
+     * @param condition_number Output condition number.
+     * @param min_singular_value Output minimum singular value.
+     */
+    void dexterity_field::evaluate(const Eigen::Ref<const Eigen::MatrixXd>& joint_angles, Eigen::Ref<Eigen::Matrix3Xf> positions, Eigen::Ref<Eigen::VectorXf> manipulability,
+                                   Eigen::Ref<Eigen::VectorXf> condition_number, Eigen::Ref<Eigen::VectorXf> min_singular_value) const {
+        const int n = static_cast<int>(this->screw_axes.cols());
+        const long count = joint_angles.cols();
+        if (joint_angles.rows() != n || positions.cols() != count || manipulability.size() != count || condition_number.size() != count || min_singular_value.size() != count) {
+            throw std::invalid_argument("joint_angles must have one row per joint and the outputs one entry per column");
+        }
+
+        for (long block = 0; block < count; block += lanes) {
+            const int used = static_cast<int>(std::min<long>(lanes, count - block));
+
+            // Accumulated transform and space Jacobian columns, one lane per configuration
+            lane_transform<lanes> T;
+            lane_array Jw[max_finger_joints][3], Jv[max_finger_joints][3];
+            for (int j = 0; j < n; j++) {
+                const double w[3] = {this->screw_axes(0, j), this->screw_axes(1, j), this->screw_axes(2, j)};
+                const double v[3] = {this->screw_axes(3, j), this->screw_axes(4, j), this->screw_axes(5, j)};
+                T.adjoint(w, v, Jw[j], Jv[j]);
+
+                // Padded lanes repeat the last configuration
+                lane_array theta;
+                for (int l = 0; l < lanes; l++) {
+                    theta(l) = joint_angles(j, block + std::min(l, used - 1));
+                }
+                T.multiply_exponential(w, v, theta);
+            }
+
+            // Fingertip and J_p J_p^T
+            const double home[3] = {this->home_tip(0), this->home_tip(1), this->home_tip(2)};
+            lane_array tip[3];
+            T.transform_point(home, tip);
+            lane_array A[3][3];
+            for (int r = 0; r < 3; r++) {
+                for (int c = r; c < 3; c++) {
+                    A[r][c].setZero();
+                }
+            }
+            for (int j = 0; j < n; j++) {
+                lane_array column[3];
+                for (int r = 0; r < 3; r++) {
+                    const int a = (r + 1) % 3, b = (r + 2) % 3;
+                    column[r] = Jv[j][r] + Jw[j][a] * tip[b] - Jw[j][b] * tip[a];
+                }
+                for (int r = 0; r < 3; r++) {
+                    for (int c = r; c < 3; c++) {
+                        A[r][c] += column[r] * column[c];
+                    }
+                }
+            }
+            lane_array eigenvalues[3];
+            symmetric_eigenvalues(A[0][0], A[1][1], A[2][2], A[0][1], A[0][2], A[1][2], eigenvalues);
+
+            lane_array sigma[3];
+            for (int k = 0; k < 3; k++) {
+                sigma[k] = eigenvalues[k].max(0.0).sqrt();
+            }
+            lane_array product = sigma[0];
+            for (int k = 1; k < this->task_dimension; k++) {
+                product *= sigma[k];
+            }
+            const lane_array& smallest = sigma[this->task_dimension - 1];
+            const lane_array condition = (smallest > 0.0).select(sigma[0] / smallest, std::numeric_limits<double>::infinity());
+            for (int l = 0; l < used; l++) {
+                positions.col(block + l) << static_cast<float>(tip[0](l)), static_cast<float>(tip[1](l)), static_cast<float>(tip[2](l));
+                manipulability(block + l) = static_cast<float>(product(l));
+                condition_number(block + l) = static_cast<float>(condition(l));
+                min_singular_value(block + l) = static_cast<float>(smallest(l));
+            }
+        }
+    }
+
+    /**
+     * @brief Best value of every measure within each occupied Cartesian cell of the fingertip positions.
+     * @param cell_size Edge length of the cubic cells.
+     * @return Occupied cells, in order of first occurrence.
+     */
+    cartesian_dexterity dexterity_field::cartesian_map(double cell_size) const {
+        if (!(cell_size > 0.0)) {
+            throw std::invalid_argument("cell_size must be positive");
+        }
+        std::unordered_map<std::uint64_t, long> cells;
+        std::vector<Eigen::Vector3i> keys;
+        std::vector<long> cell_of(this->positions.cols());
+        for (long k = 0; k < this->positions.cols(); k++) {
+            Eigen::Vector3i key = (this->positions.col(k).cast<double>() / cell_size).array().floor().cast<int>();
+            std::uint64_t packed = 0;
+            for (int r = 0; r < 3; r++) {
+                packed = packed << 21 | (static_cast<std::uint64_t>(key(r) + (1 << 20)) & 0x1FFFFF);
+            }
+            auto inserted = cells.emplace(packed, static_cast<long>(keys.size()));
+            if (inserted.second) {
+                keys.push_back(key);
+            }
+            cell_of[k] = inserted.first->second;
+        }
+
+        cartesian_dexterity map;
+        const long count = static_cast<long>(keys.size());
+        map.cell_centers.resize(3, count);
+        map.manipulability = Eigen::VectorXf::Zero(count);
+        map.condition_number = Eigen::VectorXf::Constant(count, std::numeric_limits<float>::infinity());
+        map.min_singular_value = Eigen::VectorXf::Zero(count);
+        for (long c = 0; c < count; c++) {
+            map.cell_centers.col(c) = ((keys[c].cast<double>().array() + 0.5) * cell_size).cast<float>();
+        }
+        for (long k = 0; k < this->positions.cols(); k++) {
+            const long c = cell_of[k];
+            map.manipulability(c) = std::max(map.manipulability(c), this->manipulability(k));
+            map.condition_number(c) = std::min(map.condition_number(c), this->condition_number(k));
+            map.min_singular_value(c) = std::max(map.min_singular_value(c), this->min_singular_value(k));
+        }
+        return map;
+    }
+
+    /**
+     * @brief Closed-form eigenvalues of symmetric 3x3 matrices, one per lane.
+     *
+     * With q = tr(A) / 3, p = sqrt(tr((A - qI)^2) / 6) and r = det((A - qI) / p) / 2, the eigenvalues are
+     * q + 2p cos(phi + 2k pi / 3) for phi = acos(r) / 3, using only packet arithmetic, acos and cos.
+     * Only the largest is taken from this form; lanes with p = 0 are multiples of the identity.
+     *
+     * @param a00 Diagonal entry (0, 0).
+     * @param a11 Diagonal entry (1, 1).
+     * @param a22 Diagonal entry (2, 2).
+     * @param a01 Off-diagonal entry (0, 1).
+     * @param a02 Off-diagonal entry (0, 2).
+     * @param a12 Off-diagonal entry (1, 2).
+     * @param eigenvalues Output eigenvalues, largest first.
+     */
+    void dexterity_field::symmetric_eigenvalues(const lane_array& a00, const lane_array& a11, const lane_array& a22, const lane_array& a01,
+                                                const lane_array& a02, const lane_array& a12, lane_array eigenvalues[3]) {
+        const lane_array q = (a00 + a11 + a22) / 3.0;
+        const lane_array b00 = a00 - q, b11 = a11 - q, b22 = a22 - q;
+        const lane_array p2 = b00 * b00 + b11 * b11 + b22 * b22 + 2.0 * (a01 * a01 + a02 * a02 + a12 * a12);
+        const lane_array scale = (a00.abs() + a11.abs() + a22.abs()).max(1e-300);
+        const auto degenerate = p2 <= 1e-30 * scale * scale;
+        const lane_array p = degenerate.select(lane_array::Ones(), (p2 / 6.0).sqrt());
+        const lane_array inverse = 1.0 / p;
+        const lane_array c00 = b00 * inverse, c11 = b11 * inverse, c22 = b22 * inverse;
+        const lane_array c01 = a01 * inverse, c02 = a02 * inverse, c12 = a12 * inverse;
+        const lane_array det = c00 * (c11 * c22 - c12 * c12) - c01 * (c01 * c22 - c12 * c02) + c02 * (c01 * c12 - c11 * c02);
+        const lane_array phi = (0.5 * det).max(-1.0).min(1.0).acos() / 3.0;
+        const lane_array largest = q + 2.0 * p * phi.cos();
+
+        // acos loses half the digits near r = 1, so the other two come from the deflated quadratic
+        // t^2 - (tr(A) - largest) t + det(A) / largest, which keeps small eigenvalues accurate
+        const lane_array det_a = a00 * (a11 * a22 - a12 * a12) - a01 * (a01 * a22 - a12 * a02) + a02 * (a01 * a12 - a11 * a02);
+        const lane_array sum = (3.0 * q - largest).max(0.0);
+        const lane_array product = (largest > 0.0).select(det_a / largest, 0.0).max(0.0);
+        const lane_array middle = 0.5 * (sum + (sum * sum - 4.0 * product).max(0.0).sqrt());
+        const lane_array smallest = (middle > 0.0).select(product / middle, 0.0);
+        eigenvalues[0] = degenerate.select(q, largest);
+        eigenvalues[1] = degenerate.select(q, middle);
+        eigenvalues[2] = degenerate.select(q, smallest);
+    }
+
+    ////////////////////////////////////////////////////////////
+    // Private functions
+    ////////////////////////////////////////////////////////////
+
+    /**
+     * @brief Evaluate points [begin, end) of a joint angle matrix into the result arrays on several threads.
+     * @param joint_angles Joint angles of all points; the results are resized to match.
+     * @param begin First point to evaluate.
+     * @param num_threads Number of threads.
+     */
+    void dexterity_field::evaluate_parallel(const Eigen::MatrixXd& joint_angles, long begin, int num_threads) {
+        const long end = joint_angles.cols();
+        this->positions.conservativeResize(3, end);
+        this->manipulability.conservativeResize(end);
+        this->condition_number.conservativeResize(end);
+        this->min_singular_value.conservativeResize(end);
+
+        const long blocks = (end - begin + lanes - 1) / lanes;
+        const int threads = static_cast<int>(std::max(1L, std::min<long>(num_threads, blocks)));
+        std::vector<std::thread> workers;
+        for (int t = 0; t < threads; t++) {
+            long first = begin + blocks * t / threads * lanes;
+            long last = std::min(end, begin + blocks * (t + 1) / threads * lanes);
+            workers.emplace_back([this, &joint_angles, first, last]() {
+                const long count = last - first;
+                this->evaluate(joint_angles.middleCols(first, count), this->positions.middleCols(first, count), this->manipulability.segment(first, count),
+                               this->condition_number.segment(first, count), this->min_singular_value.segment(first, count));
+            });
+        }
+        for (auto& worker : workers) {
+            worker.join();
+        }
+    }
+
+    /**
+     * @brief Result vector of one measure.
+     * @param measure Measure.
+     * @return Values of every evaluated point.
+     */
+    const Eigen::VectorXf& dexterity_field::field(dexterity_measure measure) const {
+        switch (measure) {
+            case dexterity_measure::condition_number: return this->condition_number;
+            case dexterity_measure::min_singular_value: return this->min_singular_value;
+            default: return this->manipulability;
+        }
+    }
+
+}
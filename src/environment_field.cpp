@@ -0,0 +1,474 @@
+#include "include/environment_field.hpp"
+#include <Eigen/Dense>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace fm {
+
+    namespace {
+
+        const char field_file_magic[8] = {'F', 'M', 'S', 'D', 'F', '\0', '\0', '\0'};
+        const std::uint32_t field_file_version = 1;
+
+        // Fixed header of a distance field file, followed by the float grid values
+        struct field_record
+        {
+            char magic[8];
+            std::uint32_t version;
+            std::uint32_t record_size;
+            std::uint64_t file_size;
+            std::int32_t dimensions[3];
+            std::int32_t reserved;
+            double origin[3];
+            double spacing;
+        };
+
+        /**
+         * @brief Closest point of a triangle to a point, by the Voronoi region of the point.
+         */
+        Eigen::Vector3d closest_point_on_triangle(const Eigen::Vector3d& p, const Eigen::Vector3d& a, const Eigen::Vector3d& b, const Eigen::Vector3d& c) {
+            const Eigen::Vector3d ab = b - a, ac = c - a, ap = p - a;
+            const double d1 = ab.dot(ap), d2 = ac.dot(ap);
+            if (d1 <= 0.0 && d2 <= 0.0) {
+                return a;
+            }
+            const Eigen::Vector3d bp = p - b;
+            const double d3 = ab.dot(bp), d4 = ac.dot(bp);
+            if (d3 >= 0.0 && d4 <= d3) {
+                return b;
+            }
+            const double vc = d1 * d4 - d3 * d2;
+            if (vc <= 0.0 && d1 >= 0.0 && d3 <= 0.0) {
+                return a + d1 / (d1 - d3) * ab;
+            }
+            const Eigen::Vector3d cp = p - c;
+            const double d5 = ab.dot(cp), d6 = ac.dot(cp);
+            if (d6 >= 0.0 && d5 <= d6) {
+                return c;
+            }
+            const double vb = d5 * d2 - d1 * d6;
+            if (vb <= 0.0 && d2 >= 0.0 && d6 <= 0.0) {
+                return a + d2 / (d2 - d6) * ac;
+            }
+            const double va = d3 * d6 - d5 * d4;
+            if (va <= 0.0 && d4 - d3 >= 0.0 && d5 - d6 >= 0.0) {
+                return b + (d4 - d3) / ((d4 - d3) + (d5 - d6)) * (c - b);
+            }
+            const double denominator = 1.0 / (va + vb + vc);
+            return a + vb * denominator * ab + vc * denominator * ac;
+        }
+
+        /**
+         * @brief Solid angle a triangle subtends at a point (van Oosterom and Strackee), signed by its winding.
+         */
+        double solid_angle(const Eigen::Vector3d& p, const Eigen::Vector3d& a, const Eigen::Vector3d& b, const Eigen::Vector3d& c) {
+            const Eigen::Vector3d x = a - p, y = b - p, z = c - p;
+            const double lx = x.norm(), ly = y.norm(), lz = z.norm();
+            const double numerator = x.dot(y.cross(z));
+            const double denominator = lx * ly * lz + x.dot(y) * lz + x.dot(z) * ly + y.dot(z) * lx;
+            return 2.0 * std::atan2(numerator, denominator);
+        }
+
+    }
+
+    ////////////////////////////////////////////////////////////
+    // Setter functions
+    ////////////////////////////////////////////////////////////
+
+    /**
+     * @brief Add a half-space; the solid side is behind the plane.
+     * @param geometry Plane with a nonzero normal, normalized here.
+     */
+    void environment_model::add_plane(const plane& geometry) {
+        const double length = geometry.normal.norm();
+        if (!(length > 1e-12) || !geometry.normal.allFinite() || !std::isfinite(geometry.offset)) {
+            throw std::invalid_argument("plane must have a finite nonzero normal and a finite offset");
+        }
+        plane normalized;
+        normalized.normal = geometry.normal / length;
+        normalized.offset = geometry.offset / length;
+        this->planes.push_back(normalized);
+    }
+
+    void environment_model::add_sphere(const sphere& geometry) {
+        if (!(geometry.radius > 0.0) || !geometry.center.allFinite()) {
+            throw std::invalid_argument("sphere must have a finite center and a positive radius");
+        }
+        this->spheres.push_back(geometry);
+    }
+
+    void environment_model::add_box(const box& geometry) {
+        if (!(geometry.half_extents.minCoeff() >= 0.0) || !geometry.center.allFinite() || !geometry.rotation.allFinite() ||
+            !(geometry.rotation.transpose() * geometry.rotation).isIdentity(1e-9)) {
+            throw std::invalid_argument("box must have a finite center, a rotation matrix and non-negative half extents");
+        }
+        this->boxes.push_back(geometry);
+    }
+
+    void environment_model::add_capsule(const capsule& geometry) {
+        if (!(geometry.radius > 0.0) || !geometry.a.allFinite() || !geometry.b.allFinite()) {
+            throw std::invalid_argument("capsule must have finite ends and a positive radius");
+        }
+        this->capsules.push_back(geometry);
+    }
+
+    /**
+     * @brief Add a closed triangle mesh. Inside and outside come from the winding number, so either
+     * consistent orientation works.
+     * @param vertices Vertex positions, one column each.
+     * @param triangles Vertex indices of each triangle, one column each.
+     */
+    void environment_model::add_mesh(const Eigen::Ref<const Eigen::Matrix3Xd>& vertices, const Eigen::Ref<const Eigen::Matrix3Xi>& triangles) {
+        if (vertices.cols() < 3 || triangles.cols() < 1 || !vertices.allFinite()) {
+            throw std::invalid_argument("mesh must have finite vertices and at least one triangle");
+        }
+        if (triangles.minCoeff() < 0 || triangles.maxCoeff() >= vertices.cols()) {
+            throw std::invalid_argument("mesh triangle refers to a missing vertex");
+        }
+        mesh_entry mesh;
+        mesh.vertices = vertices;
+        mesh.triangles = triangles;
+        mesh.bounds.min = vertices.rowwise().minCoeff();
+        mesh.bounds.max = vertices.rowwise().maxCoeff();
+        this->meshes.push_back(mesh);
+    }
+
+    ////////////////////////////////////////////////////////////
+    // Getter functions
+    ////////////////////////////////////////////////////////////
+
+    int environment_model::get_num_objects() const {
+        return static_cast<int>(this->planes.size() + this->spheres.size() + this->boxes.size() + this->capsules.size() + this->meshes.size());
+    }
+
+    ////////////////////////////////////////////////////////////
+    // Member functions
+    ////////////////////////////////////////////////////////////
+
+    /**
+     * @brief Exact signed distance to the union of all objects, negative inside.
+     *
+     * Inside overlapping objects the value is the deepest single penetration, not the distance to the
+     * union's surface, which is what clearance checks and repulsion need.
+     *
+     * @param point Query point.
+     * @return Signed distance.
+     */
+    double environment_model::signed_distance(const Eigen::Vector3d& point) const {
+        if (this->get_num_objects() == 0) {
+            throw std::runtime_error("no objects have been added");
+        }
+        double best = std::numeric_limits<double>::infinity();
+        for (const plane& pl : this->planes) {
+            best = std::min(best, pl.normal.dot(point) - pl.offset);
+        }
+        for (const sphere& s : this->spheres) {
+            best = std::min(best, (point - s.center).norm() - s.radius);
+        }
+        Eigen::Vector3d normal;
+        for (const box& b : this->boxes) {
+            best = std::min(best, geometry::box_signed_distance(b, point, normal));
+        }
+        double t;
+        for (const capsule& c : this->capsules) {
+            best = std::min(best, (point - geometry::closest_point_on_segment(c.a, c.b, point, t)).norm() - c.radius);
+        }
+        for (const mesh_entry& mesh : this->meshes) {
+            best = std::min(best, this->mesh_signed_distance(mesh, point, best));
+        }
+        return best;
+    }
+
+    /**
+     * @brief Sample the signed distance on a regular grid and write it as a distance field file.
+     *
+     * Grid points start at region.min and step by the spacing until they cover region.max. A region
+     * that is flat in z gives a planar field with a single layer. The file is a fixed header (magic,
+     * version, sizes, dimensions, origin, spacing) followed by the values as floats, x fastest.
+     *
+     * @param path Output file path.
+     * @param region Box to cover.
+     * @param spacing Grid spacing.
+     * @param num_threads Worker threads, all hardware threads if not positive.
+     */
+    void environment_model::write_distance_field(const std::string& path, const aabb& region, double spacing, int num_threads) const {
+        if (!(spacing > 0.0) || !std::isfinite(spacing)) {
+            throw std::invalid_argument("spacing must be positive and finite");
+        }
+        if (!region.min.allFinite() || !region.max.allFinite() || (region.max - region.min).minCoeff() < 0.0) {
+            throw std::invalid_argument("region must be finite with min <= max");
+        }
+        if (this->get_num_objects() == 0) {
+            throw std::runtime_error("no objects have been added");
+        }
+
+        Eigen::Vector3i dimensions;
+        for (int r = 0; r < 3; r++) {
+            const double cells = std::ceil((region.max(r) - region.min(r)) / spacing - 1e-9);
+            if (cells > 1 << 20) {
+                throw std::invalid_argument("region is too large for the spacing");
+            }
+            dimensions(r) = static_cast<int>(cells) + 1;
+        }
+        if (dimensions(0) < 2 || dimensions(1) < 2) {
+            throw std::invalid_argument("region must span at least one grid cell in x and y");
+        }
+        const long rows = static_cast<long>(dimensions(1)) * dimensions(2);
+        std::vector<float> values(static_cast<std::size_t>(rows) * dimensions(0));
+
+        if (num_threads <= 0) {
+            num_threads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+        }
+        num_threads = static_cast<int>(std::min<long>(num_threads, rows));
+        auto fill_rows = [&](long begin, long end) {
+            for (long row = begin; row < end; row++) {
+                Eigen::Vector3d point = region.min;
+                point(1) += (row % dimensions(1)) * spacing;
+                point(2) += (row / dimensions(1)) * spacing;
+                for (int x = 0; x < dimensions(0); x++) {
+                    point(0) = region.min(0) + x * spacing;
+                    values[row * dimensions(0) + x] = static_cast<float>(this->signed_distance(point));
+                }
+            }
+        };
+        std::vector<std::thread> workers;
+        const long chunk = (rows + num_threads - 1) / num_threads;
+        for (int w = 0; w < num_threads; w++) {
+            const long begin = w * chunk, end = std::min(rows, begin + chunk);
+            if (begin < end) {
+                workers.emplace_back(fill_rows, begin, end);
+            }
+        }
+        for (std::thread& worker : workers) {
+            worker.join();
+        }
+
+        field_record record;
+        std::memset(&record, 0, sizeof(record));
+        std::memcpy(record.magic, field_file_magic, sizeof(field_file_magic));
+        record.version = field_file_version;
+        record.record_size = sizeof(field_record);
+        record.file_size = sizeof(field_record) + sizeof(float) * values.size();
+        for (int r = 0; r < 3; r++) {
+            record.dimensions[r] = dimensions(r);
+            record.origin[r] = region.min(r);
+        }
+        record.spacing = spacing;
+
+        std::ofstream file(path, std::ios::binary);
+        if (!file) {
+            throw std::runtime_error("could not open " + path + " for writing");
+        }
+        file.write(reinterpret_cast<const char*>(&record), sizeof(record));
+        file.write(reinterpret_cast<const char*>(values.data()), static_cast<std::streamsize>(sizeof(float) * values.size()));
+        if (!file) {
+            throw std::runtime_error("failed writing " + path);
+        }
+    }
+
+    ////////////////////////////////////////////////////////////
+    // Private functions
+    ////////////////////////////////////////////////////////////
+
+    /**
+     * @brief Signed distance to a closed mesh: the distance to the nearest triangle, negative where the
+     * winding number is over one half.
+     * @param mesh Mesh.
+     * @param point Query point.
+     * @param bound Distance already found; a point outside the mesh bounds at least this far away
+     * skips the triangles.
+     * @return Signed distance, or a lower bound of at least bound when skipped.
+     */
+    double environment_model::mesh_signed_distance(const mesh_entry& mesh, const Eigen::Vector3d& point, double bound) const {
+        aabb at_point;
+        at_point.min = point;
+        at_point.max = point;
+        const double outside = mesh.bounds.distance(at_point);
+        if (outside >= bound) {
+            return outside;
+        }
+
+        double nearest = std::numeric_limits<double>::infinity();
+        double winding = 0.0;
+        for (long k = 0; k < mesh.triangles.cols(); k++) {
+            const Eigen::Vector3d a = mesh.vertices.col(mesh.triangles(0, k));
+            const Eigen::Vector3d b = mesh.vertices.col(mesh.triangles(1, k));
+            const Eigen::Vector3d c = mesh.vertices.col(mesh.triangles(2, k));
+            nearest = std::min(nearest, (point - closest_point_on_triangle(point, a, b, c)).squaredNorm());
+            if (outside == 0.0) {
+                winding += solid_angle(point, a, b, c);
+            }
+        }
+        nearest = std::sqrt(nearest);
+        return std::abs(winding) > 2.0 * M_PI ? -nearest : nearest;
+    }
+
+    ////////////////////////////////////////////////////////////
+    // Distance fields
+    ////////////////////////////////////////////////////////////
+
+    /**
+     * @brief Map a distance field file and validate its layout.
+     * @param path Distance field file path.
+     */
+    signed_distance_field::signed_distance_field(const std::string& path)
+        : data(nullptr), size(0), values(nullptr), spacing(0.0)
+    {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            throw std::runtime_error("could not open " + path + " for reading");
+        }
+        struct stat info;
+        if (::fstat(fd, &info) != 0 || info.st_size < static_cast<off_t>(sizeof(field_record))) {
+            ::close(fd);
+            throw std::runtime_error(path + " is not a distance field");
+        }
+        void* mapping = ::mmap(nullptr, static_cast<std::size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (mapping == MAP_FAILED) {
+            throw std::runtime_error("could not map " + path);
+        }
+        this->data = static_cast<const unsigned char*>(mapping);
+        this->size = static_cast<std::size_t>(info.st_size);
+
+        const field_record& record = *reinterpret_cast<const field_record*>(this->data);
+        bool valid = std::memcmp(record.magic, field_file_magic, sizeof(field_file_magic)) == 0 &&
+                     record.version == field_file_version &&
+                     record.record_size == sizeof(field_record) &&
+                     record.file_size == this->size &&
+                     record.dimensions[0] >= 2 && record.dimensions[1] >= 2 && record.dimensions[2] >= 1 &&
+                     record.spacing > 0.0;
+        if (valid) {
+            const std::uint64_t count = static_cast<std::uint64_t>(record.dimensions[0]) * record.dimensions[1] * record.dimensions[2];
+            valid = sizeof(field_record) + sizeof(float) * count == this->size;
+        }
+        if (!valid) {
+            ::munmap(const_cast<unsigned char*>(this->data), this->size);
+            throw std::runtime_error(path + " is not a compatible distance field");
+        }
+        this->values = reinterpret_cast<const float*>(this->data + sizeof(field_record));
+        this->origin = Eigen::Map<const Eigen::Vector3d>(record.origin);
+        this->spacing = record.spacing;
+        this->dimensions = Eigen::Map<const Eigen::Vector3i>(record.dimensions);
+    }
+
+    /**
+     * @brief Unmap the distance field.
+     */
+    signed_distance_field::~signed_distance_field()
+    {
+        ::munmap(const_cast<unsigned char*>(this->data), this->size);
+    }
+
+    const Eigen::Vector3d& signed_distance_field::get_origin() const {
+        return this->origin;
+    }
+
+    double signed_distance_field::get_spacing() const {
+        return this->spacing;
+    }
+
+    const Eigen::Vector3i& signed_distance_field::get_dimensions() const {
+        return this->dimensions;
+    }
+
+    bool signed_distance_field::is_planar() const {
+        return this->dimensions(2) == 1;
+    }
+
+    /**
+     * @brief Interpolated signed distance at a point.
+     * @param point Query point.
+     * @return Signed distance.
+     */
+    double signed_distance_field::distance(const Eigen::Vector3d& point) const {
+        Eigen::Vector3d gradient;
+        return this->distance(point, gradient);
+    }
+
+    /**
+     * @brief Trilinear signed distance and its gradient at a point.
+     *
+     * Points outside the grid take the value at the nearest grid point less the distance to it, a lower
+     * bound since a distance changes by at most the distance moved, and the gradient there.
+     *
+     * @param point Query point.
+     * @param gradient Output gradient of the interpolated distance.
+     * @return Signed distance.
+     */
+    double signed_distance_field::distance(const Eigen::Vector3d& point, Eigen::Vector3d& gradient) const {
+        int cell[3] = {0, 0, 0};
+        double f[3] = {0.0, 0.0, 0.0};
+        double outside = 0.0;
+        for (int r = 0; r < (this->is_planar() ? 2 : 3); r++) {
+            const double u = (point(r) - this->origin(r)) / this->spacing;
+            const double clamped = std::min(std::max(u, 0.0), static_cast<double>(this->dimensions(r) - 1));
+            cell[r] = std::min(static_cast<int>(clamped), this->dimensions(r) - 2);
+            f[r] = clamped - cell[r];
+            outside += (u - clamped) * (u - clamped);
+        }
+
+        const long sy = this->dimensions(0);
+        const long sz = this->is_planar() ? 0 : sy * this->dimensions(1);
+        const float* v = this->values + cell[0] + cell[1] * sy + cell[2] * sz;
+        const double v000 = v[0], v100 = v[1], v010 = v[sy], v110 = v[sy + 1];
+        const double v001 = v[sz], v101 = v[sz + 1], v011 = v[sz + sy], v111 = v[sz + sy + 1];
+
+        // Blend along x, then y, then z
+        const double x00 = v000 + f[0] * (v100 - v000), x10 = v010 + f[0] * (v110 - v010);
+        const double x01 = v001 + f[0] * (v101 - v001), x11 = v011 + f[0] * (v111 - v011);
+        const double y0 = x00 + f[1] * (x10 - x00), y1 = x01 + f[1] * (x11 - x01);
+        const double value = y0 + f[2] * (y1 - y0);
+
+        const double dx0 = (1.0 - f[1]) * (v100 - v000) + f[1] * (v110 - v010);
+        const double dx1 = (1.0 - f[1]) * (v101 - v001) + f[1] * (v111 - v011);
+        gradient(0) = ((1.0 - f[2]) * dx0 + f[2] * dx1) / this->spacing;
+        gradient(1) = ((1.0 - f[2]) * (x10 - x00) + f[2] * (x11 - x01)) / this->spacing;
+        gradient(2) = (y1 - y0) / this->spacing;
+        return value - std::sqrt(outside) * this->spacing;
+    }
+
+    /**
+     * @brief Signed distance between a capsule surface and the environment.
+     *
+     * The axis is sampled at most one grid spacing apart; since the distance changes by at most the
+     * distance moved, the result overestimates the true minimum by at most half a spacing.
+     *
+     * @param geometry Capsule.
+     * @param point Output point of the capsule surface closest to the environment.
+     * @param gradient Output distance gradient there, the direction that increases clearance.
+     * @return Smallest signed distance.
+     */
+    double signed_distance_field::capsule_distance(const capsule& geometry, Eigen::Vector3d& point, Eigen::Vector3d& gradient) const {
+        const int samples = static_cast<int>(std::ceil((geometry.b - geometry.a).norm() / this->spacing)) + 1;
+        double best = std::numeric_limits<double>::infinity();
+        Eigen::Vector3d sample_gradient;
+        for (int k = 0; k < samples; k++) {
+            const double t = samples > 1 ? static_cast<double>(k) / (samples - 1) : 0.0;
+            const Eigen::Vector3d sample = geometry.a + t * (geometry.b - geometry.a);
+            const double d = this->distance(sample, sample_gradient);
+            if (d < best) {
+                best = d;
+                gradient = sample_gradient;
+                point = sample;
+            }
+        }
+        const double length = gradient.norm();
+        if (length > 1e-12) {
+            point -= geometry.radius * gradient / length;
+        }
+        return best - geometry.radius;
+    }
+
+}
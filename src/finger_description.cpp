@@ -0,0 +1,712 @@
+#include "include/finger_description.hpp"
+#include "include/open_chain_kinematics.hpp"
+#include <Eigen/Dense>
+#include <yaml-cpp/yaml.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <initializer_list>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+#include <type_traits>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace fm {
+
+    namespace {
+
+        const char model_file_magic[8] = {'F', 'M', 'M', 'O', 'D', 'E', 'L', '\0'};
+        const double geometry_tolerance = 1e-6;
+
+        // Fixed layout at the start of a compiled model file; every field is naturally aligned so the
+        // mapped file is read in place. Matrices are column-major.
+        struct model_record
+        {
+            char magic[8];
+            std::uint32_t version;
+            std::uint32_t record_size;
+            std::uint64_t content_hash;
+            std::uint64_t file_size;
+            std::uint32_t num_joints;
+            std::uint32_t num_tendons;
+            std::uint32_t num_motors;
+            std::uint32_t num_motor_tendons;
+            std::uint32_t num_tables;
+            std::uint32_t reserved;
+            double link_lengths[max_finger_joints];
+            double joint_angles[max_finger_joints];
+            double joint_lower_limits[max_finger_joints];
+            double joint_upper_limits[max_finger_joints];
+            double screw_axes_space[max_finger_joints][6];
+            double screw_axes_body[max_finger_joints][6];
+            double home_position_body_frame[16];
+            double tendon_routing[max_finger_tendons][max_finger_joints];
+            double motor_shaft[max_finger_tendons][max_finger_motors];
+            double link_mass[max_finger_joints];
+            double link_center_of_mass[max_finger_joints][3];
+            double link_rotational_inertia[max_finger_joints][9];
+            double link_capsules[max_finger_joints][7];
+        };
+
+        // Directory entry of a derived table, following the record
+        struct table_entry
+        {
+            std::uint32_t tag;
+            std::uint32_t reserved;
+            std::uint64_t offset;
+            std::uint64_t size;
+        };
+
+        static_assert(std::is_standard_layout<model_record>::value && std::is_trivially_copyable<model_record>::value, "model_record must be mappable");
+        static_assert(sizeof(model_record) % 8 == 0 && sizeof(table_entry) == 24, "compiled model layout must stay 8 byte aligned");
+
+        [[noreturn]] void fail(const std::string& key, const std::string& message) {
+            throw std::invalid_argument("finger description: " + key + ": " + message);
+        }
+
+        void check_keys(const YAML::Node& node, const std::string& key, std::initializer_list<const char*> allowed) {
+            if (!node || !node.IsMap()) {
+                fail(key, "expected a mapping");
+            }
+            for (const auto& item : node) {
+                std::string name = item.first.as<std::string>();
+                bool known = false;
+                for (const char* a : allowed) {
+                    known = known || name == a;
+                }
+                if (!known) {
+                    fail(key, "unknown key '" + name + "'");
+                }
+            }
+        }
+
+        double read_number(const YAML::Node& node, const std::string& key, bool allow_infinite = false) {
+            if (!node || !node.IsScalar()) {
+                fail(key, "expected a number");
+            }
+            double value;
+            try {
+                value = node.as<double>();
+            } catch (const YAML::Exception&) {
+                fail(key, "expected a number");
+            }
+            if (std::isnan(value) || (!allow_infinite && std::isinf(value))) {
+                fail(key, "must be finite");
+            }
+            return value;
+        }
+
+        Eigen::VectorXd read_numbers(const YAML::Node& node, const std::string& key, int size, bool allow_infinite = false) {
+            if (!node || !node.IsSequence() || static_cast<int>(node.size()) != size) {
+                fail(key, "expected a list of " + std::to_string(size) + " numbers");
+            }
+            Eigen::VectorXd values(size);
+            for (int i = 0; i < size; i++) {
+                values(i) = read_number(node[i], key + "[" + std::to_string(i) + "]", allow_infinite);
+            }
+            return values;
+        }
+
+        YAML::Node read_list(const YAML::Node& node, const std::string& key, int min_size, int max_size) {
+            if (!node || !node.IsSequence() || static_cast<int>(node.size()) < min_size || static_cast<int>(node.size()) > max_size) {
+                fail(key, "expected a list of " + std::to_string(min_size) + " to " + std::to_string(max_size) + " entries");
+            }
+            return node;
+        }
+
+        Eigen::Matrix4d read_home_frame(const YAML::Node& node, const std::string& key) {
+            if (!node || !node.IsSequence() || node.size() != 4) {
+                fail(key, "expected 4 rows");
+            }
+            Eigen::Matrix4d M;
+            for (int r = 0; r < 4; r++) {
+                M.row(r) = read_numbers(node[r], key + "[" + std::to_string(r) + "]", 4).transpose();
+            }
+            Eigen::Matrix3d R = M.block<3, 3>(0, 0);
+            if (!M.row(3).isApprox(Eigen::RowVector4d(0, 0, 0, 1)) || !(R * R.transpose()).isIdentity(geometry_tolerance) || R.determinant() <= 0.0) {
+                fail(key, "must be a homogeneous transform with a proper rotation");
+            }
+            return M;
+        }
+
+        Eigen::Matrix<double, 6, 1> read_screw_axis(const YAML::Node& joint, const std::string& key) {
+            Eigen::Matrix<double, 6, 1> S;
+            if (joint["screw_axis"]) {
+                if (joint["axis"] || joint["point"]) {
+                    fail(key, "give either screw_axis or axis and point");
+                }
+                S = read_numbers(joint["screw_axis"], key + ".screw_axis", 6);
+            } else {
+                // Revolute joint about a unit axis through a point, S = (w, -w x q)
+                Eigen::Vector3d w = read_numbers(joint["axis"], key + ".axis", 3);
+                Eigen::Vector3d q = read_numbers(joint["point"], key + ".point", 3);
+                S << w, -w.cross(q);
+            }
+            double w_norm = S.head<3>().norm();
+            bool revolute = std::abs(w_norm - 1.0) < geometry_tolerance;
+            bool prismatic = w_norm < geometry_tolerance && std::abs(S.tail<3>().norm() - 1.0) < geometry_tolerance;
+            if (!revolute && !prismatic) {
+                fail(key, "screw axis must have a unit rotation, or zero rotation and a unit translation");
+            }
+            return S;
+        }
+
+        link_inertia read_inertia(const YAML::Node& node, const std::string& key) {
+            check_keys(node, key, {"mass", "center_of_mass", "rotational_inertia"});
+            link_inertia inertia;
+            inertia.mass = read_number(node["mass"], key + ".mass");
+            if (inertia.mass < 0.0) {
+                fail(key + ".mass", "must be non-negative");
+            }
+            inertia.center_of_mass = read_numbers(node["center_of_mass"], key + ".center_of_mass", 3);
+
+            // Ixx, Iyy, Izz, Ixy, Ixz, Iyz about the center of mass
+            Eigen::VectorXd I = read_numbers(node["rotational_inertia"], key + ".rotational_inertia", 6);
+            inertia.rotational_inertia << I(0), I(3), I(4),
+                                          I(3), I(1), I(5),
+                                          I(4), I(5), I(2);
+            Eigen::Vector3d principal = Eigen::SelfAdjointEigenSolver<Eigen::Matrix3d>(inertia.rotational_inertia, Eigen::EigenvaluesOnly).eigenvalues();
+            double scale = std::max(1.0, principal.cwiseAbs().maxCoeff());
+            if (principal(0) < -1e-12 * scale || principal(0) + principal(1) < principal(2) * (1.0 - geometry_tolerance)) {
+                fail(key + ".rotational_inertia", "is not physically realizable");
+            }
+            return inertia;
+        }
+
+        link_geometry read_capsule(const YAML::Node& node, const std::string& key) {
+            check_keys(node, key, {"start", "end", "radius"});
+            link_geometry geometry;
+            geometry.start = read_numbers(node["start"], key + ".start", 3);
+            geometry.end = read_numbers(node["end"], key + ".end", 3);
+            geometry.radius = read_number(node["radius"], key + ".radius");
+            if (geometry.radius <= 0.0) {
+                fail(key + ".radius", "must be positive");
+            }
+            return geometry;
+        }
+
+        std::string read_file(const std::string& path) {
+            std::ifstream file(path, std::ios::binary);
+            if (!file) {
+                throw std::runtime_error("could not open " + path + " for reading");
+            }
+            std::ostringstream text;
+            text << file.rdbuf();
+            return text.str();
+        }
+
+    }
+
+    ////////////////////////////////////////////////////////////
+    // Description files
+    ////////////////////////////////////////////////////////////
+
+    /**
+     * @brief Content hash of a finger description, FNV-1a 64 over the format version and the text.
+     * @param text Description file contents.
+     * @return 64-bit hash used as the compiled model cache key.
+     */
+    std::uint64_t finger_description_hash(const std::string& text) {
+        std::uint64_t hash = 14695981039346656037ull;
+        auto mix = [&hash](const unsigned char* bytes, std::size_t count) {
+            for (std::size_t i = 0; i < count; i++) {
+                hash = (hash ^ bytes[i]) * 1099511628211ull;
+            }
+        };
+        mix(reinterpret_cast<const unsigned char*>(&finger_description_version), sizeof(finger_description_version));
+        mix(reinterpret_cast<const unsigned char*>(text.data()), text.size());
+        return hash;
+    }
+
+    /**
+     * @brief Parse and validate a YAML finger description.
+     *
+     * The description holds format_version, an optional name, home_position_body_frame (4 rows), and a
+     * list of joints, each with a space frame screw_axis (or a revolute axis and point), a length and
+     * optional angle, limits [lower, upper] (either may be .inf), inertia {mass, center_of_mass,
+     * rotational_inertia [Ixx, Iyy, Izz, Ixy, Ixz, Iyz]} and collision capsule {start, end, radius}.
+     * Optional tendons give one moment_arms entry per joint and optional motors one tendon_coefficients
+     * entry per tendon. Unknown keys are rejected, and the body screw axes are derived as
+     * B_i = Ad_{M^-1} S_i.
+     *
+     * @param text Description file contents.
+     * @return Finger model with space and body screw axes set.
+     */
+    finger_model<> parse_finger_description(const std::string& text) {
+        YAML::Node root;
+        try {
+            root = YAML::Load(text);
+        } catch (const YAML::Exception& e) {
+            throw std::invalid_argument(std::string("finger description: ") + e.what());
+        }
+        check_keys(root, "description", {"format_version", "name", "home_position_body_frame", "joints", "tendons", "motors"});
+        if (read_number(root["format_version"], "format_version") != finger_description_version) {
+            fail("format_version", "unsupported version");
+        }
+        Eigen::Matrix4d M = read_home_frame(root["home_position_body_frame"], "home_position_body_frame");
+
+        const YAML::Node joints = read_list(root["joints"], "joints", 1, max_finger_joints);
+        const int n = static_cast<int>(joints.size());
+        Eigen::VectorXd link_lengths(n), joint_angles(n);
+        Eigen::VectorXd lower = Eigen::VectorXd::Constant(n, -std::numeric_limits<double>::infinity());
+        Eigen::VectorXd upper = Eigen::VectorXd::Constant(n, std::numeric_limits<double>::infinity());
+        Eigen::Matrix<double, 6, Eigen::Dynamic> S(6, n), B(6, n);
+        std::vector<link_inertia> inertias(n);
+        std::vector<link_geometry> capsules(n);
+        Eigen::Matrix4d M_inv = rigid_body_motion::Transform_Inverse(M);
+        for (int i = 0; i < n; i++) {
+            const std::string key = "joints[" + std::to_string(i) + "]";
+            const YAML::Node joint = joints[i];
+            check_keys(joint, key, {"name", "screw_axis", "axis", "point", "length", "angle", "limits", "inertia", "capsule"});
+            S.col(i) = read_screw_axis(joint, key);
+            B.col(i) = rigid_body_motion::Adjoint_Twist(M_inv, S.col(i));
+            link_lengths(i) = read_number(joint["length"], key + ".length");
+            if (link_lengths(i) < 0.0) {
+                fail(key + ".length", "must be non-negative");
+            }
+            if (joint["limits"]) {
+                Eigen::VectorXd limits = read_numbers(joint["limits"], key + ".limits", 2, true);
+                if (limits(0) > limits(1)) {
+                    fail(key + ".limits", "lower limit exceeds upper limit");
+                }
+                lower(i) = limits(0);
+                upper(i) = limits(1);
+            }
+            joint_angles(i) = joint["angle"] ? read_number(joint["angle"], key + ".angle") : std::max(lower(i), std::min(0.0, upper(i)));
+            if (joint_angles(i) < lower(i) || joint_angles(i) > upper(i)) {
+                fail(key + ".angle", "lies outside the joint limits");
+            }
+            if (joint["inertia"]) {
+                inertias[i] = read_inertia(joint["inertia"], key + ".inertia");
+            }
+            if (joint["capsule"]) {
+                capsules[i] = read_capsule(joint["capsule"], key + ".capsule");
+            }
+        }
+
+        finger_model<> finger(link_lengths, joint_angles);
+        finger.set_home_position_body_frame(M);
+        finger.set_home_position_screw_axes_space(S);
+        finger.set_home_position_screw_axes_body(B);
+        finger.set_joint_limits(lower, upper);
+        for (int i = 0; i < n; i++) {
+            finger.set_link_inertia(i, inertias[i]);
+            finger.set_link_geometry(i, capsules[i]);
+        }
+
+        int num_tendons = 0;
+        if (root["tendons"]) {
+            const YAML::Node tendons = read_list(root["tendons"], "tendons", 1, max_finger_tendons);
+            num_tendons = static_cast<int>(tendons.size());
+            Eigen::MatrixXd routing(n, num_tendons);
+            for (int t = 0; t < num_tendons; t++) {
+                const std::string key = "tendons[" + std::to_string(t) + "]";
+                check_keys(tendons[t], key, {"name", "moment_arms"});
+                routing.col(t) = read_numbers(tendons[t]["moment_arms"], key + ".moment_arms", n);
+            }
+            finger.set_tendon_routing_matrix(routing);
+        }
+        if (root["motors"]) {
+            if (num_tendons == 0) {
+                fail("motors", "require tendons");
+            }
+            const YAML::Node motors = read_list(root["motors"], "motors", 1, max_finger_motors);
+            Eigen::MatrixXd motor_shaft(motors.size(), num_tendons);
+            for (int m = 0; m < static_cast<int>(motors.size()); m++) {
+                const std::string key = "motors[" + std::to_string(m) + "]";
+                check_keys(motors[m], key, {"name", "tendon_coefficients"});
+                motor_shaft.row(m) = read_numbers(motors[m]["tendon_coefficients"], key + ".tendon_coefficients", num_tendons).transpose();
+            }
+            finger.set_motor_shaft_matrix(motor_shaft);
+        }
+        return finger;
+    }
+
+    /**
+     * @brief Read, parse and validate a YAML finger description file.
+     * @param path Description file path.
+     * @return Finger model.
+     */
+    finger_model<> load_finger_description(const std::string& path) {
+        return parse_finger_description(read_file(path));
+    }
+
+    /**
+     * @brief Format a finger model as a YAML description that parses back to the same model.
+     *
+     * Space screw axes are written as screw_axis entries with round-trip precision; joint limits are
+     * written when at least one side is bounded, the angle is clamped to them, inertias are written
+     * when the link has mass and capsules when they have a radius.
+     *
+     * @param finger Finger model with space screw axes and home frame set.
+     * @param name Description name.
+     * @return Description text.
+     */
+    std::string format_finger_description(const finger_model<>& finger, const std::string& name) {
+        const int n = finger.get_num_joints();
+        std::ostringstream out;
+        out.precision(17);
+        auto list = [&out](const double* values, int count) {
+            out << "[";
+            for (int i = 0; i < count; i++) {
+                if (std::isinf(values[i])) {
+                    out << (values[i] > 0 ? ".inf" : "-.inf");
+                } else {
+                    out << values[i];
+                }
+                out << (i + 1 < count ? ", " : "]");
+            }
+        };
+
+        out << "format_version: " << finger_description_version << "\n"
+            << "name: " << name << "\n"
+            << "home_position_body_frame:\n";
+        const Eigen::Matrix4d& M = finger.get_home_position_body_frame();
+        for (int r = 0; r < 4; r++) {
+            Eigen::RowVector4d row = M.row(r);
+            out << "  - ";
+            list(row.data(), 4);
+            out << "\n";
+        }
+
+        out << "joints:\n";
+        const auto lower = finger.get_joint_lower_limits();
+        const auto upper = finger.get_joint_upper_limits();
+        for (int i = 0; i < n; i++) {
+            Eigen::Matrix<double, 6, 1> S = finger.get_home_position_screw_axes_space().col(i);
+            out << "  - screw_axis: ";
+            list(S.data(), 6);
+            out << "\n    length: " << finger.get_link_lengths()(i)
+                << "\n    angle: " << std::max(lower(i), std::min(finger.get_joint_angles()(i), upper(i))) << "\n";
+            if (!std::isinf(lower(i)) || !std::isinf(upper(i))) {
+                double limits[2] = {lower(i), upper(i)};
+                out << "    limits: ";
+                list(limits, 2);
+                out << "\n";
+            }
+            const link_inertia& inertia = finger.get_link_inertia(i);
+            if (inertia.mass > 0.0) {
+                const Eigen::Matrix3d& I = inertia.rotational_inertia;
+                double packed[6] = {I(0, 0), I(1, 1), I(2, 2), I(0, 1), I(0, 2), I(1, 2)};
+                out << "    inertia:\n      mass: " << inertia.mass << "\n      center_of_mass: ";
+                list(inertia.center_of_mass.data(), 3);
+                out << "\n      rotational_inertia: ";
+                list(packed, 6);
+                out << "\n";
+            }
+            const link_geometry& geometry = finger.get_link_geometry(i);
+            if (geometry.radius > 0.0) {
+                out << "    capsule:\n      start: ";
+                list(geometry.start.data(), 3);
+                out << "\n      end: ";
+                list(geometry.end.data(), 3);
+                out << "\n      radius: " << geometry.radius << "\n";
+            }
+        }
+
+        const auto& routing = finger.get_tendon_routing_matrix();
+        if (routing.cols() > 0) {
+            out << "tendons:\n";
+            for (int t = 0; t < routing.cols(); t++) {
+                Eigen::VectorXd arms = routing.col(t);
+                out << "  - moment_arms: ";
+                list(arms.data(), n);
+                out << "\n";
+            }
+            const auto& motor_shaft = finger.get_motor_shaft_matrix();
+            if (motor_shaft.cols() == routing.cols() && !motor_shaft.isZero()) {
+                out << "motors:\n";
+                for (int m = 0; m < motor_shaft.rows(); m++) {
+                    Eigen::RowVectorXd coefficients = motor_shaft.row(m);
+                    out << "  - tendon_coefficients: ";
+                    list(coefficients.data(), static_cast<int>(coefficients.size()));
+                    out << "\n";
+                }
+            }
+        }
+        return out.str();
+    }
+
+    /**
+     * @brief Write a finger model as a YAML description file.
+     * @param path Output file path.
+     * @param finger Finger model.
+     * @param name Description name.
+     */
+    void write_finger_description(const std::string& path, const finger_model<>& finger, const std::string& name) {
+        const std::string text = format_finger_description(finger, name);
+        std::ofstream file(path, std::ios::binary);
+        if (!file) {
+            throw std::runtime_error("could not open " + path + " for writing");
+        }
+        file << text;
+        if (!file) {
+            throw std::runtime_error("failed writing " + path);
+        }
+    }
+
+    /**
+     * @brief Load a finger model through the compiled model cache.
+     *
+     * The description is hashed; a compiled model with that hash in the cache directory is mapped and
+     * used as is, otherwise the description is parsed, validated and compiled into the cache (written
+     * to a temporary file and renamed, so concurrent loaders never see a partial file).
+     *
+     * @param description_path YAML description file path.
+     * @param cache_directory Directory of compiled models, created if missing.
+     * @return Finger model.
+     */
+    finger_model<> load_finger_model(const std::string& description_path, const std::string& cache_directory) {
+        const std::string text = read_file(description_path);
+        const std::uint64_t hash = finger_description_hash(text);
+
+        char name[32];
+        std::snprintf(name, sizeof(name), "%016llx.fmodel", static_cast<unsigned long long>(hash));
+        const std::filesystem::path cache_path = std::filesystem::path(cache_directory) / name;
+
+        std::error_code error;
+        if (std::filesystem::exists(cache_path, error)) {
+            try {
+                compiled_finger_model compiled(cache_path.string());
+                if (compiled.get_content_hash() == hash) {
+                    return compiled.get_finger_model();
+                }
+            } catch (const std::runtime_error&) {
+                // Stale or damaged cache entries are recompiled below
+            }
+        }
+
+        finger_model<> finger = parse_finger_description(text);
+        std::filesystem::create_directories(cache_directory);
+        const std::filesystem::path temporary = cache_path.string() + ".tmp" + std::to_string(::getpid());
+        compiled_finger_model::write(temporary.string(), finger, hash);
+        std::filesystem::rename(temporary, cache_path);
+        return finger;
+    }
+
+    ////////////////////////////////////////////////////////////
+    // Compiled models
+    ////////////////////////////////////////////////////////////
+
+    /**
+     * @brief Map a compiled finger model file and validate its layout.
+     * @param path Compiled model file path.
+     */
+    compiled_finger_model::compiled_finger_model(const std::string& path)
+        : data(nullptr), size(0)
+    {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            throw std::runtime_error("could not open " + path + " for reading");
+        }
+        struct stat info;
+        if (::fstat(fd, &info) != 0 || info.st_size < static_cast<off_t>(sizeof(model_record))) {
+            ::close(fd);
+            throw std::runtime_error(path + " is not a compiled finger model");
+        }
+        void* mapping = ::mmap(nullptr, static_cast<std::size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (mapping == MAP_FAILED) {
+            throw std::runtime_error("could not map " + path);
+        }
+        this->data = static_cast<const unsigned char*>(mapping);
+        this->size = static_cast<std::size_t>(info.st_size);
+
+        const model_record& record = *reinterpret_cast<const model_record*>(this->data);
+        bool valid = std::memcmp(record.magic, model_file_magic, sizeof(model_file_magic)) == 0 &&
+                     record.version == finger_description_version &&
+                     record.record_size == sizeof(model_record) &&
+                     record.file_size == this->size &&
+                     record.num_joints >= 1 && record.num_joints <= static_cast<std::uint32_t>(max_finger_joints) &&
+                     record.num_tendons <= static_cast<std::uint32_t>(max_finger_tendons) &&
+                     record.num_motors <= static_cast<std::uint32_t>(max_finger_motors) &&
+                     record.num_motor_tendons <= static_cast<std::uint32_t>(max_finger_tendons) &&
+                     record.num_tables <= (this->size - sizeof(model_record)) / sizeof(table_entry);
+        if (valid) {
+            const table_entry* tables = reinterpret_cast<const table_entry*>(this->data + sizeof(model_record));
+            for (std::uint32_t i = 0; i < record.num_tables; i++) {
+                valid = valid && tables[i].offset <= this->size && tables[i].size <= this->size - tables[i].offset;
+            }
+        }
+        if (!valid) {
+            ::munmap(const_cast<unsigned char*>(this->data), this->size);
+            throw std::runtime_error(path + " is not a compatible compiled finger model");
+        }
+    }
+
+    /**
+     * @brief Unmap the compiled model.
+     */
+    compiled_finger_model::~compiled_finger_model()
+    {
+        ::munmap(const_cast<unsigned char*>(this->data), this->size);
+    }
+
+    /**
+     * @brief Write a compiled finger model with optional derived tables.
+     *
+     * The file is a model_record (magic, version, sizes, content hash and the model arrays), a table
+     * directory, then each table's bytes at a 16 byte aligned offset.
+     *
+     * @param path Output file path.
+     * @param finger Finger model with space and body screw axes set.
+     * @param content_hash Hash of the description the model was compiled from.
+     * @param tables Derived tables to store with the model.
+     */
+    void compiled_finger_model::write(const std::string& path, const finger_model<>& finger, std::uint64_t content_hash, const std::vector<compiled_table>& tables) {
+        // Both chains must be complete
+        finger.pose_space(finger.get_joint_angles());
+        finger.pose_body(finger.get_joint_angles());
+
+        model_record record;
+        std::memset(&record, 0, sizeof(record));
+        std::memcpy(record.magic, model_file_magic, sizeof(model_file_magic));
+        record.version = finger_description_version;
+        record.record_size = sizeof(model_record);
+        record.content_hash = content_hash;
+
+        const int n = finger.get_num_joints();
+        const auto& routing = finger.get_tendon_routing_matrix();
+        const auto& motor_shaft = finger.get_motor_shaft_matrix();
+        record.num_joints = static_cast<std::uint32_t>(n);
+        record.num_tendons = static_cast<std::uint32_t>(routing.cols());
+        record.num_motors = static_cast<std::uint32_t>(motor_shaft.rows());
+        record.num_motor_tendons = static_cast<std::uint32_t>(motor_shaft.cols());
+        record.num_tables = static_cast<std::uint32_t>(tables.size());
+
+        const auto lower = finger.get_joint_lower_limits();
+        const auto upper = finger.get_joint_upper_limits();
+        for (int i = 0; i < n; i++) {
+            record.link_lengths[i] = finger.get_link_lengths()(i);
+            record.joint_angles[i] = finger.get_joint_angles()(i);
+            record.joint_lower_limits[i] = lower(i);
+            record.joint_upper_limits[i] = upper(i);
+            Eigen::Map<Eigen::Matrix<double, 6, 1>>(record.screw_axes_space[i]) = finger.get_home_position_screw_axes_space().col(i);
+            Eigen::Map<Eigen::Matrix<double, 6, 1>>(record.screw_axes_body[i]) = finger.get_home_position_screw_axes_body().col(i);
+            const link_inertia& inertia = finger.get_link_inertia(i);
+            record.link_mass[i] = inertia.mass;
+            Eigen::Map<Eigen::Vector3d>(record.link_center_of_mass[i]) = inertia.center_of_mass;
+            Eigen::Map<Eigen::Matrix3d>(record.link_rotational_inertia[i]) = inertia.rotational_inertia;
+            const link_geometry& geometry = finger.get_link_geometry(i);
+            Eigen::Map<Eigen::Vector3d>(record.link_capsules[i]) = geometry.start;
+            Eigen::Map<Eigen::Vector3d>(record.link_capsules[i] + 3) = geometry.end;
+            record.link_capsules[i][6] = geometry.radius;
+        }
+        Eigen::Map<Eigen::Matrix4d>(record.home_position_body_frame) = finger.get_home_position_body_frame();
+        for (int t = 0; t < routing.cols(); t++) {
+            for (int i = 0; i < n; i++) {
+                record.tendon_routing[t][i] = routing(i, t);
+            }
+        }
+        for (int t = 0; t < motor_shaft.cols(); t++) {
+            for (int m = 0; m < motor_shaft.rows(); m++) {
+                record.motor_shaft[t][m] = motor_shaft(m, t);
+            }
+        }
+
+        std::vector<table_entry> directory(tables.size());
+        std::uint64_t offset = sizeof(model_record) + sizeof(table_entry) * tables.size();
+        for (std::size_t i = 0; i < tables.size(); i++) {
+            offset = (offset + 15) & ~std::uint64_t(15);
+            directory[i] = {tables[i].tag, 0, offset, tables[i].data.size()};
+            offset += tables[i].data.size();
+        }
+        record.file_size = offset;
+
+        std::ofstream file(path, std::ios::binary);
+        if (!file) {
+            throw std::runtime_error("could not open " + path + " for writing");
+        }
+        file.write(reinterpret_cast<const char*>(&record), sizeof(record));
+        file.write(reinterpret_cast<const char*>(directory.data()), sizeof(table_entry) * directory.size());
+        std::uint64_t position = sizeof(model_record) + sizeof(table_entry) * tables.size();
+        const char padding[16] = {};
+        for (std::size_t i = 0; i < tables.size(); i++) {
+            file.write(padding, static_cast<std::streamsize>(directory[i].offset - position));
+            file.write(tables[i].data.data(), static_cast<std::streamsize>(tables[i].data.size()));
+            position = directory[i].offset + tables[i].data.size();
+        }
+        if (!file) {
+            throw std::runtime_error("failed writing " + path);
+        }
+    }
+
+    ////////////////////////////////////////////////////////////
+    // Getter functions
+    ////////////////////////////////////////////////////////////
+
+    /**
+     * @brief Get the hash of the description the model was compiled from.
+     * @return Content hash.
+     */
+    std::uint64_t compiled_finger_model::get_content_hash() const {
+        return reinterpret_cast<const model_record*>(this->data)->content_hash;
+    }
+
+    /**
+     * @brief Get the number of joints.
+     * @return Number of joints.
+     */
+    int compiled_finger_model::get_num_joints() const {
+        return static_cast<int>(reinterpret_cast<const model_record*>(this->data)->num_joints);
+    }
+
+    /**
+     * @brief Build a finger model from the mapped arrays, without any parsing or derivation.
+     * @return Finger model.
+     */
+    finger_model<> compiled_finger_model::get_finger_model() const {
+        const model_record& record = *reinterpret_cast<const model_record*>(this->data);
+        const int n = static_cast<int>(record.num_joints);
+
+        finger_model<> finger(Eigen::Map<const Eigen::VectorXd>(record.link_lengths, n), Eigen::Map<const Eigen::VectorXd>(record.joint_angles, n));
+        finger.set_home_position_body_frame(Eigen::Map<const Eigen::Matrix4d>(record.home_position_body_frame));
+        finger.set_home_position_screw_axes_space(Eigen::Map<const Eigen::Matrix<double, 6, Eigen::Dynamic>>(&record.screw_axes_space[0][0], 6, n));
+        finger.set_home_position_screw_axes_body(Eigen::Map<const Eigen::Matrix<double, 6, Eigen::Dynamic>>(&record.screw_axes_body[0][0], 6, n));
+        finger.set_joint_limits(Eigen::Map<const Eigen::VectorXd>(record.joint_lower_limits, n), Eigen::Map<const Eigen::VectorXd>(record.joint_upper_limits, n));
+        for (int i = 0; i < n; i++) {
+            link_inertia inertia;
+            inertia.mass = record.link_mass[i];
+            inertia.center_of_mass = Eigen::Map<const Eigen::Vector3d>(record.link_center_of_mass[i]);
+            inertia.rotational_inertia = Eigen::Map<const Eigen::Matrix3d>(record.link_rotational_inertia[i]);
+            finger.set_link_inertia(i, inertia);
+            link_geometry geometry;
+            geometry.start = Eigen::Map<const Eigen::Vector3d>(record.link_capsules[i]);
+            geometry.end = Eigen::Map<const Eigen::Vector3d>(record.link_capsules[i] + 3);
+            geometry.radius = record.link_capsules[i][6];
+            finger.set_link_geometry(i, geometry);
+        }
+        Eigen::Map<const Eigen::MatrixXd, 0, Eigen::OuterStride<>> routing(&record.tendon_routing[0][0], n, record.num_tendons, Eigen::OuterStride<>(max_finger_joints));
+        finger.set_tendon_routing_matrix(routing);
+        Eigen::Map<const Eigen::MatrixXd, 0, Eigen::OuterStride<>> motor_shaft(&record.motor_shaft[0][0], record.num_motors, record.num_motor_tendons, Eigen::OuterStride<>(max_finger_motors));
+        finger.set_motor_shaft_matrix(motor_shaft);
+        return finger;
+    }
+
+    /**
+     * @brief Get a derived table stored with the model.
+     * @param tag Table tag.
+     * @param size Set to the table size in bytes.
+     * @return Pointer into the mapping, valid while this object lives, or nullptr if there is no such table.
+     */
+    const void* compiled_finger_model::get_table(std::uint32_t tag, std::size_t& size) const {
+        const model_record& record = *reinterpret_cast<const model_record*>(this->data);
+        const table_entry* tables = reinterpret_cast<const table_entry*>(this->data + sizeof(model_record));
+        for (std::uint32_t i = 0; i < record.num_tables; i++) {
+            if (tables[i].tag == tag) {
+                size = static_cast<std::size_t>(tables[i].size);
+                return this->data + tables[i].offset;
+            }
+        }
+        size = 0;
+        return nullptr;
+    }
+
+}
@@ -2,21 +2,42 @@
 #include "include/open_chain_kinematics.hpp"
 #include <iostream>
 #include <Eigen/Dense>
+#include <limits>
+#include <stdexcept>
 #include <vector>
 
 namespace fm {
 
+    namespace {
+
+        // Damped least squares settings shared by the inverse kinematics solvers
+        const double ik_tolerance = 1e-10;
+        const double ik_damping = 1e-6;
+        const int ik_max_iterations = 100;
+
+    }
+
     /**
      * @brief Default constructor for the finger_model class.
+     *
+     * A fixed-size finger starts with N zero joint angles; a dynamic one starts empty.
      */
-    finger_model::finger_model()
-        : finger_space_jacobian(Eigen::MatrixXd::Zero(6, 3)),
-          finger_body_jacobian(Eigen::MatrixXd::Zero(6, 3)),
-          tendon_routing_matrix(Eigen::MatrixXd::Zero(3, 6)),
-          link_lengths(Eigen::VectorXd()),
-          joint_angles(Eigen::VectorXd()),
-          home_position_screw_axes_body(std::vector<Eigen::VectorXd>(3)),
-          home_position_screw_axes_space(std::vector<Eigen::VectorXd>(3))
+    template <int N>
+    finger_model<N>::finger_model()
+        : home_position_body_frame(Eigen::Matrix4d::Identity()),
+          home_position_screw_axes_body(screw_matrix::Zero(6, N == Eigen::Dynamic ? 0 : N)),
+          home_position_screw_axes_space(screw_matrix::Zero(6, N == Eigen::Dynamic ? 0 : N)),
+          has_screw_axes_body(false),
+          has_screw_axes_space(false),
+          link_lengths(joint_vector::Zero(N == Eigen::Dynamic ? 0 : N)),
+          joint_angles(joint_vector::Zero(N == Eigen::Dynamic ? 0 : N)),
+          joint_lower_limits(joint_vector::Constant(N == Eigen::Dynamic ? 0 : N, -std::numeric_limits<double>::infinity())),
+          joint_upper_limits(joint_vector::Constant(N == Eigen::Dynamic ? 0 : N, std::numeric_limits<double>::infinity())),
+          fingertip_pose_space(Eigen::Matrix4d::Identity()),
+          fingertip_pose_body(Eigen::Matrix4d::Identity()),
+          dirty(dirty_all),
+          tendon_routing_matrix(routing_matrix::Zero(N == Eigen::Dynamic ? 0 : N, 0)),
+          motor_shaft_matrix(motor_matrix::Zero(max_finger_motors, max_finger_tendons))
     {
         // Default constructor implementation
     }
@@ -26,28 +47,29 @@ namespace fm {
      * @param link_lengths Vector of link lengths.
      * @param joint_angles Vector of joint angles.
      */
-    finger_model::finger_model(Eigen::VectorXd link_lengths, Eigen::VectorXd joint_angles)
-        : finger_space_jacobian(Eigen::MatrixXd::Zero(6, 3)),
-          finger_body_jacobian(Eigen::MatrixXd::Zero(6, 3)),
-          tendon_routing_matrix(Eigen::MatrixXd::Zero(3, 6)),
-          link_lengths(link_lengths),
-          joint_angles(joint_angles),
-          home_position_screw_axes_body(std::vector<Eigen::VectorXd>(3)),
-          home_position_screw_axes_space(std::vector<Eigen::VectorXd>(3))
+    template <int N>
+    finger_model<N>::finger_model(const Eigen::Ref<const Eigen::VectorXd>& link_lengths, const Eigen::Ref<const Eigen::VectorXd>& joint_angles)
+        : finger_model()
     {
-        if (link_lengths.size() < 1 || link_lengths.size() > 4) {
-            throw std::invalid_argument("link_lengths must have exactly 1-4 elements");
-        }
-
-        if (joint_angles.size() < 1 || joint_angles.size() > 4) {
-            throw std::invalid_argument("joint_angles must have exactly 1-4 elements");
+        this->check_joint_count(link_lengths.size(), "link_lengths must have one element per joint");
+        this->check_joint_count(joint_angles.size(), "joint_angles must have one element per joint");
+        if (link_lengths.size() != joint_angles.size()) {
+            throw std::invalid_argument("link_lengths and joint_angles must have the same number of elements");
         }
+        this->link_lengths = link_lengths;
+        this->joint_angles = joint_angles;
+        this->home_position_screw_axes_body.setZero(6, joint_angles.size());
+        this->home_position_screw_axes_space.setZero(6, joint_angles.size());
+        this->tendon_routing_matrix.setZero(joint_angles.size(), 0);
+        this->joint_lower_limits.setConstant(joint_angles.size(), -std::numeric_limits<double>::infinity());
+        this->joint_upper_limits.setConstant(joint_angles.size(), std::numeric_limits<double>::infinity());
     }
-    
+
     /**
      * @brief Destructor for the finger_model class.
      */
-    finger_model::~finger_model()
+    template <int N>
+    finger_model<N>::~finger_model()
     {
     }
 
@@ -59,66 +81,169 @@ namespace fm {
      * @brief Set the home position screw axes in the body frame.
      * @param home_position_screw_axes Vector of screw axes.
      */
-    void finger_model::set_home_position_screw_axes_body(std::vector<Eigen::VectorXd> home_position_screw_axes) {
-        if (home_position_screw_axes.size() < 1 || home_position_screw_axes.size() > 4) {
-            throw std::invalid_argument("home_position_screw_axes must have exactly 1-4 elements");
+    template <int N>
+    void finger_model<N>::set_home_position_screw_axes_body(const std::vector<Eigen::VectorXd>& home_position_screw_axes) {
+        this->check_joint_count(home_position_screw_axes.size(), "home_position_screw_axes must have one element per joint");
+        Eigen::Matrix<double, 6, Eigen::Dynamic, 0, 6, max_finger_joints> axes(6, home_position_screw_axes.size());
+        for (int i = 0; i < axes.cols(); i++) {
+            if (home_position_screw_axes[i].size() != 6) {
+                throw std::invalid_argument("each screw axis must be a 6-vector");
+            }
+            axes.col(i) = home_position_screw_axes[i];
         }
+        this->set_home_position_screw_axes_body(axes);
+    }
+
+    /**
+     * @brief Set the home position screw axes in the body frame, one per column.
+     * @param home_position_screw_axes 6xN matrix of screw axes.
+     */
+    template <int N>
+    void finger_model<N>::set_home_position_screw_axes_body(const Eigen::Ref<const Eigen::Matrix<double, 6, Eigen::Dynamic>>& home_position_screw_axes) {
+        this->check_joint_count(home_position_screw_axes.cols(), "home_position_screw_axes must have one element per joint");
         this->home_position_screw_axes_body = home_position_screw_axes;
+        this->has_screw_axes_body = true;
+        this->dirty |= dirty_body;
     }
 
     /**
      * @brief Set the home position screw axes in the space frame.
      * @param home_position_screw_axes Vector of screw axes.
      */
-    void finger_model::set_home_position_screw_axes_space(std::vector<Eigen::VectorXd> home_position_screw_axes) {
-        if (home_position_screw_axes.size() < 1 || home_position_screw_axes.size() > 4) {
-            throw std::invalid_argument("home_position_screw_axes must have exactly 1-4 elements");
+    template <int N>
+    void finger_model<N>::set_home_position_screw_axes_space(const std::vector<Eigen::VectorXd>& home_position_screw_axes) {
+        this->check_joint_count(home_position_screw_axes.size(), "home_position_screw_axes must have one element per joint");
+        Eigen::Matrix<double, 6, Eigen::Dynamic, 0, 6, max_finger_joints> axes(6, home_position_screw_axes.size());
+        for (int i = 0; i < axes.cols(); i++) {
+            if (home_position_screw_axes[i].size() != 6) {
+                throw std::invalid_argument("each screw axis must be a 6-vector");
+            }
+            axes.col(i) = home_position_screw_axes[i];
         }
+        this->set_home_position_screw_axes_space(axes);
+    }
+
+    /**
+     * @brief Set the home position screw axes in the space frame, one per column.
+     * @param home_position_screw_axes 6xN matrix of screw axes.
+     */
+    template <int N>
+    void finger_model<N>::set_home_position_screw_axes_space(const Eigen::Ref<const Eigen::Matrix<double, 6, Eigen::Dynamic>>& home_position_screw_axes) {
+        this->check_joint_count(home_position_screw_axes.cols(), "home_position_screw_axes must have one element per joint");
         this->home_position_screw_axes_space = home_position_screw_axes;
+        this->has_screw_axes_space = true;
+        this->dirty |= dirty_space;
     }
 
     /**
      * @brief Set the home position in the body frame.
      * @param home_position_body_frame 4x4 transformation matrix.
      */
-    void finger_model::set_home_position_body_frame(Eigen::MatrixXd home_position_body_frame) {
+    template <int N>
+    void finger_model<N>::set_home_position_body_frame(const Eigen::Ref<const Eigen::MatrixXd>& home_position_body_frame) {
         if (home_position_body_frame.rows() != 4 || home_position_body_frame.cols() != 4) {
             throw std::invalid_argument("home_position_body_frame must be a 4x4 matrix");
         }
         this->home_position_body_frame = home_position_body_frame;
+        this->dirty |= dirty_all;
     }
 
     /**
      * @brief Set the tendon routing matrix.
-     * @param tendon_routing_matrix Matrix representing the tendon routing.
+     * @param tendon_routing_matrix Matrix representing the tendon routing (joints x tendons).
      */
-    void finger_model::set_tendon_routing_matrix(Eigen::MatrixXd tendon_routing_matrix) {
-        if (tendon_routing_matrix.rows() > 3 || tendon_routing_matrix.cols() > 6) {
-            throw std::invalid_argument("tendon_routing_matrix allows no more than 3 rows and 6 columns");
+    template <int N>
+    void finger_model<N>::set_tendon_routing_matrix(const Eigen::Ref<const Eigen::MatrixXd>& tendon_routing_matrix) {
+        if ((N != Eigen::Dynamic && tendon_routing_matrix.rows() != N) || tendon_routing_matrix.rows() > max_finger_joints || tendon_routing_matrix.cols() > max_finger_tendons) {
+            throw std::invalid_argument("tendon_routing_matrix must have one row per joint and no more than max_finger_tendons columns");
         }
         this->tendon_routing_matrix = tendon_routing_matrix;
     }
 
+    /**
+     * @brief Set the motor shaft matrix.
+     * @param motor_shaft_matrix Matrix mapping tendon excursions to motor shaft angles (motors x tendons).
+     */
+    template <int N>
+    void finger_model<N>::set_motor_shaft_matrix(const Eigen::Ref<const Eigen::MatrixXd>& motor_shaft_matrix) {
+        if (motor_shaft_matrix.rows() > max_finger_motors || motor_shaft_matrix.cols() > max_finger_tendons) {
+            throw std::invalid_argument("motor_shaft_matrix allows no more than max_finger_motors rows and max_finger_tendons columns");
+        }
+        this->motor_shaft_matrix = motor_shaft_matrix;
+    }
+
     /**
      * @brief Set the link lengths.
      * @param link_lengths Vector of link lengths.
      */
-    void finger_model::set_link_lengths(Eigen::VectorXd link_lengths) {
-        if (link_lengths.size() < 1 || link_lengths.size() > 4) {
-            throw std::invalid_argument("link_lengths must have exactly 1-4 elements");
-        }
+    template <int N>
+    void finger_model<N>::set_link_lengths(const Eigen::Ref<const Eigen::VectorXd>& link_lengths) {
+        this->check_joint_count(link_lengths.size(), "link_lengths must have one element per joint");
         this->link_lengths = link_lengths;
     }
 
     /**
      * @brief Set the joint angles.
+     *
+     * Copies into the fixed-size storage and marks the cached kinematics dirty.
+     *
      * @param joint_angles Vector of joint angles.
      */
-    void finger_model::set_joint_angles(Eigen::VectorXd joint_angles) {
-        if (joint_angles.size() < 1 || joint_angles.size() > 4) {
-            throw std::invalid_argument("joint_angles must have exactly 1-4 elements");
-        }
+    template <int N>
+    void finger_model<N>::set_joint_angles(const Eigen::Ref<const Eigen::VectorXd>& joint_angles) {
+        this->check_joint_count(joint_angles.size(), "joint_angles must have one element per joint");
         this->joint_angles = joint_angles;
+        this->dirty = dirty_all;
+    }
+
+    /**
+     * @brief Set the joint limits; joints are unbounded until this is called.
+     * @param lower Lower joint limits.
+     * @param upper Upper joint limits.
+     */
+    template <int N>
+    void finger_model<N>::set_joint_limits(const Eigen::Ref<const Eigen::VectorXd>& lower, const Eigen::Ref<const Eigen::VectorXd>& upper) {
+        this->check_joint_count(lower.size(), "lower must have one element per joint");
+        if (upper.size() != lower.size()) {
+            throw std::invalid_argument("lower and upper must have the same number of elements");
+        }
+        if ((lower.array() > upper.array()).any() || lower.hasNaN() || upper.hasNaN()) {
+            throw std::invalid_argument("each lower joint limit must not exceed its upper limit");
+        }
+        this->joint_lower_limits = lower;
+        this->joint_upper_limits = upper;
+    }
+
+    /**
+     * @brief Set the mass properties of one link.
+     * @param link Link index; link i moves with joint i.
+     * @param inertia Mass, center of mass and rotational inertia at the home configuration in the space frame.
+     */
+    template <int N>
+    void finger_model<N>::set_link_inertia(int link, const link_inertia& inertia) {
+        if (link < 0 || link >= max_joints) {
+            throw std::invalid_argument("link index is out of range");
+        }
+        if (!(inertia.mass >= 0.0) || !inertia.rotational_inertia.isApprox(inertia.rotational_inertia.transpose())) {
+            throw std::invalid_argument("link mass must be non-negative and the rotational inertia symmetric");
+        }
+        this->link_inertias[link] = inertia;
+    }
+
+    /**
+     * @brief Set the collision capsule of one link.
+     * @param link Link index; link i moves with joint i.
+     * @param geometry Capsule segment at the home configuration in the space frame and its radius.
+     */
+    template <int N>
+    void finger_model<N>::set_link_geometry(int link, const link_geometry& geometry) {
+        if (link < 0 || link >= max_joints) {
+            throw std::invalid_argument("link index is out of range");
+        }
+        if (!(geometry.radius >= 0.0) || !geometry.start.allFinite() || !geometry.end.allFinite()) {
+            throw std::invalid_argument("link capsule must have finite ends and a non-negative radius");
+        }
+        this->link_geometries[link] = geometry;
     }
 
     ////////////////////////////////////////////////////////////
@@ -126,36 +251,168 @@ namespace fm {
     ////////////////////////////////////////////////////////////
 
     /**
-     * @brief Get the finger space Jacobian.
+     * @brief Get the number of joints.
+     * @return Number of joints.
+     */
+    template <int N>
+    int finger_model<N>::get_num_joints() const {
+        return static_cast<int>(joint_angles.size());
+    }
+
+    /**
+     * @brief Get the lower joint limits.
+     * @return Vector of lower limits, -inf for unbounded joints.
+     */
+    template <int N>
+    typename finger_model<N>::joint_vector finger_model<N>::get_joint_lower_limits() const {
+        if (joint_lower_limits.size() != joint_angles.size()) {
+            return joint_vector::Constant(joint_angles.size(), -std::numeric_limits<double>::infinity());
+        }
+        return joint_lower_limits;
+    }
+
+    /**
+     * @brief Get the upper joint limits.
+     * @return Vector of upper limits, +inf for unbounded joints.
+     */
+    template <int N>
+    typename finger_model<N>::joint_vector finger_model<N>::get_joint_upper_limits() const {
+        if (joint_upper_limits.size() != joint_angles.size()) {
+            return joint_vector::Constant(joint_angles.size(), std::numeric_limits<double>::infinity());
+        }
+        return joint_upper_limits;
+    }
+
+    /**
+     * @brief Get the mass properties of one link.
+     * @param link Link index.
+     * @return Link inertia; massless unless set.
+     */
+    template <int N>
+    const link_inertia& finger_model<N>::get_link_inertia(int link) const {
+        if (link < 0 || link >= max_joints) {
+            throw std::invalid_argument("link index is out of range");
+        }
+        return link_inertias[link];
+    }
+
+    /**
+     * @brief Get the collision capsule of one link.
+     * @param link Link index.
+     * @return Link capsule; without geometry (zero radius) unless set.
+     */
+    template <int N>
+    const link_geometry& finger_model<N>::get_link_geometry(int link) const {
+        if (link < 0 || link >= max_joints) {
+            throw std::invalid_argument("link index is out of range");
+        }
+        return link_geometries[link];
+    }
+
+    /**
+     * @brief Get the finger space Jacobian, recomputed only if the joint angles or screw axes changed.
+     * @return Matrix representing the space Jacobian.
+     */
+    template <int N>
+    const typename finger_model<N>::jacobian_matrix& finger_model<N>::get_finger_space_jacobian() {
+        this->update_space();
+        return finger_space_jacobian;
+    }
+
+    /**
+     * @brief Get the cached finger space Jacobian without recomputing it.
      * @return Matrix representing the space Jacobian.
      */
-    Eigen::MatrixXd finger_model::get_finger_space_jacobian() {
-        this->calculate_finger_space_jacobian();   // Update the finger space jacobian before returning it
+    template <int N>
+    const typename finger_model<N>::jacobian_matrix& finger_model<N>::get_finger_space_jacobian() const {
+        this->check_cache(false);
         return finger_space_jacobian;
     }
 
     /**
-     * @brief Get the finger body Jacobian.
+     * @brief Get the finger body Jacobian, recomputed only if the joint angles or screw axes changed.
+     * @return Matrix representing the body Jacobian.
+     */
+    template <int N>
+    const typename finger_model<N>::jacobian_matrix& finger_model<N>::get_finger_body_jacobian() {
+        this->update_body();
+        return finger_body_jacobian;
+    }
+
+    /**
+     * @brief Get the cached finger body Jacobian without recomputing it.
      * @return Matrix representing the body Jacobian.
      */
-    Eigen::MatrixXd finger_model::get_finger_body_jacobian() {
-        this->calculate_finger_body_jacobian();    // Update the finger body jacobian before returning it
+    template <int N>
+    const typename finger_model<N>::jacobian_matrix& finger_model<N>::get_finger_body_jacobian() const {
+        this->check_cache(true);
         return finger_body_jacobian;
     }
 
+    /**
+     * @brief Get the fingertip frame from the space screw axes, T = e^[S1]theta1 ... e^[Sn]thetan M.
+     * @return 4x4 transformation matrix.
+     */
+    template <int N>
+    const Eigen::Matrix4d& finger_model<N>::get_fingertip_pose_space() {
+        this->update_space();
+        return fingertip_pose_space;
+    }
+
+    /**
+     * @brief Get the cached fingertip frame from the space screw axes without recomputing it.
+     * @return 4x4 transformation matrix.
+     */
+    template <int N>
+    const Eigen::Matrix4d& finger_model<N>::get_fingertip_pose_space() const {
+        this->check_cache(false);
+        return fingertip_pose_space;
+    }
+
+    /**
+     * @brief Get the fingertip frame from the body screw axes, T = M e^[B1]theta1 ... e^[Bn]thetan.
+     * @return 4x4 transformation matrix.
+     */
+    template <int N>
+    const Eigen::Matrix4d& finger_model<N>::get_fingertip_pose_body() {
+        this->update_body();
+        return fingertip_pose_body;
+    }
+
+    /**
+     * @brief Get the cached fingertip frame from the body screw axes without recomputing it.
+     * @return 4x4 transformation matrix.
+     */
+    template <int N>
+    const Eigen::Matrix4d& finger_model<N>::get_fingertip_pose_body() const {
+        this->check_cache(true);
+        return fingertip_pose_body;
+    }
+
     /**
      * @brief Get the tendon routing matrix.
      * @return Matrix representing the tendon routing.
      */
-    Eigen::MatrixXd finger_model::get_tendon_routing_matrix() {
+    template <int N>
+    const typename finger_model<N>::routing_matrix& finger_model<N>::get_tendon_routing_matrix() const {
         return tendon_routing_matrix;
     }
 
+    /**
+     * @brief Get the motor shaft matrix.
+     * @return Matrix mapping tendon excursions to motor shaft angles.
+     */
+    template <int N>
+    const typename finger_model<N>::motor_matrix& finger_model<N>::get_motor_shaft_matrix() const {
+        return motor_shaft_matrix;
+    }
+
     /**
      * @brief Get the link lengths.
      * @return Vector of link lengths.
      */
-    Eigen::VectorXd finger_model::get_link_lengths() {
+    template <int N>
+    const typename finger_model<N>::joint_vector& finger_model<N>::get_link_lengths() const {
         return link_lengths;
     }
 
@@ -163,64 +420,441 @@ namespace fm {
      * @brief Get the joint angles.
      * @return Vector of joint angles.
      */
-    Eigen::VectorXd finger_model::get_joint_angles() {
+    template <int N>
+    const typename finger_model<N>::joint_vector& finger_model<N>::get_joint_angles() const {
         return joint_angles;
     }
 
+    /**
+     * @brief Get the home position screw axes in the body frame.
+     * @return 6xN matrix of screw axes.
+     */
+    template <int N>
+    const typename finger_model<N>::screw_matrix& finger_model<N>::get_home_position_screw_axes_body() const {
+        return home_position_screw_axes_body;
+    }
+
+    /**
+     * @brief Get the home position screw axes in the space frame.
+     * @return 6xN matrix of screw axes.
+     */
+    template <int N>
+    const typename finger_model<N>::screw_matrix& finger_model<N>::get_home_position_screw_axes_space() const {
+        return home_position_screw_axes_space;
+    }
+
+    /**
+     * @brief Get the home position in the body frame.
+     * @return 4x4 transformation matrix.
+     */
+    template <int N>
+    const Eigen::Matrix4d& finger_model<N>::get_home_position_body_frame() const {
+        return home_position_body_frame;
+    }
+
     ////////////////////////////////////////////////////////////
     // Member functions
     ////////////////////////////////////////////////////////////
 
     /**
-     * @brief Calculate the space Jacobian.
+     * @brief Recompute every stale cached pose and Jacobian of the chains whose screw axes are set.
+     *
+     * Afterwards the const getters can be called from several threads until the model changes again.
+     */
+    template <int N>
+    void finger_model<N>::update() {
+        if (this->has_screw_axes_space) {
+            this->update_space();
+        }
+        if (this->has_screw_axes_body) {
+            this->update_body();
+        }
+    }
+
+    /**
+     * @brief Calculate the space Jacobian into the cached matrix.
      */
-    void finger_model::calculate_finger_space_jacobian() {
-        // Calculate Space Jacobian
+    template <int N>
+    void finger_model<N>::calculate_finger_space_jacobian() {
+        this->update_space();
     }
 
     /**
-     * @brief Calculate the body Jacobian.
+     * @brief Calculate the body Jacobian into the cached matrix.
      */
-    void finger_model::calculate_finger_body_jacobian() {
-        // Calculate Body Jacobian
+    template <int N>
+    void finger_model<N>::calculate_finger_body_jacobian() {
+        this->update_body();
     }
 
     /**
      * @brief Calculate the forward kinematics in the body frame.
      * @return Vector representing the logarithm of the transformation matrix.
      */
-    Eigen::VectorXd finger_model::forward_kinematics_body() {
-        // Calculate forward kinematics
-        Eigen::MatrixXd T = open_chain_kinematics::FKin_Body(this->home_position_body_frame, this->home_position_screw_axes_body, this->joint_angles);
-        return rigid_body_motion::Matrix_Logarithm(T);
+    template <int N>
+    Eigen::VectorXd finger_model<N>::forward_kinematics_body() const {
+        return rigid_body_motion::Screw_Logarithm(this->dirty & dirty_body ? this->pose_body(this->joint_angles) : this->fingertip_pose_body);
     }
 
     /**
      * @brief Calculate the forward kinematics in the space frame.
      * @return Vector representing the logarithm of the transformation matrix.
      */
-    Eigen::VectorXd finger_model::forward_kinematics_space() {
-        // Calculate forward kinematics
-        Eigen::MatrixXd T = open_chain_kinematics::FKin_Space(this->home_position_body_frame, this->home_position_screw_axes_space, this->joint_angles);
-        return rigid_body_motion::Matrix_Logarithm(T);
+    template <int N>
+    Eigen::VectorXd finger_model<N>::forward_kinematics_space() const {
+        return rigid_body_motion::Screw_Logarithm(this->dirty & dirty_space ? this->pose_space(this->joint_angles) : this->fingertip_pose_space);
     }
 
     /**
-     * @brief Calculate the inverse kinematics in the body frame.
+     * @brief Calculate the inverse kinematics with the body twist error.
+     *
+     * Damped least squares Newton iterations theta += (J_b^T J_b + lambda I)^-1 J_b^T V_b, with
+     * [V_b] = log(T(theta)^-1 T_d), starting from the current joint angles. Poses a finger with fewer
+     * than six joints cannot reach are solved in the least squares sense.
+     *
      * @param desired_pose Desired end-effector configuration.
      * @return Vector of joint angles.
      */
-    Eigen::VectorXd finger_model::inverse_kinematics_body(const Eigen::MatrixXd& desired_pose) {
-        return open_chain_kinematics::IKin_Body(this->home_position_body_frame, this->home_position_screw_axes_body, desired_pose);
+    template <int N>
+    typename finger_model<N>::joint_vector finger_model<N>::inverse_kinematics_body(const Eigen::Matrix4d& desired_pose) const {
+        this->check_chain(true);
+        const int n = this->get_num_joints();
+        joint_vector theta = this->joint_angles;
+        jacobian_matrix J(6, n);
+        for (int iter = 0; iter < ik_max_iterations; iter++) {
+            Eigen::Matrix<double, 6, 1> V = rigid_body_motion::Screw_Logarithm(rigid_body_motion::Transform_Inverse(this->pose_body(theta)) * desired_pose);
+            this->body_jacobian(theta, J);
+            joint_vector step = (J.transpose() * J + ik_damping * Eigen::Matrix<double, N, N, 0, max_joints, max_joints>::Identity(n, n)).ldlt().solve(J.transpose() * V);
+            theta += step;
+            if (step.norm() < ik_tolerance) {
+                break;
+            }
+        }
+        return theta;
     }
 
     /**
-     * @brief Calculate the inverse kinematics in the space frame.
+     * @brief Calculate the inverse kinematics with the space twist error.
+     *
+     * Same iteration as inverse_kinematics_body with V_s = Ad_T V_b and the space Jacobian.
+     *
      * @param desired_pose Desired end-effector configuration.
      * @return Vector of joint angles.
      */
-    Eigen::VectorXd finger_model::inverse_kinematics_space(const Eigen::MatrixXd& desired_pose) {
-        return open_chain_kinematics::IKin_Space(this->home_position_body_frame, this->home_position_screw_axes_space, desired_pose);
+    template <int N>
+    typename finger_model<N>::joint_vector finger_model<N>::inverse_kinematics_space(const Eigen::Matrix4d& desired_pose) const {
+        this->check_chain(false);
+        const int n = this->get_num_joints();
+        joint_vector theta = this->joint_angles;
+        jacobian_matrix J(6, n);
+        for (int iter = 0; iter < ik_max_iterations; iter++) {
+            Eigen::Matrix4d T = this->pose_space(theta);
+            Eigen::Matrix<double, 6, 1> V = rigid_body_motion::Adjoint_Twist(T, rigid_body_motion::Screw_Logarithm(rigid_body_motion::Transform_Inverse(T) * desired_pose));
+            this->space_jacobian(theta, J);
+            joint_vector step = (J.transpose() * J + ik_damping * Eigen::Matrix<double, N, N, 0, max_joints, max_joints>::Identity(n, n)).ldlt().solve(J.transpose() * V);
+            theta += step;
+            if (step.norm() < ik_tolerance) {
+                break;
+            }
+        }
+        return theta;
+    }
+
+    /**
+     * @brief Calculate the joint angles that place the fingertip at a point, ignoring orientation.
+     *
+     * Damped least squares on the fingertip position error with the point Jacobian v_i + w_i x p,
+     * starting from the current joint angles.
+     *
+     * @param desired_position Desired fingertip position in the space frame.
+     * @return Vector of joint angles.
+     */
+    template <int N>
+    typename finger_model<N>::joint_vector finger_model<N>::inverse_kinematics_position(const Eigen::Vector3d& desired_position) const {
+        this->check_chain(false);
+        const int n = this->get_num_joints();
+        joint_vector theta = this->joint_angles;
+        jacobian_matrix J(6, n);
+        Eigen::Matrix<double, 3, N, 0, 3, max_joints> J_p(3, n);
+        for (int iter = 0; iter < ik_max_iterations; iter++) {
+            Eigen::Vector3d p = this->pose_space(theta).template block<3, 1>(0, 3);
+            this->space_jacobian(theta, J);
+            for (int i = 0; i < n; i++) {
+                J_p.col(i) = J.template block<3, 1>(3, i) + J.template block<3, 1>(0, i).cross(p);
+            }
+            joint_vector step = (J_p.transpose() * J_p + ik_damping * Eigen::Matrix<double, N, N, 0, max_joints, max_joints>::Identity(n, n)).ldlt().solve(J_p.transpose() * (desired_position - p));
+            theta += step;
+            if (step.norm() < ik_tolerance) {
+                break;
+            }
+        }
+        return theta;
+    }
+
+    /**
+     * @brief Calculate the fingertip position in the space frame, from the cache when it is current.
+     * @return Position of the end-effector frame origin.
+     */
+    template <int N>
+    Eigen::Vector3d finger_model<N>::fingertip_position_space() const {
+        if (this->dirty & dirty_space) {
+            return this->pose_space(this->joint_angles).template block<3, 1>(0, 3);
+        }
+        return this->fingertip_pose_space.template block<3, 1>(0, 3);
+    }
+
+    /**
+     * @brief Calculate the joint stiffness contributed by a constant force at the fingertip.
+     * @param fingertip_force Force applied at the fingertip, in the space frame.
+     * @return Hessian of the force's work with respect to the joint angles.
+     */
+    template <int N>
+    typename finger_model<N>::joint_matrix finger_model<N>::fingertip_force_hessian(const Eigen::Vector3d& fingertip_force) const {
+        joint_matrix hessian;
+        this->fingertip_force_hessian(this->joint_angles, fingertip_force, hessian);
+        return hessian;
+    }
+
+    /**
+     * @brief Fingertip frame from the space screw axes at arbitrary joint angles.
+     *
+     * The loop runs over the compile-time joint count with 4x4 fixed-size transforms, so the compiler
+     * unrolls it for fixed N.
+     *
+     * @param joint_angles Joint angles.
+     * @return 4x4 transformation matrix.
+     */
+    template <int N>
+    Eigen::Matrix4d finger_model<N>::pose_space(const joint_vector& joint_angles) const {
+        this->check_chain(false);
+        Eigen::Matrix4d T = Eigen::Matrix4d::Identity();
+        for (int i = 0; i < joint_angles.size(); i++) {
+            T = T * rigid_body_motion::Screw_Exponential(this->home_position_screw_axes_space.col(i), joint_angles(i));
+        }
+        return T * this->home_position_body_frame;
+    }
+
+    /**
+     * @brief Fingertip frame from the body screw axes at arbitrary joint angles.
+     * @param joint_angles Joint angles.
+     * @return 4x4 transformation matrix.
+     */
+    template <int N>
+    Eigen::Matrix4d finger_model<N>::pose_body(const joint_vector& joint_angles) const {
+        this->check_chain(true);
+        Eigen::Matrix4d T = this->home_position_body_frame;
+        for (int i = 0; i < joint_angles.size(); i++) {
+            T = T * rigid_body_motion::Screw_Exponential(this->home_position_screw_axes_body.col(i), joint_angles(i));
+        }
+        return T;
+    }
+
+    /**
+     * @brief Space Jacobian at arbitrary joint angles.
+     *
+     * Column i is Ad_{e^[S1]theta1 ... e^[S(i-1)]theta(i-1)} S_i. The fingertip frame falls out of the
+     * same product of exponentials.
+     *
+     * @param joint_angles Joint angles.
+     * @param jacobian Output 6xN Jacobian.
+     * @param pose Optional output fingertip frame.
+     */
+    template <int N>
+    void finger_model<N>::space_jacobian(const joint_vector& joint_angles, jacobian_matrix& jacobian, Eigen::Matrix4d* pose) const {
+        this->check_chain(false);
+        const int n = static_cast<int>(joint_angles.size());
+        jacobian.resize(6, n);
+        Eigen::Matrix4d T = Eigen::Matrix4d::Identity();
+        for (int i = 0; i < n; i++) {
+            jacobian.col(i) = rigid_body_motion::Adjoint_Twist(T, this->home_position_screw_axes_space.col(i));
+            T = T * rigid_body_motion::Screw_Exponential(this->home_position_screw_axes_space.col(i), joint_angles(i));
+        }
+        if (pose != nullptr) {
+            *pose = T * this->home_position_body_frame;
+        }
+    }
+
+    /**
+     * @brief Body Jacobian at arbitrary joint angles.
+     *
+     * Column i is Ad_{e^-[Bn]thetan ... e^-[B(i+1)]theta(i+1)} B_i.
+     *
+     * @param joint_angles Joint angles.
+     * @param jacobian Output 6xN Jacobian.
+     */
+    template <int N>
+    void finger_model<N>::body_jacobian(const joint_vector& joint_angles, jacobian_matrix& jacobian) const {
+        this->check_chain(true);
+        const int n = static_cast<int>(joint_angles.size());
+        jacobian.resize(6, n);
+        Eigen::Matrix4d T = Eigen::Matrix4d::Identity();
+        for (int i = n - 1; i >= 0; i--) {
+            if (i < n - 1) {
+                T = T * rigid_body_motion::Screw_Exponential(this->home_position_screw_axes_body.col(i + 1), -joint_angles(i + 1));
+            }
+            jacobian.col(i) = rigid_body_motion::Adjoint_Twist(T, this->home_position_screw_axes_body.col(i));
+        }
+    }
+
+    /**
+     * @brief Displacement of every link from its home configuration at arbitrary joint angles.
+     *
+     * Link i moves with joints 1 to i, so its frame is e^[S1]theta1 ... e^[Si]thetai; a point p of the link
+     * at home is at frames[i] p.
+     *
+     * @param joint_angles Joint angles.
+     * @param frames Output transforms, one per joint.
+     */
+    template <int N>
+    void finger_model<N>::link_frames_space(const joint_vector& joint_angles, link_frames& frames) const {
+        this->check_chain(false);
+        Eigen::Matrix4d T = Eigen::Matrix4d::Identity();
+        for (int i = 0; i < joint_angles.size(); i++) {
+            T = T * rigid_body_motion::Screw_Exponential(this->home_position_screw_axes_space.col(i), joint_angles(i));
+            frames[i] = T;
+        }
+    }
+
+    /**
+     * @brief Hessian of the work f . p(theta) of a constant fingertip force at arbitrary joint angles.
+     *
+     * H_ij = f . d(v_i + w_i x p)/dtheta_j for the space Jacobian columns (w_i, v_i) and fingertip p, as in
+     * open_chain_kinematics::Position_Hessian_Space but on fixed-size storage.
+     *
+     * @param joint_angles Joint angles.
+     * @param fingertip_force Force applied at the fingertip, in the space frame.
+     * @param hessian Output NxN Hessian.
+     */
+    template <int N>
+    void finger_model<N>::fingertip_force_hessian(const joint_vector& joint_angles, const Eigen::Vector3d& fingertip_force, joint_matrix& hessian) const {
+        const int n = static_cast<int>(joint_angles.size());
+        jacobian_matrix J;
+        Eigen::Matrix4d T;
+        this->space_jacobian(joint_angles, J, &T);
+        const Eigen::Vector3d p = T.template block<3, 1>(0, 3);
+
+        hessian.resize(n, n);
+        for (int i = 0; i < n; i++) {
+            const Eigen::Vector3d w_i = J.template block<3, 1>(0, i), v_i = J.template block<3, 1>(3, i);
+            for (int j = 0; j <= i; j++) {
+                const Eigen::Vector3d w_j = J.template block<3, 1>(0, j), v_j = J.template block<3, 1>(3, j);
+
+                // d(v_i + w_i x p)/dtheta_j, with the ad term only present for earlier joints
+                Eigen::Vector3d d = w_i.cross(v_j + w_j.cross(p));
+                if (j < i) {
+                    d += w_j.cross(v_i) + v_j.cross(w_i) + w_j.cross(w_i).cross(p);
+                }
+                hessian(i, j) = fingertip_force.dot(d);
+                hessian(j, i) = hessian(i, j);
+            }
+        }
+    }
+
+    ////////////////////////////////////////////////////////////
+    // Private functions
+    ////////////////////////////////////////////////////////////
+
+    /**
+     * @brief Check that the screw axes have been set for the current joint count.
+     * @param body True for the body screw axes, false for the space screw axes.
+     */
+    template <int N>
+    void finger_model<N>::check_chain(bool body) const {
+        const screw_matrix& axes = body ? this->home_position_screw_axes_body : this->home_position_screw_axes_space;
+        if (!(body ? this->has_screw_axes_body : this->has_screw_axes_space)) {
+            throw std::runtime_error("screw axes have not been set");
+        }
+        if (axes.cols() != this->joint_angles.size()) {
+            throw std::runtime_error("the number of screw axes does not match the number of joint angles");
+        }
+    }
+
+    /**
+     * @brief Check a joint count against N, or against 1..max_finger_joints for a dynamic finger.
+     * @param size Number of elements supplied.
+     * @param message Error message.
+     */
+    template <int N>
+    void finger_model<N>::check_joint_count(Eigen::Index size, const char* message) const {
+        if (N == Eigen::Dynamic ? (size < 1 || size > max_finger_joints) : size != N) {
+            throw std::invalid_argument(message);
+        }
+    }
+
+    /**
+     * @brief Check that the cached pose and Jacobian of a chain are current.
+     * @param body True for the body chain, false for the space chain.
+     */
+    template <int N>
+    void finger_model<N>::check_cache(bool body) const {
+        this->check_chain(body);
+        if (this->dirty & (body ? dirty_body : dirty_space)) {
+            throw std::runtime_error("cached kinematics are stale; call update() after changing the model");
+        }
+    }
+
+    /**
+     * @brief Refresh the space frame pose and Jacobian if they are stale, in one product of exponentials.
+     */
+    template <int N>
+    void finger_model<N>::update_space() {
+        if (this->dirty & dirty_space) {
+            this->space_jacobian(this->joint_angles, this->finger_space_jacobian, &this->fingertip_pose_space);
+            this->dirty &= ~static_cast<unsigned int>(dirty_space);
+        }
+    }
+
+    /**
+     * @brief Refresh the body frame pose and Jacobian if they are stale.
+     */
+    template <int N>
+    void finger_model<N>::update_body() {
+        if (this->dirty & dirty_body) {
+            this->fingertip_pose_body = this->pose_body(this->joint_angles);
+            this->body_jacobian(this->joint_angles, this->finger_body_jacobian);
+            this->dirty &= ~static_cast<unsigned int>(dirty_body);
+        }
+    }
+
+    // Supported joint counts
+    template class finger_model<Eigen::Dynamic>;
+    template class finger_model<1>;
+    template class finger_model<2>;
+    template class finger_model<3>;
+    template class finger_model<4>;
+    template class finger_model<5>;
+
+    /**
+     * @brief Link vectors of a finger at its home configuration.
+     *
+     * For revolute axes (w_i, q_i) and (w_j, q_j) the link vector is the projection of q_j - q_i on the
+     * common normal w_i x w_j; axes within about 6 degrees of parallel, and the last link, use the part
+     * of the offset perpendicular to w_i instead, since their common normal is ill-conditioned.
+     *
+     * @param finger Finger model with space screw axes and home frame set.
+     * @return 3xn matrix of link vectors in the space frame.
+     */
+    Eigen::Matrix3Xd home_link_vectors(const finger_model<>& finger) {
+        const int n = finger.get_num_joints();
+        const auto& S = finger.get_home_position_screw_axes_space();
+        auto revolute = [&S](int i) { return S.block<3, 1>(0, i).norm() > 0.5; };
+        auto axis_point = [&S](int i) -> Eigen::Vector3d { return S.block<3, 1>(0, i).cross(S.block<3, 1>(3, i)); };
+
+        Eigen::Matrix3Xd links = Eigen::Matrix3Xd::Zero(3, n);
+        for (int i = 0; i < n; i++) {
+            if (!revolute(i)) {
+                continue;
+            }
+            const Eigen::Vector3d w = S.block<3, 1>(0, i);
+            int next = i + 1;
+            while (next < n && !revolute(next)) {
+                next++;
+            }
+            Eigen::Vector3d d = (next < n ? axis_point(next) : Eigen::Vector3d(finger.get_home_position_body_frame().block<3, 1>(0, 3))) - axis_point(i);
+            Eigen::Vector3d normal = next < n ? Eigen::Vector3d(w.cross(S.block<3, 1>(0, next))) : Eigen::Vector3d::Zero();
+            links.col(i) = normal.norm() > 0.1 ? Eigen::Vector3d(d.dot(normal) / normal.squaredNorm() * normal) : Eigen::Vector3d(d - d.dot(w) * w);
+        }
+        return links;
     }
 
-}
\ No newline at end of file
+}
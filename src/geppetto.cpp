@@ -0,0 +1,465 @@
+#include "include/geppetto.hpp"
+#include <Eigen/Dense>
+#include <array>
+#include <charconv>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace fm {
+
+    namespace geppetto {
+
+        namespace {
+
+            bool is_word_start(char c) {
+                return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_';
+            }
+
+            bool is_word_char(char c) {
+                return is_word_start(c) || (c >= '0' && c <= '9');
+            }
+
+            bool is_number_char(char c) {
+                return (c >= '0' && c <= '9') || c == '.' || c == 'e' || c == 'E' || c == '+' || c == '-';
+            }
+
+            [[noreturn]] void fail(std::uint32_t line, const std::string& message) {
+                throw std::invalid_argument("line " + std::to_string(line) + ": " + message);
+            }
+
+        }
+
+        ////////////////////////////////////////////////////////////
+        // Lexer
+        ////////////////////////////////////////////////////////////
+
+        /**
+         * @brief Constructor for the lexer class.
+         * @param text Script text; it must outlive the lexer and the tokens.
+         */
+        lexer::lexer(std::string_view text)
+            : text(text), position(0), line(1)
+        {
+        }
+
+        /**
+         * @brief Read the next token. Blank space and comments are skipped; every line break is a token.
+         * @return Token, of kind end once the text is exhausted.
+         */
+        token lexer::next() {
+            const std::size_t size = this->text.size();
+            while (this->position < size) {
+                const char c = this->text[this->position];
+                if (c == ' ' || c == '\t' || c == '\r') {
+                    this->position++;
+                } else if (c == '#') {
+                    while (this->position < size && this->text[this->position] != '\n') {
+                        this->position++;
+                    }
+                } else {
+                    break;
+                }
+            }
+
+            token result;
+            result.line = this->line;
+            if (this->position == size) {
+                return result;
+            }
+            const std::size_t begin = this->position;
+            const char c = this->text[begin];
+            if (c == '\n') {
+                this->position++;
+                this->line++;
+                result.kind = token_kind::newline;
+                result.text = this->text.substr(begin, 1);
+                return result;
+            }
+            if (is_word_start(c)) {
+                while (this->position < size && is_word_char(this->text[this->position])) {
+                    this->position++;
+                }
+                result.kind = token_kind::word;
+                result.text = this->text.substr(begin, this->position - begin);
+                return result;
+            }
+            if (is_number_char(c)) {
+                while (this->position < size && is_number_char(this->text[this->position])) {
+                    this->position++;
+                }
+                result.kind = token_kind::number;
+                result.text = this->text.substr(begin, this->position - begin);
+                // from_chars takes no leading plus sign
+                const char* first = result.text.data() + (c == '+' ? 1 : 0);
+                const char* last = result.text.data() + result.text.size();
+                auto [end, error] = std::from_chars(first, last, result.value);
+                if (error != std::errc() || end != last || !std::isfinite(result.value)) {
+                    fail(this->line, "invalid number '" + std::string(result.text) + "'");
+                }
+                return result;
+            }
+            fail(this->line, "unexpected character '" + std::string(1, c) + "'");
+        }
+
+        ////////////////////////////////////////////////////////////
+        // Script files
+        ////////////////////////////////////////////////////////////
+
+        /**
+         * @brief Map a script file.
+         * @param path Script file path.
+         */
+        script_file::script_file(const std::string& path)
+            : data(nullptr), size(0)
+        {
+            int fd = ::open(path.c_str(), O_RDONLY);
+            if (fd < 0) {
+                throw std::runtime_error("could not open " + path + " for reading");
+            }
+            struct stat info;
+            if (::fstat(fd, &info) != 0) {
+                ::close(fd);
+                throw std::runtime_error("could not read " + path);
+            }
+            if (info.st_size > 0) {
+                void* mapping = ::mmap(nullptr, static_cast<std::size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+                if (mapping == MAP_FAILED) {
+                    ::close(fd);
+                    throw std::runtime_error("could not map " + path);
+                }
+                // Scripts are read front to back once
+                ::madvise(mapping, static_cast<std::size_t>(info.st_size), MADV_SEQUENTIAL);
+                this->data = static_cast<const char*>(mapping);
+                this->size = static_cast<std::size_t>(info.st_size);
+            }
+            ::close(fd);
+        }
+
+        /**
+         * @brief Unmap the script.
+         */
+        script_file::~script_file()
+        {
+            if (this->data != nullptr) {
+                ::munmap(const_cast<char*>(this->data), this->size);
+            }
+        }
+
+        /**
+         * @brief Get the script text, valid while this object lives.
+         * @return View of the mapped file.
+         */
+        std::string_view script_file::get_text() const {
+            return std::string_view(this->data, this->size);
+        }
+
+        ////////////////////////////////////////////////////////////
+        // Compiler
+        ////////////////////////////////////////////////////////////
+
+        /**
+         * @brief Compile a script to bytecode.
+         *
+         * Every command becomes one fixed width instruction; its numbers go to the constant pool, so
+         * running the program never touches the text again.
+         *
+         * @param text Script text.
+         * @param num_joints Number of joints of the finger the script is for.
+         * @return Program.
+         */
+        program compile(std::string_view text, int num_joints) {
+            if (num_joints < 1 || num_joints > max_finger_joints) {
+                throw std::invalid_argument("num_joints must be between 1 and max_finger_joints");
+            }
+            program result;
+            result.num_joints = num_joints;
+            result.code.reserve(text.size() / 16);
+            result.constants.reserve(text.size() / 8);
+            result.lines.reserve(text.size() / 16);
+
+            lexer tokens(text);
+            std::vector<std::uint32_t> open_loops;
+            std::array<double, max_finger_joints> operands;
+            token current = tokens.next();
+            while (current.kind != token_kind::end) {
+                if (current.kind == token_kind::newline) {
+                    current = tokens.next();
+                    continue;
+                }
+                if (current.kind != token_kind::word) {
+                    fail(current.line, "expected a command, found '" + std::string(current.text) + "'");
+                }
+                const std::string_view command = current.text;
+                const std::uint32_t line = current.line;
+                std::size_t count = 0;
+                current = tokens.next();
+                while (current.kind == token_kind::number) {
+                    if (count == operands.size()) {
+                        fail(line, "too many numbers for '" + std::string(command) + "'");
+                    }
+                    operands[count++] = current.value;
+                    current = tokens.next();
+                }
+                if (current.kind == token_kind::word) {
+                    fail(line, "unexpected '" + std::string(current.text) + "' after '" + std::string(command) + "'");
+                }
+
+                auto expect = [&](std::size_t expected) {
+                    if (count != expected) {
+                        fail(line, "'" + std::string(command) + "' takes " + std::to_string(expected) + " numbers, found " + std::to_string(count));
+                    }
+                };
+                auto add = [&](opcode op, std::size_t constants, std::uint16_t joint = 0) {
+                    result.code.push_back({op, 0, joint, static_cast<std::uint32_t>(result.constants.size())});
+                    result.constants.insert(result.constants.end(), operands.begin(), operands.begin() + constants);
+                    result.lines.push_back(line);
+                };
+
+                if (command == "joints") {
+                    expect(static_cast<std::size_t>(num_joints));
+                    add(opcode::joints, count);
+                } else if (command == "joint") {
+                    expect(2);
+                    if (operands[0] != std::floor(operands[0]) || operands[0] < 0 || operands[0] >= num_joints) {
+                        fail(line, "joint index must be an integer from 0 to " + std::to_string(num_joints - 1));
+                    }
+                    const std::uint16_t joint = static_cast<std::uint16_t>(operands[0]);
+                    operands[0] = operands[1];
+                    add(opcode::joint, 1, joint);
+                } else if (command == "tip") {
+                    expect(3);
+                    add(opcode::tip, 3);
+                } else if (command == "home") {
+                    expect(0);
+                    add(opcode::home, 0);
+                } else if (command == "duration" || command == "wait") {
+                    expect(1);
+                    if (operands[0] < 0.0) {
+                        fail(line, "'" + std::string(command) + "' takes a non-negative time");
+                    }
+                    add(command == "wait" ? opcode::wait : opcode::duration, 1);
+                } else if (command == "repeat") {
+                    expect(1);
+                    if (operands[0] != std::floor(operands[0]) || operands[0] < 1 || operands[0] > std::numeric_limits<std::uint32_t>::max()) {
+                        fail(line, "repeat count must be a positive integer");
+                    }
+                    open_loops.push_back(static_cast<std::uint32_t>(result.code.size()));
+                    result.code.push_back({opcode::repeat, 0, 0, static_cast<std::uint32_t>(operands[0])});
+                    result.lines.push_back(line);
+                } else if (command == "end") {
+                    expect(0);
+                    if (open_loops.empty()) {
+                        fail(line, "'end' without 'repeat'");
+                    }
+                    result.code.push_back({opcode::end_repeat, 0, 0, open_loops.back() + 1});
+                    result.lines.push_back(line);
+                    open_loops.pop_back();
+                } else {
+                    fail(line, "unknown command '" + std::string(command) + "'");
+                }
+            }
+            if (!open_loops.empty()) {
+                fail(result.lines[open_loops.back()], "'repeat' without 'end'");
+            }
+            return result;
+        }
+
+        /**
+         * @brief Compile a script file, tokenizing the mapped file in place.
+         * @param path Script file path.
+         * @param num_joints Number of joints of the finger the script is for.
+         * @return Program.
+         */
+        program compile_file(const std::string& path, int num_joints) {
+            script_file file(path);
+            try {
+                return compile(file.get_text(), num_joints);
+            } catch (const std::invalid_argument& error) {
+                throw std::invalid_argument(path + " " + error.what());
+            }
+        }
+
+        /**
+         * @brief Check a program before it runs: every constant read lies in the pool, joint indices are
+         * in range, and each 'end' jumps back past its own 'repeat' with every loop closed.
+         * @param code Program.
+         * @param num_joints Number of joints of the finger it is to run on.
+         */
+        void validate(const program& code, int num_joints) {
+            if (code.num_joints != num_joints) {
+                throw std::invalid_argument("program was compiled for a different number of joints");
+            }
+            if (code.lines.size() != code.code.size()) {
+                throw std::invalid_argument("program has no line for every instruction");
+            }
+            std::vector<std::size_t> open_loops;
+            for (std::size_t pc = 0; pc < code.code.size(); pc++) {
+                const instruction& in = code.code[pc];
+                const std::size_t width = in.op == opcode::joints ? num_joints : in.op == opcode::tip ? 3 : in.op == opcode::home ? 0 : 1;
+                bool valid = true;
+                if (in.op == opcode::repeat) {
+                    valid = in.operand > 0;
+                    open_loops.push_back(pc);
+                } else if (in.op == opcode::end_repeat) {
+                    valid = !open_loops.empty() && in.operand == open_loops.back() + 1;
+                    if (!open_loops.empty()) {
+                        open_loops.pop_back();
+                    }
+                } else {
+                    valid = static_cast<std::size_t>(in.operand) + width <= code.constants.size() && (in.op != opcode::joint || in.joint < num_joints);
+                }
+                if (!valid) {
+                    throw std::invalid_argument("program instruction " + std::to_string(pc) + " is malformed");
+                }
+            }
+            if (!open_loops.empty()) {
+                throw std::invalid_argument("program instruction " + std::to_string(open_loops.back()) + " is malformed");
+            }
+        }
+
+        ////////////////////////////////////////////////////////////
+        // Virtual machine
+        ////////////////////////////////////////////////////////////
+
+        /**
+         * @brief Move a finger to the target of a joints, joint, tip or home instruction.
+         *
+         * The target must lie within the joint limits, and the inverse kinematics of a 'tip' target must
+         * end within the tip tolerance of it; otherwise the move fails with the script line.
+         *
+         * @param finger Finger model; holds the new joint angles on return.
+         * @param op Move opcode.
+         * @param joint Joint index of a 'joint' move.
+         * @param values Operands of the move.
+         * @param tip_tolerance Reach tolerance of a 'tip' move.
+         * @param line Script line, for errors.
+         */
+        void move(finger_model<>& finger, opcode op, std::uint16_t joint, const double* values, double tip_tolerance, std::uint32_t line) {
+            const int n = finger.get_num_joints();
+            finger_model<>::joint_vector target;
+            if (op == opcode::joints) {
+                target = Eigen::Map<const Eigen::VectorXd>(values, n);
+            } else if (op == opcode::joint) {
+                target = finger.get_joint_angles();
+                target(joint) = values[0];
+            } else if (op == opcode::home) {
+                target.setZero(n);
+            } else {
+                target = finger.inverse_kinematics_position(Eigen::Vector3d(values[0], values[1], values[2]));
+            }
+            if ((target.array() < finger.get_joint_lower_limits().array()).any() || (target.array() > finger.get_joint_upper_limits().array()).any()) {
+                throw std::runtime_error("line " + std::to_string(line) + ": joint target is outside the joint limits");
+            }
+            finger.set_joint_angles(target);
+            if (op == opcode::tip && (finger.fingertip_position_space() - Eigen::Vector3d(values[0], values[1], values[2])).norm() > tip_tolerance) {
+                throw std::runtime_error("line " + std::to_string(line) + ": fingertip target is out of reach");
+            }
+        }
+
+        /**
+         * @brief Constructor for the virtual_machine class.
+         * @param finger Finger model the commands act on; it must outlive the machine.
+         */
+        virtual_machine::virtual_machine(finger_model<>& finger)
+            : finger(finger), tip_tolerance(1e-4), time(0.0), num_waypoints(0)
+        {
+        }
+
+        /**
+         * @brief Set how far from a 'tip' target the inverse kinematics may end before the target counts
+         * as unreachable.
+         * @param tolerance Positive distance.
+         */
+        void virtual_machine::set_tip_tolerance(double tolerance) {
+            if (!(tolerance > 0.0)) {
+                throw std::invalid_argument("tip tolerance must be positive");
+            }
+            this->tip_tolerance = tolerance;
+        }
+
+        /**
+         * @brief Get the script time reached by the last run.
+         */
+        double virtual_machine::get_time() const {
+            return this->time;
+        }
+
+        /**
+         * @brief Get the number of waypoints the last run produced.
+         */
+        long virtual_machine::get_num_waypoints() const {
+            return this->num_waypoints;
+        }
+
+        /**
+         * @brief Run a program from the finger's current joint angles.
+         *
+         * Moves update the finger's joint angles and take the current duration (one second until a
+         * 'duration' command); each move and wait produces a waypoint. Targets outside the joint limits
+         * and unreachable tip targets stop the run with the script line.
+         *
+         * @param code Compiled program.
+         * @param sink Receives every waypoint.
+         * @return Script time at the end.
+         */
+        double virtual_machine::run(const program& code, const waypoint_sink& sink) {
+            const int n = this->finger.get_num_joints();
+            validate(code, n);
+
+            double duration = 1.0;
+            this->time = 0.0;
+            this->num_waypoints = 1;
+            sink(this->time, this->finger.get_joint_angles());
+
+            auto emit = [&]() {
+                this->num_waypoints++;
+                sink(this->time, this->finger.get_joint_angles());
+            };
+
+            // Remaining passes of the enclosing loops, innermost last
+            std::vector<std::uint32_t> loops;
+            const double* constants = code.constants.data();
+            for (std::size_t pc = 0; pc < code.code.size(); pc++) {
+                const instruction& in = code.code[pc];
+                const double* value = constants + in.operand;
+                switch (in.op) {
+                case opcode::joints:
+                case opcode::joint:
+                case opcode::tip:
+                case opcode::home:
+                    move(this->finger, in.op, in.joint, value, this->tip_tolerance, code.lines[pc]);
+                    this->time += duration;
+                    emit();
+                    break;
+                case opcode::duration:
+                    duration = value[0];
+                    break;
+                case opcode::wait:
+                    this->time += value[0];
+                    emit();
+                    break;
+                case opcode::repeat:
+                    loops.push_back(in.operand);
+                    break;
+                case opcode::end_repeat:
+                    if (--loops.back() > 0) {
+                        pc = in.operand - 1;
+                    } else {
+                        loops.pop_back();
+                    }
+                    break;
+                }
+            }
+            return this->time;
+        }
+
+    }
+
+}
@@ -0,0 +1,331 @@
+#include "include/hand_model.hpp"
+#include "include/lane_kinematics.hpp"
+#include "include/open_chain_kinematics.hpp"
+#include <Eigen/Dense>
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+namespace fm {
+
+    /**
+     * @brief Default constructor for the hand_model class; fingers are added with add_finger.
+     */
+    hand_model::hand_model()
+        : screw_axes(decltype(screw_axes)::Zero()),
+          home_frames(decltype(home_frames)::Zero()),
+          joint_angles(decltype(joint_angles)::Zero()),
+          num_fingers(0),
+          num_joints{0, 0, 0, 0, 0},
+          max_joints(0),
+          space_jacobians(decltype(space_jacobians)::Zero()),
+          fingertip_poses(decltype(fingertip_poses)::Zero()),
+          dirty(true)
+    {
+        // Unused lanes keep an identity home frame so their results stay finite
+        for (int r = 0; r < 3; r++) {
+            this->home_frames.col(4 * r) = 1.0;
+        }
+    }
+
+    ////////////////////////////////////////////////////////////
+    // Setter functions
+    ////////////////////////////////////////////////////////////
+
+    /**
+     * @brief Add a finger mounted on the palm.
+     *
+     * The finger's space screw axes and home frame are moved into the palm frame once, S_palm =
+     * Ad_{T_pb} S and M_palm = T_pb M, so the per-tick update works in the palm frame directly.
+     *
+     * @param finger Finger model with space screw axes and home frame set; its joint angles are copied.
+     * @param palm_to_base Pose of the finger's base (space) frame in the palm frame.
+     * @return Finger index.
+     */
+    int hand_model::add_finger(const finger_model<>& finger, const Eigen::Matrix4d& palm_to_base) {
+        if (this->num_fingers >= max_hand_fingers) {
+            throw std::invalid_argument("a hand_model holds at most max_hand_fingers fingers");
+        }
+        const int f = this->num_fingers;
+        const int n = finger.get_num_joints();
+
+        // Validates that the screw axes are set
+        finger.pose_space(finger.get_joint_angles());
+
+        const auto& S_list = finger.get_home_position_screw_axes_space();
+        for (int j = 0; j < n; j++) {
+            Eigen::Matrix<double, 6, 1> S = rigid_body_motion::Adjoint_Twist(palm_to_base, S_list.col(j));
+            for (int c = 0; c < 6; c++) {
+                this->screw_axes(f, 6 * j + c) = S(c);
+            }
+            this->joint_angles(f, j) = finger.get_joint_angles()(j);
+        }
+
+        Eigen::Matrix4d M = palm_to_base * finger.get_home_position_body_frame();
+        for (int r = 0; r < 3; r++) {
+            for (int c = 0; c < 3; c++) {
+                this->home_frames(f, 3 * r + c) = M(r, c);
+            }
+            this->home_frames(f, 9 + r) = M(r, 3);
+        }
+
+        this->num_joints[f] = n;
+        this->max_joints = std::max(this->max_joints, n);
+        this->num_fingers++;
+        this->dirty = true;
+        return f;
+    }
+
+    /**
+     * @brief Set the joint angles of one finger.
+     * @param finger Finger index.
+     * @param joint_angles Joint angles of that finger.
+     */
+    void hand_model::set_joint_angles(int finger, const Eigen::Ref<const Eigen::VectorXd>& joint_angles) {
+        this->check_finger(finger);
+        if (joint_angles.size() != this->num_joints[finger]) {
+            throw std::invalid_argument("joint_angles must have one element per joint of the finger");
+        }
+        for (int j = 0; j < this->num_joints[finger]; j++) {
+            this->joint_angles(finger, j) = joint_angles(j);
+        }
+        this->dirty = true;
+    }
+
+    /**
+     * @brief Set the joint angles of every finger from one vector, finger after finger.
+     * @param joint_angles Concatenated joint angles, get_num_joints() elements.
+     */
+    void hand_model::set_joint_angles(const Eigen::Ref<const Eigen::VectorXd>& joint_angles) {
+        if (joint_angles.size() != this->get_num_joints()) {
+            throw std::invalid_argument("joint_angles must have one element per joint of the hand");
+        }
+        int k = 0;
+        for (int f = 0; f < this->num_fingers; f++) {
+            for (int j = 0; j < this->num_joints[f]; j++) {
+                this->joint_angles(f, j) = joint_angles(k++);
+            }
+        }
+        this->dirty = true;
+    }
+
+    ////////////////////////////////////////////////////////////
+    // Getter functions
+    ////////////////////////////////////////////////////////////
+
+    /**
+     * @brief Get the number of fingers.
+     * @return Number of fingers.
+     */
+    int hand_model::get_num_fingers() const {
+        return num_fingers;
+    }
+
+    /**
+     * @brief Get the number of joints of one finger.
+     * @param finger Finger index.
+     * @return Number of joints.
+     */
+    int hand_model::get_num_joints(int finger) const {
+        this->check_finger(finger);
+        return num_joints[finger];
+    }
+
+    /**
+     * @brief Get the total number of joints of the hand.
+     * @return Number of joints.
+     */
+    int hand_model::get_num_joints() const {
+        int total = 0;
+        for (int f = 0; f < this->num_fingers; f++) {
+            total += this->num_joints[f];
+        }
+        return total;
+    }
+
+    /**
+     * @brief Get the joint angles of one finger.
+     * @param finger Finger index.
+     * @return Joint angles.
+     */
+    hand_model::joint_vector hand_model::get_joint_angles(int finger) const {
+        this->check_finger(finger);
+        return this->joint_angles.row(finger).head(this->num_joints[finger]).transpose().matrix();
+    }
+
+    /**
+     * @brief Get the fingertip frame of one finger in the palm frame, updating the hand if needed.
+     * @param finger Finger index.
+     * @return 4x4 transformation matrix.
+     */
+    Eigen::Matrix4d hand_model::get_fingertip_pose(int finger) {
+        this->update();
+        return std::as_const(*this).get_fingertip_pose(finger);
+    }
+
+    /**
+     * @brief Get the fingertip frame of one finger in the palm frame; the hand must be up to date.
+     * @param finger Finger index.
+     * @return 4x4 transformation matrix.
+     */
+    Eigen::Matrix4d hand_model::get_fingertip_pose(int finger) const {
+        this->check_finger(finger);
+        this->check_cache();
+        Eigen::Matrix4d T = Eigen::Matrix4d::Identity();
+        for (int r = 0; r < 3; r++) {
+            for (int c = 0; c < 3; c++) {
+                T(r, c) = this->fingertip_poses(finger, 3 * r + c);
+            }
+            T(r, 3) = this->fingertip_poses(finger, 9 + r);
+        }
+        return T;
+    }
+
+    /**
+     * @brief Get the fingertip position of one finger in the palm frame, updating the hand if needed.
+     * @param finger Finger index.
+     * @return Fingertip position.
+     */
+    Eigen::Vector3d hand_model::get_fingertip_position(int finger) {
+        this->update();
+        return std::as_const(*this).get_fingertip_position(finger);
+    }
+
+    /**
+     * @brief Get the fingertip position of one finger in the palm frame; the hand must be up to date.
+     * @param finger Finger index.
+     * @return Fingertip position.
+     */
+    Eigen::Vector3d hand_model::get_fingertip_position(int finger) const {
+        this->check_finger(finger);
+        this->check_cache();
+        return Eigen::Vector3d(this->fingertip_poses(finger, 9), this->fingertip_poses(finger, 10), this->fingertip_poses(finger, 11));
+    }
+
+    /**
+     * @brief Get the space Jacobian of one finger, expressed in the palm frame, updating the hand if needed.
+     * @param finger Finger index.
+     * @return 6xn Jacobian.
+     */
+    hand_model::jacobian_matrix hand_model::get_space_jacobian(int finger) {
+        this->update();
+        return std::as_const(*this).get_space_jacobian(finger);
+    }
+
+    /**
+     * @brief Get the space Jacobian of one finger, expressed in the palm frame; the hand must be up to date.
+     * @param finger Finger index.
+     * @return 6xn Jacobian.
+     */
+    hand_model::jacobian_matrix hand_model::get_space_jacobian(int finger) const {
+        this->check_finger(finger);
+        this->check_cache();
+        jacobian_matrix J(6, this->num_joints[finger]);
+        for (int j = 0; j < this->num_joints[finger]; j++) {
+            for (int c = 0; c < 6; c++) {
+                J(c, j) = this->space_jacobians(finger, 6 * j + c);
+            }
+        }
+        return J;
+    }
+
+    /**
+     * @brief Get the body Jacobian of one finger, J_b = Ad_{T^-1} J_s, updating the hand if needed.
+     * @param finger Finger index.
+     * @return 6xn Jacobian.
+     */
+    hand_model::jacobian_matrix hand_model::get_body_jacobian(int finger) {
+        this->update();
+        return std::as_const(*this).get_body_jacobian(finger);
+    }
+
+    /**
+     * @brief Get the body Jacobian of one finger, J_b = Ad_{T^-1} J_s; the hand must be up to date.
+     * @param finger Finger index.
+     * @return 6xn Jacobian.
+     */
+    hand_model::jacobian_matrix hand_model::get_body_jacobian(int finger) const {
+        jacobian_matrix J = this->get_space_jacobian(finger);
+        Eigen::Matrix4d T_inv = rigid_body_motion::Transform_Inverse(this->get_fingertip_pose(finger));
+        for (int j = 0; j < J.cols(); j++) {
+            J.col(j) = rigid_body_motion::Adjoint_Twist(T_inv, J.col(j));
+        }
+        return J;
+    }
+
+    ////////////////////////////////////////////////////////////
+    // Member functions
+    ////////////////////////////////////////////////////////////
+
+    /**
+     * @brief Evaluate the forward kinematics and space Jacobians of all fingers at once.
+     *
+     * The product of exponentials runs joint by joint on a lane_transform, one lane per finger, so each
+     * arithmetic step (including sin and cos) is a packet operation over the whole hand. Fingers with fewer
+     * joints carry zero screws in the extra joints, which act as the identity. Skipped when no joint angle
+     * or finger changed since the last call.
+     */
+    void hand_model::update() {
+        if (!this->dirty) {
+            return;
+        }
+
+        // Accumulated transform e^[S1]theta1 ... e^[Sj]thetaj, one lane per finger
+        lane_transform<lanes> T;
+        for (int j = 0; j < this->max_joints; j++) {
+            const lane_array w[3] = {this->screw_axes.col(6 * j), this->screw_axes.col(6 * j + 1), this->screw_axes.col(6 * j + 2)};
+            const lane_array v[3] = {this->screw_axes.col(6 * j + 3), this->screw_axes.col(6 * j + 4), this->screw_axes.col(6 * j + 5)};
+
+            // Jacobian column Ad_T S
+            lane_array Jw[3], Jv[3];
+            T.adjoint(w, v, Jw, Jv);
+            for (int r = 0; r < 3; r++) {
+                this->space_jacobians.col(6 * j + r) = Jw[r];
+                this->space_jacobians.col(6 * j + 3 + r) = Jv[r];
+            }
+            T.multiply_exponential(w, v, lane_array(this->joint_angles.col(j)));
+        }
+
+        // Fingertip frame T M, column by column of the home rotation
+        for (int c = 0; c < 3; c++) {
+            const lane_array home_column[3] = {this->home_frames.col(c), this->home_frames.col(3 + c), this->home_frames.col(6 + c)};
+            lane_array column[3];
+            T.rotate(home_column, column);
+            for (int r = 0; r < 3; r++) {
+                this->fingertip_poses.col(3 * r + c) = column[r];
+            }
+        }
+        const lane_array home_tip[3] = {this->home_frames.col(9), this->home_frames.col(10), this->home_frames.col(11)};
+        lane_array tip[3];
+        T.transform_point(home_tip, tip);
+        for (int r = 0; r < 3; r++) {
+            this->fingertip_poses.col(9 + r) = tip[r];
+        }
+
+        this->dirty = false;
+    }
+
+    ////////////////////////////////////////////////////////////
+    // Private functions
+    ////////////////////////////////////////////////////////////
+
+    /**
+     * @brief Check a finger index.
+     * @param finger Finger index.
+     */
+    void hand_model::check_finger(int finger) const {
+        if (finger < 0 || finger >= this->num_fingers) {
+            throw std::invalid_argument("finger index is out of range");
+        }
+    }
+
+    /**
+     * @brief Check that the cached kinematics match the current joint angles and fingers.
+     */
+    void hand_model::check_cache() const {
+        if (this->dirty) {
+            throw std::runtime_error("cached kinematics are stale; call update() after changing the hand");
+        }
+    }
+
+}
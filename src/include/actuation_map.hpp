@@ -0,0 +1,58 @@
+#ifndef ACTUATION_MAP_HPP
+#define ACTUATION_MAP_HPP
+
+#include <Eigen/Dense>
+#include "finger_model.hpp"
+#include "tendon_routing_model.hpp"
+
+namespace fm {
+
+    class actuation_map
+    {
+    public:
+        actuation_map(const Eigen::MatrixXd& tendon_routing_matrix, const Eigen::MatrixXd& motor_shaft_matrix);
+        actuation_map(const finger_model<>& finger);
+
+        // Setters and Getters
+        void set_motor_offsets(const Eigen::VectorXd& motor_offsets);
+        const Eigen::VectorXd& get_motor_offsets() const;
+        const Eigen::MatrixXd& get_motor_joint_jacobian() const;
+        const Eigen::MatrixXd& get_joint_motor_jacobian() const;
+        int get_num_joints() const;
+        int get_num_tendons() const;
+        int get_num_motors() const;
+
+        // Position mappings
+        Eigen::VectorXd joint_to_tendon(const Eigen::VectorXd& joint_angles) const;
+        Eigen::VectorXd tendon_to_motor(const Eigen::VectorXd& tendon_excursions) const;
+        Eigen::VectorXd joint_to_motor(const Eigen::VectorXd& joint_angles) const;
+        Eigen::VectorXd joint_to_motor(const Eigen::VectorXd& joint_angles, const tendon_routing_model& routing) const;
+        Eigen::VectorXd motor_to_tendon(const Eigen::VectorXd& motor_angles) const;
+        Eigen::VectorXd tendon_to_joint(const Eigen::VectorXd& tendon_excursions) const;
+        Eigen::VectorXd motor_to_joint(const Eigen::VectorXd& motor_angles) const;
+
+        // Force mappings
+        Eigen::VectorXd joint_torques_from_motor_torques(const Eigen::VectorXd& motor_torques) const;
+        Eigen::VectorXd tendon_tensions_from_motor_torques(const Eigen::VectorXd& motor_torques) const;
+        Eigen::VectorXd motor_torques_from_tendon_tensions(const Eigen::VectorXd& tendon_tensions) const;
+
+        // Batched trajectory mappings, one column per sample
+        void joint_to_motor(const Eigen::Ref<const Eigen::MatrixXd>& joint_trajectory, Eigen::Ref<Eigen::MatrixXd> motor_trajectory) const;
+        void motor_to_joint(const Eigen::Ref<const Eigen::MatrixXd>& motor_trajectory, Eigen::Ref<Eigen::MatrixXd> joint_trajectory) const;
+
+    private:
+        void precompute();
+
+        Eigen::MatrixXd tendon_routing_matrix;     // R, joints x tendons
+        Eigen::MatrixXd motor_shaft_matrix;        // M, motors x tendons
+        Eigen::MatrixXd motor_joint_jacobian;      // M R^T, motors x joints
+        Eigen::MatrixXd joint_motor_jacobian;      // (M R^T)^+, joints x motors
+        Eigen::MatrixXd tendon_joint_map;          // (R^T)^+, joints x tendons
+        Eigen::MatrixXd motor_tendon_map;          // M^+, tendons x motors
+        Eigen::MatrixXd tension_motor_torque_map;  // (M^T)^+, motors x tendons
+        Eigen::VectorXd motor_offsets;
+    };
+
+}
+
+#endif // ACTUATION_MAP_HPP
@@ -0,0 +1,61 @@
+#ifndef CARTESIAN_TRAJECTORY_HPP
+#define CARTESIAN_TRAJECTORY_HPP
+
+#include <Eigen/Dense>
+#include "finger_model.hpp"
+
+namespace fm {
+
+    // Path of the fingertip frame between two poses
+    enum class cartesian_path
+    {
+        screw,          // Constant screw motion, T0 exp(s log(T0^-1 T1))
+        straight_line   // Straight line of the origin, with the rotation interpolated on SO(3)
+    };
+
+    // Joint waypoints of a Cartesian move and what they cost to find
+    struct cartesian_plan
+    {
+        Eigen::VectorXd fractions;        // Path parameter of every waypoint, from 0 to 1
+        Eigen::MatrixXd joint_angles;     // One column per waypoint; the joints move linearly between them
+        long ik_solves = 0;               // Including the solves of rejected steps
+        long rejected_steps = 0;
+        double solve_seconds = 0.0;       // Time spent in inverse kinematics
+        double solves_per_second = 0.0;
+        double max_deviation = 0.0;       // Largest fingertip distance from the ideal path found at the checked points (m)
+    };
+
+    // Follows a Cartesian fingertip path with inverse kinematics at adaptively spaced samples. Every solve starts
+    // from the previous waypoint extrapolated along the path, and a step is kept only if the fingertip stays within
+    // the tolerance of the ideal path at the new waypoint and at the quarter points of the joint space chord to it.
+    // The chord error shrinks with the square of the step, so accepted steps grow until the error nears the tolerance
+    // and rejected steps shrink by the same rule, keeping the number of solves close to the fewest that meet it
+    class cartesian_trajectory
+    {
+    public:
+        explicit cartesian_trajectory(const finger_model<>& finger);
+
+        // Setters and Getters
+        void set_path(cartesian_path path);
+        void set_position_only(bool position_only);
+        void set_tolerance(double tolerance);
+        cartesian_path get_path() const;
+        bool get_position_only() const;
+        double get_tolerance() const;
+
+        // Member functions
+        static Eigen::Matrix4d interpolate(const Eigen::Matrix4d& start, const Eigen::Matrix4d& goal, double fraction, cartesian_path path);
+        cartesian_plan plan(const Eigen::Ref<const Eigen::VectorXd>& start_angles, const Eigen::Matrix4d& goal);
+
+    private:
+        double deviation(const Eigen::Matrix4d& start, const Eigen::Matrix4d& goal, double fraction, const finger_model<>::joint_vector& joint_angles);
+
+        finger_model<> finger;   // Scratch model; its joint angles seed every solve
+        cartesian_path path;
+        bool position_only;
+        double tolerance;
+    };
+
+}
+
+#endif // CARTESIAN_TRAJECTORY_HPP
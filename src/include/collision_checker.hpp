@@ -0,0 +1,113 @@
+#ifndef COLLISION_CHECKER_HPP
+#define COLLISION_CHECKER_HPP
+
+#include <Eigen/Dense>
+#include <array>
+#include <vector>
+#include "collision_geometry.hpp"
+#include "finger_model.hpp"
+
+namespace fm {
+
+    // First contact found along a trajectory
+    struct collision_report
+    {
+        bool collision = false;
+        long segment = -1;        // Segment of the first contact
+        double time = 0.0;        // Fraction of that segment at the first contact
+        int body_a = -1;
+        int body_b = -1;
+        double distance = 0.0;    // Distance between the two bodies there, less the clearance
+        long iterations = 0;      // Conservative advancement steps taken
+    };
+
+    // Self-collision checking between link capsules of several fingers and palm capsules, with a bounding
+    // volume hierarchy over all bodies and conservative advancement along piecewise linear joint trajectories
+    class collision_checker
+    {
+    public:
+        collision_checker();
+
+        // Setters and Getters
+        int add_finger(const finger_model<>& finger, const Eigen::Matrix4d& palm_to_base = Eigen::Matrix4d::Identity());
+        int add_palm_capsule(const capsule& geometry);
+        void ignore_pair(int body_a, int body_b);
+        void set_clearance(double clearance);
+        void set_tolerance(double tolerance);
+        void set_max_iterations(long max_iterations);
+        int get_num_fingers() const;
+        int get_num_joints() const;
+        int get_num_bodies() const;
+        int get_body_finger(int body) const;
+        int get_body_link(int body) const;
+        const std::vector<capsule>& get_body_capsules() const;
+        long get_num_distance_tests() const;
+
+        // Member functions
+        void update(const Eigen::Ref<const Eigen::VectorXd>& joint_angles);
+        double distance(const Eigen::Ref<const Eigen::VectorXd>& joint_angles, int& body_a, int& body_b);
+        bool in_collision(const Eigen::Ref<const Eigen::VectorXd>& joint_angles);
+        collision_report check_segment(const Eigen::Ref<const Eigen::VectorXd>& start, const Eigen::Ref<const Eigen::VectorXd>& end);
+        collision_report check_trajectory(const Eigen::Ref<const Eigen::MatrixXd>& waypoints);
+
+    private:
+        struct finger_entry
+        {
+            Eigen::Matrix<double, 6, Eigen::Dynamic, 0, 6, max_finger_joints> screw_axes;
+            Eigen::Matrix4d palm_to_base;
+            int first_joint;
+            std::array<int, max_finger_joints> link_bodies;   // Body of every link, -1 without geometry
+        };
+        struct body_entry
+        {
+            int finger;      // -1 for palm capsules
+            int link;
+            capsule home;    // In the finger's space frame, or the palm frame
+            // Largest distance from joint i's axis to the capsule surface, for every joint up to the link
+            Eigen::Matrix<double, max_finger_joints, 1> reach;
+        };
+        struct bvh_node
+        {
+            aabb bounds;
+            double motion;   // Largest motion bound of the bodies below
+            double radius;   // Largest capsule radius below, bounding the penetration of overlapping boxes
+            int left;
+            int right;
+            int body;        // Body of a leaf, -1 for inner nodes
+        };
+        struct pair_query
+        {
+            double slack;    // Smallest distance less clearance over the pairs
+            double ratio;    // Smallest slack over the pair's motion bound
+            int body_a;
+            int body_b;
+            bool stop_at_contact;   // Return as soon as a pair is within the tolerance
+        };
+
+        void build_hierarchy();
+        int build_node(std::vector<int>& bodies, int begin, int end);
+        double segment_motion(const Eigen::Ref<const Eigen::VectorXd>& start, const Eigen::Ref<const Eigen::VectorXd>& end, std::vector<double>& motion) const;
+        void query(pair_query& result);
+        void query_nodes(int a, int b, pair_query& result);
+        bool ignored(int body_a, int body_b) const;
+
+        // Bodies and settings
+        std::vector<finger_entry> fingers;
+        std::vector<body_entry> bodies;
+        std::vector<char> ignored_pairs;
+        int num_joints;
+        double clearance;
+        double tolerance;
+        long max_iterations;
+
+        // State of the last update; nodes are refit in place and rebuilt when bodies are added
+        std::vector<capsule> capsules;
+        std::vector<double> motion;
+        std::vector<bvh_node> nodes;
+        bool hierarchy_dirty;
+        long distance_tests;
+    };
+
+}
+
+#endif // COLLISION_CHECKER_HPP
@@ -0,0 +1,70 @@
+#ifndef COLLISION_GEOMETRY_HPP
+#define COLLISION_GEOMETRY_HPP
+
+#include <Eigen/Dense>
+
+namespace fm {
+
+    // Axis-aligned bounding box
+    struct aabb
+    {
+        Eigen::Vector3d min = Eigen::Vector3d::Zero();
+        Eigen::Vector3d max = Eigen::Vector3d::Zero();
+
+        bool overlaps(const aabb& other) const;
+        aabb inflated(double margin) const;
+        double distance(const aabb& other) const;
+    };
+
+    // Line segment swept by a sphere, used for finger links
+    struct capsule
+    {
+        Eigen::Vector3d a = Eigen::Vector3d::Zero();
+        Eigen::Vector3d b = Eigen::Vector3d::Zero();
+        double radius = 0.0;
+
+        aabb bounds() const;
+    };
+
+    // Half-space {x : normal . x <= offset}; the solid side is behind the plane
+    struct plane
+    {
+        Eigen::Vector3d normal = Eigen::Vector3d::UnitZ();
+        double offset = 0.0;
+    };
+
+    struct sphere
+    {
+        Eigen::Vector3d center = Eigen::Vector3d::Zero();
+        double radius = 0.0;
+
+        aabb bounds() const;
+    };
+
+    // Oriented box given by its center, rotation (columns are the box axes) and half extents
+    struct box
+    {
+        Eigen::Vector3d center = Eigen::Vector3d::Zero();
+        Eigen::Matrix3d rotation = Eigen::Matrix3d::Identity();
+        Eigen::Vector3d half_extents = Eigen::Vector3d::Zero();
+
+        aabb bounds() const;
+    };
+
+    namespace geometry {
+        Eigen::Vector3d closest_point_on_segment(const Eigen::Vector3d& a, const Eigen::Vector3d& b, const Eigen::Vector3d& p, double& t);
+        double segment_segment_distance(const Eigen::Vector3d& p0, const Eigen::Vector3d& p1, const Eigen::Vector3d& q0, const Eigen::Vector3d& q1,
+                                        double& s, double& t);
+        double box_signed_distance(const box& b, const Eigen::Vector3d& p, Eigen::Vector3d& normal);
+
+        // Signed distance between a capsule surface and a primitive; negative when penetrating.
+        // point is the deepest point of the capsule surface and normal points from the primitive toward the capsule.
+        double capsule_plane(const capsule& c, const plane& pl, Eigen::Vector3d& point, Eigen::Vector3d& normal);
+        double capsule_sphere(const capsule& c, const sphere& s, Eigen::Vector3d& point, Eigen::Vector3d& normal);
+        double capsule_box(const capsule& c, const box& b, Eigen::Vector3d& point, Eigen::Vector3d& normal);
+        double capsule_capsule(const capsule& c0, const capsule& c1, Eigen::Vector3d& point, Eigen::Vector3d& normal);
+    }
+
+}
+
+#endif // COLLISION_GEOMETRY_HPP
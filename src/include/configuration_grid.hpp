@@ -0,0 +1,35 @@
+#ifndef CONFIGURATION_GRID_HPP
+#define CONFIGURATION_GRID_HPP
+
+#include <Eigen/Dense>
+
+namespace fm {
+
+    // Uniform grid over joint space; points are numbered with the first joint varying fastest
+    class configuration_grid
+    {
+    public:
+        configuration_grid(const Eigen::VectorXd& joint_min, const Eigen::VectorXd& joint_max, const Eigen::VectorXi& samples);
+
+        // Getters
+        const Eigen::VectorXd& get_joint_min() const;
+        const Eigen::VectorXd& get_joint_max() const;
+        const Eigen::VectorXi& get_samples() const;
+        int get_num_joints() const;
+        long size() const;
+
+        // Member functions
+        void point(long index, Eigen::Ref<Eigen::VectorXd> joint_angles) const;
+        Eigen::VectorXd point(long index) const;
+
+    private:
+        Eigen::VectorXd joint_min;
+        Eigen::VectorXd joint_max;
+        Eigen::VectorXi samples;
+        Eigen::VectorXd spacing;
+        long num_points;
+    };
+
+}
+
+#endif // CONFIGURATION_GRID_HPP
@@ -0,0 +1,81 @@
+#ifndef CONTACT_MODEL_HPP
+#define CONTACT_MODEL_HPP
+
+#include <Eigen/Dense>
+#include <vector>
+#include "collision_geometry.hpp"
+#include "finger_model.hpp"
+
+namespace fm {
+
+    // Penalty contact with regularized Coulomb friction
+    struct contact_parameters
+    {
+        double stiffness = 2e4;           // Normal stiffness (N/m)
+        double damping = 5.0;             // Normal damping (Ns/m)
+        double friction_coefficient = 0.5;
+        double slip_velocity = 1e-3;      // Tangential velocity below which friction is blended to zero (m/s)
+    };
+
+    struct contact_point
+    {
+        int link = 0;
+        int object = 0;
+        Eigen::Vector3d point = Eigen::Vector3d::Zero();   // Deepest point on the link surface
+        Eigen::Vector3d normal = Eigen::Vector3d::Zero();  // From the object toward the link
+        double depth = 0.0;
+        Eigen::Vector3d force = Eigen::Vector3d::Zero();   // Force applied on the link
+    };
+
+    class contact_model
+    {
+    public:
+        contact_model(const finger_model<>& finger, const Eigen::VectorXd& link_radii, const contact_parameters& parameters = contact_parameters());
+
+        // Setters and Getters
+        int add_plane(const plane& object);
+        int add_sphere(const sphere& object);
+        int add_box(const box& object);
+        void set_contact_parameters(const contact_parameters& parameters);
+        const std::vector<capsule>& get_link_capsules() const;
+        const std::vector<contact_point>& get_contacts() const;
+        Eigen::Vector3d get_object_force(int object) const;
+        int get_num_narrow_phase_tests() const;
+
+        // Member functions
+        void update_link_capsules(const Eigen::VectorXd& joint_angles);
+        const Eigen::VectorXd& evaluate(const Eigen::VectorXd& joint_angles, const Eigen::VectorXd& joint_velocities);
+
+    private:
+        enum class shape { plane, sphere, box };
+        struct object_entry
+        {
+            shape kind;
+            int index;
+            aabb bounds;
+        };
+
+        // Finger geometry
+        finger_model<> finger;
+        std::vector<Eigen::Vector3d> home_joint_points;
+        Eigen::VectorXd link_radii;
+
+        // Environment
+        contact_parameters parameters;
+        std::vector<plane> planes;
+        std::vector<sphere> spheres;
+        std::vector<box> boxes;
+        std::vector<object_entry> objects;
+
+        // Per-step state, kept between calls to avoid allocation
+        std::vector<capsule> link_capsules;
+        finger_model<>::link_frames link_frames;
+        finger_model<>::jacobian_matrix space_jacobian;
+        std::vector<contact_point> contacts;
+        Eigen::VectorXd joint_torques;
+        int narrow_phase_tests;
+    };
+
+}
+
+#endif // CONTACT_MODEL_HPP
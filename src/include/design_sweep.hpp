@@ -0,0 +1,100 @@
+#ifndef DESIGN_SWEEP_HPP
+#define DESIGN_SWEEP_HPP
+
+#include <Eigen/Dense>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "finger_model.hpp"
+
+namespace fm {
+
+    // Objectives of one design; area, force capacity and dexterity are maximized, the tension peak minimized
+    struct design_scores
+    {
+        double workspace_area = 0.0;   // Area reached by the fingertip in the plane normal to the first joint axis
+        double force_capacity = 0.0;   // Smallest maximum fingertip force over the force grid and directions
+        double dexterity = 0.0;        // Mean inverse condition number of the position Jacobian
+        double tension_peak = 0.0;     // Largest tendon tension needed for the reference force
+    };
+
+    struct design_candidate
+    {
+        long index = 0;
+        Eigen::VectorXd link_lengths;
+        Eigen::MatrixXd tendon_routing_matrix;
+        design_scores scores;
+    };
+
+    bool dominates(const design_scores& a, const design_scores& b);
+
+    // Sweep over link lengths and tendon moment arms of a base finger, keeping the Pareto front of the scores
+    class design_sweep
+    {
+    public:
+        design_sweep(const finger_model<>& base, double min_tension, double max_tension);
+
+        // Setters and Getters
+        void set_link_length_range(const Eigen::VectorXd& min_lengths, const Eigen::VectorXd& max_lengths);
+        void set_moment_arm_range(const Eigen::MatrixXd& min_moment_arms, const Eigen::MatrixXd& max_moment_arms);
+        void set_enumeration(int levels);
+        void set_random_samples(long num_candidates, std::uint64_t seed);
+        void set_joint_range(const Eigen::VectorXd& joint_min, const Eigen::VectorXd& joint_max);
+        void set_grid_samples(int kinematic_samples, int force_samples);
+        void set_directions(const Eigen::Matrix3Xd& directions);
+        void set_reference_force(double reference_force);
+        void set_cell_size(double cell_size);
+        void set_force_tolerance(double force_tolerance);
+        long get_num_candidates() const;
+        long get_num_rejected() const;
+        const std::vector<design_candidate>& get_pareto_front() const;
+
+        // Member functions
+        design_candidate candidate(long index) const;
+        finger_model<> build_finger(const design_candidate& candidate) const;
+        design_scores score(const design_candidate& candidate) const;
+        void run(int num_threads = 0);
+        void write_pareto_front(const std::string& path) const;
+
+    private:
+        bool evaluate(design_candidate& candidate, const std::function<bool(const design_scores&)>& dominated) const;
+        bool is_dominated(const design_scores& bound);
+        void insert(const design_candidate& candidate);
+        void check_ranges() const;
+
+        finger_model<> base;
+        Eigen::Matrix3Xd link_vectors;
+        double min_tension;
+        double max_tension;
+
+        // Design space; parameters with equal bounds are held fixed
+        Eigen::VectorXd min_lengths;
+        Eigen::VectorXd max_lengths;
+        Eigen::MatrixXd min_moment_arms;
+        Eigen::MatrixXd max_moment_arms;
+        int levels;
+        long num_random_candidates;
+        std::uint64_t seed;
+
+        // Evaluation settings
+        Eigen::VectorXd joint_min;
+        Eigen::VectorXd joint_max;
+        int kinematic_samples;
+        int force_samples;
+        Eigen::Matrix3Xd directions;
+        double reference_force;
+        double cell_size;
+        double force_tolerance;
+
+        // Results
+        std::vector<design_candidate> pareto_front;
+        std::mutex pareto_mutex;
+        std::atomic<long> num_rejected;
+    };
+
+}
+
+#endif // DESIGN_SWEEP_HPP
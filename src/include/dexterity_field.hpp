@@ -0,0 +1,82 @@
+#ifndef DEXTERITY_FIELD_HPP
+#define DEXTERITY_FIELD_HPP
+
+#include <Eigen/Dense>
+#include "configuration_grid.hpp"
+#include "finger_model.hpp"
+
+namespace fm {
+
+    // Fields stored for every sampled configuration
+    enum class dexterity_measure { manipulability, condition_number, min_singular_value };
+
+    // Best value of every measure in each occupied Cartesian cell
+    struct cartesian_dexterity
+    {
+        Eigen::Matrix3Xf cell_centers;
+        Eigen::VectorXf manipulability;        // Largest in the cell
+        Eigen::VectorXf condition_number;      // Smallest in the cell
+        Eigen::VectorXf min_singular_value;    // Largest in the cell
+    };
+
+    // Manipulability, condition number and smallest singular value of the fingertip position Jacobian over
+    // a configuration grid, with adaptive refinement where a field changes steeply
+    class dexterity_field
+    {
+    public:
+        // Configurations evaluated together, one SIMD lane each
+        static constexpr int lanes = 8;
+        using lane_array = Eigen::Array<double, lanes, 1>;
+
+        explicit dexterity_field(const finger_model<>& finger);
+
+        // Setters and Getters
+        void set_task_dimension(int task_dimension);
+        void set_refinement(int max_depth, double threshold, dexterity_measure measure = dexterity_measure::manipulability);
+        int get_task_dimension() const;
+        configuration_grid get_grid() const;
+        long get_num_grid_points() const;
+        long get_num_points() const;
+        const Eigen::MatrixXd& get_joint_angles() const;
+        const Eigen::Matrix3Xf& get_positions() const;
+        const Eigen::VectorXf& get_manipulability() const;
+        const Eigen::VectorXf& get_condition_number() const;
+        const Eigen::VectorXf& get_min_singular_value() const;
+
+        // Member functions
+        void compute(const configuration_grid& grid, int num_threads = 0);
+        void evaluate(const Eigen::Ref<const Eigen::MatrixXd>& joint_angles, Eigen::Ref<Eigen::Matrix3Xf> positions, Eigen::Ref<Eigen::VectorXf> manipulability,
+                      Eigen::Ref<Eigen::VectorXf> condition_number, Eigen::Ref<Eigen::VectorXf> min_singular_value) const;
+        cartesian_dexterity cartesian_map(double cell_size) const;
+
+        static void symmetric_eigenvalues(const lane_array& a00, const lane_array& a11, const lane_array& a22, const lane_array& a01,
+                                          const lane_array& a02, const lane_array& a12, lane_array eigenvalues[3]);
+
+    private:
+        void evaluate_parallel(const Eigen::MatrixXd& joint_angles, long begin, int num_threads);
+        const Eigen::VectorXf& field(dexterity_measure measure) const;
+
+        // Space screw axes and home fingertip position, read by the lane kernel
+        Eigen::Matrix<double, 6, Eigen::Dynamic, 0, 6, max_finger_joints> screw_axes;
+        Eigen::Vector3d home_tip;
+        int task_dimension;
+
+        // Refinement settings
+        int max_depth;
+        double threshold;
+        dexterity_measure refinement_measure;
+
+        // Results, grid points first in grid order, then refinement points
+        Eigen::VectorXd grid_min;
+        Eigen::VectorXd grid_max;
+        Eigen::VectorXi grid_samples;
+        Eigen::MatrixXd joint_angles;
+        Eigen::Matrix3Xf positions;
+        Eigen::VectorXf manipulability;
+        Eigen::VectorXf condition_number;
+        Eigen::VectorXf min_singular_value;
+    };
+
+}
+
+#endif // DEXTERITY_FIELD_HPP
@@ -0,0 +1,80 @@
+#ifndef ENVIRONMENT_FIELD_HPP
+#define ENVIRONMENT_FIELD_HPP
+
+#include <Eigen/Dense>
+#include <cstddef>
+#include <string>
+#include <vector>
+#include "collision_geometry.hpp"
+
+namespace fm {
+
+    // Static testbed environment (fixtures, load cells, test objects) as a union of primitives and closed
+    // triangle meshes, with exact signed distances; sampled once into a signed_distance_field file
+    class environment_model
+    {
+    public:
+        environment_model() = default;
+
+        // Setters and Getters
+        void add_plane(const plane& geometry);
+        void add_sphere(const sphere& geometry);
+        void add_box(const box& geometry);
+        void add_capsule(const capsule& geometry);
+        void add_mesh(const Eigen::Ref<const Eigen::Matrix3Xd>& vertices, const Eigen::Ref<const Eigen::Matrix3Xi>& triangles);
+        int get_num_objects() const;
+
+        // Member functions
+        double signed_distance(const Eigen::Vector3d& point) const;
+        void write_distance_field(const std::string& path, const aabb& region, double spacing, int num_threads = 0) const;
+
+    private:
+        struct mesh_entry
+        {
+            Eigen::Matrix3Xd vertices;
+            Eigen::Matrix3Xi triangles;
+            aabb bounds;
+        };
+
+        double mesh_signed_distance(const mesh_entry& mesh, const Eigen::Vector3d& point, double bound) const;
+
+        std::vector<plane> planes;
+        std::vector<sphere> spheres;
+        std::vector<box> boxes;
+        std::vector<capsule> capsules;
+        std::vector<mesh_entry> meshes;
+    };
+
+    // Read-only memory mapping of a sampled signed distance grid; a query is a trilinear blend of eight
+    // grid values. Fields with one layer in z are planar and ignore the z coordinate
+    class signed_distance_field
+    {
+    public:
+        explicit signed_distance_field(const std::string& path);
+        ~signed_distance_field();
+        signed_distance_field(const signed_distance_field&) = delete;
+        signed_distance_field& operator=(const signed_distance_field&) = delete;
+
+        // Getters
+        const Eigen::Vector3d& get_origin() const;
+        double get_spacing() const;
+        const Eigen::Vector3i& get_dimensions() const;
+        bool is_planar() const;
+
+        // Member functions
+        double distance(const Eigen::Vector3d& point) const;
+        double distance(const Eigen::Vector3d& point, Eigen::Vector3d& gradient) const;
+        double capsule_distance(const capsule& geometry, Eigen::Vector3d& point, Eigen::Vector3d& gradient) const;
+
+    private:
+        const unsigned char* data;
+        std::size_t size;
+        const float* values;   // x fastest, then y, then z
+        Eigen::Vector3d origin;
+        double spacing;
+        Eigen::Vector3i dimensions;
+    };
+
+}
+
+#endif // ENVIRONMENT_FIELD_HPP
@@ -0,0 +1,56 @@
+#ifndef FINGER_DESCRIPTION_HPP
+#define FINGER_DESCRIPTION_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "finger_model.hpp"
+
+namespace fm {
+
+    // Version of both the YAML description format and the compiled binary layout
+    constexpr std::uint32_t finger_description_version = 1;
+
+    // Validating YAML loader; errors name the offending key, e.g. "joints[1].limits"
+    std::uint64_t finger_description_hash(const std::string& text);
+    finger_model<> parse_finger_description(const std::string& text);
+    finger_model<> load_finger_description(const std::string& path);
+    std::string format_finger_description(const finger_model<>& finger, const std::string& name);
+    void write_finger_description(const std::string& path, const finger_model<>& finger, const std::string& name);
+
+    // Loads <cache_directory>/<content hash>.fmodel if present, otherwise parses the description and compiles it there
+    finger_model<> load_finger_model(const std::string& description_path, const std::string& cache_directory);
+
+    // Derived data stored alongside a compiled model, looked up by tag
+    struct compiled_table
+    {
+        std::uint32_t tag;
+        std::vector<char> data;
+    };
+
+    // Read-only memory mapping of a compiled finger model; the file is used in place without parsing
+    class compiled_finger_model
+    {
+    public:
+        explicit compiled_finger_model(const std::string& path);
+        ~compiled_finger_model();
+        compiled_finger_model(const compiled_finger_model&) = delete;
+        compiled_finger_model& operator=(const compiled_finger_model&) = delete;
+
+        static void write(const std::string& path, const finger_model<>& finger, std::uint64_t content_hash, const std::vector<compiled_table>& tables = {});
+
+        // Getters
+        std::uint64_t get_content_hash() const;
+        int get_num_joints() const;
+        finger_model<> get_finger_model() const;
+        const void* get_table(std::uint32_t tag, std::size_t& size) const;
+
+    private:
+        const unsigned char* data;
+        std::size_t size;
+    };
+
+}
+
+#endif // FINGER_DESCRIPTION_HPP
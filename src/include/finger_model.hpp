@@ -2,54 +2,191 @@
 #define FINGER_MODEL_HPP
 
 #include <Eigen/Dense>
+#include <array>
+#include <stdexcept>
 #include <vector>
 
 namespace fm {
 
+    // Size limits shared by fixed and dynamic fingers; five joints cover a thumb
+    constexpr int max_finger_joints = 5;
+    constexpr int max_finger_tendons = 6;
+    constexpr int max_finger_motors = 6;
+
+    // Mass properties of one link at the home configuration, in the space frame; the link moves with its joint
+    struct link_inertia
+    {
+        double mass = 0.0;
+        Eigen::Vector3d center_of_mass = Eigen::Vector3d::Zero();
+        Eigen::Matrix3d rotational_inertia = Eigen::Matrix3d::Zero(); // About the center of mass
+    };
+
+    // Capsule around one link at the home configuration, in the space frame; the link moves with its joint.
+    // Links with zero radius have no geometry
+    struct link_geometry
+    {
+        Eigen::Vector3d start = Eigen::Vector3d::Zero();
+        Eigen::Vector3d end = Eigen::Vector3d::Zero();
+        double radius = 0.0;
+    };
+
+    // Finger with N joints known at compile time, or Eigen::Dynamic for fingers loaded from configuration.
+    // All members are fixed-size (or fixed-capacity for Dynamic), so no kinematics call touches the heap.
+    template <int N = Eigen::Dynamic>
     class finger_model
     {
+        static_assert(N == Eigen::Dynamic || (N >= 1 && N <= max_finger_joints), "finger_model supports 1 to max_finger_joints joints");
+
     public:
+        static constexpr int max_joints = N == Eigen::Dynamic ? max_finger_joints : N;
+        using joint_vector = Eigen::Matrix<double, N, 1, 0, max_joints, 1>;
+        using screw_matrix = Eigen::Matrix<double, 6, N, 0, 6, max_joints>;
+        using jacobian_matrix = Eigen::Matrix<double, 6, N, 0, 6, max_joints>;
+        using routing_matrix = Eigen::Matrix<double, N, Eigen::Dynamic, N == 1 ? Eigen::RowMajor : Eigen::ColMajor, max_joints, max_finger_tendons>;
+        using motor_matrix = Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, 0, max_finger_motors, max_finger_tendons>;
+        using joint_matrix = Eigen::Matrix<double, N, N, 0, max_joints, max_joints>;
+        using link_frames = std::array<Eigen::Matrix4d, max_joints>;
+
         finger_model(); // Default constructor
-        finger_model(Eigen::VectorXd link_lengths, Eigen::VectorXd joint_angles); // Overloaded constructor
+        finger_model(const Eigen::Ref<const Eigen::VectorXd>& link_lengths, const Eigen::Ref<const Eigen::VectorXd>& joint_angles); // Overloaded constructor
+        template <int M>
+        finger_model(const finger_model<M>& other); // Conversion between fixed and dynamic joint counts
         ~finger_model();
 
-        // Setters and Getters
-        void set_home_position_screw_axes_body(std::vector<Eigen::VectorXd> home_position_screw_axes);
-        void set_home_position_screw_axes_space(std::vector<Eigen::VectorXd> home_position_screw_axes);
-        void set_home_position_body_frame(Eigen::MatrixXd home_position_body_frame);
-        void set_link_lengths(Eigen::VectorXd link_lengths);
-        void set_joint_angles(Eigen::VectorXd joint_angles);
-        Eigen::VectorXd get_link_lengths();
-        Eigen::VectorXd get_joint_angles();
+        // Setters and Getters; setters mark the cached kinematics dirty. The non-const getters recompute them once on
+        // demand, the const ones only read and throw if the cache is stale, so update() a model before sharing it
+        void set_home_position_screw_axes_body(const std::vector<Eigen::VectorXd>& home_position_screw_axes);
+        void set_home_position_screw_axes_body(const Eigen::Ref<const Eigen::Matrix<double, 6, Eigen::Dynamic>>& home_position_screw_axes);
+        void set_home_position_screw_axes_space(const std::vector<Eigen::VectorXd>& home_position_screw_axes);
+        void set_home_position_screw_axes_space(const Eigen::Ref<const Eigen::Matrix<double, 6, Eigen::Dynamic>>& home_position_screw_axes);
+        void set_home_position_body_frame(const Eigen::Ref<const Eigen::MatrixXd>& home_position_body_frame);
+        void set_link_lengths(const Eigen::Ref<const Eigen::VectorXd>& link_lengths);
+        void set_joint_angles(const Eigen::Ref<const Eigen::VectorXd>& joint_angles);
+        void set_joint_limits(const Eigen::Ref<const Eigen::VectorXd>& lower, const Eigen::Ref<const Eigen::VectorXd>& upper);
+        void set_link_inertia(int link, const link_inertia& inertia);
+        void set_link_geometry(int link, const link_geometry& geometry);
+        int get_num_joints() const;
+        joint_vector get_joint_lower_limits() const;
+        joint_vector get_joint_upper_limits() const;
+        const link_inertia& get_link_inertia(int link) const;
+        const link_geometry& get_link_geometry(int link) const;
+        const joint_vector& get_link_lengths() const;
+        const joint_vector& get_joint_angles() const;
+        const screw_matrix& get_home_position_screw_axes_body() const;
+        const screw_matrix& get_home_position_screw_axes_space() const;
+        const Eigen::Matrix4d& get_home_position_body_frame() const;
 
-        void set_tendon_routing_matrix(Eigen::MatrixXd tendon_routing_matrix);
-        Eigen::MatrixXd get_finger_space_jacobian();
-        Eigen::MatrixXd get_finger_body_jacobian();
-        Eigen::MatrixXd get_tendon_routing_matrix();
+        void set_tendon_routing_matrix(const Eigen::Ref<const Eigen::MatrixXd>& tendon_routing_matrix);
+        void set_motor_shaft_matrix(const Eigen::Ref<const Eigen::MatrixXd>& motor_shaft_matrix);
+        const jacobian_matrix& get_finger_space_jacobian();
+        const jacobian_matrix& get_finger_space_jacobian() const;
+        const jacobian_matrix& get_finger_body_jacobian();
+        const jacobian_matrix& get_finger_body_jacobian() const;
+        const Eigen::Matrix4d& get_fingertip_pose_space();
+        const Eigen::Matrix4d& get_fingertip_pose_space() const;
+        const Eigen::Matrix4d& get_fingertip_pose_body();
+        const Eigen::Matrix4d& get_fingertip_pose_body() const;
+        const routing_matrix& get_tendon_routing_matrix() const;
+        const motor_matrix& get_motor_shaft_matrix() const;
 
         // Member functions
+        void update();
         void calculate_finger_space_jacobian();
         void calculate_finger_body_jacobian();
-        Eigen::VectorXd forward_kinematics_body();
-        Eigen::VectorXd forward_kinematics_space();
-        Eigen::VectorXd inverse_kinematics_body(const Eigen::MatrixXd& desired_pose);
-        Eigen::VectorXd inverse_kinematics_space(const Eigen::MatrixXd& desired_pose);
+        Eigen::VectorXd forward_kinematics_body() const;
+        Eigen::VectorXd forward_kinematics_space() const;
+        joint_vector inverse_kinematics_body(const Eigen::Matrix4d& desired_pose) const;
+        joint_vector inverse_kinematics_space(const Eigen::Matrix4d& desired_pose) const;
+        joint_vector inverse_kinematics_position(const Eigen::Vector3d& desired_position) const;
+        Eigen::Vector3d fingertip_position_space() const;
+        joint_matrix fingertip_force_hessian(const Eigen::Vector3d& fingertip_force) const;
+
+        // Kernels at given joint angles into the caller's storage; they only read the model
+        Eigen::Matrix4d pose_space(const joint_vector& joint_angles) const;
+        Eigen::Matrix4d pose_body(const joint_vector& joint_angles) const;
+        void space_jacobian(const joint_vector& joint_angles, jacobian_matrix& jacobian, Eigen::Matrix4d* pose = nullptr) const;
+        void body_jacobian(const joint_vector& joint_angles, jacobian_matrix& jacobian) const;
+        void link_frames_space(const joint_vector& joint_angles, link_frames& frames) const;
+        void fingertip_force_hessian(const joint_vector& joint_angles, const Eigen::Vector3d& fingertip_force, joint_matrix& hessian) const;
 
     private:
+        template <int> friend class finger_model;
+
+        // Cached quantities that depend on the joint angles and geometry; the pose and Jacobian of a chain are refreshed together
+        enum dirty_flag : unsigned int
+        {
+            dirty_space = 1u << 0,
+            dirty_body = 1u << 1,
+            dirty_all = dirty_space | dirty_body
+        };
+
+        void check_chain(bool body) const;
+        void check_cache(bool body) const;
+        void check_joint_count(Eigen::Index size, const char* message) const;
+        void update_space();
+        void update_body();
+
         // Finger geometric information
-        Eigen::MatrixXd home_position_body_frame;
-        std::vector<Eigen::VectorXd> home_position_screw_axes_body;
-        std::vector<Eigen::VectorXd> home_position_screw_axes_space;
-        Eigen::VectorXd link_lengths; 
-        Eigen::VectorXd joint_angles; 
-
-        // Finger mappings
-        Eigen::MatrixXd finger_space_jacobian;
-        Eigen::MatrixXd finger_body_jacobian;
-        Eigen::MatrixXd tendon_routing_matrix;
-        Eigen::MatrixXd motor_shaft_matrix;
+        Eigen::Matrix4d home_position_body_frame;
+        screw_matrix home_position_screw_axes_body;
+        screw_matrix home_position_screw_axes_space;
+        bool has_screw_axes_body;
+        bool has_screw_axes_space;
+        joint_vector link_lengths;
+        joint_vector joint_angles;
+        joint_vector joint_lower_limits;
+        joint_vector joint_upper_limits;
+        std::array<link_inertia, max_joints> link_inertias;
+        std::array<link_geometry, max_joints> link_geometries;
+
+        // Finger mappings, cached
+        jacobian_matrix finger_space_jacobian;
+        jacobian_matrix finger_body_jacobian;
+        Eigen::Matrix4d fingertip_pose_space;
+        Eigen::Matrix4d fingertip_pose_body;
+        unsigned int dirty;
+        routing_matrix tendon_routing_matrix;
+        motor_matrix motor_shaft_matrix;
     };
 
+    /**
+     * @brief Copy a finger model with a different joint count type, e.g. a finger_model<3> into finger_model<>.
+     * @param other Finger model to copy.
+     */
+    template <int N>
+    template <int M>
+    finger_model<N>::finger_model(const finger_model<M>& other)
+        : home_position_body_frame(other.home_position_body_frame),
+          has_screw_axes_body(other.has_screw_axes_body),
+          has_screw_axes_space(other.has_screw_axes_space),
+          dirty(dirty_all),
+          motor_shaft_matrix(other.motor_shaft_matrix)
+    {
+        this->check_joint_count(other.joint_angles.size(), "other finger_model has a different number of joints");
+        this->link_lengths = other.link_lengths;
+        this->joint_angles = other.joint_angles;
+        this->home_position_screw_axes_body = other.home_position_screw_axes_body;
+        this->home_position_screw_axes_space = other.home_position_screw_axes_space;
+        this->tendon_routing_matrix = other.tendon_routing_matrix;
+        this->joint_lower_limits = other.joint_lower_limits;
+        this->joint_upper_limits = other.joint_upper_limits;
+        for (int i = 0; i < other.joint_angles.size(); i++) {
+            this->link_inertias[i] = other.link_inertias[i];
+            this->link_geometries[i] = other.link_geometries[i];
+        }
+    }
+
+    extern template class finger_model<Eigen::Dynamic>;
+    extern template class finger_model<1>;
+    extern template class finger_model<2>;
+    extern template class finger_model<3>;
+    extern template class finger_model<4>;
+    extern template class finger_model<5>;
+
+    // Vector of every link at home: the common normal from joint axis i to the next revolute axis, or to
+    // the fingertip for the last one; zero for prismatic joints and links without length
+    Eigen::Matrix3Xd home_link_vectors(const finger_model<>& finger);
+
 }
 
 #endif // FINGER_MODEL_HPP
\ No newline at end of file
@@ -0,0 +1,122 @@
+#ifndef GEPPETTO_HPP
+#define GEPPETTO_HPP
+
+#include <Eigen/Dense>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "finger_model.hpp"
+
+namespace fm {
+
+    // Geppetto, the finger command language: one command per line, '#' starts a comment.
+    //   joints q1 ... qn   move all joints to the angles (rad)
+    //   joint i q          move joint i
+    //   tip x y z          move the fingertip to a space frame position (m)
+    //   home               move all joints to zero
+    //   duration s         take s seconds for each following move
+    //   wait s             hold for s seconds
+    //   repeat n ... end   run the enclosed lines n times
+    namespace geppetto {
+
+        enum class token_kind : std::uint8_t { word, number, newline, end };
+
+        // Token as a view into the script text; nothing is copied
+        struct token
+        {
+            token_kind kind = token_kind::end;
+            std::string_view text;
+            double value = 0.0;        // Numbers only
+            std::uint32_t line = 1;
+        };
+
+        class lexer
+        {
+        public:
+            explicit lexer(std::string_view text);
+            token next();
+
+        private:
+            std::string_view text;
+            std::size_t position;
+            std::uint32_t line;
+        };
+
+        // Read-only memory mapping of a script file
+        class script_file
+        {
+        public:
+            explicit script_file(const std::string& path);
+            ~script_file();
+            script_file(const script_file&) = delete;
+            script_file& operator=(const script_file&) = delete;
+
+            std::string_view get_text() const;
+
+        private:
+            const char* data;
+            std::size_t size;
+        };
+
+        enum class opcode : std::uint8_t { joints, joint, tip, home, duration, wait, repeat, end_repeat };
+
+        // Fixed width instruction; operand is a constant pool index, a loop count or a jump target
+        struct instruction
+        {
+            opcode op;
+            std::uint8_t reserved;
+            std::uint16_t joint;
+            std::uint32_t operand;
+        };
+
+        struct program
+        {
+            int num_joints = 0;
+            std::vector<instruction> code;
+            std::vector<double> constants;
+            std::vector<std::uint32_t> lines;   // Source line of every instruction, for runtime errors
+        };
+
+        program compile(std::string_view text, int num_joints);
+        program compile_file(const std::string& path, int num_joints);
+
+        // Throws std::invalid_argument unless every operand, constant read and loop jump of the program
+        // is in range for a finger with num_joints joints; run this before executing untrusted bytecode
+        void validate(const program& code, int num_joints);
+
+        // Moves the finger to the target of a joints, joint, tip or home instruction; throws
+        // std::runtime_error with the script line if the target breaks a joint limit or is out of reach
+        void move(finger_model<>& finger, opcode op, std::uint16_t joint, const double* values, double tip_tolerance, std::uint32_t line);
+
+        // Receives the joint angles the finger reaches at each time, starting from its angles at time zero
+        using waypoint_sink = std::function<void(double time, const Eigen::Ref<const Eigen::VectorXd>& joint_angles)>;
+
+        // Runs programs against a finger model, which holds the joint angles between commands
+        class virtual_machine
+        {
+        public:
+            explicit virtual_machine(finger_model<>& finger);
+
+            // Setters and Getters
+            void set_tip_tolerance(double tolerance);
+            double get_time() const;
+            long get_num_waypoints() const;
+
+            // Member functions
+            double run(const program& code, const waypoint_sink& sink);
+
+        private:
+            finger_model<>& finger;
+            double tip_tolerance;
+            double time;
+            long num_waypoints;
+        };
+
+    }
+
+}
+
+#endif // GEPPETTO_HPP
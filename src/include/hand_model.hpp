@@ -0,0 +1,65 @@
+#ifndef HAND_MODEL_HPP
+#define HAND_MODEL_HPP
+
+#include <Eigen/Dense>
+#include "finger_model.hpp"
+
+namespace fm {
+
+    constexpr int max_hand_fingers = 5;
+
+    // Fingers of one hand stored structure-of-arrays, one SIMD lane per finger, in a common palm frame
+    class hand_model
+    {
+    public:
+        // Lane count padded to a whole number of AVX registers of doubles
+        static constexpr int lanes = 8;
+        using lane_array = Eigen::Array<double, lanes, 1>;
+        using jacobian_matrix = Eigen::Matrix<double, 6, Eigen::Dynamic, 0, 6, max_finger_joints>;
+        using joint_vector = Eigen::Matrix<double, Eigen::Dynamic, 1, 0, max_finger_joints, 1>;
+
+        hand_model();
+
+        // Setters and Getters; setters mark the cached kinematics dirty. The non-const getters recompute all
+        // fingers once on demand, the const ones only read and throw if the cache is stale
+        int add_finger(const finger_model<>& finger, const Eigen::Matrix4d& palm_to_base = Eigen::Matrix4d::Identity());
+        void set_joint_angles(int finger, const Eigen::Ref<const Eigen::VectorXd>& joint_angles);
+        void set_joint_angles(const Eigen::Ref<const Eigen::VectorXd>& joint_angles);
+        int get_num_fingers() const;
+        int get_num_joints(int finger) const;
+        int get_num_joints() const;
+        joint_vector get_joint_angles(int finger) const;
+        Eigen::Matrix4d get_fingertip_pose(int finger);
+        Eigen::Matrix4d get_fingertip_pose(int finger) const;
+        Eigen::Vector3d get_fingertip_position(int finger);
+        Eigen::Vector3d get_fingertip_position(int finger) const;
+        jacobian_matrix get_space_jacobian(int finger);
+        jacobian_matrix get_space_jacobian(int finger) const;
+        jacobian_matrix get_body_jacobian(int finger);
+        jacobian_matrix get_body_jacobian(int finger) const;
+
+        // Member functions
+        void update();
+
+    private:
+        void check_finger(int finger) const;
+        void check_cache() const;
+
+        // Screw axes in the palm frame, column 6 * joint + component; padded joints and lanes are zero
+        Eigen::Array<double, lanes, 6 * max_finger_joints> screw_axes;
+        // Home fingertip frames in the palm frame as R (row-major) then p
+        Eigen::Array<double, lanes, 12> home_frames;
+        Eigen::Array<double, lanes, max_finger_joints> joint_angles;
+        int num_fingers;
+        int num_joints[max_hand_fingers];
+        int max_joints;
+
+        // Cached results for every lane, refreshed together
+        Eigen::Array<double, lanes, 6 * max_finger_joints> space_jacobians;
+        Eigen::Array<double, lanes, 12> fingertip_poses;
+        bool dirty;
+    };
+
+}
+
+#endif // HAND_MODEL_HPP
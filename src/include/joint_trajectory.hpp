@@ -0,0 +1,72 @@
+#ifndef JOINT_TRAJECTORY_HPP
+#define JOINT_TRAJECTORY_HPP
+
+#include <Eigen/Dense>
+#include "finger_model.hpp"
+
+namespace fm {
+
+    // Shape of a point to point joint motion that starts and ends at rest
+    enum class profile_type
+    {
+        trapezoidal,   // Constant acceleration, cruise, constant deceleration
+        s_curve,       // Jerk limited double S with seven phases
+        quintic        // Fifth order polynomial with zero end velocity and acceleration
+    };
+
+    // One synchronized motion: every joint follows start + delta s(t / duration) with the same
+    // normalized shape s, so all joints start and finish together
+    struct trajectory_segment
+    {
+        using joint_vector = Eigen::Matrix<double, Eigen::Dynamic, 1, 0, max_finger_joints, 1>;
+
+        profile_type profile = profile_type::quintic;
+        double duration = 0.0;
+        double acceleration_fraction = 0.25;   // Acceleration phase over duration, trapezoidal and S-curve
+        double jerk_fraction = 0.125;          // Jerk phase over duration, S-curve
+        joint_vector start;
+        joint_vector delta;
+    };
+
+    // Plans synchronized joint space segments under per joint velocity, acceleration and jerk limits, and
+    // samples them in batches. Batches are structure of arrays, one column of samples per joint, and every
+    // phase of the shape is evaluated as one vectorized array expression over its samples
+    class trajectory_generator
+    {
+    public:
+        explicit trajectory_generator(int num_joints, profile_type profile = profile_type::quintic);
+
+        // Setters and Getters
+        void set_profile(profile_type profile);
+        void set_velocity_limits(const Eigen::VectorXd& limits);
+        void set_acceleration_limits(const Eigen::VectorXd& limits);
+        void set_jerk_limits(const Eigen::VectorXd& limits);
+        profile_type get_profile() const;
+        int get_num_joints() const;
+        const Eigen::VectorXd& get_velocity_limits() const;
+        const Eigen::VectorXd& get_acceleration_limits() const;
+        const Eigen::VectorXd& get_jerk_limits() const;
+
+        // Member functions
+        trajectory_segment plan(const Eigen::Ref<const Eigen::VectorXd>& start, const Eigen::Ref<const Eigen::VectorXd>& goal,
+                                double min_duration = 0.0) const;
+        static void evaluate(const trajectory_segment& segment, double time, Eigen::Ref<Eigen::VectorXd> position,
+                             Eigen::Ref<Eigen::VectorXd> velocity);
+        static long count_samples(const trajectory_segment& segment, double first_time, double period);
+        static long sample(const trajectory_segment& segment, double first_time, double period, Eigen::Ref<Eigen::MatrixXd> positions);
+        static long sample(const trajectory_segment& segment, double first_time, double period, Eigen::Ref<Eigen::MatrixXd> positions,
+                           Eigen::Ref<Eigen::MatrixXd> velocities);
+
+    private:
+        void check_limits(const Eigen::VectorXd& limits) const;
+
+        int num_joints;
+        profile_type profile;
+        Eigen::VectorXd velocity_limits;
+        Eigen::VectorXd acceleration_limits;
+        Eigen::VectorXd jerk_limits;
+    };
+
+}
+
+#endif // JOINT_TRAJECTORY_HPP
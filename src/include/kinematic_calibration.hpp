@@ -0,0 +1,113 @@
+#ifndef KINEMATIC_CALIBRATION_HPP
+#define KINEMATIC_CALIBRATION_HPP
+
+#include <Eigen/Dense>
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <string>
+#include <vector>
+#include "finger_model.hpp"
+
+namespace fm {
+
+    // Binary log of joint readings paired with measured fingertip positions, written sample by sample
+    // Layout: "FMCALLOG", uint32 version, uint32 joints, then records of n joint readings and x, y, z
+    class calibration_log
+    {
+    public:
+        calibration_log(const std::string& path, int num_joints);
+
+        // Member functions
+        void append(const Eigen::Ref<const Eigen::VectorXd>& joint_readings, const Eigen::Vector3d& position);
+        void flush();
+
+    private:
+        std::ofstream file;
+        int num_joints;
+    };
+
+    // Levenberg-Marquardt calibration of screw axes, encoder offsets, home frame and measurement base frame
+    // from fingertip position measurements; measured = B * prod exp([S_i](theta_i + delta_i)) * M * origin
+    class kinematic_calibration
+    {
+    public:
+        explicit kinematic_calibration(const finger_model<>& nominal);
+
+        // Setters and Getters
+        void set_estimate_encoder_offsets(bool estimate);
+        void set_estimate_screw_axes(bool estimate);
+        void set_estimate_home_frame(bool estimate);
+        void set_estimate_base_frame(bool estimate);
+        void set_base_frame(const Eigen::Matrix4d& base_frame);
+        void set_max_iterations(int max_iterations);
+        void set_tolerance(double tolerance);
+        void set_num_threads(int num_threads);
+        void set_chunk_size(long chunk_size);
+        finger_model<> get_finger_model() const;
+        const Eigen::VectorXd& get_encoder_offsets() const;
+        const Eigen::Matrix4d& get_base_frame() const;
+        double get_initial_rms_error() const;
+        double get_rms_error() const;
+        int get_iterations() const;
+        long get_num_samples() const;
+
+        // Member functions
+        double calibrate(const Eigen::Ref<const Eigen::MatrixXd>& joint_readings, const Eigen::Ref<const Eigen::Matrix3Xd>& positions);
+        double calibrate(const std::string& log_path);
+
+    private:
+        struct parameters
+        {
+            Eigen::VectorXd encoder_offsets;
+            std::vector<Eigen::Matrix<double, 6, 1>> screw_axes;
+            Eigen::Matrix4d home_frame;
+            Eigen::Matrix4d base_frame;
+        };
+
+        // Normal equations J^T J, J^T r and sum of squared residuals over one pass
+        struct normal_equations
+        {
+            Eigen::MatrixXd JtJ;
+            Eigen::VectorXd Jtr;
+            double cost;
+            long samples;
+        };
+
+        // Fills the joint readings (n x k) and positions (3 x k) of the next chunk, returning false at the end
+        using chunk_reader = std::function<bool(Eigen::MatrixXd&, Eigen::Matrix3Xd&)>;
+
+        double run(const std::function<chunk_reader()>& open_pass);
+        void layout();
+        normal_equations pass(const parameters& state, const chunk_reader& read_chunk) const;
+        void accumulate(const parameters& state, const Eigen::MatrixXd& joint_readings, const Eigen::Matrix3Xd& positions,
+                        long begin, long end, normal_equations& result) const;
+        parameters apply(const parameters& state, const Eigen::VectorXd& step) const;
+
+        finger_model<> nominal;
+        parameters estimate;
+        bool estimate_encoder_offsets;
+        bool estimate_screw_axes;
+        bool estimate_home_frame;
+        bool estimate_base_frame;
+        int max_iterations;
+        double tolerance;
+        int num_threads;
+        long chunk_size;
+
+        // Column of each parameter group in the Jacobian, -1 when it is held fixed
+        std::vector<int> offset_columns;
+        std::vector<int> screw_columns;
+        int home_column;
+        int base_column;
+        int num_parameters;
+
+        double initial_rms_error;
+        double rms_error;
+        int iterations;
+        long num_samples;
+    };
+
+}
+
+#endif // KINEMATIC_CALIBRATION_HPP
@@ -0,0 +1,23 @@
+#ifndef KINEMATICS_CODEGEN_HPP
+#define KINEMATICS_CODEGEN_HPP
+
+#include <string>
+#include "finger_model.hpp"
+
+namespace fm {
+
+    // Generated header and source for one finger
+    struct generated_kinematics
+    {
+        std::string header;
+        std::string source;
+        int operation_count; // Arithmetic nodes left after CSE and zero folding, summed over the functions
+    };
+
+    // Emits straight-line FK, Jacobian and J^T F code for a fixed finger into namespace generated_kinematics::<name>,
+    // with the open_chain_kinematics function names specialised to fixed-size arguments
+    generated_kinematics generate_kinematics(const finger_model<>& finger, const std::string& name, const std::string& header_file_name);
+
+}
+
+#endif // KINEMATICS_CODEGEN_HPP
@@ -0,0 +1,142 @@
+#ifndef LANE_KINEMATICS_HPP
+#define LANE_KINEMATICS_HPP
+
+#include <Eigen/Dense>
+
+namespace fm {
+
+    // Rigid transform held as lane arrays, one SIMD lane per finger or configuration, for products of
+    // exponentials where every arithmetic step (including sin and cos) is a packet operation. Screws and
+    // points are given per lane (lane arrays) or shared by all lanes (doubles)
+    template <int Lanes>
+    class lane_transform
+    {
+    public:
+        using lane_array = Eigen::Array<double, Lanes, 1>;
+
+        lane_transform(); // Identity
+
+        // Member functions
+        template <typename Scalar>
+        void adjoint(const Scalar w[3], const Scalar v[3], lane_array w_out[3], lane_array v_out[3]) const;
+        template <typename Scalar>
+        void multiply_exponential(const Scalar w[3], const Scalar v[3], const lane_array& theta);
+        template <typename Scalar>
+        void rotate(const Scalar x[3], lane_array out[3]) const;
+        template <typename Scalar>
+        void transform_point(const Scalar x[3], lane_array out[3]) const;
+
+        lane_array R[3][3];
+        lane_array p[3];
+    };
+
+    template <int Lanes>
+    lane_transform<Lanes>::lane_transform() {
+        for (int r = 0; r < 3; r++) {
+            for (int c = 0; c < 3; c++) {
+                this->R[r][c].setConstant(r == c ? 1.0 : 0.0);
+            }
+            this->p[r].setZero();
+        }
+    }
+
+    /**
+     * @brief Adjoint map of a screw, Ad_T S: w' = R w, v' = p x w' + R v; a space Jacobian column.
+     * @param w Angular part of the screw.
+     * @param v Linear part of the screw.
+     * @param w_out Output angular part.
+     * @param v_out Output linear part.
+     */
+    template <int Lanes>
+    template <typename Scalar>
+    void lane_transform<Lanes>::adjoint(const Scalar w[3], const Scalar v[3], lane_array w_out[3], lane_array v_out[3]) const {
+        lane_array Rv[3];
+        this->rotate(w, w_out);
+        this->rotate(v, Rv);
+        for (int r = 0; r < 3; r++) {
+            const int a = (r + 1) % 3, b = (r + 2) % 3;
+            v_out[r] = this->p[a] * w_out[b] - this->p[b] * w_out[a] + Rv[r];
+        }
+    }
+
+    /**
+     * @brief Post-multiply by the exponential of a screw, T = T e^[S]theta.
+     *
+     * R_j = I + s W + (1 - c) W^2 with W^2 = w w^T - |w|^2 I, and p_j = theta v + (1 - c) W v + (theta - s) W^2 v.
+     * Both hold for a unit w and reduce to a translation theta v for a prismatic screw (w = 0), so a zero
+     * screw acts as the identity.
+     *
+     * @param w Angular part of the screw.
+     * @param v Linear part of the screw.
+     * @param theta Joint angle of every lane.
+     */
+    template <int Lanes>
+    template <typename Scalar>
+    void lane_transform<Lanes>::multiply_exponential(const Scalar w[3], const Scalar v[3], const lane_array& theta) {
+        const lane_array s = theta.sin();
+        const lane_array one_minus_c = 1.0 - theta.cos();
+        const lane_array theta_minus_s = theta - s;
+        const Scalar ww = w[0] * w[0] + w[1] * w[1] + w[2] * w[2];
+
+        lane_array Rj[3][3];
+        for (int r = 0; r < 3; r++) {
+            for (int c = 0; c < 3; c++) {
+                Rj[r][c] = one_minus_c * (w[r] * w[c]);
+            }
+            Rj[r][r] += 1.0 - one_minus_c * ww;
+        }
+        Rj[0][1] -= s * w[2]; Rj[1][0] += s * w[2];
+        Rj[0][2] += s * w[1]; Rj[2][0] -= s * w[1];
+        Rj[1][2] -= s * w[0]; Rj[2][1] += s * w[0];
+
+        const Scalar wv[3] = {w[1] * v[2] - w[2] * v[1], w[2] * v[0] - w[0] * v[2], w[0] * v[1] - w[1] * v[0]};
+        const Scalar wwv[3] = {w[1] * wv[2] - w[2] * wv[1], w[2] * wv[0] - w[0] * wv[2], w[0] * wv[1] - w[1] * wv[0]};
+        lane_array pj[3];
+        for (int r = 0; r < 3; r++) {
+            pj[r] = theta * v[r] + one_minus_c * wv[r] + theta_minus_s * wwv[r];
+        }
+
+        lane_array R_next[3][3];
+        for (int r = 0; r < 3; r++) {
+            for (int c = 0; c < 3; c++) {
+                R_next[r][c] = this->R[r][0] * Rj[0][c] + this->R[r][1] * Rj[1][c] + this->R[r][2] * Rj[2][c];
+            }
+            this->p[r] += this->R[r][0] * pj[0] + this->R[r][1] * pj[1] + this->R[r][2] * pj[2];
+        }
+        for (int r = 0; r < 3; r++) {
+            for (int c = 0; c < 3; c++) {
+                this->R[r][c] = R_next[r][c];
+            }
+        }
+    }
+
+    /**
+     * @brief Rotate a vector, R x.
+     * @param x Vector.
+     * @param out Output rotated vector.
+     */
+    template <int Lanes>
+    template <typename Scalar>
+    void lane_transform<Lanes>::rotate(const Scalar x[3], lane_array out[3]) const {
+        for (int r = 0; r < 3; r++) {
+            out[r] = this->R[r][0] * x[0] + this->R[r][1] * x[1] + this->R[r][2] * x[2];
+        }
+    }
+
+    /**
+     * @brief Transform a point, R x + p.
+     * @param x Point.
+     * @param out Output transformed point.
+     */
+    template <int Lanes>
+    template <typename Scalar>
+    void lane_transform<Lanes>::transform_point(const Scalar x[3], lane_array out[3]) const {
+        this->rotate(x, out);
+        for (int r = 0; r < 3; r++) {
+            out[r] += this->p[r];
+        }
+    }
+
+}
+
+#endif // LANE_KINEMATICS_HPP
@@ -7,11 +7,15 @@
 namespace rigid_body_motion {
     Eigen::MatrixXd VecToso3(const Eigen::VectorXd &omega);
     Eigen::VectorXd so3ToVec(const Eigen::MatrixXd &so3mat);
-    Eigen::MatrixXd Rodriguez(const Eigen::VectorXd &omega, const float &theta);
+    Eigen::MatrixXd Rodriguez(const Eigen::VectorXd &omega, const double &theta);
     Eigen::VectorXd RotationLogarithm (const Eigen::MatrixXd &R);
     Eigen::MatrixXd Adjoint(const Eigen::MatrixXd &T);
-    Eigen::MatrixXd Matrix_Exponential(const Eigen::VectorXd &S, const float &theta);
+    Eigen::MatrixXd Matrix_Exponential(const Eigen::VectorXd &S, const double &theta);
     Eigen::MatrixXd Matrix_Logarithm(const Eigen::MatrixXd &T);
+    Eigen::Matrix4d Screw_Exponential(const Eigen::Matrix<double, 6, 1> &S, double theta);
+    Eigen::Matrix<double, 6, 1> Adjoint_Twist(const Eigen::Matrix4d &T, const Eigen::Matrix<double, 6, 1> &V);
+    Eigen::Matrix<double, 6, 1> Screw_Logarithm(const Eigen::Matrix4d &T);
+    Eigen::Matrix4d Transform_Inverse(const Eigen::Matrix4d &T);
 
 }
 
@@ -20,6 +24,9 @@ namespace open_chain_kinematics {
     Eigen::MatrixXd FKin_Body(const Eigen::MatrixXd M, const std::vector<Eigen::VectorXd> B_list, const Eigen::VectorXd theta_list);
     Eigen::VectorXd IKin_Space(const Eigen::MatrixXd M, const std::vector<Eigen::VectorXd> S_list, const Eigen::MatrixXd T);
     Eigen::VectorXd IKin_Body(const Eigen::MatrixXd M, const std::vector<Eigen::VectorXd> B_list, const Eigen::MatrixXd T);
+    Eigen::MatrixXd Jacobian_Space(const std::vector<Eigen::VectorXd>& S_list, const Eigen::VectorXd& theta_list);
+    Eigen::MatrixXd Jacobian_Body(const std::vector<Eigen::VectorXd>& B_list, const Eigen::VectorXd& theta_list);
+    Eigen::MatrixXd Position_Hessian_Space(const Eigen::MatrixXd& M, const std::vector<Eigen::VectorXd>& S_list, const Eigen::VectorXd& theta_list, const Eigen::Vector3d& force);
 
 } // namespace open_chain_kinematics
 
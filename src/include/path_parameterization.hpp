@@ -0,0 +1,75 @@
+#ifndef PATH_PARAMETERIZATION_HPP
+#define PATH_PARAMETERIZATION_HPP
+
+#include <Eigen/Dense>
+#include <vector>
+#include "finger_model.hpp"
+#include "tendon_transmission_model.hpp"
+
+namespace fm {
+
+    // Motor current limit of the firmware (A)
+    constexpr double default_current_limit = 2.0;
+
+    // Joint torques of the finger's rigid links, tau = M(q) qdd + C(q, qd) qd + g(q), by recursive Newton-Euler in the space frame
+    Eigen::VectorXd inverse_dynamics(const finger_model<>& finger, const Eigen::Ref<const Eigen::VectorXd>& joint_angles,
+                                     const Eigen::Ref<const Eigen::VectorXd>& joint_velocities, const Eigen::Ref<const Eigen::VectorXd>& joint_accelerations,
+                                     const Eigen::Vector3d& gravity);
+
+    // Timing of a path at its grid points; the path parameter s runs from 0 to 1
+    struct path_timing
+    {
+        Eigen::VectorXd times;               // Time at every grid point
+        Eigen::VectorXd path_velocities;     // ds/dt at every grid point
+        Eigen::VectorXd path_accelerations;  // d2s/dt2 from every grid point to the next; the last is zero
+        double duration = 0.0;
+    };
+
+    // Time optimal rest to rest parameterization of a joint path by reachability analysis (TOPP-RA). Joint torques
+    // are affine in (d2s/dt2, (ds/dt)^2) along the path, and the tendons must produce them with tensions between
+    // the minimum tension and the lesser of the maximum tension and the motor current limit, so the torque limits
+    // are the facets of the zonotope R [f_min, f_max]. A backward pass computes the controllable (ds/dt)^2 interval
+    // of every grid point and a forward pass takes the greatest acceleration that stays controllable, each in
+    // constant time per grid point. Capstan friction is not modelled
+    class path_parameterizer
+    {
+    public:
+        path_parameterizer(const finger_model<>& finger, const std::vector<tendon_parameters>& tendons);
+
+        // Setters and Getters
+        void set_current_limit(double current_limit);
+        void set_tension_limits(double min_tension, double max_tension);
+        void set_velocity_limits(const Eigen::VectorXd& velocity_limits);
+        void set_gravity(const Eigen::Vector3d& gravity);
+        int get_num_joints() const;
+        double get_current_limit() const;
+        const Eigen::VectorXd& get_velocity_limits() const;
+        const Eigen::Vector3d& get_gravity() const;
+
+        // Member functions
+        path_timing parameterize(const Eigen::Ref<const Eigen::MatrixXd>& path) const;
+
+    private:
+        // Torque limits n^T tau in [offset - radius, offset + radius]
+        struct torque_facet
+        {
+            Eigen::VectorXd normal;
+            double offset;
+            double radius;
+        };
+
+        std::vector<torque_facet> torque_facets() const;
+
+        finger_model<> finger;
+        Eigen::MatrixXd tendon_routing_matrix;   // Joints x tendons
+        Eigen::VectorXd current_per_tension;     // Spool radius over torque constant (A/N)
+        double current_limit;
+        double min_tension;
+        double max_tension;
+        Eigen::VectorXd velocity_limits;
+        Eigen::Vector3d gravity;
+    };
+
+}
+
+#endif // PATH_PARAMETERIZATION_HPP
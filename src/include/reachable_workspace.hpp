@@ -0,0 +1,67 @@
+#ifndef REACHABLE_WORKSPACE_HPP
+#define REACHABLE_WORKSPACE_HPP
+
+#include <Eigen/Dense>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "configuration_grid.hpp"
+#include "finger_model.hpp"
+
+namespace fm {
+
+    // Reachable fingertip positions as a bitset voxel grid; voxels on the workspace boundary are split
+    // into 2^depth leaves per axis, so a query is at most two bit lookups
+    class reachable_workspace
+    {
+    public:
+        explicit reachable_workspace(const finger_model<>& finger);
+
+        // Setters and Getters
+        void set_voxel_size(double voxel_size);
+        void set_refinement_depth(int depth);
+        double get_voxel_size() const;
+        int get_refinement_depth() const;
+        const Eigen::Vector3d& get_origin() const;
+        const Eigen::Vector3i& get_dimensions() const;
+        long get_num_occupied_voxels() const;
+        long get_num_boundary_voxels() const;
+        long get_num_samples() const;
+
+        // Member functions
+        void build(const configuration_grid& grid, int num_threads = 0);
+        bool reachable(const Eigen::Ref<const Eigen::Vector3d>& position) const;
+        double reachable_volume() const;
+        void fingertip_positions(const Eigen::Ref<const Eigen::MatrixXd>& joint_angles, Eigen::Ref<Eigen::Matrix3Xd> positions) const;
+        void write(const std::string& path) const;
+        void read(const std::string& path);
+
+    private:
+        static void fingertip_positions(const finger_model<>& finger, const Eigen::Ref<const Eigen::MatrixXd>& joint_angles, Eigen::Ref<Eigen::Matrix3Xd> positions);
+        void positions_parallel(const Eigen::MatrixXd& joint_angles, Eigen::Matrix3Xd& positions, int num_threads) const;
+        long voxel_index(const Eigen::Ref<const Eigen::Vector3d>& position, Eigen::Vector3i& cell) const;
+        long leaf_block(long voxel) const;
+        void find_boundary();
+        void index_boundary();
+
+        finger_model<> finger;
+
+        // Settings
+        double voxel_size;
+        int depth;
+
+        // Voxel grid; bit k of the sets is voxel k, x fastest
+        Eigen::Vector3d origin;
+        Eigen::Vector3i dimensions;
+        std::vector<std::uint64_t> occupied;
+        std::vector<std::uint64_t> boundary;
+        // Number of boundary voxels before each word of the boundary set, for constant time rank
+        std::vector<std::uint32_t> boundary_rank;
+        // Leaf bits of the boundary voxels in boundary order, 8^depth bits each rounded up to whole words
+        std::vector<std::uint64_t> leaves;
+        long num_samples;
+    };
+
+}
+
+#endif // REACHABLE_WORKSPACE_HPP
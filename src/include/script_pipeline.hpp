@@ -0,0 +1,134 @@
+#ifndef SCRIPT_PIPELINE_HPP
+#define SCRIPT_PIPELINE_HPP
+
+#include <Eigen/Dense>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <thread>
+#include <vector>
+#include "actuation_map.hpp"
+#include "finger_model.hpp"
+#include "geppetto.hpp"
+#include "joint_trajectory.hpp"
+#include "spsc_ring.hpp"
+
+namespace fm {
+
+    // One sample of the motor stream
+    struct motor_setpoint
+    {
+        double time = 0.0;
+        std::array<double, max_finger_joints> joint_angles{};
+        std::array<double, max_finger_motors> motor_angles{};
+    };
+
+    // Counters of one pipeline stage; service time excludes waiting on either ring
+    struct stage_counters
+    {
+        long items = 0;                  // Input items processed
+        double busy_seconds = 0.0;       // Total service time
+        double max_item_seconds = 0.0;   // Longest service time of one item
+        std::size_t max_input_depth = 0; // Deepest input ring seen at a pop
+        long input_waits = 0;            // Times the stage found its input empty
+        long output_waits = 0;           // Times the stage found its output full (back-pressure)
+    };
+
+    // Runs a Geppetto program as four threads joined by bounded SPSC rings: decode (loops and durations),
+    // inverse kinematics, trajectory sampling of a profile between waypoints at the sample period, and motor
+    // mapping. Full rings stall the stages before them, so the stages run ahead of the motor stream only by
+    // the ring capacity, and a slow solve is absorbed by the samples already queued behind it
+    class script_pipeline
+    {
+    public:
+        static constexpr int decode_stage = 0;
+        static constexpr int ik_stage = 1;
+        static constexpr int trajectory_stage = 2;
+        static constexpr int motor_stage = 3;
+        static constexpr int num_stages = 4;
+
+        explicit script_pipeline(const finger_model<>& finger, std::size_t ring_capacity = 1024);
+        ~script_pipeline();
+        script_pipeline(const script_pipeline&) = delete;
+        script_pipeline& operator=(const script_pipeline&) = delete;
+
+        // Setters and Getters
+        void set_sample_period(double period);
+        void set_tip_tolerance(double tolerance);
+        void set_trajectory(const trajectory_generator& trajectory);
+        double get_sample_period() const;
+        int get_num_motors() const;
+        const trajectory_generator& get_trajectory() const;
+        stage_counters get_counters(int stage) const;
+        std::size_t get_output_depth() const;
+
+        // Member functions
+        void start(const geppetto::program& code);
+        bool pop(motor_setpoint& setpoint);
+        bool finished() const;
+        long stream(const std::function<void(const motor_setpoint&)>& sink, bool real_time = true);
+        void stop();
+
+    private:
+        // Motion or wait with its duration resolved
+        struct command_item
+        {
+            geppetto::opcode op;
+            std::uint16_t joint;
+            std::uint32_t line;
+            double seconds;
+            std::array<double, max_finger_joints> values;
+        };
+        struct joint_item
+        {
+            double time;
+            std::array<double, max_finger_joints> joint_angles;
+        };
+        struct stage_state
+        {
+            std::atomic<long> items{0};
+            std::atomic<double> busy_seconds{0.0};
+            std::atomic<double> max_item_seconds{0.0};
+            std::atomic<std::size_t> max_input_depth{0};
+            std::atomic<long> input_waits{0};
+            std::atomic<long> output_waits{0};
+            std::atomic<bool> done{false};
+            double blocked_seconds = 0.0;   // Output wait of the current item, stage thread only
+        };
+
+        void decode_loop();
+        void ik_loop();
+        void trajectory_loop();
+        void motor_loop();
+        void run_stage(int stage, void (script_pipeline::*loop)());
+        template <typename T>
+        bool push_wait(spsc_ring<T>& ring, const T& item, stage_state& state);
+        template <typename T>
+        bool pop_wait(spsc_ring<T>& ring, T& item, const stage_state& upstream, stage_state& state);
+        void record(stage_state& state, double seconds);
+        void rethrow();
+
+        // Model and settings; the stage threads read them only while running
+        finger_model<> finger;
+        actuation_map actuation;
+        geppetto::program code;
+        double sample_period;
+        double tip_tolerance;
+        trajectory_generator trajectory;
+
+        spsc_ring<command_item> commands;
+        spsc_ring<joint_item> waypoints;
+        spsc_ring<joint_item> samples;
+        spsc_ring<motor_setpoint> setpoints;
+        std::array<stage_state, num_stages> states;
+        std::vector<std::thread> threads;
+        std::atomic<bool> abort;
+        std::atomic<bool> failed;
+        std::exception_ptr error;
+    };
+
+}
+
+#endif // SCRIPT_PIPELINE_HPP
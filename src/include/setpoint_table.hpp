@@ -0,0 +1,54 @@
+#ifndef SETPOINT_TABLE_HPP
+#define SETPOINT_TABLE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include "finger_model.hpp"
+#include "joint_trajectory.hpp"
+
+namespace fm {
+
+    // Key of a compiled script: the script text, the finger model, the trajectory profile and limits, and the sample period
+    std::uint64_t setpoint_table_key(std::string_view script, const finger_model<>& finger, const trajectory_generator& trajectory,
+                                     double sample_period);
+
+    // Returns <cache_directory>/<key>.fsetpt, compiling the script through the script pipeline if it is not cached
+    std::string compile_setpoint_table(const std::string& script_path, const finger_model<>& finger, const trajectory_generator& trajectory,
+                                       const std::string& cache_directory, double sample_period = 1e-3);
+
+    // Read-only memory mapping of a compiled motor setpoint timeline; sample k is at time k times the
+    // sample period and is one row of motor angles followed by joint angles
+    class setpoint_table
+    {
+    public:
+        explicit setpoint_table(const std::string& path);
+        ~setpoint_table();
+        setpoint_table(const setpoint_table&) = delete;
+        setpoint_table& operator=(const setpoint_table&) = delete;
+
+        // Getters
+        std::uint64_t get_key() const;
+        int get_num_joints() const;
+        int get_num_motors() const;
+        long get_num_samples() const;
+        double get_sample_period() const;
+        double get_duration() const;
+        const double* get_motor_angles(long sample) const;
+        const double* get_joint_angles(long sample) const;
+
+        // Member functions
+        void play(const std::function<void(long sample, const double* motor_angles)>& sink, bool real_time = true) const;
+
+    private:
+        const unsigned char* data;
+        std::size_t size;
+        const double* rows;
+        std::size_t stride;
+    };
+
+}
+
+#endif // SETPOINT_TABLE_HPP
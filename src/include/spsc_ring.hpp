@@ -0,0 +1,107 @@
+#ifndef SPSC_RING_HPP
+#define SPSC_RING_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <stdexcept>
+#include <vector>
+
+namespace fm {
+
+    // Bounded lock-free queue between exactly one producer thread and one consumer thread.
+    // Each side owns one index and keeps a cached copy of the other, so a push or pop touches the shared
+    // cache line of the other side only when the cached copy says the ring looks full or empty
+    template <typename T>
+    class spsc_ring
+    {
+    public:
+        explicit spsc_ring(std::size_t capacity);
+        spsc_ring(const spsc_ring&) = delete;
+        spsc_ring& operator=(const spsc_ring&) = delete;
+
+        // Getters
+        std::size_t get_capacity() const;
+        std::size_t size() const;
+
+        // Member functions
+        bool try_push(const T& item);
+        bool try_pop(T& item);
+
+    private:
+        std::vector<T> slots;
+        std::size_t mask;
+
+        alignas(64) std::atomic<std::size_t> head;   // Next slot to pop, written by the consumer
+        std::size_t cached_tail;
+        alignas(64) std::atomic<std::size_t> tail;   // Next slot to push, written by the producer
+        std::size_t cached_head;
+    };
+
+    /**
+     * @brief Constructor for the spsc_ring class.
+     * @param capacity Number of slots, a power of two.
+     */
+    template <typename T>
+    spsc_ring<T>::spsc_ring(std::size_t capacity)
+        : mask(capacity - 1), head(0), cached_tail(0), tail(0), cached_head(0)
+    {
+        if (capacity < 2 || (capacity & (capacity - 1)) != 0) {
+            throw std::invalid_argument("ring capacity must be a power of two of at least 2");
+        }
+        this->slots.resize(capacity);
+    }
+
+    template <typename T>
+    std::size_t spsc_ring<T>::get_capacity() const {
+        return this->slots.size();
+    }
+
+    /**
+     * @brief Number of queued items; exact only when both sides are idle.
+     */
+    template <typename T>
+    std::size_t spsc_ring<T>::size() const {
+        return this->tail.load(std::memory_order_acquire) - this->head.load(std::memory_order_acquire);
+    }
+
+    /**
+     * @brief Append an item; producer thread only.
+     * @param item Item to copy in.
+     * @return False if the ring is full.
+     */
+    template <typename T>
+    bool spsc_ring<T>::try_push(const T& item) {
+        const std::size_t position = this->tail.load(std::memory_order_relaxed);
+        if (position - this->cached_head == this->slots.size()) {
+            this->cached_head = this->head.load(std::memory_order_acquire);
+            if (position - this->cached_head == this->slots.size()) {
+                return false;
+            }
+        }
+        this->slots[position & this->mask] = item;
+        this->tail.store(position + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Remove the oldest item; consumer thread only.
+     * @param item Set to the removed item.
+     * @return False if the ring is empty.
+     */
+    template <typename T>
+    bool spsc_ring<T>::try_pop(T& item) {
+        const std::size_t position = this->head.load(std::memory_order_relaxed);
+        if (position == this->cached_tail) {
+            this->cached_tail = this->tail.load(std::memory_order_acquire);
+            if (position == this->cached_tail) {
+                return false;
+            }
+        }
+        item = this->slots[position & this->mask];
+        this->head.store(position + 1, std::memory_order_release);
+        return true;
+    }
+
+}
+
+#endif // SPSC_RING_HPP
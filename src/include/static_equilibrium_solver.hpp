@@ -0,0 +1,57 @@
+#ifndef STATIC_EQUILIBRIUM_SOLVER_HPP
+#define STATIC_EQUILIBRIUM_SOLVER_HPP
+
+#include <Eigen/Dense>
+#include "finger_model.hpp"
+#include "actuation_map.hpp"
+
+namespace fm {
+
+    class static_equilibrium_solver
+    {
+    public:
+        static_equilibrium_solver(const finger_model<>& finger, const Eigen::VectorXd& tendon_stiffness,
+                                  const Eigen::VectorXd& joint_stiffness, const Eigen::VectorXd& joint_rest_angles);
+
+        // Setters and Getters
+        void set_tolerance(double tolerance);
+        void set_max_iterations(int max_iterations);
+        void set_initial_guess(const Eigen::VectorXd& joint_angles);
+        const Eigen::VectorXd& get_joint_angles() const;
+        const Eigen::VectorXd& get_tendon_tensions() const;
+        int get_iterations() const;
+        bool get_converged() const;
+
+        // Member functions
+        const Eigen::VectorXd& solve(const Eigen::VectorXd& motor_angles, const Eigen::VectorXd& fingertip_wrench);
+        Eigen::MatrixXd solve_grid(const Eigen::MatrixXd& motor_angle_grid, const Eigen::VectorXd& fingertip_wrench, int num_threads = 0) const;
+        double energy(const Eigen::VectorXd& joint_angles, const Eigen::VectorXd& motor_angles, const Eigen::VectorXd& fingertip_wrench) const;
+
+    private:
+        using joint_vector = finger_model<>::joint_vector;
+        using joint_matrix = finger_model<>::joint_matrix;
+        using tendon_vector = Eigen::Matrix<double, Eigen::Dynamic, 1, 0, max_finger_tendons, 1>;
+
+        double evaluate(const joint_vector& joint_angles, const tendon_vector& tendon_commands, const Eigen::VectorXd& fingertip_wrench,
+                        joint_vector* gradient, joint_matrix* hessian) const;
+
+        finger_model<> finger;
+        actuation_map actuation;
+
+        // Elastic elements
+        Eigen::VectorXd tendon_stiffness;
+        Eigen::VectorXd joint_stiffness;
+        Eigen::VectorXd joint_rest_angles;
+
+        // Solver state
+        Eigen::VectorXd joint_angles;
+        Eigen::VectorXd tendon_tensions;
+        double tolerance;
+        int max_iterations;
+        int iterations;
+        bool converged;
+    };
+
+}
+
+#endif // STATIC_EQUILIBRIUM_SOLVER_HPP
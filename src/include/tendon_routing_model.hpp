@@ -0,0 +1,70 @@
+#ifndef TENDON_ROUTING_MODEL_HPP
+#define TENDON_ROUTING_MODEL_HPP
+
+#include <Eigen/Dense>
+#include <vector>
+
+namespace fm {
+
+    // Routing of one tendon across one joint, described in the joint's plane of rotation with the joint axis at the origin
+    struct tendon_joint_routing
+    {
+        enum class type { none, pulley, via_points };
+
+        type kind = type::none;
+        double pulley_radius = 0.0;                             // Signed moment arm of a tendon wrapped on a circular pulley
+        double pulley_wrap_angle = 0.0;                         // Wrap angle on the pulley at zero joint angle
+        Eigen::Vector2d proximal_point = Eigen::Vector2d::Zero(); // Via point fixed to the proximal link
+        Eigen::Vector2d distal_point = Eigen::Vector2d::Zero();   // Via point fixed to the distal link, at zero joint angle
+    };
+
+    class tendon_routing_model
+    {
+    public:
+        tendon_routing_model(int num_joints, int num_tendons);
+
+        // Setters and Getters
+        void set_joint_routing(int joint, int tendon, const tendon_joint_routing& routing);
+        const tendon_joint_routing& get_joint_routing(int joint, int tendon) const;
+        int get_num_joints() const;
+        int get_num_tendons() const;
+        int get_num_intervals(int joint) const;
+        double get_interpolation_error() const;
+
+        // Member functions
+        void compile(const Eigen::VectorXd& joint_min, const Eigen::VectorXd& joint_max, double tolerance = 1e-7);
+        void evaluate(const Eigen::Ref<const Eigen::VectorXd>& joint_angles, Eigen::Ref<Eigen::MatrixXd> routing_matrix,
+                      Eigen::Ref<Eigen::MatrixXd> routing_matrix_derivative) const;
+        Eigen::MatrixXd routing_matrix(const Eigen::Ref<const Eigen::VectorXd>& joint_angles) const;
+        void tendon_excursions(const Eigen::Ref<const Eigen::VectorXd>& joint_angles, Eigen::Ref<Eigen::VectorXd> excursions) const;
+        static void exact_moment_arm(const tendon_joint_routing& routing, double joint_angle, double& moment_arm, double& derivative);
+
+    private:
+        // Per-joint spline table: for every interval and every tendon crossing the joint, cubic coefficients
+        // of the moment arm in the normalized interval coordinate followed by the integrated excursion at the interval start
+        struct joint_table
+        {
+            double joint_min = 0.0;
+            double joint_max = 0.0;
+            double interval = 0.0;
+            double inverse_interval = 0.0;
+            int num_intervals = 0;
+            std::vector<int> tendons;
+            std::vector<double> coefficients;
+            std::vector<double> zero_excursion;
+        };
+
+        void build_table(int joint, int num_intervals);
+        void lookup(const joint_table& table, double joint_angle, int& interval, double& u) const;
+
+        int num_joints;
+        int num_tendons;
+        std::vector<tendon_joint_routing> routing;
+        std::vector<joint_table> tables;
+        double interpolation_error;
+        bool compiled;
+    };
+
+}
+
+#endif // TENDON_ROUTING_MODEL_HPP
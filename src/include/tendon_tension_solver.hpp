@@ -0,0 +1,55 @@
+#ifndef TENDON_TENSION_SOLVER_HPP
+#define TENDON_TENSION_SOLVER_HPP
+
+#include <Eigen/Dense>
+#include <limits>
+
+namespace fm {
+
+    // Problem size limits; all solver workspaces are sized from these so that solve() never allocates
+    constexpr int max_solver_joints = 8;
+    constexpr int max_solver_tendons = 8;
+
+    class tendon_tension_solver
+    {
+    public:
+        using tension_vector = Eigen::Matrix<double, Eigen::Dynamic, 1, 0, max_solver_tendons, 1>;
+        using torque_vector = Eigen::Matrix<double, Eigen::Dynamic, 1, 0, max_solver_joints, 1>;
+        using hessian_matrix = Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, 0, max_solver_tendons, max_solver_tendons>;
+
+        tendon_tension_solver(const Eigen::MatrixXd& tendon_routing_matrix, double min_tension,
+                              double max_tension = std::numeric_limits<double>::infinity(),
+                              double regularization = 1e-8);
+
+        // Setters and Getters
+        void set_tendon_routing_matrix(const Eigen::MatrixXd& tendon_routing_matrix);
+        void set_tension_limits(double min_tension, double max_tension);
+        const tension_vector& get_tensions() const;
+        double get_torque_residual() const;
+        int get_iterations() const;
+
+        // Member functions
+        const tension_vector& solve(const Eigen::Ref<const Eigen::VectorXd>& joint_torques);
+        void reset();
+
+    private:
+        enum class bound : unsigned char { free, lower, upper };
+
+        // Problem data
+        Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, 0, max_solver_joints, max_solver_tendons> routing;
+        hessian_matrix hessian;
+        double min_tension;
+        double max_tension;
+        double regularization;
+
+        // Solution and warm start state
+        tension_vector tensions;
+        bound active_set[max_solver_tendons];
+        bool warm;
+        double torque_residual;
+        int iterations;
+    };
+
+}
+
+#endif // TENDON_TENSION_SOLVER_HPP
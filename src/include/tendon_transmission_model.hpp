@@ -0,0 +1,66 @@
+#ifndef TENDON_TRANSMISSION_MODEL_HPP
+#define TENDON_TRANSMISSION_MODEL_HPP
+
+#include <Eigen/Dense>
+#include <vector>
+#include "tendon_routing_model.hpp"
+
+namespace fm {
+
+    // Physical parameters of one tendon and the motor spool that drives it
+    struct tendon_parameters
+    {
+        double stiffness = 1e4;            // Series stiffness of the tendon (N/m)
+        double friction_coefficient = 0.0; // Capstan friction coefficient at the routing points
+        double spool_radius = 0.005;       // Motor spool radius (m)
+        double torque_constant = 0.05;     // Motor torque constant (Nm/A)
+    };
+
+    // Transmission state of every tendon (rows) at every trajectory sample (columns)
+    struct transmission_effort
+    {
+        Eigen::MatrixXd wrap_angles;     // Total wrap angle between motor and joint (rad)
+        Eigen::MatrixXd joint_tensions;  // Tension delivered at the joints (N)
+        Eigen::MatrixXd motor_tensions;  // Tension required at the motor spool (N)
+        Eigen::MatrixXd tendon_stretch;  // Elastic elongation of the tendon (m)
+        Eigen::MatrixXd motor_currents;  // Motor current (A)
+        Eigen::MatrixXd joint_errors;    // Joint deflection caused by the stretch, one row per joint (rad)
+    };
+
+    class tendon_transmission_model
+    {
+    public:
+        tendon_transmission_model(const Eigen::MatrixXd& tendon_routing_matrix, const std::vector<tendon_parameters>& tendons);
+
+        // Setters and Getters
+        void set_wrap_angles(const Eigen::MatrixXd& wrap_angles);
+        void set_routing_geometry(const tendon_routing_model& routing);
+        void set_velocity_deadband(double velocity_deadband);
+        const Eigen::MatrixXd& get_tendon_routing_matrix() const;
+        const std::vector<tendon_parameters>& get_tendon_parameters() const;
+
+        // Member functions
+        void evaluate(const Eigen::Ref<const Eigen::MatrixXd>& joint_angles, const Eigen::Ref<const Eigen::MatrixXd>& joint_velocities,
+                      const Eigen::Ref<const Eigen::MatrixXd>& joint_tensions, transmission_effort& effort) const;
+        void evaluate_torques(const Eigen::Ref<const Eigen::MatrixXd>& joint_angles, const Eigen::Ref<const Eigen::MatrixXd>& joint_velocities,
+                              const Eigen::Ref<const Eigen::MatrixXd>& joint_torques, double min_tension, transmission_effort& effort) const;
+
+    private:
+        void compute_wrap_angles(const Eigen::Ref<const Eigen::MatrixXd>& joint_angles, Eigen::MatrixXd& wrap_angles) const;
+
+        Eigen::MatrixXd tendon_routing_matrix;   // Joints x tendons
+        Eigen::MatrixXd stretch_to_joint_error;  // Joints x tendons, least squares map of tendon stretch to joint deflection
+        std::vector<tendon_parameters> tendons;
+        Eigen::ArrayXd stiffness;
+        Eigen::ArrayXd friction_coefficient;
+        Eigen::ArrayXd current_per_tension;
+
+        // Routing geometry; when absent the constant wrap angles are used
+        Eigen::MatrixXd wrap_angles;             // Joints x tendons
+        std::vector<tendon_joint_routing> routing_geometry;
+        double velocity_deadband;
+    };
+
+}
+
+#endif // TENDON_TRANSMISSION_MODEL_HPP
@@ -0,0 +1,76 @@
+#ifndef TOLERANCE_ANALYSIS_HPP
+#define TOLERANCE_ANALYSIS_HPP
+
+#include <Eigen/Dense>
+#include <array>
+#include <cstdint>
+#include <vector>
+#include "configuration_grid.hpp"
+#include "finger_model.hpp"
+
+namespace fm {
+
+    // Monte Carlo propagation of link length, joint axis and encoder tolerances to fingertip position error
+    // over a configuration grid; every perturbed finger is drawn from a counter-based random stream keyed
+    // by the seed and its sample index, so results do not depend on the number of threads
+    class tolerance_analysis
+    {
+    public:
+        explicit tolerance_analysis(const finger_model<>& nominal);
+
+        // Setters and Getters
+        void set_link_length_tolerance(const Eigen::VectorXd& standard_deviations);
+        void set_axis_tolerance(double angle_standard_deviation, double position_standard_deviation);
+        void set_encoder_tolerance(const Eigen::VectorXd& standard_deviations);
+        void set_num_samples(long num_samples);
+        void set_seed(std::uint64_t seed);
+        long get_num_samples() const;
+        configuration_grid get_grid() const;
+        const Eigen::VectorXf& get_mean_errors() const;
+        const Eigen::VectorXf& get_rms_errors() const;
+        const Eigen::VectorXf& get_max_errors() const;
+
+        // Member functions
+        finger_model<> sample_finger(long sample) const;
+        void compute(const configuration_grid& grid, int num_threads = 0);
+
+    private:
+        using screw_vector = Eigen::Matrix<double, 6, 1>;
+
+        // One Monte Carlo draw of the finger geometry and encoder biases
+        struct perturbed_finger
+        {
+            std::array<screw_vector, max_finger_joints> screw_axes;
+            Eigen::Matrix4d home_frame;
+            std::array<double, max_finger_joints> offsets;
+            std::array<double, max_finger_joints> cos_offsets;
+            std::array<double, max_finger_joints> sin_offsets;
+        };
+
+        perturbed_finger draw(long sample) const;
+        void evaluate(const configuration_grid& grid, const std::vector<perturbed_finger>& fingers, long begin, long end);
+
+        finger_model<> nominal;
+        std::vector<screw_vector> screw_axes;
+        Eigen::Matrix4d home_frame;
+        Eigen::Matrix3Xd link_directions;   // Unit direction of every link at home, zero when it has no length
+
+        Eigen::VectorXd link_length_tolerance;
+        double axis_angle_tolerance;
+        double axis_position_tolerance;
+        Eigen::VectorXd encoder_tolerance;
+        long num_samples;
+        std::uint64_t seed;
+
+        // Results, one entry per grid point
+        Eigen::VectorXd grid_min;
+        Eigen::VectorXd grid_max;
+        Eigen::VectorXi grid_samples;
+        Eigen::VectorXf mean_errors;
+        Eigen::VectorXf rms_errors;
+        Eigen::VectorXf max_errors;
+    };
+
+}
+
+#endif // TOLERANCE_ANALYSIS_HPP
@@ -0,0 +1,67 @@
+#ifndef WORKSPACE_FORCE_MAP_HPP
+#define WORKSPACE_FORCE_MAP_HPP
+
+#include <Eigen/Dense>
+#include <string>
+#include <vector>
+#include "configuration_grid.hpp"
+#include "finger_model.hpp"
+#include "tendon_tension_solver.hpp"
+
+namespace fm {
+
+    // Maximum fingertip force along a set of directions and Cartesian stiffness at every grid point
+    class workspace_force_map
+    {
+    public:
+        workspace_force_map(const finger_model<>& finger, const Eigen::VectorXd& tendon_stiffness, double min_tension, double max_tension);
+
+        // Setters and Getters
+        void set_joint_stiffness(const Eigen::VectorXd& joint_stiffness, const Eigen::VectorXd& joint_rest_angles);
+        void set_directions(const Eigen::Matrix3Xd& directions);
+        void set_force_tolerance(double force_tolerance);
+        const Eigen::Matrix3Xd& get_directions() const;
+        configuration_grid get_grid() const;
+        const Eigen::MatrixXf& get_positions() const;
+        const Eigen::MatrixXf& get_max_forces() const;
+        const Eigen::MatrixXf& get_stiffness() const;
+        Eigen::Matrix3d get_stiffness(long index) const;
+
+        // Member functions
+        void compute(const configuration_grid& grid, int num_threads = 0);
+        void evaluate(const finger_model<>& finger, const Eigen::Ref<const Eigen::VectorXd>& joint_angles, tendon_tension_solver& solver,
+                      Eigen::Ref<Eigen::Vector3f> position, Eigen::Ref<Eigen::VectorXf> max_forces, Eigen::Ref<Eigen::VectorXf> stiffness) const;
+        void write(const std::string& path) const;
+        void read(const std::string& path);
+
+    private:
+        using jacobian_matrix = Eigen::Matrix<double, 3, Eigen::Dynamic, 0, 3, max_solver_joints>;
+        using joint_vector = Eigen::Matrix<double, Eigen::Dynamic, 1, 0, max_solver_joints, 1>;
+        using joint_matrix = Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, 0, max_solver_joints, max_solver_joints>;
+
+        double max_force(tendon_tension_solver& solver, const joint_vector& spring_torques, const joint_vector& direction_torques) const;
+
+        finger_model<> finger;
+
+        // Elastic elements and limits
+        Eigen::MatrixXd joint_stiffness_matrix;
+        joint_matrix joint_compliance_matrix;
+        Eigen::VectorXd joint_stiffness;
+        Eigen::VectorXd joint_rest_angles;
+        double min_tension;
+        double max_tension;
+        double force_tolerance;
+        Eigen::Matrix3Xd directions;
+
+        // Results, one column per grid point
+        Eigen::VectorXd grid_min;
+        Eigen::VectorXd grid_max;
+        Eigen::VectorXi grid_samples;
+        Eigen::MatrixXf positions;
+        Eigen::MatrixXf max_forces;
+        Eigen::MatrixXf stiffness;   // Upper triangle of K_x as xx, yy, zz, xy, xz, yz
+    };
+
+}
+
+#endif // WORKSPACE_FORCE_MAP_HPP
@@ -0,0 +1,482 @@
+#include "include/joint_trajectory.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+namespace fm {
+
+    namespace {
+
+        // Peak velocity, acceleration and jerk of the quintic over unit time and unit distance
+        const double quintic_velocity = 1.875;
+        const double quintic_acceleration = 5.773502691896258;
+        const double quintic_jerk = 60.0;
+
+        // Coefficients of the normalized shape s(tau) of a segment, tau in [0, 1]
+        struct shape
+        {
+            profile_type profile;
+            double alpha;   // Acceleration phase
+            double beta;    // Jerk phase
+            double A;       // Peak acceleration
+            double V;       // Cruise velocity
+            double J;       // Jerk
+        };
+
+        shape shape_of(const trajectory_segment& segment) {
+            shape f;
+            f.profile = segment.profile;
+            f.alpha = segment.acceleration_fraction;
+            f.beta = segment.jerk_fraction;
+            f.V = 1.0 / (1.0 - f.alpha);
+            f.A = segment.profile == profile_type::s_curve ? f.V / (f.alpha - f.beta) : f.V / f.alpha;
+            f.J = segment.profile == profile_type::s_curve ? f.A / f.beta : 0.0;
+            return f;
+        }
+
+        /**
+         * @brief Normalized shape and its derivative at one point.
+         * @param f Shape.
+         * @param tau Normalized time in [0, 1].
+         * @param s Set to the normalized position.
+         * @param ds Set to the derivative with respect to tau.
+         */
+        void shape_at(const shape& f, double tau, double& s, double& ds) {
+            if (f.profile == profile_type::quintic) {
+                s = tau * tau * tau * (10.0 + tau * (-15.0 + 6.0 * tau));
+                ds = 30.0 * tau * tau * (1.0 - tau) * (1.0 - tau);
+                return;
+            }
+            // Deceleration mirrors acceleration
+            const bool mirrored = tau > 0.5;
+            const double t = mirrored ? 1.0 - tau : tau;
+            if (t >= f.alpha) {
+                s = f.V * (t - 0.5 * f.alpha);
+                ds = f.V;
+            } else if (f.profile == profile_type::trapezoidal) {
+                s = 0.5 * f.A * t * t;
+                ds = f.A * t;
+            } else if (t < f.beta) {
+                s = f.J * t * t * t / 6.0;
+                ds = 0.5 * f.J * t * t;
+            } else if (t < f.alpha - f.beta) {
+                s = f.A * (3.0 * t * t - 3.0 * f.beta * t + f.beta * f.beta) / 6.0;
+                ds = f.A * (t - 0.5 * f.beta);
+            } else {
+                const double u = f.alpha - t;
+                s = 0.5 * f.V * f.alpha - f.V * u + f.J * u * u * u / 6.0;
+                ds = f.V - 0.5 * f.J * u * u;
+            }
+            if (mirrored) {
+                s = 1.0 - s;
+            }
+        }
+
+        /**
+         * @brief Shortest duration of a shape that keeps one joint within its limits.
+         * @param segment Segment with the shape's profile and fractions.
+         * @param distance Absolute joint travel.
+         * @param velocity Velocity limit.
+         * @param acceleration Acceleration limit.
+         * @param jerk Jerk limit.
+         * @return Duration.
+         */
+        double required_duration(const trajectory_segment& segment, double distance, double velocity, double acceleration, double jerk) {
+            if (distance <= 0.0) {
+                return 0.0;
+            }
+            double peak_velocity = quintic_velocity, peak_acceleration = quintic_acceleration, peak_jerk = quintic_jerk;
+            if (segment.profile != profile_type::quintic) {
+                const shape f = shape_of(segment);
+                peak_velocity = f.V;
+                peak_acceleration = f.A;
+                peak_jerk = f.J;
+            }
+            double duration = distance * peak_velocity / velocity;
+            duration = std::max(duration, std::sqrt(distance * peak_acceleration / acceleration));
+            if (peak_jerk > 0.0) {
+                duration = std::max(duration, std::cbrt(distance * peak_jerk / jerk));
+            }
+            return duration;
+        }
+
+        /**
+         * @brief Time optimal trapezoid or double S of one joint.
+         * @param profile Trapezoidal or S-curve.
+         * @param distance Absolute joint travel.
+         * @param velocity Velocity limit.
+         * @param acceleration Acceleration limit.
+         * @param jerk Jerk limit.
+         * @param alpha Set to the acceleration phase fraction.
+         * @param beta Set to the jerk phase fraction.
+         * @return Duration, or zero when the limits do not bound the motion.
+         */
+        double optimal_duration(profile_type profile, double distance, double velocity, double acceleration, double jerk,
+                                double& alpha, double& beta) {
+            if (distance <= 0.0 || !std::isfinite(acceleration)) {
+                return 0.0;
+            }
+            if (profile == profile_type::trapezoidal) {
+                if (distance * acceleration < velocity * velocity) {
+                    alpha = 0.5;
+                    return 2.0 * std::sqrt(distance / acceleration);
+                }
+                const double duration = distance / velocity + velocity / acceleration;
+                alpha = velocity / acceleration / duration;
+                return duration;
+            }
+            if (!std::isfinite(jerk)) {
+                return 0.0;
+            }
+            // Biagiotti and Melchiorri, double S with zero end velocities
+            double Tj, Ta;
+            if (velocity * jerk >= acceleration * acceleration) {
+                Tj = acceleration / jerk;
+                Ta = Tj + velocity / acceleration;
+            } else {
+                Tj = std::sqrt(velocity / jerk);
+                Ta = 2.0 * Tj;
+            }
+            double Tv = distance / velocity - Ta;
+            if (Tv < 0.0) {
+                Tv = 0.0;
+                if (distance >= 2.0 * acceleration * acceleration * acceleration / (jerk * jerk)) {
+                    Tj = acceleration / jerk;
+                    Ta = 0.5 * Tj + std::sqrt(0.25 * Tj * Tj + distance / acceleration);
+                } else {
+                    Tj = std::cbrt(0.5 * distance / jerk);
+                    Ta = 2.0 * Tj;
+                }
+            }
+            const double duration = 2.0 * Ta + Tv;
+            alpha = Ta / duration;
+            beta = std::min(Tj / duration, 0.5 * alpha);
+            return duration;
+        }
+
+        // Index of the first sample at or after tau = boundary, clamped to [0, count]
+        long first_sample_after(double boundary, double duration, double first_time, double period, long count) {
+            const double index = std::ceil((boundary * duration - first_time) / period - 1e-9);
+            return static_cast<long>(std::min<double>(count, std::max(0.0, index)));
+        }
+
+        /**
+         * @brief Normalized shape over the samples of a batch, one vectorized expression per phase.
+         * @param f Shape.
+         * @param duration Segment duration.
+         * @param first_time Segment time of the first sample.
+         * @param period Time between samples.
+         * @param s Set to the normalized positions.
+         * @param ds Set to the derivatives with respect to tau if not null.
+         */
+        template <typename Column>
+        void shape_batch(const shape& f, double duration, double first_time, double period, Column s, Column* ds) {
+            const long count = s.size();
+            const double scale = period / duration;
+            const double offset = first_time / duration;
+            // Calls phase(k0, tau) for the samples with tau in [lower, upper), or up to the end for the last phase
+            auto for_phase = [&](double lower, double upper, bool last, const auto& phase) {
+                const long k0 = first_sample_after(lower, duration, first_time, period, count);
+                const long k1 = last ? count : first_sample_after(upper, duration, first_time, period, count);
+                if (k1 > k0) {
+                    phase(k0, k1 - k0, (Eigen::ArrayXd::LinSpaced(k1 - k0, k0, k1 - 1) * scale + offset).min(1.0));
+                }
+            };
+            auto put = [&](long k0, long n, const auto& position, const auto& velocity) {
+                s.segment(k0, n).array() = position;
+                if (ds) {
+                    ds->segment(k0, n).array() = velocity;
+                }
+            };
+
+            const double A = f.A, V = f.V, J = f.J, a = f.alpha, b = f.beta;
+            if (f.profile == profile_type::quintic) {
+                for_phase(0.0, 1.0, true, [&](long k0, long n, const auto& t) {
+                    put(k0, n, t.cube() * (10.0 + t * (-15.0 + 6.0 * t)), 30.0 * t.square() * (1.0 - t).square());
+                });
+                return;
+            }
+            if (f.profile == profile_type::trapezoidal) {
+                for_phase(0.0, a, false, [&](long k0, long n, const auto& t) {
+                    put(k0, n, 0.5 * A * t.square(), A * t);
+                });
+            } else {
+                for_phase(0.0, b, false, [&](long k0, long n, const auto& t) {
+                    put(k0, n, J / 6.0 * t.cube(), 0.5 * J * t.square());
+                });
+                for_phase(b, a - b, false, [&](long k0, long n, const auto& t) {
+                    put(k0, n, A / 6.0 * (3.0 * t.square() - 3.0 * b * t + b * b), A * (t - 0.5 * b));
+                });
+                for_phase(a - b, a, false, [&](long k0, long n, const auto& t) {
+                    put(k0, n, 0.5 * V * a - V * (a - t) + J / 6.0 * (a - t).cube(), V - 0.5 * J * (a - t).square());
+                });
+            }
+            for_phase(a, 1.0 - a, false, [&](long k0, long n, const auto& t) {
+                put(k0, n, V * (t - 0.5 * a), Eigen::ArrayXd::Constant(n, V));
+            });
+            if (f.profile == profile_type::trapezoidal) {
+                for_phase(1.0 - a, 1.0, true, [&](long k0, long n, const auto& t) {
+                    put(k0, n, 1.0 - 0.5 * A * (1.0 - t).square(), A * (1.0 - t));
+                });
+            } else {
+                // Mirror of the acceleration phases
+                for_phase(1.0 - a, 1.0 - a + b, false, [&](long k0, long n, const auto& t) {
+                    put(k0, n, 1.0 - 0.5 * V * a + V * (t - 1.0 + a) - J / 6.0 * (t - 1.0 + a).cube(), V - 0.5 * J * (t - 1.0 + a).square());
+                });
+                for_phase(1.0 - a + b, 1.0 - b, false, [&](long k0, long n, const auto& t) {
+                    put(k0, n, 1.0 - A / 6.0 * (3.0 * (1.0 - t).square() - 3.0 * b * (1.0 - t) + b * b), A * (1.0 - t - 0.5 * b));
+                });
+                for_phase(1.0 - b, 1.0, true, [&](long k0, long n, const auto& t) {
+                    put(k0, n, 1.0 - J / 6.0 * (1.0 - t).cube(), 0.5 * J * (1.0 - t).square());
+                });
+            }
+        }
+
+        /**
+         * @brief Sample a segment into joint columns.
+         * @param segment Segment.
+         * @param first_time Segment time of the first sample.
+         * @param period Time between samples.
+         * @param positions Samples by joints; filled up to its rows.
+         * @param velocities Same layout, or null.
+         * @return Number of rows written.
+         */
+        long sample_segment(const trajectory_segment& segment, double first_time, double period, Eigen::Ref<Eigen::MatrixXd> positions,
+                            Eigen::Ref<Eigen::MatrixXd>* velocities) {
+            const int n = static_cast<int>(segment.start.size());
+            if (first_time < -1e-9 * period) {
+                throw std::invalid_argument("samples must not start before the segment");
+            }
+            if (positions.cols() != n || (velocities && (velocities->cols() != n || velocities->rows() < positions.rows()))) {
+                throw std::invalid_argument("sample buffers must have one column per joint");
+            }
+            const long count = std::min<long>(trajectory_generator::count_samples(segment, first_time, period), positions.rows());
+            if (count <= 0) {
+                return 0;
+            }
+            // The shape goes into the first column, which is scaled into every joint last
+            auto s = positions.col(0).head(count);
+            if (segment.duration > 0.0) {
+                auto ds = velocities ? velocities->col(0).head(count) : positions.col(0).head(count);
+                shape_batch(shape_of(segment), segment.duration, first_time, period, s, velocities ? &ds : nullptr);
+            } else {
+                s.setOnes();
+                if (velocities) {
+                    velocities->col(0).head(count).setZero();
+                }
+            }
+            const double rate = segment.duration > 0.0 ? 1.0 / segment.duration : 0.0;
+            for (int i = n - 1; i >= 0; i--) {
+                if (velocities) {
+                    velocities->col(i).head(count) = (segment.delta(i) * rate) * velocities->col(0).head(count);
+                }
+                positions.col(i).head(count) = (segment.delta(i) * s.array() + segment.start(i)).matrix();
+            }
+            return count;
+        }
+
+    }
+
+    /**
+     * @brief Constructor for the trajectory_generator class; no limits until set.
+     * @param num_joints Number of joints.
+     * @param profile Shape of the planned segments.
+     */
+    trajectory_generator::trajectory_generator(int num_joints, profile_type profile)
+        : num_joints(num_joints),
+          profile(profile)
+    {
+        if (num_joints < 1 || num_joints > max_finger_joints) {
+            throw std::invalid_argument("number of joints must be between 1 and max_finger_joints");
+        }
+        const double unlimited = std::numeric_limits<double>::infinity();
+        this->velocity_limits = Eigen::VectorXd::Constant(num_joints, unlimited);
+        this->acceleration_limits = Eigen::VectorXd::Constant(num_joints, unlimited);
+        this->jerk_limits = Eigen::VectorXd::Constant(num_joints, unlimited);
+    }
+
+    ////////////////////////////////////////////////////////////
+    // Setter functions
+    ////////////////////////////////////////////////////////////
+
+    void trajectory_generator::set_profile(profile_type profile) {
+        this->profile = profile;
+    }
+
+    /**
+     * @brief Set the joint speed limits.
+     * @param limits Positive limit of every joint, infinity for none.
+     */
+    void trajectory_generator::set_velocity_limits(const Eigen::VectorXd& limits) {
+        this->check_limits(limits);
+        this->velocity_limits = limits;
+    }
+
+    /**
+     * @brief Set the joint acceleration limits.
+     * @param limits Positive limit of every joint, infinity for none.
+     */
+    void trajectory_generator::set_acceleration_limits(const Eigen::VectorXd& limits) {
+        this->check_limits(limits);
+        this->acceleration_limits = limits;
+    }
+
+    /**
+     * @brief Set the joint jerk limits; trapezoidal segments ignore them.
+     * @param limits Positive limit of every joint, infinity for none.
+     */
+    void trajectory_generator::set_jerk_limits(const Eigen::VectorXd& limits) {
+        this->check_limits(limits);
+        this->jerk_limits = limits;
+    }
+
+    ////////////////////////////////////////////////////////////
+    // Getter functions
+    ////////////////////////////////////////////////////////////
+
+    profile_type trajectory_generator::get_profile() const {
+        return this->profile;
+    }
+
+    int trajectory_generator::get_num_joints() const {
+        return this->num_joints;
+    }
+
+    const Eigen::VectorXd& trajectory_generator::get_velocity_limits() const {
+        return this->velocity_limits;
+    }
+
+    const Eigen::VectorXd& trajectory_generator::get_acceleration_limits() const {
+        return this->acceleration_limits;
+    }
+
+    const Eigen::VectorXd& trajectory_generator::get_jerk_limits() const {
+        return this->jerk_limits;
+    }
+
+    ////////////////////////////////////////////////////////////
+    // Member functions
+    ////////////////////////////////////////////////////////////
+
+    /**
+     * @brief Plan a synchronized motion between two joint configurations.
+     *
+     * The joint that needs the longest time optimal motion sets the phase fractions of the shape, and the
+     * duration is the shortest that keeps every joint within its limits with that shape, so the slowest
+     * joint moves time optimally and the others finish with it at lower peaks.
+     *
+     * @param start Start joint angles.
+     * @param goal Goal joint angles.
+     * @param min_duration Lower bound of the duration, e.g. the commanded duration.
+     * @return Segment.
+     */
+    trajectory_segment trajectory_generator::plan(const Eigen::Ref<const Eigen::VectorXd>& start, const Eigen::Ref<const Eigen::VectorXd>& goal,
+                                                  double min_duration) const {
+        if (start.size() != this->num_joints || goal.size() != this->num_joints) {
+            throw std::invalid_argument("start and goal must have one angle per joint");
+        }
+        if (!start.allFinite() || !goal.allFinite() || !(min_duration >= 0.0) || !std::isfinite(min_duration)) {
+            throw std::invalid_argument("start, goal and minimum duration must be finite");
+        }
+        trajectory_segment segment;
+        segment.profile = this->profile;
+        segment.start = start;
+        segment.delta = goal - start;
+
+        if (this->profile != profile_type::quintic) {
+            double slowest = 0.0;
+            for (int i = 0; i < this->num_joints; i++) {
+                double alpha = segment.acceleration_fraction, beta = segment.jerk_fraction;
+                const double duration = optimal_duration(this->profile, std::abs(segment.delta(i)), this->velocity_limits(i),
+                                                         this->acceleration_limits(i), this->jerk_limits(i), alpha, beta);
+                if (duration > slowest) {
+                    slowest = duration;
+                    segment.acceleration_fraction = alpha;
+                    segment.jerk_fraction = beta;
+                }
+            }
+        }
+        segment.duration = min_duration;
+        for (int i = 0; i < this->num_joints; i++) {
+            segment.duration = std::max(segment.duration, required_duration(segment, std::abs(segment.delta(i)), this->velocity_limits(i),
+                                                                             this->acceleration_limits(i), this->jerk_limits(i)));
+        }
+        return segment;
+    }
+
+    /**
+     * @brief Position and velocity of a segment at one time, held at the ends outside it.
+     * @param segment Segment.
+     * @param time Time since the start of the segment.
+     * @param position Set to the joint angles.
+     * @param velocity Set to the joint velocities.
+     */
+    void trajectory_generator::evaluate(const trajectory_segment& segment, double time, Eigen::Ref<Eigen::VectorXd> position,
+                                        Eigen::Ref<Eigen::VectorXd> velocity) {
+        double s = 1.0, ds = 0.0;
+        if (segment.duration > 0.0) {
+            shape_at(shape_of(segment), std::min(1.0, std::max(0.0, time / segment.duration)), s, ds);
+            if (time < 0.0 || time > segment.duration) {
+                ds = 0.0;
+            }
+        }
+        position = segment.start + s * segment.delta;
+        velocity = segment.delta * (segment.duration > 0.0 ? ds / segment.duration : 0.0);
+    }
+
+    /**
+     * @brief Number of samples first_time + k period that fall within a segment.
+     * @param segment Segment.
+     * @param first_time Segment time of the first sample.
+     * @param period Positive time between samples.
+     * @return Count.
+     */
+    long trajectory_generator::count_samples(const trajectory_segment& segment, double first_time, double period) {
+        if (!(period > 0.0)) {
+            throw std::invalid_argument("sample period must be positive");
+        }
+        const double last = std::floor((segment.duration - first_time) / period + 1e-9);
+        return last < 0.0 ? 0 : static_cast<long>(last) + 1;
+    }
+
+    /**
+     * @brief Sample a segment's joint angles in one batch.
+     * @param segment Segment.
+     * @param first_time Segment time of the first sample, not negative.
+     * @param period Positive time between samples.
+     * @param positions Samples by joints, one contiguous column per joint; filled up to its rows.
+     * @return Number of rows written.
+     */
+    long trajectory_generator::sample(const trajectory_segment& segment, double first_time, double period, Eigen::Ref<Eigen::MatrixXd> positions) {
+        return sample_segment(segment, first_time, period, positions, nullptr);
+    }
+
+    /**
+     * @brief Sample a segment's joint angles and velocities in one batch.
+     * @param segment Segment.
+     * @param first_time Segment time of the first sample, not negative.
+     * @param period Positive time between samples.
+     * @param positions Samples by joints, one contiguous column per joint; filled up to its rows.
+     * @param velocities Same layout, at least as many rows.
+     * @return Number of rows written.
+     */
+    long trajectory_generator::sample(const trajectory_segment& segment, double first_time, double period, Eigen::Ref<Eigen::MatrixXd> positions,
+                                      Eigen::Ref<Eigen::MatrixXd> velocities) {
+        return sample_segment(segment, first_time, period, positions, &velocities);
+    }
+
+    ////////////////////////////////////////////////////////////
+    // Private functions
+    ////////////////////////////////////////////////////////////
+
+    void trajectory_generator::check_limits(const Eigen::VectorXd& limits) const {
+        if (limits.size() != this->num_joints) {
+            throw std::invalid_argument("limits must have one entry per joint");
+        }
+        if (!(limits.array() > 0.0).all()) {
+            throw std::invalid_argument("limits must be positive");
+        }
+    }
+
+}
@@ -0,0 +1,598 @@
+#include "include/kinematic_calibration.hpp"
+#include "include/open_chain_kinematics.hpp"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+
+namespace fm {
+
+    namespace {
+
+        const char log_magic[8] = {'F', 'M', 'C', 'A', 'L', 'L', 'O', 'G'};
+        constexpr std::uint32_t log_version = 1;
+
+        // Samples whose Jacobian rows are stacked before each rank update of J^T J
+        constexpr int rows_per_update = 64;
+
+        Eigen::Matrix3d skew(const Eigen::Vector3d& v) {
+            Eigen::Matrix3d m;
+            m << 0, -v(2), v(1),
+                 v(2), 0, -v(0),
+                 -v(1), v(0), 0;
+            return m;
+        }
+
+        /**
+         * @brief Exponential of an arbitrary twist, exp([xi]), through the unit screw exponential.
+         * @param xi Twist (omega, v).
+         * @return 4x4 transformation matrix.
+         */
+        Eigen::Matrix4d twist_exponential(const Eigen::Matrix<double, 6, 1>& xi) {
+            double angle = xi.head<3>().norm();
+            if (angle < 1e-12) {
+                Eigen::Matrix<double, 6, 1> S;
+                S << Eigen::Vector3d::Zero(), xi.tail<3>();
+                return rigid_body_motion::Screw_Exponential(S, 1.0);
+            }
+            return rigid_body_motion::Screw_Exponential(xi / angle, angle);
+        }
+
+        Eigen::Vector3d axis_point(const Eigen::Matrix<double, 6, 1>& S) {
+            // v = -w x q, so w x v is the point of the axis closest to the origin
+            return S.head<3>().cross(S.tail<3>());
+        }
+
+        // Distance between the lines of two revolute screw axes, or from an axis to a point; axes within
+        // about 6 degrees of parallel use the parallel distance, since their common normal is ill-conditioned
+        double line_distance(const Eigen::Matrix<double, 6, 1>& a, const Eigen::Matrix<double, 6, 1>& b) {
+            Eigen::Vector3d d = axis_point(b) - axis_point(a);
+            Eigen::Vector3d normal = a.head<3>().cross(b.head<3>());
+            if (normal.norm() < 0.1) {
+                return d.cross(a.head<3>()).norm();
+            }
+            return std::abs(d.dot(normal)) / normal.norm();
+        }
+
+        double point_distance(const Eigen::Matrix<double, 6, 1>& a, const Eigen::Vector3d& p) {
+            return (p - axis_point(a)).cross(a.head<3>()).norm();
+        }
+
+        bool is_revolute(const Eigen::Matrix<double, 6, 1>& S) {
+            return S.head<3>().norm() > 0.5;
+        }
+
+    }
+
+    ////////////////////////////////////////////////////////////
+    // Calibration log
+    ////////////////////////////////////////////////////////////
+
+    /**
+     * @brief Create a calibration log, truncating any existing file.
+     * @param path Output file path.
+     * @param num_joints Number of joint readings per sample.
+     */
+    calibration_log::calibration_log(const std::string& path, int num_joints)
+        : file(path, std::ios::binary | std::ios::trunc), num_joints(num_joints) {
+        if (num_joints < 1 || num_joints > max_finger_joints) {
+            throw std::invalid_argument("num_joints must be between 1 and max_finger_joints");
+        }
+        if (!this->file) {
+            throw std::runtime_error("could not open " + path + " for writing");
+        }
+        std::uint32_t header[2] = {log_version, static_cast<std::uint32_t>(num_joints)};
+        this->file.write(log_magic, sizeof(log_magic));
+        this->file.write(reinterpret_cast<const char*>(header), sizeof(header));
+    }
+
+    /**
+     * @brief Append one sample.
+     * @param joint_readings Raw joint readings.
+     * @param position Measured fingertip position.
+     */
+    void calibration_log::append(const Eigen::Ref<const Eigen::VectorXd>& joint_readings, const Eigen::Vector3d& position) {
+        if (joint_readings.size() != this->num_joints) {
+            throw std::invalid_argument("joint_readings must have one element per joint");
+        }
+        double record[max_finger_joints + 3];
+        std::memcpy(record, joint_readings.data(), sizeof(double) * this->num_joints);
+        std::memcpy(record + this->num_joints, position.data(), sizeof(double) * 3);
+        this->file.write(reinterpret_cast<const char*>(record), sizeof(double) * (this->num_joints + 3));
+        if (!this->file) {
+            throw std::runtime_error("failed writing calibration log");
+        }
+    }
+
+    /**
+     * @brief Flush buffered samples so the log can be read while it is still open.
+     */
+    void calibration_log::flush() {
+        this->file.flush();
+    }
+
+    ////////////////////////////////////////////////////////////
+    // Constructor
+    ////////////////////////////////////////////////////////////
+
+    /**
+     * @brief Start a calibration from a nominal finger model.
+     *
+     * Encoder offsets, screw axes and the home frame are estimated by default; the base frame relating
+     * the measurement system to the finger's space frame is held at identity unless enabled.
+     *
+     * @param nominal Finger model with space screw axes and home frame set.
+     */
+    kinematic_calibration::kinematic_calibration(const finger_model<>& nominal)
+        : nominal(nominal), estimate_encoder_offsets(true), estimate_screw_axes(true), estimate_home_frame(true),
+          estimate_base_frame(false), max_iterations(50), tolerance(1e-10), num_threads(0), chunk_size(1 << 16),
+          initial_rms_error(0.0), rms_error(0.0), iterations(0), num_samples(0) {
+        const int n = nominal.get_num_joints();
+        this->estimate.encoder_offsets = Eigen::VectorXd::Zero(n);
+        for (int i = 0; i < n; i++) {
+            this->estimate.screw_axes.push_back(nominal.get_home_position_screw_axes_space().col(i));
+        }
+        this->estimate.home_frame = nominal.get_home_position_body_frame();
+        this->estimate.base_frame = Eigen::Matrix4d::Identity();
+    }
+
+    ////////////////////////////////////////////////////////////
+    // Setter functions
+    ////////////////////////////////////////////////////////////
+
+    void kinematic_calibration::set_estimate_encoder_offsets(bool estimate) {
+        this->estimate_encoder_offsets = estimate;
+    }
+
+    void kinematic_calibration::set_estimate_screw_axes(bool estimate) {
+        this->estimate_screw_axes = estimate;
+    }
+
+    void kinematic_calibration::set_estimate_home_frame(bool estimate) {
+        this->estimate_home_frame = estimate;
+    }
+
+    void kinematic_calibration::set_estimate_base_frame(bool estimate) {
+        this->estimate_base_frame = estimate;
+    }
+
+    /**
+     * @brief Set the base frame, the pose of the finger's space frame in the measurement frame.
+     * @param base_frame 4x4 transformation matrix, used as is or as the initial estimate.
+     */
+    void kinematic_calibration::set_base_frame(const Eigen::Matrix4d& base_frame) {
+        this->estimate.base_frame = base_frame;
+    }
+
+    void kinematic_calibration::set_max_iterations(int max_iterations) {
+        if (max_iterations < 1) {
+            throw std::invalid_argument("max_iterations must be positive");
+        }
+        this->max_iterations = max_iterations;
+    }
+
+    /**
+     * @brief Set the convergence tolerance on the relative decrease of the squared error.
+     * @param tolerance Relative tolerance.
+     */
+    void kinematic_calibration::set_tolerance(double tolerance) {
+        if (!(tolerance > 0.0)) {
+            throw std::invalid_argument("tolerance must be positive");
+        }
+        this->tolerance = tolerance;
+    }
+
+    /**
+     * @brief Set the number of threads evaluating residuals, 0 for one per hardware thread.
+     */
+    void kinematic_calibration::set_num_threads(int num_threads) {
+        this->num_threads = num_threads;
+    }
+
+    /**
+     * @brief Set the number of samples held in memory at once when streaming a log.
+     */
+    void kinematic_calibration::set_chunk_size(long chunk_size) {
+        if (chunk_size < 1) {
+            throw std::invalid_argument("chunk_size must be positive");
+        }
+        this->chunk_size = chunk_size;
+    }
+
+    ////////////////////////////////////////////////////////////
+    // Getter functions
+    ////////////////////////////////////////////////////////////
+
+    /**
+     * @brief Corrected finger model that takes raw joint readings.
+     *
+     * Encoder offsets and the base frame are folded into the geometry: with E_i = prod_{j<=i}
+     * exp([S_j] delta_j), the corrected axes are S_i' = Ad_{B E_i} S_i and the home frame is B E_n M,
+     * since exp([S](theta + delta)) = exp([S] delta) exp([S] theta). Joint limits move by -delta so
+     * they bound the same physical angles, and link lengths are recomputed as the distances between
+     * successive joint axes and from the last axis to the fingertip.
+     *
+     * @return Calibrated finger model.
+     */
+    finger_model<> kinematic_calibration::get_finger_model() const {
+        const int n = this->nominal.get_num_joints();
+        const parameters& p = this->estimate;
+        Eigen::Matrix<double, 6, Eigen::Dynamic> S(6, n), B(6, n);
+        Eigen::Matrix4d E = p.base_frame;
+        for (int i = 0; i < n; i++) {
+            E = E * rigid_body_motion::Screw_Exponential(p.screw_axes[i], p.encoder_offsets(i));
+            S.col(i) = rigid_body_motion::Adjoint_Twist(E, p.screw_axes[i]);
+        }
+        Eigen::Matrix4d M = E * p.home_frame;
+        Eigen::Matrix4d M_inv = rigid_body_motion::Transform_Inverse(M);
+        for (int i = 0; i < n; i++) {
+            B.col(i) = rigid_body_motion::Adjoint_Twist(M_inv, S.col(i));
+        }
+
+        Eigen::VectorXd link_lengths = this->nominal.get_link_lengths();
+        for (int i = 0; i < n; i++) {
+            if (!is_revolute(S.col(i))) {
+                continue;
+            }
+            if (i + 1 < n && is_revolute(S.col(i + 1))) {
+                link_lengths(i) = line_distance(S.col(i), S.col(i + 1));
+            } else if (i + 1 == n) {
+                link_lengths(i) = point_distance(S.col(i), M.block<3, 1>(0, 3));
+            }
+        }
+
+        Eigen::VectorXd lower = this->nominal.get_joint_lower_limits();
+        Eigen::VectorXd upper = this->nominal.get_joint_upper_limits();
+        lower -= p.encoder_offsets;
+        upper -= p.encoder_offsets;
+        Eigen::VectorXd angles = (this->nominal.get_joint_angles() - p.encoder_offsets).cwiseMax(lower).cwiseMin(upper);
+
+        finger_model<> finger(this->nominal);
+        finger.set_link_lengths(link_lengths);
+        finger.set_joint_angles(angles);
+        finger.set_home_position_body_frame(M);
+        finger.set_home_position_screw_axes_space(S);
+        finger.set_home_position_screw_axes_body(B);
+        finger.set_joint_limits(lower, upper);
+        return finger;
+    }
+
+    /**
+     * @brief Estimated encoder offsets delta, with true angle = reading + delta.
+     */
+    const Eigen::VectorXd& kinematic_calibration::get_encoder_offsets() const {
+        return this->estimate.encoder_offsets;
+    }
+
+    const Eigen::Matrix4d& kinematic_calibration::get_base_frame() const {
+        return this->estimate.base_frame;
+    }
+
+    /**
+     * @brief RMS fingertip position error of the nominal model on the last calibration data.
+     */
+    double kinematic_calibration::get_initial_rms_error() const {
+        return this->initial_rms_error;
+    }
+
+    /**
+     * @brief RMS fingertip position error of the calibrated model on the last calibration data.
+     */
+    double kinematic_calibration::get_rms_error() const {
+        return this->rms_error;
+    }
+
+    int kinematic_calibration::get_iterations() const {
+        return this->iterations;
+    }
+
+    long kinematic_calibration::get_num_samples() const {
+        return this->num_samples;
+    }
+
+    ////////////////////////////////////////////////////////////
+    // Member functions
+    ////////////////////////////////////////////////////////////
+
+    /**
+     * @brief Calibrate from samples held in memory.
+     * @param joint_readings Raw joint readings, one column per sample.
+     * @param positions Measured fingertip positions in the measurement frame, one column per sample.
+     * @return Final RMS fingertip position error.
+     */
+    double kinematic_calibration::calibrate(const Eigen::Ref<const Eigen::MatrixXd>& joint_readings, const Eigen::Ref<const Eigen::Matrix3Xd>& positions) {
+        if (joint_readings.rows() != this->nominal.get_num_joints()) {
+            throw std::invalid_argument("joint_readings must have one row per joint");
+        }
+        if (joint_readings.cols() != positions.cols()) {
+            throw std::invalid_argument("joint_readings and positions must have one column per sample");
+        }
+        return this->run([this, &joint_readings, &positions]() -> chunk_reader {
+            auto next = std::make_shared<long>(0);
+            return [this, &joint_readings, &positions, next](Eigen::MatrixXd& readings, Eigen::Matrix3Xd& measured) {
+                long count = std::min(this->chunk_size, joint_readings.cols() - *next);
+                if (count <= 0) {
+                    return false;
+                }
+                readings = joint_readings.middleCols(*next, count);
+                measured = positions.middleCols(*next, count);
+                *next += count;
+                return true;
+            };
+        });
+    }
+
+    /**
+     * @brief Calibrate from a calibration log, streamed from disk in chunks on every pass.
+     * @param log_path Log written by calibration_log.
+     * @return Final RMS fingertip position error.
+     */
+    double kinematic_calibration::calibrate(const std::string& log_path) {
+        const int n = this->nominal.get_num_joints();
+        {
+            std::ifstream file(log_path, std::ios::binary);
+            char magic[sizeof(log_magic)];
+            std::uint32_t header[2];
+            file.read(magic, sizeof(magic));
+            file.read(reinterpret_cast<char*>(header), sizeof(header));
+            if (!file || std::memcmp(magic, log_magic, sizeof(magic)) != 0 || header[0] != log_version) {
+                throw std::runtime_error(log_path + " is not a calibration log");
+            }
+            if (header[1] != static_cast<std::uint32_t>(n)) {
+                throw std::runtime_error(log_path + " was recorded for a different number of joints");
+            }
+        }
+        const std::streamoff header_size = sizeof(log_magic) + 2 * sizeof(std::uint32_t);
+
+        return this->run([this, &log_path, n, header_size]() -> chunk_reader {
+            auto file = std::make_shared<std::ifstream>(log_path, std::ios::binary);
+            file->seekg(header_size);
+            auto buffer = std::make_shared<std::vector<double>>();
+            return [this, n, file, buffer](Eigen::MatrixXd& readings, Eigen::Matrix3Xd& measured) {
+                const long record = n + 3;
+                buffer->resize(this->chunk_size * record);
+                file->read(reinterpret_cast<char*>(buffer->data()), sizeof(double) * buffer->size());
+                long count = static_cast<long>(file->gcount() / (sizeof(double) * record));
+                if (count <= 0) {
+                    return false;
+                }
+                Eigen::Map<const Eigen::MatrixXd> records(buffer->data(), record, count);
+                readings = records.topRows(n);
+                measured = records.bottomRows<3>();
+                return true;
+            };
+        });
+    }
+
+    /**
+     * @brief Levenberg-Marquardt iterations over passes through the data.
+     *
+     * Every pass evaluates residuals and analytic Jacobians at the trial parameters and accumulates
+     * the normal equations, so an accepted trial is already linearized for the next step. Steps solve
+     * (J^T J + lambda diag(J^T J)) dx = -J^T r; lambda shrinks after an accepted step and grows after a
+     * rejected one.
+     *
+     * @param open_pass Returns a reader positioned at the start of the data.
+     * @return Final RMS fingertip position error.
+     */
+    double kinematic_calibration::run(const std::function<chunk_reader()>& open_pass) {
+        this->layout();
+        normal_equations current = this->pass(this->estimate, open_pass());
+        if (current.samples * 3 < this->num_parameters) {
+            throw std::invalid_argument("calibration needs at least as many measurements as parameters");
+        }
+        this->num_samples = current.samples;
+        this->initial_rms_error = std::sqrt(current.cost / current.samples);
+        this->iterations = 0;
+
+        double lambda = 1e-3;
+        while (this->iterations < this->max_iterations && current.cost > 0.0 && lambda < 1e12) {
+            Eigen::VectorXd damping = current.JtJ.diagonal().cwiseMax(1e-12 * current.JtJ.diagonal().maxCoeff() + 1e-300);
+            Eigen::MatrixXd A = current.JtJ;
+            A.diagonal() += lambda * damping;
+            Eigen::VectorXd step = A.ldlt().solve(-current.Jtr);
+            this->iterations++;
+
+            parameters trial_state = this->apply(this->estimate, step);
+            normal_equations trial = this->pass(trial_state, open_pass());
+            if (trial.cost < current.cost) {
+                double decrease = (current.cost - trial.cost) / current.cost;
+                this->estimate = trial_state;
+                current = std::move(trial);
+                lambda = std::max(lambda / 3.0, 1e-12);
+                if (decrease < this->tolerance) {
+                    break;
+                }
+            } else {
+                lambda *= 4.0;
+            }
+        }
+        this->rms_error = std::sqrt(current.cost / current.samples);
+        return this->rms_error;
+    }
+
+    /**
+     * @brief Assign Jacobian columns to the parameter groups being estimated.
+     *
+     * Each screw axis gets a 6-vector perturbation xi_i with S_i <- Ad_{exp(xi_i)} S_i, the home frame
+     * eta with M <- exp(eta) M and the base frame beta with B <- exp(beta) B. Perturbations along
+     * directions the data cannot see (e.g. sliding an axis along itself) give zero Jacobian columns,
+     * which the damping keeps at zero.
+     */
+    void kinematic_calibration::layout() {
+        const int n = this->nominal.get_num_joints();
+        int column = 0;
+        this->offset_columns.assign(n, -1);
+        this->screw_columns.assign(n, -1);
+        for (int i = 0; i < n; i++) {
+            if (this->estimate_encoder_offsets) {
+                this->offset_columns[i] = column++;
+            }
+            if (this->estimate_screw_axes) {
+                this->screw_columns[i] = column;
+                column += 6;
+            }
+        }
+        this->home_column = this->estimate_home_frame ? column : -1;
+        column += this->estimate_home_frame ? 6 : 0;
+        this->base_column = this->estimate_base_frame ? column : -1;
+        column += this->estimate_base_frame ? 6 : 0;
+        if (column == 0) {
+            throw std::invalid_argument("no calibration parameters are enabled");
+        }
+        this->num_parameters = column;
+    }
+
+    /**
+     * @brief Accumulate the normal equations over all samples, splitting each chunk across threads.
+     * @param state Parameters to linearize about.
+     * @param read_chunk Reader positioned at the start of the data.
+     * @return Summed normal equations.
+     */
+    kinematic_calibration::normal_equations kinematic_calibration::pass(const parameters& state, const chunk_reader& read_chunk) const {
+        int threads = this->num_threads;
+        if (threads <= 0) {
+            threads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+        }
+        std::vector<normal_equations> partial(threads);
+        for (auto& result : partial) {
+            result.JtJ = Eigen::MatrixXd::Zero(this->num_parameters, this->num_parameters);
+            result.Jtr = Eigen::VectorXd::Zero(this->num_parameters);
+            result.cost = 0.0;
+            result.samples = 0;
+        }
+
+        Eigen::MatrixXd readings;
+        Eigen::Matrix3Xd measured;
+        while (read_chunk(readings, measured)) {
+            const long count = readings.cols();
+            const int used = static_cast<int>(std::max(1L, std::min<long>(threads, count / rows_per_update)));
+            if (used == 1) {
+                this->accumulate(state, readings, measured, 0, count, partial[0]);
+                continue;
+            }
+            std::vector<std::thread> workers;
+            for (int t = 0; t < used; t++) {
+                long begin = count * t / used;
+                long end = count * (t + 1) / used;
+                workers.emplace_back([this, &state, &readings, &measured, begin, end, &partial, t]() {
+                    this->accumulate(state, readings, measured, begin, end, partial[t]);
+                });
+            }
+            for (auto& worker : workers) {
+                worker.join();
+            }
+        }
+
+        normal_equations total = std::move(partial[0]);
+        for (int t = 1; t < threads; t++) {
+            total.JtJ += partial[t].JtJ;
+            total.Jtr += partial[t].Jtr;
+            total.cost += partial[t].cost;
+            total.samples += partial[t].samples;
+        }
+        total.JtJ.triangularView<Eigen::StrictlyLower>() = total.JtJ.transpose();
+        return total;
+    }
+
+    /**
+     * @brief Add the residuals and Jacobian rows of a range of samples to the normal equations.
+     *
+     * With A_i = B prod_{j<i} exp([S_j] phi_j) (R_i, t_i) the transform before joint i, A_i' the one
+     * after it and p the predicted fingertip, the position rows are
+     * - encoder offset: [t_i - p] R_i w_i + R_i v_i, the space Jacobian column
+     * - screw axis: ([t_i - p] R_i - [t_i' - p] R_i', R_i - R_i'), from Ad_{A_i} xi - Ad_{A_i'} xi
+     * - home frame: ([t_n' - p] R_n', R_n')
+     * - base frame: (-[p], I)
+     * Rows are stacked in blocks and added to the upper triangle of J^T J with a rank update.
+     *
+     * @param state Parameters to linearize about.
+     * @param joint_readings Raw joint readings of the chunk.
+     * @param positions Measured positions of the chunk.
+     * @param begin First sample.
+     * @param end One past the last sample.
+     * @param result Normal equations to add to.
+     */
+    void kinematic_calibration::accumulate(const parameters& state, const Eigen::MatrixXd& joint_readings, const Eigen::Matrix3Xd& positions,
+                                           long begin, long end, normal_equations& result) const {
+        const int n = static_cast<int>(state.screw_axes.size());
+        Eigen::MatrixXd J(3 * rows_per_update, this->num_parameters);
+        Eigen::VectorXd r(3 * rows_per_update);
+        std::array<Eigen::Matrix4d, max_finger_joints + 1> A;
+
+        for (long block = begin; block < end; block += rows_per_update) {
+            const int count = static_cast<int>(std::min<long>(rows_per_update, end - block));
+            J.setZero();
+            r.setZero();
+            for (int k = 0; k < count; k++) {
+                const long sample = block + k;
+                A[0] = state.base_frame;
+                for (int i = 0; i < n; i++) {
+                    A[i + 1] = A[i] * rigid_body_motion::Screw_Exponential(state.screw_axes[i], joint_readings(i, sample) + state.encoder_offsets(i));
+                }
+                const Eigen::Vector3d p = A[n].block<3, 3>(0, 0) * state.home_frame.block<3, 1>(0, 3) + A[n].block<3, 1>(0, 3);
+                r.segment<3>(3 * k) = p - positions.col(sample);
+
+                auto rows = J.middleRows<3>(3 * k);
+                Eigen::Matrix3d lever_before = skew(A[0].block<3, 1>(0, 3) - p) * A[0].block<3, 3>(0, 0);
+                for (int i = 0; i < n; i++) {
+                    const Eigen::Matrix3d R = A[i].block<3, 3>(0, 0);
+                    const Eigen::Matrix3d R_after = A[i + 1].block<3, 3>(0, 0);
+                    const Eigen::Matrix3d lever_after = skew(A[i + 1].block<3, 1>(0, 3) - p) * R_after;
+                    if (this->offset_columns[i] >= 0) {
+                        rows.col(this->offset_columns[i]) = lever_before * state.screw_axes[i].head<3>() + R * state.screw_axes[i].tail<3>();
+                    }
+                    if (this->screw_columns[i] >= 0) {
+                        rows.block<3, 3>(0, this->screw_columns[i]) = lever_before - lever_after;
+                        rows.block<3, 3>(0, this->screw_columns[i] + 3) = R - R_after;
+                    }
+                    lever_before = lever_after;
+                }
+                if (this->home_column >= 0) {
+                    rows.block<3, 3>(0, this->home_column) = lever_before;
+                    rows.block<3, 3>(0, this->home_column + 3) = A[n].block<3, 3>(0, 0);
+                }
+                if (this->base_column >= 0) {
+                    rows.block<3, 3>(0, this->base_column) = -skew(p);
+                    rows.block<3, 3>(0, this->base_column + 3).setIdentity();
+                }
+            }
+            result.JtJ.selfadjointView<Eigen::Upper>().rankUpdate(J.transpose());
+            result.Jtr.noalias() += J.transpose() * r;
+            result.cost += r.squaredNorm();
+            result.samples += count;
+        }
+    }
+
+    /**
+     * @brief Apply a parameter step as left perturbations of the screw axes and frames.
+     * @param state Current parameters.
+     * @param step Step in the layout of the Jacobian columns.
+     * @return Updated parameters, with revolute screw axes renormalized to unit rotation.
+     */
+    kinematic_calibration::parameters kinematic_calibration::apply(const parameters& state, const Eigen::VectorXd& step) const {
+        parameters updated = state;
+        for (int i = 0; i < static_cast<int>(state.screw_axes.size()); i++) {
+            if (this->offset_columns[i] >= 0) {
+                updated.encoder_offsets(i) += step(this->offset_columns[i]);
+            }
+            if (this->screw_columns[i] >= 0) {
+                Eigen::Matrix<double, 6, 1> S = rigid_body_motion::Adjoint_Twist(twist_exponential(step.segment<6>(this->screw_columns[i])), state.screw_axes[i]);
+                double w_norm = S.head<3>().norm();
+                updated.screw_axes[i] = is_revolute(S) ? Eigen::Matrix<double, 6, 1>(S / w_norm) : Eigen::Matrix<double, 6, 1>(S / S.tail<3>().norm());
+            }
+        }
+        if (this->home_column >= 0) {
+            updated.home_frame = twist_exponential(step.segment<6>(this->home_column)) * state.home_frame;
+        }
+        if (this->base_column >= 0) {
+            updated.base_frame = twist_exponential(step.segment<6>(this->base_column)) * state.base_frame;
+        }
+        return updated;
+    }
+
+}
@@ -0,0 +1,36 @@
+#include <chrono>
+#include <iostream>
+#include <string>
+#include "include/finger_description.hpp"
+#include "include/kinematic_calibration.hpp"
+
+/**
+ * @brief Calibrate a finger description against a calibration log and write the corrected description.
+ *
+ * Usage: kinematic_calibration_tool <description.yaml> <calibration log> <output.yaml> [--base]
+ * With --base the pose of the measurement frame is estimated as well and folded into the output.
+ */
+int main(int argc, char *argv[]) {
+    if (argc < 4 || argc > 5 || (argc == 5 && std::string(argv[4]) != "--base")) {
+        std::cerr << "usage: " << argv[0] << " <description.yaml> <calibration log> <output.yaml> [--base]" << std::endl;
+        return 2;
+    }
+    try {
+        fm::finger_model<> nominal = fm::load_finger_description(argv[1]);
+        fm::kinematic_calibration calibration(nominal);
+        calibration.set_estimate_base_frame(argc == 5);
+
+        auto start = std::chrono::steady_clock::now();
+        calibration.calibrate(argv[2]);
+        double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        fm::write_finger_description(argv[3], calibration.get_finger_model(), "calibrated");
+        std::cout << calibration.get_num_samples() << " samples, " << calibration.get_iterations() << " iterations in " << elapsed << " s" << std::endl
+                  << "RMS position error " << calibration.get_initial_rms_error() << " -> " << calibration.get_rms_error() << std::endl
+                  << "encoder offsets " << calibration.get_encoder_offsets().transpose() << std::endl;
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
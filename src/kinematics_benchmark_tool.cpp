@@ -0,0 +1,86 @@
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+#include <Eigen/Dense>
+#include "include/finger_description.hpp"
+#include "include/finger_model.hpp"
+#include "include/open_chain_kinematics.hpp"
+#include "index_finger_kinematics.hpp"
+
+namespace generated = generated_kinematics::index_finger;
+
+/**
+ * @brief Time a kinematics evaluation over a batch of joint angles.
+ * @param label Name printed with the result.
+ * @param thetas Joint angle samples.
+ * @param evaluate Function evaluated at each sample, returning a value that is accumulated to keep it live.
+ */
+template <typename F>
+static void time_path(const std::string& label, const std::vector<generated::joint_vector>& thetas, F evaluate) {
+    const int repetitions = 200;
+    double sink = 0.0;
+    auto start = std::chrono::steady_clock::now();
+    for (int r = 0; r < repetitions; r++) {
+        for (const auto& theta : thetas) {
+            sink += evaluate(theta);
+        }
+    }
+    double elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    std::cout << label << ": " << elapsed / (repetitions * thetas.size()) << " ns per call (" << sink << ")" << std::endl;
+}
+
+/**
+ * @brief Compare the generated index finger kinematics with the generic open chain and finger_model paths.
+ *
+ * Usage: kinematics_benchmark_tool [description.yaml], defaulting to the description the code was generated from.
+ */
+int main(int argc, char *argv[]) {
+    std::string description_path = argc > 1 ? argv[1] : "config/index_finger.yaml";
+    fm::finger_model<> dynamic_finger = fm::load_finger_description(description_path);
+    if (dynamic_finger.get_num_joints() != generated::num_joints) {
+        std::cerr << description_path << " does not match the generated index finger" << std::endl;
+        return 1;
+    }
+    fm::finger_model<generated::num_joints> finger(dynamic_finger);
+
+    const Eigen::Matrix4d M = finger.get_home_position_body_frame();
+    std::vector<Eigen::VectorXd> S_list;
+    for (int i = 0; i < generated::num_joints; i++) {
+        S_list.push_back(finger.get_home_position_screw_axes_space().col(i));
+    }
+
+    std::mt19937 generator(1);
+    std::uniform_real_distribution<double> angle(-1.5, 1.5);
+    std::vector<generated::joint_vector> thetas(1000);
+    for (auto& theta : thetas) {
+        for (int i = 0; i < generated::num_joints; i++) {
+            theta(i) = angle(generator);
+        }
+    }
+    generated::wrench_vector wrench;
+    wrench << 0.0, 0.0, 0.01, 1.0, -0.5, 0.2;
+
+    std::cout << "FK and space Jacobian" << std::endl;
+    time_path("  open_chain_kinematics", thetas, [&](const generated::joint_vector& theta) {
+        return open_chain_kinematics::FKin_Space(M, S_list, theta)(0, 3) + open_chain_kinematics::Jacobian_Space(S_list, theta)(3, 1);
+    });
+    time_path("  finger_model", thetas, [&](const generated::joint_vector& theta) {
+        finger.set_joint_angles(theta);
+        return finger.get_fingertip_pose_space()(0, 3) + finger.get_finger_space_jacobian()(3, 1);
+    });
+    time_path("  generated", thetas, [&](const generated::joint_vector& theta) {
+        return generated::FKin_Space(theta)(0, 3) + generated::Jacobian_Space(theta)(3, 1);
+    });
+
+    std::cout << "Body Jacobian transpose times wrench" << std::endl;
+    time_path("  finger_model", thetas, [&](const generated::joint_vector& theta) {
+        finger.set_joint_angles(theta);
+        return (finger.get_finger_body_jacobian().transpose() * wrench)(0);
+    });
+    time_path("  generated", thetas, [&](const generated::joint_vector& theta) {
+        return generated::Jacobian_Transpose_Body(theta, wrench)(0);
+    });
+    return 0;
+}
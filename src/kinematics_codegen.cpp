@@ -0,0 +1,567 @@
+#include "include/kinematics_codegen.hpp"
+#include <Eigen/Dense>
+#include <array>
+#include <cctype>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace fm {
+
+    namespace {
+
+        // Constants this close to 0 or +-1 are snapped so that they fold away
+        const double fold_tolerance = 1e-12;
+
+        enum class op { constant, variable, add, multiply, negate };
+
+        struct node
+        {
+            op kind;
+            double value;
+            int a;
+            int b;
+            std::string name;
+            std::string prologue; // Statement that defines a variable, emitted once if the variable is used
+        };
+
+        // Hash-consed expression DAG: structurally equal subexpressions share one node, and constant,
+        // zero, one and sign cases are folded as nodes are built
+        class expression_graph
+        {
+        public:
+            int constant(double value) {
+                if (std::abs(value) < fold_tolerance) value = 0.0;
+                if (std::abs(value - 1.0) < fold_tolerance) value = 1.0;
+                if (std::abs(value + 1.0) < fold_tolerance) value = -1.0;
+                return this->intern({op::constant, value, -1, -1, "", ""});
+            }
+
+            int variable(const std::string& name, const std::string& prologue = "") {
+                return this->intern({op::variable, 0.0, -1, -1, name, prologue});
+            }
+
+            int add(int a, int b) {
+                if (this->is_constant(a) && this->is_constant(b)) return this->constant(this->nodes[a].value + this->nodes[b].value);
+                if (this->is_constant(a, 0.0)) return b;
+                if (this->is_constant(b, 0.0)) return a;
+                if ((this->nodes[a].kind == op::negate && this->nodes[a].a == b) || (this->nodes[b].kind == op::negate && this->nodes[b].a == a)) {
+                    return this->constant(0.0);
+                }
+                // Constant terms of nested sums are merged, k1 + (k2 + x) = (k1 + k2) + x
+                if (this->is_constant(b)) std::swap(a, b);
+                if (this->is_constant(a) && this->nodes[b].kind == op::add) {
+                    const node& inner = this->nodes[b];
+                    if (this->is_constant(inner.a)) return this->add(this->constant(this->nodes[a].value + this->nodes[inner.a].value), inner.b);
+                    if (this->is_constant(inner.b)) return this->add(this->constant(this->nodes[a].value + this->nodes[inner.b].value), inner.a);
+                }
+                if (a > b) std::swap(a, b);
+                return this->intern({op::add, 0.0, a, b, "", ""});
+            }
+
+            int subtract(int a, int b) {
+                return this->add(a, this->negate(b));
+            }
+
+            int multiply(int a, int b) {
+                if (this->is_constant(b) && !this->is_constant(a)) std::swap(a, b);
+                if (this->is_constant(a)) {
+                    double k = this->nodes[a].value;
+                    if (this->is_constant(b)) return this->constant(k * this->nodes[b].value);
+                    if (k == 0.0) return a;
+                    if (k == 1.0) return b;
+                    if (k == -1.0) return this->negate(b);
+                    if (this->nodes[b].kind == op::negate) return this->multiply(this->constant(-k), this->nodes[b].a);
+                    if (this->nodes[b].kind == op::multiply && this->is_constant(this->nodes[b].a)) {
+                        return this->multiply(this->constant(k * this->nodes[this->nodes[b].a].value), this->nodes[b].b);
+                    }
+                    return this->intern({op::multiply, 0.0, a, b, "", ""});
+                }
+                // Signs are pulled out of products so that -x * y and x * -y share x * y
+                if (this->nodes[a].kind == op::negate) return this->negate(this->multiply(this->nodes[a].a, b));
+                if (this->nodes[b].kind == op::negate) return this->negate(this->multiply(a, this->nodes[b].a));
+                if (a > b) std::swap(a, b);
+                return this->intern({op::multiply, 0.0, a, b, "", ""});
+            }
+
+            int scale(double k, int a) {
+                return this->multiply(this->constant(k), a);
+            }
+
+            int negate(int a) {
+                if (this->is_constant(a)) return this->constant(-this->nodes[a].value);
+                if (this->nodes[a].kind == op::negate) return this->nodes[a].a;
+                if (this->nodes[a].kind == op::multiply && this->is_constant(this->nodes[a].a)) {
+                    return this->multiply(this->constant(-this->nodes[this->nodes[a].a].value), this->nodes[a].b);
+                }
+                return this->intern({op::negate, 0.0, a, -1, "", ""});
+            }
+
+            bool is_constant(int a) const {
+                return this->nodes[a].kind == op::constant;
+            }
+
+            bool is_constant(int a, double value) const {
+                return this->nodes[a].kind == op::constant && this->nodes[a].value == value;
+            }
+
+            const node& at(int a) const {
+                return this->nodes[a];
+            }
+
+            int size() const {
+                return static_cast<int>(this->nodes.size());
+            }
+
+        private:
+            int intern(const node& n) {
+                auto key = std::make_tuple(static_cast<int>(n.kind), n.value, n.a, n.b, n.name);
+                auto found = this->table.find(key);
+                if (found != this->table.end()) {
+                    return found->second;
+                }
+                this->nodes.push_back(n);
+                int id = static_cast<int>(this->nodes.size()) - 1;
+                this->table.emplace(key, id);
+                return id;
+            }
+
+            std::vector<node> nodes;
+            std::map<std::tuple<int, double, int, int, std::string>, int> table;
+        };
+
+        // Symbolic rigid transform, R row-major
+        struct symbolic_transform
+        {
+            std::array<int, 9> R;
+            std::array<int, 3> p;
+        };
+
+        // Symbolic twist (w, v)
+        using symbolic_twist = std::array<int, 6>;
+
+        symbolic_transform constant_transform(expression_graph& g, const Eigen::Matrix4d& T) {
+            symbolic_transform S;
+            for (int r = 0; r < 3; r++) {
+                for (int c = 0; c < 3; c++) {
+                    S.R[3 * r + c] = g.constant(T(r, c));
+                }
+                S.p[r] = g.constant(T(r, 3));
+            }
+            return S;
+        }
+
+        int dot3(expression_graph& g, int a0, int a1, int a2, int b0, int b1, int b2) {
+            return g.add(g.add(g.multiply(a0, b0), g.multiply(a1, b1)), g.multiply(a2, b2));
+        }
+
+        std::array<int, 3> rotate(expression_graph& g, const std::array<int, 9>& R, const std::array<int, 3>& x) {
+            std::array<int, 3> y;
+            for (int r = 0; r < 3; r++) {
+                y[r] = dot3(g, R[3 * r], R[3 * r + 1], R[3 * r + 2], x[0], x[1], x[2]);
+            }
+            return y;
+        }
+
+        std::array<int, 3> cross(expression_graph& g, const std::array<int, 3>& a, const std::array<int, 3>& b) {
+            return {g.subtract(g.multiply(a[1], b[2]), g.multiply(a[2], b[1])),
+                    g.subtract(g.multiply(a[2], b[0]), g.multiply(a[0], b[2])),
+                    g.subtract(g.multiply(a[0], b[1]), g.multiply(a[1], b[0]))};
+        }
+
+        symbolic_transform compose(expression_graph& g, const symbolic_transform& A, const symbolic_transform& B) {
+            symbolic_transform C;
+            for (int r = 0; r < 3; r++) {
+                for (int c = 0; c < 3; c++) {
+                    C.R[3 * r + c] = dot3(g, A.R[3 * r], A.R[3 * r + 1], A.R[3 * r + 2], B.R[c], B.R[3 + c], B.R[6 + c]);
+                }
+            }
+            std::array<int, 3> Ap = rotate(g, A.R, B.p);
+            for (int r = 0; r < 3; r++) {
+                C.p[r] = g.add(Ap[r], A.p[r]);
+            }
+            return C;
+        }
+
+        // Ad_T S for a constant screw S
+        symbolic_twist adjoint(expression_graph& g, const symbolic_transform& T, const Eigen::Matrix<double, 6, 1>& S) {
+            std::array<int, 3> w = {g.constant(S(0)), g.constant(S(1)), g.constant(S(2))};
+            std::array<int, 3> v = {g.constant(S(3)), g.constant(S(4)), g.constant(S(5))};
+            std::array<int, 3> Rw = rotate(g, T.R, w);
+            std::array<int, 3> Rv = rotate(g, T.R, v);
+            std::array<int, 3> pRw = cross(g, T.p, Rw);
+            return {Rw[0], Rw[1], Rw[2], g.add(pRw[0], Rv[0]), g.add(pRw[1], Rv[1]), g.add(pRw[2], Rv[2])};
+        }
+
+        // e^[S] theta_i for a constant screw, or e^-[S] theta_i when inverse is set. R = I + s W + (1 - c) W^2 and
+        // p = (theta I + (1 - c) W + (theta - s) W^2) v are expanded into constant coefficients of 1, s, c and
+        // theta, so axis-aligned joints fold to e.g. R(0, 0) = c and R(2, 2) = 1 exactly.
+        symbolic_transform exponential(expression_graph& g, const Eigen::Matrix<double, 6, 1>& S, int joint, bool inverse) {
+            const std::string index = std::to_string(joint);
+            int theta = g.variable("theta_list(" + index + ")");
+            int s = g.variable("s" + index, "const double s" + index + " = std::sin(theta_list(" + index + "));");
+            int c = g.variable("c" + index, "const double c" + index + " = std::cos(theta_list(" + index + "));");
+            if (inverse) {
+                theta = g.negate(theta);
+                s = g.negate(s);
+            }
+
+            Eigen::Vector3d w = S.head<3>();
+            Eigen::Vector3d v = S.tail<3>();
+            Eigen::Matrix3d W;
+            W << 0, -w(2), w(1),
+                 w(2), 0, -w(0),
+                 -w(1), w(0), 0;
+            Eigen::Matrix3d W2 = W * W;
+            Eigen::Matrix3d R_constant = Eigen::Matrix3d::Identity() + W2;
+            Eigen::Vector3d Wv = W * v;
+            Eigen::Vector3d W2v = W2 * v;
+
+            symbolic_transform T;
+            for (int r = 0; r < 3; r++) {
+                for (int k = 0; k < 3; k++) {
+                    T.R[3 * r + k] = g.add(g.add(g.constant(R_constant(r, k)), g.scale(W(r, k), s)), g.scale(-W2(r, k), c));
+                }
+                T.p[r] = g.add(g.add(g.constant(Wv(r)), g.scale(-Wv(r), c)), g.add(g.scale(-W2v(r), s), g.scale(v(r) + W2v(r), theta)));
+            }
+            return T;
+        }
+
+        // Constants are printed to 15 significant digits, so geometry like 0.103 - 0.046 reads as 0.057
+        std::string format_number(double value) {
+            std::ostringstream out;
+            out.precision(15);
+            out << value;
+            std::string text = out.str();
+            if (text.find_first_of(".e") == std::string::npos) {
+                text += ".0";
+            }
+            return text;
+        }
+
+        // Renders the part of the graph reachable from a set of outputs as straight-line statements; nodes
+        // used more than once become named temporaries, the rest are inlined into their single user
+        class function_emitter
+        {
+        public:
+            function_emitter(const expression_graph& g, const std::vector<std::pair<std::string, int>>& outputs)
+                : g(g), outputs(outputs), reachable(g.size(), false), uses(g.size(), 0), operations(0)
+            {
+                std::vector<int> stack;
+                for (const auto& output : outputs) {
+                    stack.push_back(output.second);
+                    this->uses[output.second]++;
+                }
+                while (!stack.empty()) {
+                    int id = stack.back();
+                    stack.pop_back();
+                    if (this->reachable[id]) continue;
+                    this->reachable[id] = true;
+                    const node& n = g.at(id);
+                    if (n.kind == op::add || n.kind == op::multiply || n.kind == op::negate) {
+                        this->operations++;
+                    }
+                    for (int child : {n.a, n.b}) {
+                        if (child >= 0) {
+                            this->uses[child]++;
+                            stack.push_back(child);
+                        }
+                    }
+                }
+            }
+
+            std::string body() const {
+                std::ostringstream out;
+                for (int id = 0; id < this->g.size(); id++) {
+                    if (this->reachable[id] && !this->g.at(id).prologue.empty()) {
+                        out << "        " << this->g.at(id).prologue << "\n";
+                    }
+                }
+                for (int id = 0; id < this->g.size(); id++) {
+                    if (this->reachable[id] && this->is_temporary(id)) {
+                        out << "        const double t" << id << " = " << this->render_node(id, 0) << ";\n";
+                    }
+                }
+                for (const auto& output : this->outputs) {
+                    out << "        " << output.first << " = " << this->render(output.second, 0) << ";\n";
+                }
+                return out.str();
+            }
+
+            int get_operation_count() const {
+                return this->operations;
+            }
+
+        private:
+            bool is_temporary(int id) const {
+                op kind = this->g.at(id).kind;
+                return this->uses[id] > 1 && (kind == op::add || kind == op::multiply || kind == op::negate);
+            }
+
+            bool is_negative(int id) const {
+                const node& n = this->g.at(id);
+                if (this->is_temporary(id)) {
+                    return false;
+                }
+                return n.kind == op::negate || (n.kind == op::constant && n.value < 0.0) ||
+                       (n.kind == op::multiply && this->g.at(n.a).kind == op::constant && this->g.at(n.a).value < 0.0);
+            }
+
+            // Reference to a node from its parent with the given precedence (0 statement, 1 sum, 2 product, 3 negation)
+            std::string render(int id, int precedence) const {
+                if (this->is_temporary(id)) {
+                    return "t" + std::to_string(id);
+                }
+                return this->render_node(id, precedence);
+            }
+
+            std::string render_node(int id, int precedence) const {
+                const node& n = this->g.at(id);
+                std::string text;
+                int own = 4;
+                switch (n.kind) {
+                    case op::constant:
+                        text = format_number(n.value);
+                        own = n.value < 0.0 ? 3 : 4;
+                        break;
+                    case op::variable:
+                        text = n.name;
+                        break;
+                    case op::add: {
+                        int left = n.a, right = n.b;
+                        if (this->is_negative(left) && !this->is_negative(right)) std::swap(left, right);
+                        if (this->is_negative(right)) {
+                            text = this->render(left, 1) + " - " + this->render_magnitude(right);
+                        } else {
+                            text = this->render(left, 1) + " + " + this->render(right, 1);
+                        }
+                        own = 1;
+                        break;
+                    }
+                    case op::multiply:
+                        text = this->render(n.a, 2) + " * " + this->render(n.b, 2);
+                        own = 2;
+                        break;
+                    case op::negate:
+                        text = "-" + this->render(n.a, 3);
+                        own = 1;
+                        break;
+                }
+                return own < precedence ? "(" + text + ")" : text;
+            }
+
+            // |x| of a negated node, negative constant or negatively scaled product, as the right operand of a subtraction
+            std::string render_magnitude(int id) const {
+                const node& n = this->g.at(id);
+                if (n.kind == op::constant) {
+                    return format_number(-n.value);
+                }
+                if (n.kind == op::multiply) {
+                    return format_number(-this->g.at(n.a).value) + " * " + this->render(n.b, 2);
+                }
+                return this->render(n.a, 2);
+            }
+
+            const expression_graph& g;
+            std::vector<std::pair<std::string, int>> outputs;
+            std::vector<bool> reachable;
+            std::vector<int> uses;
+            int operations;
+        };
+
+    }
+
+    /**
+     * @brief Generate straight-line kinematics code for a fixed finger.
+     *
+     * The chain is expanded into a symbolic expression DAG over sin, cos and the joint angles, with the
+     * geometry as constants. Construction hash-conses every node (common subexpression elimination) and
+     * folds products with 0, +-1 and other constants, so a planar joint, for example, leaves only the
+     * terms of its rotation plane. Each emitted function keeps only the nodes its outputs reach, and
+     * nodes shared within a function are emitted once as temporaries. The generated functions follow
+     * the open_chain_kinematics names (FKin_Space, FKin_Body, Jacobian_Space, Jacobian_Body, IKin_Space,
+     * IKin_Body) with the screws and home frame baked in, plus Jacobian_Transpose_Space/Body for J^T F.
+     *
+     * @param finger Finger with space and body screw axes and home frame set.
+     * @param name C++ identifier used as the namespace generated_kinematics::name.
+     * @param header_file_name File name the generated source includes for its header.
+     * @return Header and source text.
+     */
+    generated_kinematics generate_kinematics(const finger_model<>& finger, const std::string& name, const std::string& header_file_name) {
+        if (name.empty() || std::isdigit(static_cast<unsigned char>(name[0]))) {
+            throw std::invalid_argument("name must be a C++ identifier");
+        }
+        for (char ch : name) {
+            if (!std::isalnum(static_cast<unsigned char>(ch)) && ch != '_') {
+                throw std::invalid_argument("name must be a C++ identifier");
+            }
+        }
+        // Both chains must be complete
+        finger.pose_space(finger.get_joint_angles());
+        finger.pose_body(finger.get_joint_angles());
+
+        const int n = finger.get_num_joints();
+        const Eigen::Matrix4d& M = finger.get_home_position_body_frame();
+        const auto& S_list = finger.get_home_position_screw_axes_space();
+        const auto& B_list = finger.get_home_position_screw_axes_body();
+        for (int i = 0; i < n; i++) {
+            for (const auto& axis : {Eigen::Matrix<double, 6, 1>(S_list.col(i)), Eigen::Matrix<double, 6, 1>(B_list.col(i))}) {
+                double w = axis.head<3>().norm();
+                if (std::abs(w - 1.0) > 1e-9 && (w > 1e-9 || std::abs(axis.tail<3>().norm() - 1.0) > 1e-9)) {
+                    throw std::invalid_argument("generated kinematics need unit screw axes");
+                }
+            }
+        }
+
+        expression_graph g;
+        const char* pose_names[3][4] = {{"T(0, 0)", "T(0, 1)", "T(0, 2)", "T(0, 3)"}, {"T(1, 0)", "T(1, 1)", "T(1, 2)", "T(1, 3)"}, {"T(2, 0)", "T(2, 1)", "T(2, 2)", "T(2, 3)"}};
+        auto pose_outputs = [&pose_names](const symbolic_transform& T) {
+            std::vector<std::pair<std::string, int>> outputs;
+            for (int r = 0; r < 3; r++) {
+                for (int c = 0; c < 3; c++) {
+                    outputs.emplace_back(pose_names[r][c], T.R[3 * r + c]);
+                }
+                outputs.emplace_back(pose_names[r][3], T.p[r]);
+            }
+            return outputs;
+        };
+        auto jacobian_outputs = [n](const std::vector<symbolic_twist>& J) {
+            std::vector<std::pair<std::string, int>> outputs;
+            for (int i = 0; i < n; i++) {
+                for (int k = 0; k < 6; k++) {
+                    outputs.emplace_back("J(" + std::to_string(k) + ", " + std::to_string(i) + ")", J[i][k]);
+                }
+            }
+            return outputs;
+        };
+        auto transpose_outputs = [&g, n](const std::vector<symbolic_twist>& J) {
+            std::vector<std::pair<std::string, int>> outputs;
+            for (int i = 0; i < n; i++) {
+                int tau = g.constant(0.0);
+                for (int k = 0; k < 6; k++) {
+                    tau = g.add(tau, g.multiply(J[i][k], g.variable("wrench(" + std::to_string(k) + ")")));
+                }
+                outputs.emplace_back("tau(" + std::to_string(i) + ")", tau);
+            }
+            return outputs;
+        };
+
+        // Space chain: T = e^[S1]theta1 ... e^[Sn]thetan M, J_s column i = Ad_{e^[S1]theta1 ... e^[Si-1]thetai-1} S_i
+        symbolic_transform T_space = constant_transform(g, Eigen::Matrix4d::Identity());
+        std::vector<symbolic_twist> J_space(n);
+        for (int i = 0; i < n; i++) {
+            J_space[i] = adjoint(g, T_space, S_list.col(i));
+            T_space = compose(g, T_space, exponential(g, S_list.col(i), i, false));
+        }
+        T_space = compose(g, T_space, constant_transform(g, M));
+
+        // Body chain: T = M e^[B1]theta1 ... e^[Bn]thetan, J_b column i = Ad_{e^-[Bn]thetan ... e^-[Bi+1]thetai+1} B_i
+        symbolic_transform T_body = constant_transform(g, M);
+        for (int i = 0; i < n; i++) {
+            T_body = compose(g, T_body, exponential(g, B_list.col(i), i, false));
+        }
+        std::vector<symbolic_twist> J_body(n);
+        symbolic_transform T_tail = constant_transform(g, Eigen::Matrix4d::Identity());
+        for (int i = n - 1; i >= 0; i--) {
+            J_body[i] = adjoint(g, T_tail, B_list.col(i));
+            T_tail = compose(g, T_tail, exponential(g, B_list.col(i), i, true));
+        }
+
+        struct function_spec
+        {
+            const char* declaration;
+            const char* result_declaration;
+            const char* result;
+            std::vector<std::pair<std::string, int>> outputs;
+        };
+        std::vector<function_spec> functions = {
+            {"Eigen::Matrix4d FKin_Space(const joint_vector& theta_list)", "Eigen::Matrix4d T = Eigen::Matrix4d::Identity();", "T", pose_outputs(T_space)},
+            {"Eigen::Matrix4d FKin_Body(const joint_vector& theta_list)", "Eigen::Matrix4d T = Eigen::Matrix4d::Identity();", "T", pose_outputs(T_body)},
+            {"jacobian_matrix Jacobian_Space(const joint_vector& theta_list)", "jacobian_matrix J;", "J", jacobian_outputs(J_space)},
+            {"jacobian_matrix Jacobian_Body(const joint_vector& theta_list)", "jacobian_matrix J;", "J", jacobian_outputs(J_body)},
+            {"joint_vector Jacobian_Transpose_Space(const joint_vector& theta_list, const wrench_vector& wrench)", "joint_vector tau;", "tau", transpose_outputs(J_space)},
+            {"joint_vector Jacobian_Transpose_Body(const joint_vector& theta_list, const wrench_vector& wrench)", "joint_vector tau;", "tau", transpose_outputs(J_body)},
+        };
+
+        generated_kinematics result;
+        result.operation_count = 0;
+        std::string guard = "GENERATED_" + name + "_KINEMATICS_HPP";
+        for (char& ch : guard) {
+            ch = static_cast<char>(std::toupper(static_cast<unsigned char>(ch)));
+        }
+
+        std::ostringstream header;
+        header << "// Generated by kinematics_codegen_tool; do not edit.\n"
+               << "#ifndef " << guard << "\n#define " << guard << "\n\n"
+               << "#include <Eigen/Dense>\n\n"
+               << "namespace generated_kinematics {\n\n"
+               << "    namespace " << name << " {\n\n"
+               << "        constexpr int num_joints = " << n << ";\n"
+               << "        using joint_vector = Eigen::Matrix<double, " << n << ", 1>;\n"
+               << "        using jacobian_matrix = Eigen::Matrix<double, 6, " << n << ">;\n"
+               << "        using wrench_vector = Eigen::Matrix<double, 6, 1>;\n\n";
+        for (const auto& function : functions) {
+            header << "        " << function.declaration << ";\n";
+        }
+        header << "        joint_vector IKin_Space(const Eigen::Matrix4d& T, const joint_vector& theta_guess);\n"
+               << "        joint_vector IKin_Body(const Eigen::Matrix4d& T, const joint_vector& theta_guess);\n\n"
+               << "    }\n\n}\n\n#endif // " << guard << "\n";
+
+        std::ostringstream source;
+        source << "// Generated by kinematics_codegen_tool; do not edit.\n"
+               << "#include \"" << header_file_name << "\"\n"
+               << "#include \"open_chain_kinematics.hpp\"\n"
+               << "#include <cmath>\n\n"
+               << "namespace generated_kinematics {\n\n"
+               << "namespace " << name << " {\n\n";
+        for (const auto& function : functions) {
+            function_emitter emitter(g, function.outputs);
+            result.operation_count += emitter.get_operation_count();
+            source << "    " << function.declaration << " {\n"
+                   << "        // " << emitter.get_operation_count() << " arithmetic operations\n"
+                   << "        " << function.result_declaration << "\n"
+                   << emitter.body()
+                   << "        return " << function.result << ";\n"
+                   << "    }\n\n";
+        }
+
+        // Damped least squares matching finger_model, on the generated pose and Jacobians
+        const char* ik_template =
+            "    joint_vector IKin_%s(const Eigen::Matrix4d& T, const joint_vector& theta_guess) {\n"
+            "        joint_vector theta = theta_guess;\n"
+            "        for (int iter = 0; iter < 100; iter++) {\n"
+            "            Eigen::Matrix4d T_current = FKin_%s(theta);\n"
+            "            Eigen::Matrix<double, 6, 1> V = %s;\n"
+            "            jacobian_matrix J = Jacobian_%s(theta);\n"
+            "            Eigen::Matrix<double, %d, %d> A = J.transpose() * J;\n"
+            "            A.diagonal().array() += 1e-6;\n"
+            "            joint_vector step = A.ldlt().solve(J.transpose() * V);\n"
+            "            theta += step;\n"
+            "            if (step.norm() < 1e-10) {\n"
+            "                break;\n"
+            "            }\n"
+            "        }\n"
+            "        return theta;\n"
+            "    }\n";
+        const char* body_error = "rigid_body_motion::Screw_Logarithm(rigid_body_motion::Transform_Inverse(T_current) * T)";
+        const std::string space_error = std::string("rigid_body_motion::Adjoint_Twist(T_current, ") + body_error + ")";
+        char buffer[2048];
+        std::snprintf(buffer, sizeof(buffer), ik_template, "Space", "Space", space_error.c_str(), "Space", n, n);
+        source << buffer << "\n";
+        std::snprintf(buffer, sizeof(buffer), ik_template, "Body", "Body", body_error, "Body", n, n);
+        source << buffer << "\n";
+        source << "}\n\n}\n";
+
+        result.header = header.str();
+        result.source = source.str();
+        return result;
+    }
+
+}
@@ -0,0 +1,54 @@
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include "include/finger_description.hpp"
+#include "include/kinematics_codegen.hpp"
+
+/**
+ * @brief Write a file only if its contents changed, so unchanged generated code does not trigger rebuilds.
+ * @param path Output file path.
+ * @param text File contents.
+ * @return True if the file was written.
+ */
+static bool write_if_changed(const std::string& path, const std::string& text) {
+    std::ifstream existing(path, std::ios::binary);
+    if (existing) {
+        std::ostringstream current;
+        current << existing.rdbuf();
+        if (current.str() == text) {
+            return false;
+        }
+    }
+    std::ofstream file(path, std::ios::binary);
+    file << text;
+    if (!file) {
+        throw std::runtime_error("failed writing " + path);
+    }
+    return true;
+}
+
+/**
+ * @brief Generate <name>_kinematics.hpp and <name>_kinematics.cpp for a finger description.
+ *
+ * Usage: kinematics_codegen_tool <description.yaml> <name> <output directory>
+ */
+int main(int argc, char *argv[]) {
+    if (argc != 4) {
+        std::cerr << "usage: " << argv[0] << " <description.yaml> <name> <output directory>" << std::endl;
+        return 2;
+    }
+    const std::string name = argv[2];
+    const std::string directory = argv[3];
+    try {
+        fm::finger_model<> finger = fm::load_finger_description(argv[1]);
+        fm::generated_kinematics code = fm::generate_kinematics(finger, name, name + "_kinematics.hpp");
+        write_if_changed(directory + "/" + name + "_kinematics.hpp", code.header);
+        write_if_changed(directory + "/" + name + "_kinematics.cpp", code.source);
+        std::cout << name << ": " << finger.get_num_joints() << " joints, " << code.operation_count << " arithmetic operations" << std::endl;
+    } catch (const std::exception& e) {
+        std::cerr << argv[1] << ": " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
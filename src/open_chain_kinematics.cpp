@@ -1,6 +1,7 @@
 #include <iostream>
 #include <Eigen/Dense>
 #include "include/open_chain_kinematics.hpp"
+#include <algorithm>
 #include <math.h>
 
 namespace rigid_body_motion {
@@ -45,7 +46,7 @@ namespace rigid_body_motion {
      * @param theta The angle of rotation in radians.
      * @return A 3x3 rotation matrix.
      */
-    Eigen::MatrixXd Rodriguez(const Eigen::VectorXd &omega, const float &theta){
+    Eigen::MatrixXd Rodriguez(const Eigen::VectorXd &omega, const double &theta){
         // Implements Rodriguez formula to calculate a rotation matrix from an axis and angle
         assert(omega.size() == 3 && "Input vector must have 3 components");
 
@@ -102,7 +103,7 @@ namespace rigid_body_motion {
      * @param theta The angle of rotation in radians.
      * @return A 4x4 transformation matrix.
      */
-    Eigen::MatrixXd Matrix_Exponential(const Eigen::VectorXd &S, const float &theta){
+    Eigen::MatrixXd Matrix_Exponential(const Eigen::VectorXd &S, const double &theta){
         // Calculates the matrix exponential of a rigid body motion
         assert(S.size() == 6 && "Input vector S must have 6 components");
 
@@ -156,6 +157,91 @@ namespace rigid_body_motion {
 
     }
 
+    /**
+     * @brief Fixed-size matrix exponential of a screw with a unit rotation axis (or a pure translation).
+     * @param S A 6-vector representing the screw axis.
+     * @param theta The joint angle/position.
+     * @return A 4x4 transformation matrix.
+     */
+    Eigen::Matrix4d Screw_Exponential(const Eigen::Matrix<double, 6, 1> &S, double theta){
+        Eigen::Vector3d w = S.head<3>(), v = S.tail<3>();
+        Eigen::Matrix3d W;
+        W << 0, -w(2), w(1),
+             w(2), 0, -w(0),
+             -w(1), w(0), 0;
+        double s = sin(theta), c = cos(theta);
+        Eigen::Matrix3d W2 = W * W;
+
+        Eigen::Matrix4d T = Eigen::Matrix4d::Identity();
+        T.block<3, 3>(0, 0) += s * W + (1 - c) * W2;
+        T.block<3, 1>(0, 3) = theta * v + (1 - c) * (W * v) + (theta - s) * (W2 * v);
+        return T;
+    }
+
+    /**
+     * @brief Fixed-size adjoint map applied to a twist, Ad_T V.
+     * @param T A 4x4 transformation matrix.
+     * @param V A 6-vector twist.
+     * @return The transformed twist.
+     */
+    Eigen::Matrix<double, 6, 1> Adjoint_Twist(const Eigen::Matrix4d &T, const Eigen::Matrix<double, 6, 1> &V){
+        Eigen::Matrix3d R = T.block<3, 3>(0, 0);
+        Eigen::Vector3d p = T.block<3, 1>(0, 3);
+        Eigen::Matrix<double, 6, 1> result;
+        result.head<3>() = R * V.head<3>();
+        result.tail<3>() = p.cross(result.head<3>()) + R * V.tail<3>();
+        return result;
+    }
+
+    /**
+     * @brief Fixed-size matrix logarithm of a rigid body motion, including rotations close to 0 and pi.
+     * @param T A 4x4 transformation matrix.
+     * @return A 6-vector (omega, v) * theta.
+     */
+    Eigen::Matrix<double, 6, 1> Screw_Logarithm(const Eigen::Matrix4d &T){
+        Eigen::Matrix3d R = T.block<3, 3>(0, 0);
+        Eigen::Vector3d p = T.block<3, 1>(0, 3);
+        Eigen::Matrix<double, 6, 1> S;
+
+        double cos_theta = std::min(1.0, std::max(-1.0, (R.trace() - 1) / 2));
+        double theta = acos(cos_theta);
+        if (theta < 1e-9) {
+            S << Eigen::Vector3d::Zero(), p;
+            return S;
+        }
+
+        Eigen::Vector3d omega;
+        if (M_PI - theta < 1e-6) {
+            // (R + I) / 2 = omega omega^T at theta = pi; use its largest column
+            int k = 0;
+            R.diagonal().maxCoeff(&k);
+            omega = (R.col(k) + Eigen::Vector3d::Unit(k)) / sqrt(2 * (1 + R(k, k)));
+        } else {
+            omega << R(2, 1) - R(1, 2), R(0, 2) - R(2, 0), R(1, 0) - R(0, 1);
+            omega /= 2 * sin(theta);
+        }
+
+        Eigen::Matrix3d W;
+        W << 0, -omega(2), omega(1),
+             omega(2), 0, -omega(0),
+             -omega(1), omega(0), 0;
+        Eigen::Matrix3d G_inv = Eigen::Matrix3d::Identity() / theta - W / 2 + (1 / theta - 0.5 / tan(theta / 2)) * W * W;
+        S << omega * theta, G_inv * p * theta;
+        return S;
+    }
+
+    /**
+     * @brief Fixed-size inverse of a transformation matrix using its rotation transpose.
+     * @param T A 4x4 transformation matrix.
+     * @return The inverse transformation.
+     */
+    Eigen::Matrix4d Transform_Inverse(const Eigen::Matrix4d &T){
+        Eigen::Matrix4d T_inv = Eigen::Matrix4d::Identity();
+        T_inv.block<3, 3>(0, 0) = T.block<3, 3>(0, 0).transpose();
+        T_inv.block<3, 1>(0, 3) = -T_inv.block<3, 3>(0, 0) * T.block<3, 1>(0, 3);
+        return T_inv;
+    }
+
 }
 
 namespace open_chain_kinematics {
@@ -179,7 +265,7 @@ namespace open_chain_kinematics {
 
         // Product of exponentials formula
         Eigen::MatrixXd T = Eigen::MatrixXd::Identity(4, 4);
-        for (int i = 0; i < S_list.size(); i++) {
+        for (std::size_t i = 0; i < S_list.size(); i++) {
             T = T * rigid_body_motion::Matrix_Exponential(S_list[i], theta_list(i));
         }
 
@@ -316,4 +402,85 @@ namespace open_chain_kinematics {
 
     }
 
+    /**
+     * @brief Space Jacobian of an open chain.
+     * @param S_list A list of screw axes in the space frame.
+     * @param theta_list A list of joint angles/positions.
+     * @return The 6xn space Jacobian; column i is screw axis i expressed at the current configuration.
+     */
+    Eigen::MatrixXd Jacobian_Space(const std::vector<Eigen::VectorXd>& S_list, const Eigen::VectorXd& theta_list) {
+        assert(static_cast<Eigen::Index>(S_list.size()) == theta_list.size() && "S_list and theta_list must have the same size");
+
+        Eigen::MatrixXd J(6, S_list.size());
+        Eigen::MatrixXd T = Eigen::MatrixXd::Identity(4, 4);
+        for (std::size_t i = 0; i < S_list.size(); i++) {
+            if (i > 0) {
+                T = T * rigid_body_motion::Matrix_Exponential(S_list[i - 1], theta_list(i - 1));
+            }
+            J.col(i) = rigid_body_motion::Adjoint(T) * S_list[i];
+        }
+
+        return J;
+    }
+
+    /**
+     * @brief Body Jacobian of an open chain.
+     * @param B_list A list of screw axes in the body frame.
+     * @param theta_list A list of joint angles/positions.
+     * @return The 6xn body Jacobian.
+     */
+    Eigen::MatrixXd Jacobian_Body(const std::vector<Eigen::VectorXd>& B_list, const Eigen::VectorXd& theta_list) {
+        assert(static_cast<Eigen::Index>(B_list.size()) == theta_list.size() && "B_list and theta_list must have the same size");
+
+        const int n = B_list.size();
+        Eigen::MatrixXd J(6, n);
+        Eigen::MatrixXd T = Eigen::MatrixXd::Identity(4, 4);
+        for (int i = n - 1; i >= 0; i--) {
+            if (i < n - 1) {
+                T = T * rigid_body_motion::Matrix_Exponential(B_list[i + 1], -theta_list(i + 1));
+            }
+            J.col(i) = rigid_body_motion::Adjoint(T) * B_list[i];
+        }
+
+        return J;
+    }
+
+    /**
+     * @brief Second derivative of the end-effector position projected on a force, sum_k f_k d2p_k / dtheta_i dtheta_j.
+     *
+     * The end-effector point moves with dp/dtheta_i = v_i + w_i x p, where (w_i, v_i) is column i of the space
+     * Jacobian. Space Jacobian columns only depend on earlier joints, dJ_i/dtheta_j = ad_{J_j} J_i for j < i,
+     * which gives the Hessian in closed form. It is the stiffness contributed by a constant fingertip force.
+     *
+     * @param M The home configuration of the end-effector.
+     * @param S_list A list of screw axes in the space frame.
+     * @param theta_list A list of joint angles/positions.
+     * @param force Force applied at the end-effector, in the space frame.
+     * @return The symmetric nxn Hessian.
+     */
+    Eigen::MatrixXd Position_Hessian_Space(const Eigen::MatrixXd& M, const std::vector<Eigen::VectorXd>& S_list, const Eigen::VectorXd& theta_list, const Eigen::Vector3d& force) {
+        const int n = S_list.size();
+        Eigen::MatrixXd J = Jacobian_Space(S_list, theta_list);
+        Eigen::Vector3d p = FKin_Space(M, S_list, theta_list).block<3, 1>(0, 3);
+
+        Eigen::MatrixXd H = Eigen::MatrixXd::Zero(n, n);
+        for (int i = 0; i < n; i++) {
+            Eigen::Vector3d w_i = J.block<3, 1>(0, i), v_i = J.block<3, 1>(3, i);
+            for (int j = 0; j <= i; j++) {
+                Eigen::Vector3d w_j = J.block<3, 1>(0, j), v_j = J.block<3, 1>(3, j);
+                Eigen::Vector3d p_dot_j = v_j + w_j.cross(p);
+
+                // d(v_i + w_i x p)/dtheta_j, with the ad term only present for earlier joints
+                Eigen::Vector3d d = w_i.cross(p_dot_j);
+                if (j < i) {
+                    d += w_j.cross(v_i) + v_j.cross(w_i) + w_j.cross(w_i).cross(p);
+                }
+                H(i, j) = force.dot(d);
+                H(j, i) = H(i, j);
+            }
+        }
+
+        return H;
+    }
+
 } // namespace open_chain_kinematics
\ No newline at end of file
@@ -0,0 +1,449 @@
+#include "include/path_parameterization.hpp"
+#include "include/open_chain_kinematics.hpp"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <string>
+
+namespace fm {
+
+    namespace {
+
+        using twist = Eigen::Matrix<double, 6, 1>;
+        using spatial_matrix = Eigen::Matrix<double, 6, 6>;
+
+        // One linear constraint u du + x dx <= bound on (d2s/dt2, (ds/dt)^2)
+        struct path_constraint
+        {
+            double u;
+            double x;
+            double bound;
+        };
+
+        spatial_matrix adjoint(const Eigen::Matrix4d& T) {
+            const Eigen::Matrix3d R = T.block<3, 3>(0, 0);
+            const Eigen::Vector3d p = T.block<3, 1>(0, 3);
+            Eigen::Matrix3d P;
+            P << 0, -p(2), p(1),
+                 p(2), 0, -p(0),
+                 -p(1), p(0), 0;
+            spatial_matrix A = spatial_matrix::Zero();
+            A.topLeftCorner<3, 3>() = R;
+            A.bottomRightCorner<3, 3>() = R;
+            A.bottomLeftCorner<3, 3>() = P * R;
+            return A;
+        }
+
+        // Lie bracket [ad_V] X
+        twist bracket(const twist& V, const twist& X) {
+            twist result;
+            result.head<3>() = V.head<3>().cross(X.head<3>());
+            result.tail<3>() = V.tail<3>().cross(X.head<3>()) + V.head<3>().cross(X.tail<3>());
+            return result;
+        }
+
+        // Dual of the bracket, [ad_V]^T F
+        twist bracket_transpose(const twist& V, const twist& F) {
+            twist result;
+            result.head<3>() = -V.head<3>().cross(F.head<3>()) - V.tail<3>().cross(F.tail<3>());
+            result.tail<3>() = -V.head<3>().cross(F.tail<3>());
+            return result;
+        }
+
+        /**
+         * @brief Interval of x over which some u satisfies every constraint, by eliminating u.
+         *
+         * Every pair of a lower and an upper bound on u gives one bound on x, so the cost is quadratic in
+         * the number of constraints and independent of the path length.
+         *
+         * @param constraints Constraints.
+         * @param lower Lower bound on x; raised to the interval's start.
+         * @param upper Upper bound on x; lowered to the interval's end.
+         * @param lowers Scratch for the lower bounds on u.
+         * @param uppers Scratch for the upper bounds on u.
+         * @return Whether the interval is not empty.
+         */
+        bool feasible_interval(const std::vector<path_constraint>& constraints, double& lower, double& upper,
+                               std::vector<Eigen::Vector2d>& lowers, std::vector<Eigen::Vector2d>& uppers) {
+            lowers.clear();
+            uppers.clear();
+            auto bound_x = [&](double dx, double bound) {
+                if (dx > 1e-12) {
+                    upper = std::min(upper, bound / dx);
+                } else if (dx < -1e-12) {
+                    lower = std::max(lower, bound / dx);
+                } else if (bound < -1e-9) {
+                    upper = -std::numeric_limits<double>::infinity();
+                }
+            };
+            for (const path_constraint& c : constraints) {
+                const double scale = std::max(std::abs(c.u), std::abs(c.x));
+                if (scale == 0.0) {
+                    bound_x(0.0, c.bound);
+                    continue;
+                }
+                const double u = c.u / scale, x = c.x / scale, bound = c.bound / scale;
+                if (u > 1e-12) {
+                    uppers.emplace_back(bound / u, -x / u);
+                } else if (u < -1e-12) {
+                    lowers.emplace_back(bound / u, -x / u);
+                } else {
+                    bound_x(x, bound);
+                }
+            }
+            // lower(x) = p + q x <= upper(x)
+            for (const Eigen::Vector2d& l : lowers) {
+                for (const Eigen::Vector2d& h : uppers) {
+                    bound_x(l(1) - h(1), h(0) - l(0));
+                }
+            }
+            return lower <= upper + 1e-9 * std::max(1.0, std::abs(upper));
+        }
+
+    }
+
+    /**
+     * @brief Joint torques of the finger's rigid links by recursive Newton-Euler in the space frame.
+     *
+     * Link i moves with joints 1 to i and carries the mass properties set with set_link_inertia; gravity enters
+     * as an upward acceleration of the base.
+     *
+     * @param finger Finger model with space frame screw axes.
+     * @param joint_angles Joint angles.
+     * @param joint_velocities Joint velocities.
+     * @param joint_accelerations Joint accelerations.
+     * @param gravity Gravitational acceleration in the space frame.
+     * @return Joint torques.
+     */
+    Eigen::VectorXd inverse_dynamics(const finger_model<>& finger, const Eigen::Ref<const Eigen::VectorXd>& joint_angles,
+                                     const Eigen::Ref<const Eigen::VectorXd>& joint_velocities, const Eigen::Ref<const Eigen::VectorXd>& joint_accelerations,
+                                     const Eigen::Vector3d& gravity) {
+        const int n = finger.get_num_joints();
+        if (joint_angles.size() != n || joint_velocities.size() != n || joint_accelerations.size() != n) {
+            throw std::invalid_argument("joint vectors must have one entry per joint");
+        }
+
+        // Joint axes and link frames at the current angles
+        finger_model<>::jacobian_matrix J;
+        finger_model<>::link_frames frames;
+        finger.space_jacobian(joint_angles, J);
+        finger.link_frames_space(joint_angles, frames);
+
+        // Forward pass: spatial velocity and acceleration of every link, and its wrench
+        std::array<twist, max_finger_joints> wrenches;
+        twist V = twist::Zero(), A = twist::Zero();
+        A.tail<3>() = -gravity;
+        for (int i = 0; i < n; i++) {
+            const twist axis = J.col(i);
+            A += axis * joint_accelerations(i) + bracket(V, axis) * joint_velocities(i);
+            V += axis * joint_velocities(i);
+
+            // Spatial inertia about the center of mass, moved to the space frame origin
+            const link_inertia& inertia = finger.get_link_inertia(i);
+            Eigen::Matrix4d center = frames[i];
+            center.block<3, 1>(0, 3) += frames[i].block<3, 3>(0, 0) * inertia.center_of_mass;
+            const spatial_matrix Ad = adjoint(rigid_body_motion::Transform_Inverse(center));
+            spatial_matrix G = spatial_matrix::Zero();
+            G.topLeftCorner<3, 3>() = inertia.rotational_inertia;
+            G.bottomRightCorner<3, 3>() = inertia.mass * Eigen::Matrix3d::Identity();
+            G = Ad.transpose() * G * Ad;
+
+            wrenches[i] = G * A - bracket_transpose(V, G * V);
+        }
+
+        // Backward pass: every joint carries the wrenches of the links after it
+        Eigen::VectorXd torques(n);
+        twist total = twist::Zero();
+        for (int i = n - 1; i >= 0; i--) {
+            total += wrenches[i];
+            torques(i) = J.col(i).dot(total);
+        }
+        return torques;
+    }
+
+    /**
+     * @brief Constructor for the path_parameterizer class.
+     * @param finger Finger model with space frame screw axes, link inertias and a tendon routing matrix of full row rank; copied.
+     * @param tendons Spool radius and motor torque constant of every tendon.
+     */
+    path_parameterizer::path_parameterizer(const finger_model<>& finger, const std::vector<tendon_parameters>& tendons)
+        : finger(finger),
+          tendon_routing_matrix(finger.get_tendon_routing_matrix()),
+          current_limit(default_current_limit),
+          min_tension(0.0),
+          max_tension(std::numeric_limits<double>::infinity()),
+          velocity_limits(Eigen::VectorXd::Constant(finger.get_num_joints(), std::numeric_limits<double>::infinity())),
+          gravity(0.0, 0.0, -9.81)
+    {
+        const int n = finger.get_num_joints();
+        const int m = static_cast<int>(this->tendon_routing_matrix.cols());
+        if (this->tendon_routing_matrix.rows() != n || m < 1) {
+            throw std::invalid_argument("finger needs a tendon routing matrix");
+        }
+        if (static_cast<int>(tendons.size()) != m) {
+            throw std::invalid_argument("tendons must have one entry per routing matrix column");
+        }
+        if (this->tendon_routing_matrix.fullPivLu().rank() < n) {
+            throw std::invalid_argument("tendon routing matrix must have full row rank");
+        }
+        this->current_per_tension.resize(m);
+        for (int i = 0; i < m; i++) {
+            if (!(tendons[i].spool_radius > 0.0) || !(tendons[i].torque_constant > 0.0)) {
+                throw std::invalid_argument("spool radius and motor torque constant must be positive");
+            }
+            this->current_per_tension(i) = tendons[i].spool_radius / tendons[i].torque_constant;
+        }
+    }
+
+    ////////////////////////////////////////////////////////////
+    // Setter functions
+    ////////////////////////////////////////////////////////////
+
+    /**
+     * @brief Set the motor current limit.
+     * @param current_limit Positive, finite current (A).
+     */
+    void path_parameterizer::set_current_limit(double current_limit) {
+        if (!(current_limit > 0.0) || !std::isfinite(current_limit)) {
+            throw std::invalid_argument("current limit must be positive and finite");
+        }
+        this->current_limit = current_limit;
+    }
+
+    /**
+     * @brief Set the tendon tension limits.
+     * @param min_tension Non-negative pretension every tendon keeps (N).
+     * @param max_tension Upper bound (N), may be infinity.
+     */
+    void path_parameterizer::set_tension_limits(double min_tension, double max_tension) {
+        if (!(min_tension >= 0.0) || !std::isfinite(min_tension) || !(max_tension >= min_tension)) {
+            throw std::invalid_argument("tension limits must satisfy 0 <= min_tension <= max_tension");
+        }
+        this->min_tension = min_tension;
+        this->max_tension = max_tension;
+    }
+
+    /**
+     * @brief Set the joint speed limits.
+     * @param velocity_limits Positive limit of every joint, infinity for none.
+     */
+    void path_parameterizer::set_velocity_limits(const Eigen::VectorXd& velocity_limits) {
+        if (velocity_limits.size() != this->finger.get_num_joints() || !(velocity_limits.array() > 0.0).all()) {
+            throw std::invalid_argument("velocity limits must be positive, one per joint");
+        }
+        this->velocity_limits = velocity_limits;
+    }
+
+    /**
+     * @brief Set the gravitational acceleration; the default points down the space frame z axis.
+     * @param gravity Acceleration in the space frame (m/s^2).
+     */
+    void path_parameterizer::set_gravity(const Eigen::Vector3d& gravity) {
+        this->gravity = gravity;
+    }
+
+    ////////////////////////////////////////////////////////////
+    // Getter functions
+    ////////////////////////////////////////////////////////////
+
+    int path_parameterizer::get_num_joints() const {
+        return this->finger.get_num_joints();
+    }
+
+    double path_parameterizer::get_current_limit() const {
+        return this->current_limit;
+    }
+
+    const Eigen::VectorXd& path_parameterizer::get_velocity_limits() const {
+        return this->velocity_limits;
+    }
+
+    const Eigen::Vector3d& path_parameterizer::get_gravity() const {
+        return this->gravity;
+    }
+
+    ////////////////////////////////////////////////////////////
+    // Member functions
+    ////////////////////////////////////////////////////////////
+
+    /**
+     * @brief Fastest rest to rest timing of a path within the current, tension and joint speed limits.
+     *
+     * Path derivatives come from finite differences on the grid, so the grid should resolve the path's
+     * curvature. Along the path tau = a(s) d2s/dt2 + b(s) (ds/dt)^2 + c(s), with a, b and c from three inverse
+     * dynamics evaluations per grid point.
+     *
+     * @param path Joint angles at N + 1 evenly spaced values of the path parameter, one column per grid point, N >= 2.
+     * @return Timing at every grid point.
+     */
+    path_timing path_parameterizer::parameterize(const Eigen::Ref<const Eigen::MatrixXd>& path) const {
+        const int n = this->finger.get_num_joints();
+        const long N = static_cast<long>(path.cols()) - 1;
+        if (path.rows() != n || N < 2) {
+            throw std::invalid_argument("path must have one row per joint and at least three grid points");
+        }
+        if (!path.allFinite()) {
+            throw std::invalid_argument("path must be finite");
+        }
+        const double h = 1.0 / static_cast<double>(N);
+        const std::vector<torque_facet> facets = this->torque_facets();
+        const std::size_t rows = 2 * facets.size();
+
+        // Torque limits as constraints on (u, x) = (d2s/dt2, (ds/dt)^2) at every grid point
+        std::vector<path_constraint> constraints((N + 1) * rows);
+        Eigen::VectorXd max_x(N + 1);
+        Eigen::VectorXd dq(n), ddq(n);
+        const Eigen::VectorXd zero = Eigen::VectorXd::Zero(n);
+        for (long i = 0; i <= N; i++) {
+            if (i == 0) {
+                dq = (-3.0 * path.col(0) + 4.0 * path.col(1) - path.col(2)) / (2.0 * h);
+            } else if (i == N) {
+                dq = (3.0 * path.col(N) - 4.0 * path.col(N - 1) + path.col(N - 2)) / (2.0 * h);
+            } else {
+                dq = (path.col(i + 1) - path.col(i - 1)) / (2.0 * h);
+            }
+            const long k = std::min(N - 1, std::max(1L, i));
+            ddq = (path.col(k + 1) - 2.0 * path.col(k) + path.col(k - 1)) / (h * h);
+
+            const Eigen::VectorXd c = inverse_dynamics(this->finger, path.col(i), zero, zero, this->gravity);
+            const Eigen::VectorXd a = inverse_dynamics(this->finger, path.col(i), zero, dq, this->gravity) - c;
+            const Eigen::VectorXd b = inverse_dynamics(this->finger, path.col(i), dq, ddq, this->gravity) - c;
+            path_constraint* row = &constraints[i * rows];
+            for (const torque_facet& facet : facets) {
+                const double na = facet.normal.dot(a), nb = facet.normal.dot(b), nc = facet.normal.dot(c);
+                *row++ = {na, nb, facet.offset + facet.radius - nc};
+                *row++ = {-na, -nb, facet.radius - facet.offset + nc};
+            }
+            max_x(i) = std::numeric_limits<double>::infinity();
+            for (int j = 0; j < n; j++) {
+                if (std::abs(dq(j)) > 0.0) {
+                    max_x(i) = std::min(max_x(i), std::pow(this->velocity_limits(j) / dq(j), 2));
+                }
+            }
+        }
+
+        auto infeasible = [&](long i) {
+            return std::runtime_error("path cannot be followed within the limits at s = " + std::to_string(i * h));
+        };
+        std::vector<path_constraint> step(rows + 2);
+        std::vector<Eigen::Vector2d> lowers, uppers;
+        lowers.reserve(rows + 2);
+        uppers.reserve(rows + 2);
+
+        // Backward pass: controllable x at every grid point, ending at rest
+        Eigen::VectorXd lower(N + 1), upper(N + 1);
+        step.assign(constraints.begin() + N * rows, constraints.begin() + (N + 1) * rows);
+        lower(N) = 0.0;
+        upper(N) = 0.0;
+        if (!feasible_interval(step, lower(N), upper(N), lowers, uppers)) {
+            throw infeasible(N);
+        }
+        upper(N) = lower(N) = 0.0;
+        step.resize(rows + 2);
+        for (long i = N - 1; i >= 0; i--) {
+            std::copy(constraints.begin() + i * rows, constraints.begin() + (i + 1) * rows, step.begin());
+            step[rows] = {2.0 * h, 1.0, upper(i + 1)};
+            step[rows + 1] = {-2.0 * h, -1.0, -lower(i + 1)};
+            lower(i) = 0.0;
+            upper(i) = max_x(i);
+            if (!feasible_interval(step, lower(i), upper(i), lowers, uppers)) {
+                throw infeasible(i);
+            }
+            if (!std::isfinite(upper(i))) {
+                throw std::invalid_argument("path speed is unbounded; set link inertias or joint velocity limits");
+            }
+            upper(i) = std::max(upper(i), lower(i));
+        }
+        if (lower(0) > 1e-9) {
+            throw infeasible(0);
+        }
+
+        // Forward pass: greatest acceleration that keeps the next grid point controllable
+        path_timing timing;
+        timing.times.resize(N + 1);
+        timing.path_velocities.resize(N + 1);
+        timing.path_accelerations.resize(N + 1);
+        timing.times(0) = 0.0;
+        timing.path_accelerations(N) = 0.0;
+        double x = 0.0;
+        for (long i = 0; i < N; i++) {
+            double u = (upper(i + 1) - x) / (2.0 * h);
+            for (std::size_t r = 0; r < rows; r++) {
+                const path_constraint& c = constraints[i * rows + r];
+                if (c.u > 1e-12 * std::max(1.0, std::abs(c.x))) {
+                    u = std::min(u, (c.bound - c.x * x) / c.u);
+                }
+            }
+            const double next = std::min(upper(i + 1), std::max(lower(i + 1), x + 2.0 * h * u));
+            const double speeds = std::sqrt(x) + std::sqrt(next);
+            if (!(speeds > 0.0)) {
+                throw infeasible(i);
+            }
+            timing.path_velocities(i) = std::sqrt(x);
+            timing.path_accelerations(i) = (next - x) / (2.0 * h);
+            timing.times(i + 1) = timing.times(i) + 2.0 * h / speeds;
+            x = next;
+        }
+        timing.path_velocities(N) = std::sqrt(x);
+        timing.duration = timing.times(N);
+        return timing;
+    }
+
+    ////////////////////////////////////////////////////////////
+    // Private functions
+    ////////////////////////////////////////////////////////////
+
+    /**
+     * @brief Facets of the joint torques the tendons can produce within the tension and current limits.
+     *
+     * The set is the zonotope R [f_min, f_max]; every n - 1 independent generators span the plane of a
+     * pair of opposite facets.
+     *
+     * @return Facets.
+     */
+    std::vector<path_parameterizer::torque_facet> path_parameterizer::torque_facets() const {
+        const int n = static_cast<int>(this->tendon_routing_matrix.rows());
+        const int m = static_cast<int>(this->tendon_routing_matrix.cols());
+        const Eigen::VectorXd lowest = Eigen::VectorXd::Constant(m, this->min_tension);
+        const Eigen::VectorXd highest = (this->current_limit / this->current_per_tension.array()).min(this->max_tension).matrix();
+        if ((highest.array() < lowest.array()).any()) {
+            throw std::invalid_argument("current limit allows less than the minimum tendon tension");
+        }
+        const Eigen::VectorXd center = this->tendon_routing_matrix * (0.5 * (lowest + highest));
+        const Eigen::MatrixXd generators = this->tendon_routing_matrix * (0.5 * (highest - lowest)).asDiagonal();
+
+        std::vector<torque_facet> facets;
+        Eigen::MatrixXd span(n, n - 1);
+        for (unsigned int mask = 0; mask < (1u << m); mask++) {
+            int count = 0;
+            for (int k = 0; k < m; k++) {
+                if (mask & (1u << k)) {
+                    if (count < n - 1) {
+                        span.col(count) = generators.col(k);
+                    }
+                    count++;
+                }
+            }
+            if (count != n - 1) {
+                continue;
+            }
+            torque_facet facet;
+            if (n == 1) {
+                facet.normal = Eigen::VectorXd::Ones(1);
+            } else {
+                Eigen::FullPivLU<Eigen::MatrixXd> lu(span.transpose());
+                if (lu.rank() != n - 1) {
+                    continue;
+                }
+                facet.normal = lu.kernel().col(0).normalized();
+            }
+            facet.offset = facet.normal.dot(center);
+            facet.radius = (facet.normal.transpose() * generators).cwiseAbs().sum();
+            facets.push_back(facet);
+        }
+        return facets;
+    }
+
+}
@@ -0,0 +1,551 @@
+#include "include/reachable_workspace.hpp"
+#include <Eigen/Dense>
+#include <algorithm>
+#include <bitset>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace fm {
+
+    namespace {
+
+        const char workspace_file_magic[8] = {'F', 'M', 'R', 'E', 'A', 'C', 'H', '\0'};
+        const std::uint32_t workspace_file_version = 1;
+
+        // Refinement samples are evaluated in batches of about this many points
+        const long refinement_batch = 1 << 16;
+
+        template <typename T>
+        void write_value(std::ofstream& file, const T& value) {
+            file.write(reinterpret_cast<const char*>(&value), sizeof(T));
+        }
+
+        template <typename T>
+        void read_value(std::ifstream& file, T& value) {
+            file.read(reinterpret_cast<char*>(&value), sizeof(T));
+        }
+
+        bool test_bit(const std::vector<std::uint64_t>& bits, long k) {
+            return bits[k >> 6] >> (k & 63) & 1;
+        }
+
+        void set_bit(std::vector<std::uint64_t>& bits, long k) {
+            bits[k >> 6] |= std::uint64_t(1) << (k & 63);
+        }
+
+        long leaf_words(int depth) {
+            return std::max(1L, (1L << (3 * depth)) / 64);
+        }
+
+        long count_bits(const std::vector<std::uint64_t>& bits) {
+            long count = 0;
+            for (std::uint64_t word : bits) {
+                count += static_cast<long>(std::bitset<64>(word).count());
+            }
+            return count;
+        }
+
+    }
+
+    /**
+     * @brief Constructor for the reachable_workspace class.
+     *
+     * Defaults to 2 mm voxels refined twice on the boundary, giving 0.5 mm leaves there.
+     *
+     * @param finger Finger model with space screw axes and home frame set.
+     */
+    reachable_workspace::reachable_workspace(const finger_model<>& finger)
+        : finger(finger),
+          voxel_size(0.002),
+          depth(2),
+          origin(Eigen::Vector3d::Zero()),
+          dimensions(Eigen::Vector3i::Zero()),
+          num_samples(0)
+    {
+    }
+
+    ////////////////////////////////////////////////////////////
+    // Setter functions
+    ////////////////////////////////////////////////////////////
+
+    /**
+     * @brief Set the edge length of the voxels.
+     * @param voxel_size Positive edge length.
+     */
+    void reachable_workspace::set_voxel_size(double voxel_size) {
+        if (!(voxel_size > 0.0)) {
+            throw std::invalid_argument("voxel_size must be positive");
+        }
+        this->voxel_size = voxel_size;
+    }
+
+    /**
+     * @brief Set how many times boundary voxels and the joint cells reaching them are halved.
+     * @param depth 0 to 4; 0 keeps whole voxels everywhere.
+     */
+    void reachable_workspace::set_refinement_depth(int depth) {
+        if (depth < 0 || depth > 4) {
+            throw std::invalid_argument("depth must be between 0 and 4");
+        }
+        this->depth = depth;
+    }
+
+    ////////////////////////////////////////////////////////////
+    // Getter functions
+    ////////////////////////////////////////////////////////////
+
+    double reachable_workspace::get_voxel_size() const {
+        return this->voxel_size;
+    }
+
+    int reachable_workspace::get_refinement_depth() const {
+        return this->depth;
+    }
+
+    /**
+     * @brief Get the corner of voxel (0, 0, 0) with the smallest coordinates.
+     */
+    const Eigen::Vector3d& reachable_workspace::get_origin() const {
+        return this->origin;
+    }
+
+    const Eigen::Vector3i& reachable_workspace::get_dimensions() const {
+        return this->dimensions;
+    }
+
+    long reachable_workspace::get_num_occupied_voxels() const {
+        return count_bits(this->occupied);
+    }
+
+    /**
+     * @brief Number of occupied voxels with an empty face neighbour; these hold leaf bits.
+     */
+    long reachable_workspace::get_num_boundary_voxels() const {
+        return count_bits(this->boundary);
+    }
+
+    /**
+     * @brief Number of configurations the workspace was built from, grid and refinement samples together.
+     */
+    long reachable_workspace::get_num_samples() const {
+        return this->num_samples;
+    }
+
+    ////////////////////////////////////////////////////////////
+    // Member functions
+    ////////////////////////////////////////////////////////////
+
+    /**
+     * @brief Build the workspace from fingertip positions over a configuration grid.
+     *
+     * The grid samples mark the voxels they land in; the grid bounds, padded by one voxel, set the voxel
+     * grid. Occupied voxels with an empty face neighbour form the boundary. With a refinement depth d,
+     * every grid cell with a corner in a boundary voxel is resampled on a lattice 2^d times finer, and
+     * those samples mark both voxels (filling holes the grid left) and leaves of 2^-d voxels. Voxels
+     * that are still on the boundary afterwards keep their leaves; the others are reachable as a whole.
+     *
+     * @param grid Configuration grid.
+     * @param num_threads Number of threads for the fingertip positions, 0 for one per hardware thread.
+     */
+    void reachable_workspace::build(const configuration_grid& grid, int num_threads) {
+        const int n = this->finger.get_num_joints();
+        if (grid.get_num_joints() != n) {
+            throw std::invalid_argument("grid must have one dimension per joint");
+        }
+        if (num_threads <= 0) {
+            num_threads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+        }
+
+        const long points = grid.size();
+        Eigen::MatrixXd joint_angles(n, points);
+        for (long k = 0; k < points; k++) {
+            grid.point(k, joint_angles.col(k));
+        }
+        Eigen::Matrix3Xd positions(3, points);
+        this->positions_parallel(joint_angles, positions, num_threads);
+
+        const Eigen::Vector3d low = positions.rowwise().minCoeff();
+        const Eigen::Vector3d high = positions.rowwise().maxCoeff();
+        const Eigen::Vector3d extent = ((high - low) / this->voxel_size).array().floor() + 3.0;
+        if (extent.prod() > 4e9) {
+            throw std::invalid_argument("voxel_size is too small for the workspace");
+        }
+        this->origin = low - Eigen::Vector3d::Constant(this->voxel_size);
+        this->dimensions = extent.cast<int>();
+        const long voxels = static_cast<long>(this->dimensions.cast<long>().prod());
+        this->occupied.assign((voxels + 63) / 64, 0);
+        this->boundary.assign(this->occupied.size(), 0);
+        this->leaves.clear();
+        this->num_samples = points;
+
+        std::vector<long> grid_voxels(points);
+        Eigen::Vector3i cell;
+        for (long k = 0; k < points; k++) {
+            grid_voxels[k] = this->voxel_index(positions.col(k), cell);
+            set_bit(this->occupied, grid_voxels[k]);
+        }
+        if (this->depth == 0) {
+            this->index_boundary();
+            return;
+        }
+        this->find_boundary();
+
+        // Leaves of the candidate voxels: the boundary so far and every voxel refinement newly occupies.
+        // Occupancy only grows, so no voxel outside these can end up on the boundary.
+        const int subdivisions = 1 << this->depth;
+        const long words = leaf_words(this->depth);
+        std::unordered_map<long, long> candidate_blocks;
+        std::vector<std::uint64_t> candidate_leaves;
+        auto mark = [&](const Eigen::Ref<const Eigen::Vector3d>& position) {
+            // The padding layer stays empty so that every occupied voxel has six neighbours
+            const long voxel = this->voxel_index(position, cell);
+            if (voxel < 0 || (cell.array() == 0).any() || (cell.array() + 1 == this->dimensions.array()).any()) {
+                return;
+            }
+            auto found = candidate_blocks.find(voxel);
+            if (found == candidate_blocks.end()) {
+                if (test_bit(this->occupied, voxel) && !test_bit(this->boundary, voxel)) {
+                    return;
+                }
+                found = candidate_blocks.emplace(voxel, static_cast<long>(candidate_leaves.size()) / words).first;
+                candidate_leaves.resize(candidate_leaves.size() + words, 0);
+                set_bit(this->occupied, voxel);
+            }
+            Eigen::Vector3i leaf = (((position - this->origin) / this->voxel_size).array() * subdivisions).floor().cast<int>();
+            leaf -= cell * subdivisions;
+            leaf = leaf.cwiseMax(0).cwiseMin(subdivisions - 1);
+            set_bit(candidate_leaves, found->second * words * 64 + leaf(0) + subdivisions * (leaf(1) + subdivisions * leaf(2)));
+        };
+        for (long k = 0; k < points; k++) {
+            if (test_bit(this->boundary, grid_voxels[k])) {
+                mark(positions.col(k));
+            }
+        }
+
+        // Grid cells, by lower corner, with a corner in a boundary voxel
+        const Eigen::VectorXi& samples = grid.get_samples();
+        Eigen::VectorXd step(n);
+        int active = 0;
+        for (int j = 0; j < n; j++) {
+            step(j) = samples(j) > 1 ? (grid.get_joint_max()(j) - grid.get_joint_min()(j)) / ((samples(j) - 1) * static_cast<double>(subdivisions)) : 0.0;
+            active += samples(j) > 1 ? 1 : 0;
+        }
+        const double leaf_size = this->voxel_size / subdivisions;
+        long offsets_per_cell = 1;
+        for (int j = 0; j < active; j++) {
+            offsets_per_cell *= subdivisions;
+        }
+
+        std::vector<long> batch;
+        auto flush = [&]() {
+            const long count = static_cast<long>(batch.size()) * (offsets_per_cell - 1);
+            Eigen::MatrixXd refined(n, count);
+            long column = 0;
+            for (long k : batch) {
+                // Sub-lattice offsets of the cell other than its lower corner
+                for (long m = 1; m < offsets_per_cell; m++, column++) {
+                    refined.col(column) = joint_angles.col(k);
+                    long remainder = m;
+                    for (int j = 0; j < n; j++) {
+                        if (samples(j) > 1) {
+                            refined(j, column) += step(j) * static_cast<double>(remainder % subdivisions);
+                            remainder /= subdivisions;
+                        }
+                    }
+                }
+            }
+            Eigen::Matrix3Xd refined_positions(3, count);
+            this->positions_parallel(refined, refined_positions, num_threads);
+            for (long k = 0; k < count; k++) {
+                mark(refined_positions.col(k));
+            }
+            this->num_samples += count;
+            batch.clear();
+        };
+        for (long k = 0; k < points; k++) {
+            long remainder = k;
+            bool lower_corner = true;
+            for (int j = 0; j < n; j++) {
+                lower_corner = lower_corner && (samples(j) == 1 || remainder % samples(j) + 1 < samples(j));
+                remainder /= samples(j);
+            }
+            if (!lower_corner) {
+                continue;
+            }
+            // Cells whose corners all lie within a leaf of each other would add no new leaves
+            bool touches = false;
+            double spread = 0.0;
+            for (int corner = 0; corner < (1 << n); corner++) {
+                long neighbour = k, stride = 1;
+                bool valid = true;
+                for (int j = 0; j < n; j++) {
+                    if (corner >> j & 1) {
+                        valid = valid && samples(j) > 1;
+                        neighbour += stride;
+                    }
+                    stride *= samples(j);
+                }
+                if (valid) {
+                    touches = touches || test_bit(this->boundary, grid_voxels[neighbour]);
+                    spread = std::max(spread, (positions.col(neighbour) - positions.col(k)).cwiseAbs().maxCoeff());
+                }
+            }
+            if (touches && spread >= leaf_size) {
+                batch.push_back(k);
+                if (static_cast<long>(batch.size()) * offsets_per_cell >= refinement_batch) {
+                    flush();
+                }
+            }
+        }
+        if (!batch.empty()) {
+            flush();
+        }
+
+        // Keep leaves of the voxels on the final boundary, in voxel order
+        this->find_boundary();
+        this->leaves.assign(static_cast<std::size_t>(this->boundary_rank.back()) * words, 0);
+        for (const auto& entry : candidate_blocks) {
+            if (test_bit(this->boundary, entry.first)) {
+                std::copy_n(candidate_leaves.begin() + entry.second * words, words, this->leaves.begin() + this->leaf_block(entry.first) * words);
+            }
+        }
+    }
+
+    /**
+     * @brief Whether a fingertip position lies in a reached voxel, or reached leaf of a boundary voxel.
+     *
+     * Takes one bit lookup, plus a rank and a second lookup for boundary voxels.
+     *
+     * @param position Fingertip position in the space frame.
+     * @return True if the position was reached by a sample.
+     */
+    bool reachable_workspace::reachable(const Eigen::Ref<const Eigen::Vector3d>& position) const {
+        Eigen::Vector3i cell;
+        const long voxel = this->voxel_index(position, cell);
+        if (voxel < 0 || !test_bit(this->occupied, voxel)) {
+            return false;
+        }
+        if (!test_bit(this->boundary, voxel)) {
+            return true;
+        }
+        const int subdivisions = 1 << this->depth;
+        Eigen::Vector3i leaf = (((position - this->origin) / this->voxel_size).array() * subdivisions).floor().cast<int>();
+        leaf = (leaf - cell * subdivisions).cwiseMax(0).cwiseMin(subdivisions - 1);
+        const long bit = this->leaf_block(voxel) * leaf_words(this->depth) * 64 + leaf(0) + subdivisions * (leaf(1) + subdivisions * leaf(2));
+        return test_bit(this->leaves, bit);
+    }
+
+    /**
+     * @brief Volume of the reached voxels, counting only the reached leaves of boundary voxels.
+     * @return Volume in cubic length units.
+     */
+    double reachable_workspace::reachable_volume() const {
+        const double voxel_volume = this->voxel_size * this->voxel_size * this->voxel_size;
+        const double leaf_volume = voxel_volume / static_cast<double>(1L << (3 * this->depth));
+        return static_cast<double>(this->get_num_occupied_voxels() - this->get_num_boundary_voxels()) * voxel_volume + static_cast<double>(count_bits(this->leaves)) * leaf_volume;
+    }
+
+    /**
+     * @brief Fingertip positions of a batch of configurations.
+     * @param joint_angles Joint angles, one column per configuration.
+     * @param positions Output fingertip positions.
+     */
+    void reachable_workspace::fingertip_positions(const Eigen::Ref<const Eigen::MatrixXd>& joint_angles, Eigen::Ref<Eigen::Matrix3Xd> positions) const {
+        fingertip_positions(this->finger, joint_angles, positions);
+    }
+
+    /**
+     * @brief Write the workspace to a compact binary file.
+     *
+     * The file holds an 8 byte magic and a uint32 version, the voxel size (double), refinement depth
+     * (int32), origin (double), dimensions (int32) and sample count (uint64), followed by the occupied
+     * and boundary bitsets and a uint64 count of leaf words with the leaf words. Values are stored in the
+     * host byte order.
+     *
+     * @param path Output file path.
+     */
+    void reachable_workspace::write(const std::string& path) const {
+        if (this->occupied.empty()) {
+            throw std::runtime_error("no workspace has been built");
+        }
+        std::ofstream file(path, std::ios::binary);
+        if (!file) {
+            throw std::runtime_error("could not open " + path + " for writing");
+        }
+
+        file.write(workspace_file_magic, sizeof(workspace_file_magic));
+        write_value(file, workspace_file_version);
+        write_value(file, this->voxel_size);
+        write_value(file, static_cast<std::int32_t>(this->depth));
+        for (int r = 0; r < 3; r++) write_value(file, this->origin(r));
+        for (int r = 0; r < 3; r++) write_value(file, static_cast<std::int32_t>(this->dimensions(r)));
+        write_value(file, static_cast<std::uint64_t>(this->num_samples));
+        file.write(reinterpret_cast<const char*>(this->occupied.data()), sizeof(std::uint64_t) * this->occupied.size());
+        file.write(reinterpret_cast<const char*>(this->boundary.data()), sizeof(std::uint64_t) * this->boundary.size());
+        write_value(file, static_cast<std::uint64_t>(this->leaves.size()));
+        file.write(reinterpret_cast<const char*>(this->leaves.data()), sizeof(std::uint64_t) * this->leaves.size());
+        if (!file) {
+            throw std::runtime_error("failed writing " + path);
+        }
+    }
+
+    /**
+     * @brief Read a workspace written by write(), replacing the settings and voxels of this object.
+     * @param path Input file path.
+     */
+    void reachable_workspace::read(const std::string& path) {
+        std::ifstream file(path, std::ios::binary);
+        if (!file) {
+            throw std::runtime_error("could not open " + path + " for reading");
+        }
+
+        char magic[sizeof(workspace_file_magic)];
+        std::uint32_t version = 0;
+        double voxel_size = 0.0;
+        std::int32_t depth = 0, dimensions[3] = {0, 0, 0};
+        Eigen::Vector3d origin;
+        std::uint64_t samples = 0, num_leaves = 0;
+        file.read(magic, sizeof(magic));
+        read_value(file, version);
+        if (!file || std::memcmp(magic, workspace_file_magic, sizeof(magic)) != 0 || version != workspace_file_version) {
+            throw std::runtime_error(path + " is not a reachable workspace of a supported version");
+        }
+        read_value(file, voxel_size);
+        read_value(file, depth);
+        for (int r = 0; r < 3; r++) read_value(file, origin(r));
+        for (int r = 0; r < 3; r++) read_value(file, dimensions[r]);
+        read_value(file, samples);
+        if (!file || !(voxel_size > 0.0) || depth < 0 || depth > 4 || dimensions[0] <= 0 || dimensions[1] <= 0 || dimensions[2] <= 0) {
+            throw std::runtime_error(path + " has an invalid header");
+        }
+
+        const long voxels = static_cast<long>(dimensions[0]) * dimensions[1] * dimensions[2];
+        std::vector<std::uint64_t> occupied((voxels + 63) / 64), boundary(occupied.size());
+        file.read(reinterpret_cast<char*>(occupied.data()), sizeof(std::uint64_t) * occupied.size());
+        file.read(reinterpret_cast<char*>(boundary.data()), sizeof(std::uint64_t) * boundary.size());
+        read_value(file, num_leaves);
+        if (!file || static_cast<long>(num_leaves) != count_bits(boundary) * leaf_words(depth)) {
+            throw std::runtime_error(path + " has inconsistent voxel sets");
+        }
+        std::vector<std::uint64_t> leaves(num_leaves);
+        file.read(reinterpret_cast<char*>(leaves.data()), sizeof(std::uint64_t) * leaves.size());
+        if (!file) {
+            throw std::runtime_error("failed reading " + path);
+        }
+
+        this->voxel_size = voxel_size;
+        this->depth = depth;
+        this->origin = origin;
+        this->dimensions << dimensions[0], dimensions[1], dimensions[2];
+        this->num_samples = static_cast<long>(samples);
+        this->occupied = std::move(occupied);
+        this->boundary = std::move(boundary);
+        this->leaves = std::move(leaves);
+        this->index_boundary();
+    }
+
+    ////////////////////////////////////////////////////////////
+    // Private functions
+    ////////////////////////////////////////////////////////////
+
+    /**
+     * @brief Fingertip positions of a batch of configurations from the finger's space product of exponentials.
+     * @param finger Finger model.
+     * @param joint_angles Joint angles, one column per configuration.
+     * @param positions Output fingertip positions.
+     */
+    void reachable_workspace::fingertip_positions(const finger_model<>& finger, const Eigen::Ref<const Eigen::MatrixXd>& joint_angles,
+                                                  Eigen::Ref<Eigen::Matrix3Xd> positions) {
+        const long count = joint_angles.cols();
+        if (joint_angles.rows() != finger.get_num_joints() || positions.cols() != count) {
+            throw std::invalid_argument("joint_angles must have one row per joint and positions one column per configuration");
+        }
+        for (long k = 0; k < count; k++) {
+            positions.col(k) = finger.pose_space(joint_angles.col(k)).block<3, 1>(0, 3);
+        }
+    }
+
+    /**
+     * @brief Fingertip positions of all columns of a joint angle matrix, split across threads in contiguous
+     * blocks, each with its own copy of the finger model.
+     */
+    void reachable_workspace::positions_parallel(const Eigen::MatrixXd& joint_angles, Eigen::Matrix3Xd& positions, int num_threads) const {
+        const long count = joint_angles.cols();
+        const int threads = static_cast<int>(std::max(1L, std::min<long>(num_threads, count)));
+        std::vector<std::thread> workers;
+        for (int t = 0; t < threads; t++) {
+            long first = count * t / threads;
+            long last = count * (t + 1) / threads;
+            workers.emplace_back([this, &joint_angles, &positions, first, last]() {
+                const finger_model<> finger(this->finger);
+                fingertip_positions(finger, joint_angles.middleCols(first, last - first), positions.middleCols(first, last - first));
+            });
+        }
+        for (auto& worker : workers) {
+            worker.join();
+        }
+    }
+
+    /**
+     * @brief Voxel containing a position.
+     * @param position Position in the space frame.
+     * @param cell Output integer voxel coordinates.
+     * @return Voxel index, x fastest, or -1 outside the grid.
+     */
+    long reachable_workspace::voxel_index(const Eigen::Ref<const Eigen::Vector3d>& position, Eigen::Vector3i& cell) const {
+        const Eigen::Vector3d scaled = (position - this->origin) / this->voxel_size;
+        if ((scaled.array() < 0.0).any() || (scaled.array() >= this->dimensions.cast<double>().array()).any()) {
+            return -1;
+        }
+        cell = scaled.array().floor().cast<int>();
+        return cell(0) + static_cast<long>(this->dimensions(0)) * (cell(1) + static_cast<long>(this->dimensions(1)) * cell(2));
+    }
+
+    /**
+     * @brief Position of a boundary voxel's leaves among all leaf blocks, from the rank of its boundary bit.
+     */
+    long reachable_workspace::leaf_block(long voxel) const {
+        const std::uint64_t below = this->boundary[voxel >> 6] & ((std::uint64_t(1) << (voxel & 63)) - 1);
+        return this->boundary_rank[voxel >> 6] + static_cast<long>(std::bitset<64>(below).count());
+    }
+
+    /**
+     * @brief Mark occupied voxels with an empty face neighbour as boundary and rebuild the rank table.
+     *
+     * The grid is padded by a voxel on every side, so occupied voxels never lie on its faces.
+     */
+    void reachable_workspace::find_boundary() {
+        const long nx = this->dimensions(0), ny = this->dimensions(1), nz = this->dimensions(2);
+        std::fill(this->boundary.begin(), this->boundary.end(), 0);
+        for (long z = 1; z + 1 < nz; z++) {
+            for (long y = 1; y + 1 < ny; y++) {
+                for (long x = 1; x + 1 < nx; x++) {
+                    const long k = x + nx * (y + ny * z);
+                    if (test_bit(this->occupied, k) &&
+                        !(test_bit(this->occupied, k - 1) && test_bit(this->occupied, k + 1) && test_bit(this->occupied, k - nx) &&
+                          test_bit(this->occupied, k + nx) && test_bit(this->occupied, k - nx * ny) && test_bit(this->occupied, k + nx * ny))) {
+                        set_bit(this->boundary, k);
+                    }
+                }
+            }
+        }
+        this->index_boundary();
+    }
+
+    /**
+     * @brief Rebuild the count of boundary voxels before each word of the boundary set.
+     */
+    void reachable_workspace::index_boundary() {
+        this->boundary_rank.assign(this->boundary.size() + 1, 0);
+        for (std::size_t w = 0; w < this->boundary.size(); w++) {
+            this->boundary_rank[w + 1] = this->boundary_rank[w] + static_cast<std::uint32_t>(std::bitset<64>(this->boundary[w]).count());
+        }
+    }
+
+}
@@ -0,0 +1,508 @@
+#include "include/script_pipeline.hpp"
+#include <Eigen/Dense>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+
+namespace fm {
+
+    namespace {
+
+        using clock_type = std::chrono::steady_clock;
+
+        // Samples the trajectory stage evaluates per batch
+        const long trajectory_batch_rows = 64;
+
+        double seconds_since(clock_type::time_point start) {
+            return std::chrono::duration<double>(clock_type::now() - start).count();
+        }
+
+    }
+
+    /**
+     * @brief Constructor for the script_pipeline class.
+     * @param finger Finger model with tendon routing and motor shaft matrices; copied.
+     * @param ring_capacity Slots of each ring, a power of two.
+     */
+    script_pipeline::script_pipeline(const finger_model<>& finger, std::size_t ring_capacity)
+        : finger(finger),
+          actuation(finger),
+          sample_period(1e-3),
+          tip_tolerance(1e-4),
+          trajectory(finger.get_num_joints()),
+          commands(ring_capacity),
+          waypoints(ring_capacity),
+          samples(ring_capacity),
+          setpoints(ring_capacity),
+          abort(false),
+          failed(false)
+    {
+        if (this->actuation.get_num_motors() > max_finger_motors) {
+            throw std::invalid_argument("finger has more motors than max_finger_motors");
+        }
+    }
+
+    /**
+     * @brief Destructor; stops the stage threads.
+     */
+    script_pipeline::~script_pipeline()
+    {
+        this->stop();
+    }
+
+    ////////////////////////////////////////////////////////////
+    // Setter functions
+    ////////////////////////////////////////////////////////////
+
+    /**
+     * @brief Set the time between motor setpoints.
+     * @param period Positive period in seconds.
+     */
+    void script_pipeline::set_sample_period(double period) {
+        if (!(period > 0.0) || !std::isfinite(period)) {
+            throw std::invalid_argument("sample period must be positive and finite");
+        }
+        if (!this->threads.empty()) {
+            throw std::runtime_error("pipeline is running");
+        }
+        this->sample_period = period;
+    }
+
+    /**
+     * @brief Set how far from a 'tip' target the inverse kinematics may end.
+     * @param tolerance Positive distance.
+     */
+    void script_pipeline::set_tip_tolerance(double tolerance) {
+        if (!(tolerance > 0.0)) {
+            throw std::invalid_argument("tip tolerance must be positive");
+        }
+        if (!this->threads.empty()) {
+            throw std::runtime_error("pipeline is running");
+        }
+        this->tip_tolerance = tolerance;
+    }
+
+    /**
+     * @brief Set the profile and joint limits of the motion between waypoints.
+     *
+     * Segments keep their commanded durations unless the limits need longer ones, which delays the
+     * rest of the stream. The default is a quintic without limits.
+     *
+     * @param trajectory Generator for the finger's number of joints; copied.
+     */
+    void script_pipeline::set_trajectory(const trajectory_generator& trajectory) {
+        if (trajectory.get_num_joints() != this->finger.get_num_joints()) {
+            throw std::invalid_argument("trajectory generator has a different number of joints");
+        }
+        if (!this->threads.empty()) {
+            throw std::runtime_error("pipeline is running");
+        }
+        this->trajectory = trajectory;
+    }
+
+    ////////////////////////////////////////////////////////////
+    // Getter functions
+    ////////////////////////////////////////////////////////////
+
+    double script_pipeline::get_sample_period() const {
+        return this->sample_period;
+    }
+
+    int script_pipeline::get_num_motors() const {
+        return this->actuation.get_num_motors();
+    }
+
+    const trajectory_generator& script_pipeline::get_trajectory() const {
+        return this->trajectory;
+    }
+
+    /**
+     * @brief Snapshot of a stage's counters; safe while running.
+     * @param stage Stage index, e.g. script_pipeline::ik_stage.
+     * @return Counters.
+     */
+    stage_counters script_pipeline::get_counters(int stage) const {
+        if (stage < 0 || stage >= num_stages) {
+            throw std::invalid_argument("stage index is out of range");
+        }
+        const stage_state& state = this->states[stage];
+        stage_counters counters;
+        counters.items = state.items.load(std::memory_order_relaxed);
+        counters.busy_seconds = state.busy_seconds.load(std::memory_order_relaxed);
+        counters.max_item_seconds = state.max_item_seconds.load(std::memory_order_relaxed);
+        counters.max_input_depth = state.max_input_depth.load(std::memory_order_relaxed);
+        counters.input_waits = state.input_waits.load(std::memory_order_relaxed);
+        counters.output_waits = state.output_waits.load(std::memory_order_relaxed);
+        return counters;
+    }
+
+    /**
+     * @brief Number of setpoints ready for the consumer.
+     */
+    std::size_t script_pipeline::get_output_depth() const {
+        return this->setpoints.size();
+    }
+
+    ////////////////////////////////////////////////////////////
+    // Member functions
+    ////////////////////////////////////////////////////////////
+
+    /**
+     * @brief Start the stage threads on a program, from the finger's joint angles at time zero.
+     * @param code Program compiled for the finger's number of joints; copied.
+     */
+    void script_pipeline::start(const geppetto::program& code) {
+        if (!this->threads.empty()) {
+            throw std::runtime_error("pipeline is already running");
+        }
+        geppetto::validate(code, this->finger.get_num_joints());
+        this->code = code;
+        for (stage_state& state : this->states) {
+            state.items = 0;
+            state.busy_seconds = 0.0;
+            state.max_item_seconds = 0.0;
+            state.max_input_depth = 0;
+            state.input_waits = 0;
+            state.output_waits = 0;
+            state.done = false;
+        }
+        this->abort = false;
+        this->failed = false;
+        this->error = nullptr;
+
+        this->threads.emplace_back(&script_pipeline::run_stage, this, decode_stage, &script_pipeline::decode_loop);
+        this->threads.emplace_back(&script_pipeline::run_stage, this, ik_stage, &script_pipeline::ik_loop);
+        this->threads.emplace_back(&script_pipeline::run_stage, this, trajectory_stage, &script_pipeline::trajectory_loop);
+        this->threads.emplace_back(&script_pipeline::run_stage, this, motor_stage, &script_pipeline::motor_loop);
+    }
+
+    /**
+     * @brief Take the next setpoint without blocking; consumer thread only.
+     * @param setpoint Set to the setpoint.
+     * @return False if none is ready.
+     */
+    bool script_pipeline::pop(motor_setpoint& setpoint) {
+        return this->setpoints.try_pop(setpoint);
+    }
+
+    /**
+     * @brief Whether the whole stream has been produced and consumed, or a stage failed.
+     */
+    bool script_pipeline::finished() const {
+        return this->failed.load(std::memory_order_acquire) ||
+               (this->states[motor_stage].done.load(std::memory_order_acquire) && this->setpoints.size() == 0);
+    }
+
+    /**
+     * @brief Hand every setpoint to a sink, then stop the threads.
+     *
+     * In real time the output ring is first filled halfway, then one setpoint goes out per sample
+     * period on the calling thread. If the ring is empty at a tick the previous setpoint is repeated so
+     * the motors still get a command, and the tick counts as an underrun. Otherwise setpoints go out as
+     * fast as the stages produce them. A stage error is rethrown here.
+     *
+     * @param sink Receives the setpoints in order.
+     * @param real_time Pace the sink at the sample period.
+     * @return Number of underruns.
+     */
+    long script_pipeline::stream(const std::function<void(const motor_setpoint&)>& sink, bool real_time) {
+        if (this->threads.empty()) {
+            throw std::runtime_error("pipeline has not been started");
+        }
+        long underruns = 0;
+        const std::size_t prefill = this->setpoints.get_capacity() / 2;
+        while (real_time && this->setpoints.size() < prefill && !this->states[motor_stage].done.load(std::memory_order_acquire) &&
+               !this->failed.load(std::memory_order_acquire)) {
+            std::this_thread::yield();
+        }
+
+        const auto period = std::chrono::duration_cast<clock_type::duration>(std::chrono::duration<double>(this->sample_period));
+        auto tick = clock_type::now();
+        motor_setpoint setpoint;
+        bool started = false;
+        while (!this->failed.load(std::memory_order_acquire)) {
+            if (this->setpoints.try_pop(setpoint)) {
+                sink(setpoint);
+                started = true;
+            } else if (this->states[motor_stage].done.load(std::memory_order_acquire)) {
+                if (!this->setpoints.try_pop(setpoint)) {
+                    break;
+                }
+                sink(setpoint);
+            } else if (real_time && started) {
+                underruns++;
+                sink(setpoint);
+            } else {
+                std::this_thread::yield();
+                continue;
+            }
+            if (real_time) {
+                tick += period;
+                std::this_thread::sleep_until(tick);
+            }
+        }
+        this->rethrow();
+        this->stop();
+        return underruns;
+    }
+
+    /**
+     * @brief Stop and join the stage threads and drop queued items.
+     */
+    void script_pipeline::stop() {
+        this->abort = true;
+        for (std::thread& thread : this->threads) {
+            thread.join();
+        }
+        this->threads.clear();
+        command_item command;
+        joint_item joints;
+        motor_setpoint setpoint;
+        while (this->commands.try_pop(command)) {}
+        while (this->waypoints.try_pop(joints)) {}
+        while (this->samples.try_pop(joints)) {}
+        while (this->setpoints.try_pop(setpoint)) {}
+    }
+
+    ////////////////////////////////////////////////////////////
+    // Private functions
+    ////////////////////////////////////////////////////////////
+
+    /**
+     * @brief Run a stage loop; the first error is kept and aborts every stage.
+     */
+    void script_pipeline::run_stage(int stage, void (script_pipeline::*loop)()) {
+        try {
+            (this->*loop)();
+        } catch (...) {
+            bool expected = false;
+            if (this->failed.compare_exchange_strong(expected, true)) {
+                this->error = std::current_exception();
+            }
+            this->abort = true;
+        }
+        this->states[stage].done.store(true, std::memory_order_release);
+    }
+
+    /**
+     * @brief Push an item, waiting while the ring is full.
+     * @return False if the pipeline was aborted.
+     */
+    template <typename T>
+    bool script_pipeline::push_wait(spsc_ring<T>& ring, const T& item, stage_state& state) {
+        if (ring.try_push(item)) {
+            return true;
+        }
+        state.output_waits.fetch_add(1, std::memory_order_relaxed);
+        const auto start = clock_type::now();
+        while (!ring.try_push(item)) {
+            if (this->abort.load(std::memory_order_relaxed)) {
+                return false;
+            }
+            std::this_thread::yield();
+        }
+        state.blocked_seconds += seconds_since(start);
+        return true;
+    }
+
+    /**
+     * @brief Pop an item, waiting while the ring is empty and the stage before is still running.
+     * @return False at the end of the input or if the pipeline was aborted.
+     */
+    template <typename T>
+    bool script_pipeline::pop_wait(spsc_ring<T>& ring, T& item, const stage_state& upstream, stage_state& state) {
+        state.max_input_depth.store(std::max(state.max_input_depth.load(std::memory_order_relaxed), ring.size()), std::memory_order_relaxed);
+        if (ring.try_pop(item)) {
+            return true;
+        }
+        state.input_waits.fetch_add(1, std::memory_order_relaxed);
+        while (!ring.try_pop(item)) {
+            if (this->abort.load(std::memory_order_relaxed)) {
+                return false;
+            }
+            if (upstream.done.load(std::memory_order_acquire)) {
+                // Items pushed before done was set are visible now
+                return ring.try_pop(item);
+            }
+            std::this_thread::yield();
+        }
+        return true;
+    }
+
+    /**
+     * @brief Count one item and its service time, less any time blocked on the output ring.
+     */
+    void script_pipeline::record(stage_state& state, double seconds) {
+        seconds = std::max(0.0, seconds - state.blocked_seconds);
+        state.blocked_seconds = 0.0;
+        state.items.fetch_add(1, std::memory_order_relaxed);
+        state.busy_seconds.store(state.busy_seconds.load(std::memory_order_relaxed) + seconds, std::memory_order_relaxed);
+        if (seconds > state.max_item_seconds.load(std::memory_order_relaxed)) {
+            state.max_item_seconds.store(seconds, std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * @brief Decode stage: walk the bytecode, expand loops and attach the current duration to moves.
+     */
+    void script_pipeline::decode_loop() {
+        stage_state& state = this->states[decode_stage];
+        const int n = this->code.num_joints;
+        const double* constants = this->code.constants.data();
+        std::vector<std::uint32_t> loops;
+        double duration = 1.0;
+        for (std::size_t pc = 0; pc < this->code.code.size(); pc++) {
+            const auto start = clock_type::now();
+            const geppetto::instruction& in = this->code.code[pc];
+            command_item command{in.op, in.joint, this->code.lines[pc], duration, {}};
+            bool emit = true;
+            switch (in.op) {
+            case geppetto::opcode::joints:
+                std::copy(constants + in.operand, constants + in.operand + n, command.values.begin());
+                break;
+            case geppetto::opcode::joint:
+            case geppetto::opcode::wait:
+                command.values[0] = constants[in.operand];
+                break;
+            case geppetto::opcode::tip:
+                std::copy(constants + in.operand, constants + in.operand + 3, command.values.begin());
+                break;
+            case geppetto::opcode::home:
+                break;
+            case geppetto::opcode::duration:
+                duration = constants[in.operand];
+                emit = false;
+                break;
+            case geppetto::opcode::repeat:
+                loops.push_back(in.operand);
+                emit = false;
+                break;
+            case geppetto::opcode::end_repeat:
+                if (--loops.back() > 0) {
+                    pc = in.operand - 1;
+                } else {
+                    loops.pop_back();
+                }
+                emit = false;
+                break;
+            }
+            if (emit && !this->push_wait(this->commands, command, state)) {
+                return;
+            }
+            this->record(state, seconds_since(start));
+        }
+    }
+
+    /**
+     * @brief Inverse kinematics stage: turn commands into timed joint waypoints, with the virtual
+     * machine's joint limit and tip reach checks.
+     */
+    void script_pipeline::ik_loop() {
+        stage_state& state = this->states[ik_stage];
+        const int n = this->finger.get_num_joints();
+        finger_model<> model = this->finger;
+
+        joint_item waypoint{0.0, {}};
+        Eigen::Map<Eigen::VectorXd>(waypoint.joint_angles.data(), n) = model.get_joint_angles();
+        if (!this->push_wait(this->waypoints, waypoint, state)) {
+            return;
+        }
+        command_item command;
+        while (this->pop_wait(this->commands, command, this->states[decode_stage], state)) {
+            const auto start = clock_type::now();
+            if (command.op == geppetto::opcode::wait) {
+                waypoint.time += command.values[0];
+            } else {
+                geppetto::move(model, command.op, command.joint, command.values.data(), this->tip_tolerance, command.line);
+                waypoint.time += command.seconds;
+                Eigen::Map<Eigen::VectorXd>(waypoint.joint_angles.data(), n) = model.get_joint_angles();
+            }
+            if (!this->push_wait(this->waypoints, waypoint, state)) {
+                return;
+            }
+            this->record(state, seconds_since(start));
+        }
+    }
+
+    /**
+     * @brief Trajectory stage: plan a profile between consecutive waypoints and sample it at the sample
+     * period in batches. The last waypoint is always sampled, one period after the previous sample if it
+     * falls between ticks.
+     */
+    void script_pipeline::trajectory_loop() {
+        stage_state& state = this->states[trajectory_stage];
+        const int n = this->finger.get_num_joints();
+        Eigen::MatrixXd batch(trajectory_batch_rows, n);
+        joint_item previous{}, next{}, sample{};
+        double segment_start = 0.0;   // Limits may stretch segments past their commanded times
+        long tick = 0;
+        bool first = true;
+        while (this->pop_wait(this->waypoints, next, this->states[ik_stage], state)) {
+            const auto start = clock_type::now();
+            if (first) {
+                previous = next;
+                first = false;
+            }
+            const trajectory_segment segment = this->trajectory.plan(Eigen::Map<const Eigen::VectorXd>(previous.joint_angles.data(), n),
+                                                                     Eigen::Map<const Eigen::VectorXd>(next.joint_angles.data(), n),
+                                                                     std::max(0.0, next.time - previous.time));
+            long count = batch.rows();
+            while (count == batch.rows()) {
+                count = trajectory_generator::sample(segment, tick * this->sample_period - segment_start, this->sample_period, batch);
+                for (long k = 0; k < count; k++, tick++) {
+                    sample.time = tick * this->sample_period;
+                    for (int i = 0; i < n; i++) {
+                        sample.joint_angles[i] = batch(k, i);
+                    }
+                    if (!this->push_wait(this->samples, sample, state)) {
+                        return;
+                    }
+                }
+            }
+            segment_start += segment.duration;
+            previous = next;
+            this->record(state, seconds_since(start));
+        }
+        if (!first && !this->abort.load(std::memory_order_relaxed) && sample.time < segment_start - 1e-12) {
+            previous.time = tick * this->sample_period;
+            this->push_wait(this->samples, previous, state);
+        }
+    }
+
+    /**
+     * @brief Motor stage: map joint samples to motor shaft angles.
+     */
+    void script_pipeline::motor_loop() {
+        stage_state& state = this->states[motor_stage];
+        const int n = this->finger.get_num_joints();
+        const int m = this->actuation.get_num_motors();
+        const Eigen::MatrixXd& jacobian = this->actuation.get_motor_joint_jacobian();
+        const Eigen::VectorXd& offsets = this->actuation.get_motor_offsets();
+        joint_item sample;
+        motor_setpoint setpoint;
+        while (this->pop_wait(this->samples, sample, this->states[trajectory_stage], state)) {
+            const auto start = clock_type::now();
+            setpoint.time = sample.time;
+            setpoint.joint_angles = sample.joint_angles;
+            Eigen::Map<Eigen::VectorXd>(setpoint.motor_angles.data(), m).noalias() =
+                jacobian * Eigen::Map<const Eigen::VectorXd>(sample.joint_angles.data(), n) + offsets;
+            if (!this->push_wait(this->setpoints, setpoint, state)) {
+                return;
+            }
+            this->record(state, seconds_since(start));
+        }
+    }
+
+    /**
+     * @brief Stop the threads and rethrow the first stage error, if any.
+     */
+    void script_pipeline::rethrow() {
+        if (this->failed.load(std::memory_order_acquire)) {
+            this->stop();
+            std::rethrow_exception(this->error);
+        }
+    }
+
+}
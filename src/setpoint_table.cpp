@@ -0,0 +1,293 @@
+#include "include/setpoint_table.hpp"
+#include "include/finger_description.hpp"
+#include "include/geppetto.hpp"
+#include "include/script_pipeline.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <thread>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace fm {
+
+    namespace {
+
+        const char table_file_magic[8] = {'F', 'M', 'S', 'E', 'T', 'P', 'T', '\0'};
+        const std::uint32_t table_file_version = 1;
+
+        // Fixed header of a setpoint table file, followed by the rows
+        struct table_record
+        {
+            char magic[8];
+            std::uint32_t version;
+            std::uint32_t record_size;
+            std::uint64_t file_size;
+            std::uint64_t key;
+            std::uint64_t num_samples;
+            std::uint32_t num_joints;
+            std::uint32_t num_motors;
+            double sample_period;
+        };
+
+        void mix(std::uint64_t& hash, const void* data, std::size_t count) {
+            const unsigned char* bytes = static_cast<const unsigned char*>(data);
+            for (std::size_t i = 0; i < count; i++) {
+                hash = (hash ^ bytes[i]) * 1099511628211ull;
+            }
+        }
+
+    }
+
+    /**
+     * @brief Key of a compiled script.
+     *
+     * FNV-1a over the table version, the script text, the content hash of the finger model's
+     * description, the trajectory profile and limits, and the sample period, so editing any of them
+     * compiles a new table.
+     *
+     * @param script Script text.
+     * @param finger Finger model.
+     * @param trajectory Profile and joint limits between waypoints.
+     * @param sample_period Time between setpoints.
+     * @return Key.
+     */
+    std::uint64_t setpoint_table_key(std::string_view script, const finger_model<>& finger, const trajectory_generator& trajectory,
+                                     double sample_period) {
+        std::uint64_t hash = 14695981039346656037ull;
+        const std::uint64_t model_hash = finger_description_hash(format_finger_description(finger, ""));
+        mix(hash, &table_file_version, sizeof(table_file_version));
+        mix(hash, script.data(), script.size());
+        mix(hash, &model_hash, sizeof(model_hash));
+        const profile_type profile = trajectory.get_profile();
+        mix(hash, &profile, sizeof(profile));
+        for (const Eigen::VectorXd* limits : {&trajectory.get_velocity_limits(), &trajectory.get_acceleration_limits(), &trajectory.get_jerk_limits()}) {
+            mix(hash, limits->data(), sizeof(double) * limits->size());
+        }
+        mix(hash, &sample_period, sizeof(sample_period));
+        return hash;
+    }
+
+    /**
+     * @brief Compile a script to a motor setpoint table, or reuse the cached table.
+     *
+     * The script is compiled and run through the script pipeline without pacing, and the setpoints are
+     * written row by row to a temporary file that is renamed into the cache, so concurrent compiles
+     * never see a partial table.
+     *
+     * @param script_path Geppetto script path.
+     * @param finger Finger model with tendon routing and motor shaft matrices, at its start angles.
+     * @param trajectory Profile and joint limits between waypoints.
+     * @param cache_directory Directory of compiled tables, created if missing.
+     * @param sample_period Time between setpoints.
+     * @return Path of the table.
+     */
+    std::string compile_setpoint_table(const std::string& script_path, const finger_model<>& finger, const trajectory_generator& trajectory,
+                                       const std::string& cache_directory, double sample_period) {
+        std::uint64_t key;
+        geppetto::program code;
+        {
+            geppetto::script_file script(script_path);
+            key = setpoint_table_key(script.get_text(), finger, trajectory, sample_period);
+
+            char name[32];
+            std::snprintf(name, sizeof(name), "%016llx.fsetpt", static_cast<unsigned long long>(key));
+            const std::filesystem::path cache_path = std::filesystem::path(cache_directory) / name;
+            std::error_code error;
+            if (std::filesystem::exists(cache_path, error)) {
+                try {
+                    if (setpoint_table(cache_path.string()).get_key() == key) {
+                        return cache_path.string();
+                    }
+                } catch (const std::runtime_error&) {
+                    // Damaged cache entries are recompiled below
+                }
+            }
+            code = geppetto::compile(script.get_text(), finger.get_num_joints());
+        }
+
+        script_pipeline pipeline(finger);
+        pipeline.set_sample_period(sample_period);
+        pipeline.set_trajectory(trajectory);
+        table_record record;
+        std::memset(&record, 0, sizeof(record));
+        std::memcpy(record.magic, table_file_magic, sizeof(table_file_magic));
+        record.version = table_file_version;
+        record.record_size = sizeof(table_record);
+        record.key = key;
+        record.num_joints = static_cast<std::uint32_t>(finger.get_num_joints());
+        record.num_motors = static_cast<std::uint32_t>(pipeline.get_num_motors());
+        record.sample_period = sample_period;
+
+        char name[32];
+        std::snprintf(name, sizeof(name), "%016llx.fsetpt", static_cast<unsigned long long>(key));
+        const std::filesystem::path cache_path = std::filesystem::path(cache_directory) / name;
+        std::filesystem::create_directories(cache_directory);
+        const std::filesystem::path temporary = cache_path.string() + ".tmp" + std::to_string(::getpid());
+        {
+            std::ofstream file(temporary, std::ios::binary);
+            if (!file) {
+                throw std::runtime_error("could not open " + temporary.string() + " for writing");
+            }
+            file.write(reinterpret_cast<const char*>(&record), sizeof(record));
+            pipeline.start(code);
+            try {
+                pipeline.stream([&](const motor_setpoint& setpoint) {
+                    file.write(reinterpret_cast<const char*>(setpoint.motor_angles.data()), sizeof(double) * record.num_motors);
+                    file.write(reinterpret_cast<const char*>(setpoint.joint_angles.data()), sizeof(double) * record.num_joints);
+                    record.num_samples++;
+                }, false);
+            } catch (...) {
+                file.close();
+                std::filesystem::remove(temporary);
+                throw;
+            }
+            record.file_size = sizeof(table_record) + sizeof(double) * (record.num_motors + record.num_joints) * record.num_samples;
+            file.seekp(0);
+            file.write(reinterpret_cast<const char*>(&record), sizeof(record));
+            if (!file) {
+                throw std::runtime_error("failed writing " + temporary.string());
+            }
+        }
+        std::filesystem::rename(temporary, cache_path);
+        return cache_path.string();
+    }
+
+    ////////////////////////////////////////////////////////////
+    // Setpoint tables
+    ////////////////////////////////////////////////////////////
+
+    /**
+     * @brief Map a setpoint table file and validate its layout.
+     * @param path Setpoint table file path.
+     */
+    setpoint_table::setpoint_table(const std::string& path)
+        : data(nullptr), size(0), rows(nullptr), stride(0)
+    {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            throw std::runtime_error("could not open " + path + " for reading");
+        }
+        struct stat info;
+        if (::fstat(fd, &info) != 0 || info.st_size < static_cast<off_t>(sizeof(table_record))) {
+            ::close(fd);
+            throw std::runtime_error(path + " is not a setpoint table");
+        }
+        void* mapping = ::mmap(nullptr, static_cast<std::size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (mapping == MAP_FAILED) {
+            throw std::runtime_error("could not map " + path);
+        }
+        // Playback reads the rows front to back
+        ::madvise(mapping, static_cast<std::size_t>(info.st_size), MADV_SEQUENTIAL);
+        this->data = static_cast<const unsigned char*>(mapping);
+        this->size = static_cast<std::size_t>(info.st_size);
+
+        const table_record& record = *reinterpret_cast<const table_record*>(this->data);
+        bool valid = std::memcmp(record.magic, table_file_magic, sizeof(table_file_magic)) == 0 &&
+                     record.version == table_file_version &&
+                     record.record_size == sizeof(table_record) &&
+                     record.file_size == this->size &&
+                     record.num_joints >= 1 && record.num_joints <= static_cast<std::uint32_t>(max_finger_joints) &&
+                     record.num_motors >= 1 && record.num_motors <= static_cast<std::uint32_t>(max_finger_motors) &&
+                     record.sample_period > 0.0 &&
+                     sizeof(table_record) + sizeof(double) * (record.num_joints + record.num_motors) * record.num_samples == this->size;
+        if (!valid) {
+            ::munmap(const_cast<unsigned char*>(this->data), this->size);
+            throw std::runtime_error(path + " is not a compatible setpoint table");
+        }
+        this->rows = reinterpret_cast<const double*>(this->data + sizeof(table_record));
+        this->stride = record.num_motors + record.num_joints;
+    }
+
+    /**
+     * @brief Unmap the table.
+     */
+    setpoint_table::~setpoint_table()
+    {
+        ::munmap(const_cast<unsigned char*>(this->data), this->size);
+    }
+
+    ////////////////////////////////////////////////////////////
+    // Getter functions
+    ////////////////////////////////////////////////////////////
+
+    std::uint64_t setpoint_table::get_key() const {
+        return reinterpret_cast<const table_record*>(this->data)->key;
+    }
+
+    int setpoint_table::get_num_joints() const {
+        return static_cast<int>(reinterpret_cast<const table_record*>(this->data)->num_joints);
+    }
+
+    int setpoint_table::get_num_motors() const {
+        return static_cast<int>(reinterpret_cast<const table_record*>(this->data)->num_motors);
+    }
+
+    long setpoint_table::get_num_samples() const {
+        return static_cast<long>(reinterpret_cast<const table_record*>(this->data)->num_samples);
+    }
+
+    double setpoint_table::get_sample_period() const {
+        return reinterpret_cast<const table_record*>(this->data)->sample_period;
+    }
+
+    /**
+     * @brief Time of the last sample.
+     */
+    double setpoint_table::get_duration() const {
+        return std::max(0L, this->get_num_samples() - 1) * this->get_sample_period();
+    }
+
+    /**
+     * @brief Motor shaft angles of a sample.
+     * @param sample Sample index.
+     * @return Pointer to get_num_motors() angles in the mapping, valid while this object lives.
+     */
+    const double* setpoint_table::get_motor_angles(long sample) const {
+        if (sample < 0 || sample >= this->get_num_samples()) {
+            throw std::invalid_argument("sample index is out of range");
+        }
+        return this->rows + sample * this->stride;
+    }
+
+    /**
+     * @brief Joint angles of a sample.
+     * @param sample Sample index.
+     * @return Pointer to get_num_joints() angles in the mapping, valid while this object lives.
+     */
+    const double* setpoint_table::get_joint_angles(long sample) const {
+        return this->get_motor_angles(sample) + this->get_num_motors();
+    }
+
+    ////////////////////////////////////////////////////////////
+    // Member functions
+    ////////////////////////////////////////////////////////////
+
+    /**
+     * @brief Hand every sample's motor angles to a sink in order, straight from the mapping.
+     * @param sink Receives the sample index and its motor angles.
+     * @param real_time Pace the sink at the sample period.
+     */
+    void setpoint_table::play(const std::function<void(long sample, const double* motor_angles)>& sink, bool real_time) const {
+        const long samples = this->get_num_samples();
+        const auto period = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(this->get_sample_period()));
+        auto tick = std::chrono::steady_clock::now();
+        const double* row = this->rows;
+        for (long k = 0; k < samples; k++, row += this->stride) {
+            sink(k, row);
+            if (real_time) {
+                tick += period;
+                std::this_thread::sleep_until(tick);
+            }
+        }
+    }
+
+}
@@ -0,0 +1,348 @@
+#include "include/static_equilibrium_solver.hpp"
+#include <Eigen/Dense>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <exception>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace fm {
+
+    namespace {
+
+        // Diagonal shifts tried per Newton step; 4^40 covers any finite Hessian scale
+        const int max_shift_attempts = 40;
+
+    }
+
+    /**
+     * @brief Constructor for the static_equilibrium_solver class.
+     *
+     * The finger model is copied, so the solver does not depend on the caller's model afterwards.
+     *
+     * @param finger Finger model with screw axes, home frame, routing and motor shaft matrices set.
+     * @param tendon_stiffness Series stiffness of every tendon.
+     * @param joint_stiffness Return spring stiffness of every joint.
+     * @param joint_rest_angles Joint angles at which the return springs are relaxed.
+     */
+    static_equilibrium_solver::static_equilibrium_solver(const finger_model<>& finger, const Eigen::VectorXd& tendon_stiffness,
+                                                         const Eigen::VectorXd& joint_stiffness, const Eigen::VectorXd& joint_rest_angles)
+        : finger(finger),
+          actuation(finger),
+          tendon_stiffness(tendon_stiffness),
+          joint_stiffness(joint_stiffness),
+          joint_rest_angles(joint_rest_angles),
+          tolerance(1e-10),
+          max_iterations(50),
+          iterations(0),
+          converged(false)
+    {
+        const int n = finger.get_num_joints();
+        const auto& routing = finger.get_tendon_routing_matrix();
+        if (routing.rows() != n) {
+            throw std::invalid_argument("tendon_routing_matrix must have one row per joint");
+        }
+        if (tendon_stiffness.size() != routing.cols() || (tendon_stiffness.array() < 0.0).any()) {
+            throw std::invalid_argument("tendon_stiffness must have one non-negative element per tendon");
+        }
+        if (joint_stiffness.size() != n || joint_rest_angles.size() != n || (joint_stiffness.array() < 0.0).any()) {
+            throw std::invalid_argument("joint_stiffness and joint_rest_angles must have one element per joint");
+        }
+        this->joint_angles = joint_rest_angles;
+        this->tendon_tensions = Eigen::VectorXd::Zero(tendon_stiffness.size());
+    }
+
+    ////////////////////////////////////////////////////////////
+    // Setter functions
+    ////////////////////////////////////////////////////////////
+
+    /**
+     * @brief Set the convergence tolerance on the largest gradient component.
+     * @param tolerance Tolerance in Nm.
+     */
+    void static_equilibrium_solver::set_tolerance(double tolerance) {
+        if (tolerance <= 0.0) {
+            throw std::invalid_argument("tolerance must be positive");
+        }
+        this->tolerance = tolerance;
+    }
+
+    /**
+     * @brief Set the maximum number of Newton iterations.
+     * @param max_iterations Maximum iterations per solve.
+     */
+    void static_equilibrium_solver::set_max_iterations(int max_iterations) {
+        if (max_iterations < 1) {
+            throw std::invalid_argument("max_iterations must be positive");
+        }
+        this->max_iterations = max_iterations;
+    }
+
+    /**
+     * @brief Set the joint angles the next solve starts from.
+     * @param joint_angles Initial guess.
+     */
+    void static_equilibrium_solver::set_initial_guess(const Eigen::VectorXd& joint_angles) {
+        if (joint_angles.size() != this->joint_rest_angles.size()) {
+            throw std::invalid_argument("joint_angles must have one element per joint");
+        }
+        this->joint_angles = joint_angles;
+    }
+
+    ////////////////////////////////////////////////////////////
+    // Getter functions
+    ////////////////////////////////////////////////////////////
+
+    /**
+     * @brief Get the equilibrium joint angles of the last solve.
+     * @return Joint angles.
+     */
+    const Eigen::VectorXd& static_equilibrium_solver::get_joint_angles() const {
+        return joint_angles;
+    }
+
+    /**
+     * @brief Get the tendon tensions at the last equilibrium.
+     * @return Tendon tensions.
+     */
+    const Eigen::VectorXd& static_equilibrium_solver::get_tendon_tensions() const {
+        return tendon_tensions;
+    }
+
+    /**
+     * @brief Get the number of Newton iterations used by the last solve.
+     * @return Iteration count.
+     */
+    int static_equilibrium_solver::get_iterations() const {
+        return iterations;
+    }
+
+    /**
+     * @brief Get whether the last solve met the tolerance.
+     * @return True if converged.
+     */
+    bool static_equilibrium_solver::get_converged() const {
+        return converged;
+    }
+
+    ////////////////////////////////////////////////////////////
+    // Member functions
+    ////////////////////////////////////////////////////////////
+
+    /**
+     * @brief Evaluate the potential energy of the finger and optionally its gradient and Hessian.
+     *
+     * U = 1/2 sum k_s (theta - theta_0)^2 + 1/2 sum k_t max(0, l_cmd - R^T theta)^2 - f . p(theta) - m . (W^T theta)
+     * where l_cmd are the tendon lengths reeled in by the motors and (m, f) is the fingertip wrench. Slack tendons
+     * carry no tension. The moment term uses the home joint axes W, which is exact when all joint axes are
+     * parallel, as in planar fingers.
+     *
+     * @param joint_angles Joint angles.
+     * @param tendon_commands Tendon excursions commanded by the motors.
+     * @param fingertip_wrench Fingertip wrench (moment, force) in the space frame.
+     * @param gradient Optional output gradient.
+     * @param hessian Optional output Hessian.
+     * @return Potential energy.
+     */
+    double static_equilibrium_solver::evaluate(const joint_vector& joint_angles, const tendon_vector& tendon_commands,
+                                               const Eigen::VectorXd& fingertip_wrench, joint_vector* gradient, joint_matrix* hessian) const {
+        const int n = static_cast<int>(joint_angles.size());
+        const auto& R = this->finger.get_tendon_routing_matrix();
+        const auto& S = this->finger.get_home_position_screw_axes_space();
+        const Eigen::Vector3d moment = fingertip_wrench.head<3>();
+        const Eigen::Vector3d force = fingertip_wrench.tail<3>();
+
+        const joint_vector spring = joint_angles - this->joint_rest_angles;
+        const tendon_vector stretch = (tendon_commands - R.transpose() * joint_angles).cwiseMax(0.0);
+        const tendon_vector tension = this->tendon_stiffness.cwiseProduct(stretch);
+        finger_model<>::jacobian_matrix J;
+        Eigen::Matrix4d T;
+        this->finger.space_jacobian(joint_angles, J, &T);
+        const Eigen::Vector3d p = T.block<3, 1>(0, 3);
+
+        double U = 0.5 * spring.dot(this->joint_stiffness.cwiseProduct(spring)) + 0.5 * stretch.dot(tension) - force.dot(p);
+        for (int i = 0; i < n; i++) {
+            U -= moment.dot(S.block<3, 1>(0, i)) * joint_angles(i);
+        }
+
+        if (gradient != nullptr) {
+            *gradient = this->joint_stiffness.cwiseProduct(spring) - R * tension;
+            for (int i = 0; i < n; i++) {
+                Eigen::Vector3d p_dot = J.block<3, 1>(3, i) + J.block<3, 1>(0, i).cross(p);
+                (*gradient)(i) -= force.dot(p_dot) + moment.dot(S.block<3, 1>(0, i));
+            }
+        }
+
+        if (hessian != nullptr) {
+            const tendon_vector taut = (stretch.array() > 0.0).select(this->tendon_stiffness.array(), 0.0).matrix();
+            joint_matrix work;
+            this->finger.fingertip_force_hessian(joint_angles, force, work);
+            *hessian = R * taut.asDiagonal() * R.transpose() - work;
+            hessian->diagonal() += this->joint_stiffness;
+        }
+
+        return U;
+    }
+
+    /**
+     * @brief Evaluate the potential energy at a configuration.
+     * @param joint_angles Joint angles.
+     * @param motor_angles Motor shaft angles.
+     * @param fingertip_wrench Fingertip wrench (moment, force) in the space frame.
+     * @return Potential energy.
+     */
+    double static_equilibrium_solver::energy(const Eigen::VectorXd& joint_angles, const Eigen::VectorXd& motor_angles, const Eigen::VectorXd& fingertip_wrench) const {
+        if (joint_angles.size() != this->joint_rest_angles.size()) {
+            throw std::invalid_argument("joint_angles must have one element per joint");
+        }
+        return this->evaluate(joint_angles, this->actuation.motor_to_tendon(motor_angles), fingertip_wrench, nullptr, nullptr);
+    }
+
+    /**
+     * @brief Find the equilibrium joint angles for given motor positions and fingertip wrench.
+     *
+     * Newton's method on the potential energy with the analytic Hessian, a Levenberg shift whenever the
+     * Hessian is not positive definite, and a backtracking line search on the energy. The previous
+     * equilibrium is used as the starting point, so tracking slowly changing motor commands takes a few
+     * iterations. Non-finite commands or loads, or a Hessian no bounded shift makes definite, end the solve
+     * unconverged.
+     *
+     * @param motor_angles Motor shaft angles.
+     * @param fingertip_wrench Fingertip wrench (moment, force) in the space frame.
+     * @return Equilibrium joint angles.
+     */
+    const Eigen::VectorXd& static_equilibrium_solver::solve(const Eigen::VectorXd& motor_angles, const Eigen::VectorXd& fingertip_wrench) {
+        if (motor_angles.size() != this->actuation.get_num_motors()) {
+            throw std::invalid_argument("motor_angles must have one element per motor");
+        }
+        if (fingertip_wrench.size() != 6) {
+            throw std::invalid_argument("fingertip_wrench must be a 6-vector (moment, force)");
+        }
+
+        const tendon_vector commands = this->actuation.motor_to_tendon(motor_angles);
+        joint_vector angles = this->joint_angles;
+        joint_vector gradient;
+        joint_matrix hessian;
+        Eigen::LDLT<joint_matrix> ldlt;
+
+        this->converged = false;
+        this->iterations = 0;
+        while (this->iterations < this->max_iterations) {
+            double U = this->evaluate(angles, commands, fingertip_wrench, &gradient, &hessian);
+            if (!std::isfinite(U) || !gradient.allFinite() || !hessian.allFinite()) {
+                // Non-finite commands or loads; no step can be trusted
+                break;
+            }
+            if (gradient.cwiseAbs().maxCoeff() < this->tolerance) {
+                this->converged = true;
+                break;
+            }
+            this->iterations++;
+
+            // Shift the Hessian until it is positive definite so the step is a descent direction
+            double shift = 0.0;
+            double scale = 1e-8 * (1.0 + hessian.cwiseAbs().maxCoeff());
+            bool definite = false;
+            for (int attempt = 0; attempt < max_shift_attempts; attempt++) {
+                joint_matrix shifted = hessian;
+                shifted.diagonal().array() += shift;
+                ldlt.compute(shifted);
+                if (ldlt.info() == Eigen::Success && (ldlt.vectorD().array() > 0.0).all()) {
+                    definite = true;
+                    break;
+                }
+                shift = shift == 0.0 ? scale : 4.0 * shift;
+            }
+            if (!definite) {
+                break;
+            }
+            const joint_vector step = -ldlt.solve(gradient);
+
+            // Backtracking line search on the energy
+            double slope = gradient.dot(step);
+            double alpha = 1.0;
+            bool accepted = false;
+            while (alpha > 1e-12) {
+                const joint_vector candidate = angles + alpha * step;
+                if (this->evaluate(candidate, commands, fingertip_wrench, nullptr, nullptr) <= U + 1e-4 * alpha * slope) {
+                    angles = candidate;
+                    accepted = true;
+                    break;
+                }
+                alpha *= 0.5;
+            }
+            if (!accepted || (alpha * step).cwiseAbs().maxCoeff() < 1e-15) {
+                // No further decrease is possible at machine precision
+                this->converged = gradient.cwiseAbs().maxCoeff() < 1e3 * this->tolerance;
+                break;
+            }
+        }
+
+        const tendon_vector stretch = (commands - this->finger.get_tendon_routing_matrix().transpose() * angles).cwiseMax(0.0);
+        this->joint_angles = angles;
+        this->tendon_tensions = this->tendon_stiffness.cwiseProduct(stretch);
+        return this->joint_angles;
+    }
+
+    /**
+     * @brief Map the equilibrium surface over a grid of motor commands.
+     *
+     * The columns are split into contiguous blocks, one per thread. Each thread runs its own copy of the
+     * solver and warm-starts every solve from its previous column, so neighbouring grid points should be
+     * adjacent columns. The inputs are checked before the threads start, and the first error a worker
+     * throws stops the others and is rethrown once they have joined.
+     *
+     * @param motor_angle_grid Motor shaft angles, one command per column (motors x grid points).
+     * @param fingertip_wrench Fingertip wrench (moment, force) in the space frame.
+     * @param num_threads Number of worker threads; 0 uses the hardware concurrency.
+     * @return Equilibrium joint angles (joints x grid points).
+     */
+    Eigen::MatrixXd static_equilibrium_solver::solve_grid(const Eigen::MatrixXd& motor_angle_grid, const Eigen::VectorXd& fingertip_wrench, int num_threads) const {
+        // Check what solve() would reject before any worker starts
+        if (motor_angle_grid.rows() != this->actuation.get_num_motors()) {
+            throw std::invalid_argument("motor_angle_grid must have one row per motor");
+        }
+        if (fingertip_wrench.size() != 6) {
+            throw std::invalid_argument("fingertip_wrench must be a 6-vector (moment, force)");
+        }
+
+        const int columns = static_cast<int>(motor_angle_grid.cols());
+        Eigen::MatrixXd result(this->joint_angles.size(), columns);
+        if (num_threads <= 0) {
+            num_threads = std::max(1u, std::thread::hardware_concurrency());
+        }
+        num_threads = std::max(1, std::min(num_threads, columns));
+
+        std::atomic<bool> failed(false);
+        std::exception_ptr error;
+        std::vector<std::thread> workers;
+        for (int t = 0; t < num_threads; t++) {
+            int begin = static_cast<int>(static_cast<long>(columns) * t / num_threads);
+            int end = static_cast<int>(static_cast<long>(columns) * (t + 1) / num_threads);
+            workers.emplace_back([this, &motor_angle_grid, &fingertip_wrench, &result, &failed, &error, begin, end]() {
+                try {
+                    static_equilibrium_solver solver(*this);
+                    for (int k = begin; k < end && !failed.load(std::memory_order_relaxed); k++) {
+                        result.col(k) = solver.solve(motor_angle_grid.col(k), fingertip_wrench);
+                    }
+                } catch (...) {
+                    bool expected = false;
+                    if (failed.compare_exchange_strong(expected, true)) {
+                        error = std::current_exception();
+                    }
+                }
+            });
+        }
+        for (auto& worker : workers) {
+            worker.join();
+        }
+        if (error) {
+            std::rethrow_exception(error);
+        }
+
+        return result;
+    }
+
+}
@@ -0,0 +1,345 @@
+#include "include/tendon_routing_model.hpp"
+#include <Eigen/Dense>
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+namespace fm {
+
+    /**
+     * @brief Constructor for the tendon_routing_model class.
+     * @param num_joints Number of joints of the finger.
+     * @param num_tendons Number of tendons of the finger.
+     */
+    tendon_routing_model::tendon_routing_model(int num_joints, int num_tendons)
+        : num_joints(num_joints),
+          num_tendons(num_tendons),
+          interpolation_error(0.0),
+          compiled(false)
+    {
+        if (num_joints < 1 || num_tendons < 1) {
+            throw std::invalid_argument("tendon_routing_model needs at least one joint and one tendon");
+        }
+        this->routing.resize(num_joints * num_tendons);
+        this->tables.resize(num_joints);
+    }
+
+    ////////////////////////////////////////////////////////////
+    // Setter functions
+    ////////////////////////////////////////////////////////////
+
+    /**
+     * @brief Set the routing geometry of one tendon across one joint.
+     * @param joint Joint index.
+     * @param tendon Tendon index.
+     * @param routing Routing geometry in the joint's plane of rotation.
+     */
+    void tendon_routing_model::set_joint_routing(int joint, int tendon, const tendon_joint_routing& routing) {
+        if (joint < 0 || joint >= this->num_joints || tendon < 0 || tendon >= this->num_tendons) {
+            throw std::invalid_argument("joint or tendon index out of range");
+        }
+        this->routing[joint * this->num_tendons + tendon] = routing;
+        this->compiled = false;
+    }
+
+    ////////////////////////////////////////////////////////////
+    // Getter functions
+    ////////////////////////////////////////////////////////////
+
+    /**
+     * @brief Get the routing geometry of one tendon across one joint.
+     * @param joint Joint index.
+     * @param tendon Tendon index.
+     * @return Routing geometry.
+     */
+    const tendon_joint_routing& tendon_routing_model::get_joint_routing(int joint, int tendon) const {
+        if (joint < 0 || joint >= this->num_joints || tendon < 0 || tendon >= this->num_tendons) {
+            throw std::invalid_argument("joint or tendon index out of range");
+        }
+        return routing[joint * num_tendons + tendon];
+    }
+
+    /**
+     * @brief Get the number of joints.
+     * @return Number of joints.
+     */
+    int tendon_routing_model::get_num_joints() const {
+        return num_joints;
+    }
+
+    /**
+     * @brief Get the number of tendons.
+     * @return Number of tendons.
+     */
+    int tendon_routing_model::get_num_tendons() const {
+        return num_tendons;
+    }
+
+    /**
+     * @brief Get the number of spline intervals chosen for a joint by compile().
+     * @param joint Joint index.
+     * @return Number of intervals.
+     */
+    int tendon_routing_model::get_num_intervals(int joint) const {
+        return tables.at(joint).num_intervals;
+    }
+
+    /**
+     * @brief Get the largest moment arm interpolation error measured by compile().
+     * @return Maximum absolute moment arm error.
+     */
+    double tendon_routing_model::get_interpolation_error() const {
+        return interpolation_error;
+    }
+
+    ////////////////////////////////////////////////////////////
+    // Member functions
+    ////////////////////////////////////////////////////////////
+
+    /**
+     * @brief Evaluate the exact moment arm of a routing and its derivative with respect to the joint angle.
+     *
+     * The moment arm is r = -dL/dtheta, where L is the tendon length across the joint, so that a positive
+     * tension on a tendon with a positive moment arm produces a positive joint torque.
+     *
+     * @param routing Routing geometry.
+     * @param joint_angle Joint angle in radians.
+     * @param moment_arm Output moment arm.
+     * @param derivative Output derivative of the moment arm.
+     */
+    void tendon_routing_model::exact_moment_arm(const tendon_joint_routing& routing, double joint_angle, double& moment_arm, double& derivative) {
+        switch (routing.kind) {
+        case tendon_joint_routing::type::pulley:
+            moment_arm = routing.pulley_radius;
+            derivative = 0.0;
+            return;
+        case tendon_joint_routing::type::via_points: {
+            const Eigen::Vector2d& a = routing.proximal_point;
+            double c = cos(joint_angle), s = sin(joint_angle);
+            Eigen::Vector2d b(c * routing.distal_point(0) - s * routing.distal_point(1),
+                              s * routing.distal_point(0) + c * routing.distal_point(1));
+            double L = (b - a).norm();
+            if (L < 1e-12) {
+                throw std::invalid_argument("via points coincide; tendon length is degenerate");
+            }
+            // r = a . (J b) / L with J the 90 degree rotation, dr = (r^2 - a . b) / L
+            moment_arm = (a(0) * -b(1) + a(1) * b(0)) / L;
+            derivative = (moment_arm * moment_arm - a.dot(b)) / L;
+            return;
+        }
+        default:
+            moment_arm = 0.0;
+            derivative = 0.0;
+            return;
+        }
+    }
+
+    /**
+     * @brief Fit the spline tables of one joint with a fixed number of intervals.
+     * @param joint Joint index.
+     * @param num_intervals Number of uniform intervals over the joint range.
+     */
+    void tendon_routing_model::build_table(int joint, int num_intervals) {
+        joint_table& table = this->tables[joint];
+        table.num_intervals = num_intervals;
+        table.interval = (table.joint_max - table.joint_min) / num_intervals;
+        table.inverse_interval = 1.0 / table.interval;
+
+        const int T = static_cast<int>(table.tendons.size());
+        table.coefficients.assign(static_cast<size_t>(num_intervals) * T * 5, 0.0);
+
+        for (int t = 0; t < T; t++) {
+            const tendon_joint_routing& r = this->routing[joint * this->num_tendons + table.tendons[t]];
+            double p0, m0, p1, m1;
+            exact_moment_arm(r, table.joint_min, p0, m0);
+            double excursion = 0.0;
+            for (int k = 0; k < num_intervals; k++) {
+                exact_moment_arm(r, table.joint_min + (k + 1) * table.interval, p1, m1);
+
+                // Cubic Hermite coefficients in the normalized coordinate u in [0, 1]
+                double d0 = m0 * table.interval, d1 = m1 * table.interval;
+                double* c = table.coefficients.data() + (static_cast<size_t>(k) * T + t) * 5;
+                c[0] = p0;
+                c[1] = d0;
+                c[2] = 3.0 * (p1 - p0) - 2.0 * d0 - d1;
+                c[3] = 2.0 * (p0 - p1) + d0 + d1;
+                c[4] = excursion;
+                excursion += table.interval * (c[0] + c[1] / 2.0 + c[2] / 3.0 + c[3] / 4.0);
+
+                p0 = p1;
+                m0 = m1;
+            }
+        }
+
+        // Excursions are reported relative to the zero joint angle
+        table.zero_excursion.assign(T, 0.0);
+        int k;
+        double u;
+        lookup(table, 0.0, k, u);
+        for (int t = 0; t < T; t++) {
+            const double* c = &table.coefficients[(static_cast<size_t>(k) * T + t) * 5];
+            table.zero_excursion[t] = c[4] + table.interval * u * (c[0] + u * (c[1] / 2.0 + u * (c[2] / 3.0 + u * c[3] / 4.0)));
+        }
+    }
+
+    /**
+     * @brief Locate the spline interval of a joint angle, clamping to the tabulated range.
+     * @param table Joint table.
+     * @param joint_angle Joint angle in radians.
+     * @param interval Output interval index.
+     * @param u Output normalized coordinate within the interval.
+     */
+    void tendon_routing_model::lookup(const joint_table& table, double joint_angle, int& interval, double& u) const {
+        double x = (std::min(std::max(joint_angle, table.joint_min), table.joint_max) - table.joint_min) * table.inverse_interval;
+        interval = std::min(static_cast<int>(x), table.num_intervals - 1);
+        u = x - interval;
+    }
+
+    /**
+     * @brief Precompute the per-joint spline tables from the routing geometry.
+     *
+     * Each joint's table is refined by doubling the number of uniform intervals until the moment arm error,
+     * checked against the exact geometry inside every interval, is below the tolerance.
+     *
+     * @param joint_min Lower joint limits.
+     * @param joint_max Upper joint limits.
+     * @param tolerance Maximum allowed moment arm interpolation error.
+     */
+    void tendon_routing_model::compile(const Eigen::VectorXd& joint_min, const Eigen::VectorXd& joint_max, double tolerance) {
+        if (joint_min.size() != this->num_joints || joint_max.size() != this->num_joints) {
+            throw std::invalid_argument("joint limits must have one element per joint");
+        }
+        if (!((joint_max.array() > joint_min.array()).all()) || tolerance <= 0.0) {
+            throw std::invalid_argument("joint_max must exceed joint_min and tolerance must be positive");
+        }
+
+        const int max_intervals = 1 << 14;
+        this->interpolation_error = 0.0;
+        for (int j = 0; j < this->num_joints; j++) {
+            joint_table& table = this->tables[j];
+            table.joint_min = joint_min(j);
+            table.joint_max = joint_max(j);
+            table.tendons.clear();
+            for (int t = 0; t < this->num_tendons; t++) {
+                if (this->routing[j * this->num_tendons + t].kind != tendon_joint_routing::type::none) {
+                    table.tendons.push_back(t);
+                }
+            }
+
+            const int T = static_cast<int>(table.tendons.size());
+            int num_intervals = 8;
+            double error = 0.0;
+            while (true) {
+                build_table(j, num_intervals);
+                error = 0.0;
+                for (int k = 0; k < num_intervals; k++) {
+                    for (double u : {0.25, 0.5, 0.75}) {
+                        double theta = table.joint_min + (k + u) * table.interval;
+                        for (int t = 0; t < T; t++) {
+                            const double* c = table.coefficients.data() + (static_cast<size_t>(k) * T + t) * 5;
+                            double exact, derivative;
+                            exact_moment_arm(this->routing[j * this->num_tendons + table.tendons[t]], theta, exact, derivative);
+                            error = std::max(error, std::abs(c[0] + u * (c[1] + u * (c[2] + u * c[3])) - exact));
+                        }
+                    }
+                }
+                if (error <= tolerance || num_intervals >= max_intervals) {
+                    break;
+                }
+                num_intervals *= 2;
+            }
+            this->interpolation_error = std::max(this->interpolation_error, error);
+        }
+        this->compiled = true;
+    }
+
+    /**
+     * @brief Evaluate the configuration-dependent routing matrix and its derivative.
+     *
+     * Entry (j, i) is the moment arm of tendon i about joint j, so joint torques are tau = R(theta) f.
+     * Because each moment arm only depends on the angle of its own joint, entry (j, i) of the derivative
+     * is dR(j, i)/dtheta_j. Angles outside the compiled joint range are clamped.
+     *
+     * @param joint_angles Joint angles in radians.
+     * @param routing_matrix Output routing matrix (joints x tendons).
+     * @param routing_matrix_derivative Output derivative of the routing matrix (joints x tendons).
+     */
+    void tendon_routing_model::evaluate(const Eigen::Ref<const Eigen::VectorXd>& joint_angles, Eigen::Ref<Eigen::MatrixXd> routing_matrix,
+                                        Eigen::Ref<Eigen::MatrixXd> routing_matrix_derivative) const {
+        if (!this->compiled) {
+            throw std::runtime_error("tendon_routing_model must be compiled before evaluation");
+        }
+        if (joint_angles.size() != this->num_joints) {
+            throw std::invalid_argument("joint_angles must have one element per joint");
+        }
+
+        routing_matrix.setZero();
+        routing_matrix_derivative.setZero();
+        for (int j = 0; j < this->num_joints; j++) {
+            const joint_table& table = this->tables[j];
+            const int T = static_cast<int>(table.tendons.size());
+            if (T == 0) {
+                // No tendon crosses this joint, so its table is empty
+                continue;
+            }
+            int k;
+            double u;
+            lookup(table, joint_angles(j), k, u);
+            const double* c = table.coefficients.data() + static_cast<size_t>(k) * T * 5;
+            for (int t = 0; t < T; t++, c += 5) {
+                routing_matrix(j, table.tendons[t]) = c[0] + u * (c[1] + u * (c[2] + u * c[3]));
+                routing_matrix_derivative(j, table.tendons[t]) = (c[1] + u * (2.0 * c[2] + 3.0 * u * c[3])) * table.inverse_interval;
+            }
+        }
+    }
+
+    /**
+     * @brief Evaluate the configuration-dependent routing matrix.
+     * @param joint_angles Joint angles in radians.
+     * @return Routing matrix (joints x tendons).
+     */
+    Eigen::MatrixXd tendon_routing_model::routing_matrix(const Eigen::Ref<const Eigen::VectorXd>& joint_angles) const {
+        Eigen::MatrixXd R(this->num_joints, this->num_tendons);
+        Eigen::MatrixXd dR(this->num_joints, this->num_tendons);
+        this->evaluate(joint_angles, R, dR);
+        return R;
+    }
+
+    /**
+     * @brief Evaluate the tendon excursions (tendon shortening relative to the zero pose).
+     *
+     * The excursion of tendon i is the sum over joints of the integrated moment arm, so its gradient with
+     * respect to the joint angles is column i of the routing matrix.
+     *
+     * @param joint_angles Joint angles in radians.
+     * @param excursions Output tendon excursions.
+     */
+    void tendon_routing_model::tendon_excursions(const Eigen::Ref<const Eigen::VectorXd>& joint_angles, Eigen::Ref<Eigen::VectorXd> excursions) const {
+        if (!this->compiled) {
+            throw std::runtime_error("tendon_routing_model must be compiled before evaluation");
+        }
+        if (joint_angles.size() != this->num_joints || excursions.size() != this->num_tendons) {
+            throw std::invalid_argument("joint_angles and excursions must match the model size");
+        }
+
+        excursions.setZero();
+        for (int j = 0; j < this->num_joints; j++) {
+            const joint_table& table = this->tables[j];
+            const int T = static_cast<int>(table.tendons.size());
+            if (T == 0) {
+                // No tendon crosses this joint, so its table is empty
+                continue;
+            }
+            int k;
+            double u;
+            lookup(table, joint_angles(j), k, u);
+            const double* c = table.coefficients.data() + static_cast<size_t>(k) * T * 5;
+            for (int t = 0; t < T; t++, c += 5) {
+                double integral = c[4] + table.interval * u * (c[0] + u * (c[1] / 2.0 + u * (c[2] / 3.0 + u * c[3] / 4.0)));
+                excursions(table.tendons[t]) += integral - table.zero_excursion[t];
+            }
+        }
+    }
+
+}
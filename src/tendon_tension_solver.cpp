@@ -0,0 +1,248 @@
+#include "include/tendon_tension_solver.hpp"
+#include <Eigen/Dense>
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace fm {
+
+    /**
+     * @brief Constructor for the tendon_tension_solver class.
+     * @param tendon_routing_matrix Routing matrix R (joints x tendons) mapping tendon tensions to joint torques, tau = R * f.
+     * @param min_tension Lower bound on every tendon tension (tendons can only pull).
+     * @param max_tension Upper bound on every tendon tension.
+     * @param regularization Relative weight of the minimum-tension term used to pick a solution among redundant tendons.
+     */
+    tendon_tension_solver::tendon_tension_solver(const Eigen::MatrixXd& tendon_routing_matrix, double min_tension,
+                                                 double max_tension, double regularization)
+        : min_tension(min_tension),
+          max_tension(max_tension),
+          regularization(regularization),
+          warm(false),
+          torque_residual(0.0),
+          iterations(0)
+    {
+        if (regularization <= 0.0) {
+            throw std::invalid_argument("regularization must be positive");
+        }
+        this->set_tension_limits(min_tension, max_tension);
+        this->set_tendon_routing_matrix(tendon_routing_matrix);
+    }
+
+    ////////////////////////////////////////////////////////////
+    // Setter functions
+    ////////////////////////////////////////////////////////////
+
+    /**
+     * @brief Set the tendon routing matrix and precompute the normal equations.
+     * @param tendon_routing_matrix Routing matrix R (joints x tendons).
+     */
+    void tendon_tension_solver::set_tendon_routing_matrix(const Eigen::MatrixXd& tendon_routing_matrix) {
+        if (tendon_routing_matrix.rows() < 1 || tendon_routing_matrix.rows() > max_solver_joints ||
+            tendon_routing_matrix.cols() < 1 || tendon_routing_matrix.cols() > max_solver_tendons) {
+            throw std::invalid_argument("tendon_routing_matrix must have 1-8 rows and 1-8 columns");
+        }
+
+        this->routing = tendon_routing_matrix;
+        this->hessian = this->routing.transpose() * this->routing;
+
+        // Scale the minimum-tension term to the routing matrix so it only breaks ties between redundant tendons
+        double scale = this->hessian.diagonal().maxCoeff();
+        double lambda = this->regularization * (scale > 0.0 ? scale : 1.0);
+        this->hessian.diagonal().array() += lambda;
+
+        this->tensions = tension_vector::Constant(this->routing.cols(), this->min_tension);
+        this->reset();
+    }
+
+    /**
+     * @brief Set the tension limits applied to every tendon.
+     * @param min_tension Lower tension bound.
+     * @param max_tension Upper tension bound (may be infinity).
+     */
+    void tendon_tension_solver::set_tension_limits(double min_tension, double max_tension) {
+        if (!std::isfinite(min_tension) || !(max_tension >= min_tension)) {
+            throw std::invalid_argument("tension limits must satisfy finite min_tension <= max_tension");
+        }
+        this->min_tension = min_tension;
+        this->max_tension = max_tension;
+        this->warm = false;
+    }
+
+    ////////////////////////////////////////////////////////////
+    // Getter functions
+    ////////////////////////////////////////////////////////////
+
+    /**
+     * @brief Get the tensions found by the last call to solve().
+     * @return Vector of tendon tensions.
+     */
+    const tendon_tension_solver::tension_vector& tendon_tension_solver::get_tensions() const {
+        return tensions;
+    }
+
+    /**
+     * @brief Get the joint torque error of the last solution, |R f - tau|.
+     * @return Norm of the torque residual; nonzero when the torque is not reachable within the tension limits.
+     */
+    double tendon_tension_solver::get_torque_residual() const {
+        return torque_residual;
+    }
+
+    /**
+     * @brief Get the number of active-set iterations used by the last call to solve().
+     * @return Iteration count.
+     */
+    int tendon_tension_solver::get_iterations() const {
+        return iterations;
+    }
+
+    ////////////////////////////////////////////////////////////
+    // Member functions
+    ////////////////////////////////////////////////////////////
+
+    /**
+     * @brief Discard the warm start so the next solve starts with every tendon at its minimum tension.
+     */
+    void tendon_tension_solver::reset() {
+        this->warm = false;
+    }
+
+    /**
+     * @brief Find tendon tensions that produce the desired joint torques.
+     *
+     * Solves min |R f - tau|^2 + lambda |f|^2 subject to min_tension <= f <= max_tension with a primal
+     * active-set method. The active set of the previous call is reused, so consecutive control ticks with
+     * slowly varying torques usually finish in a single factorization. All workspaces are fixed-capacity,
+     * so the call does not allocate.
+     *
+     * @param joint_torques Desired joint torques (one per row of the routing matrix).
+     * @return Vector of tendon tensions.
+     */
+    const tendon_tension_solver::tension_vector& tendon_tension_solver::solve(const Eigen::Ref<const Eigen::VectorXd>& joint_torques) {
+        const int n = static_cast<int>(this->routing.rows());
+        const int m = static_cast<int>(this->routing.cols());
+        if (joint_torques.size() != n) {
+            throw std::invalid_argument("joint_torques must have one element per routing matrix row");
+        }
+
+        // Linear term of the quadratic program
+        tension_vector c = this->routing.transpose() * joint_torques;
+
+        // Start from the previous active set, or from every tendon at its lower bound
+        if (!this->warm) {
+            for (int i = 0; i < m; i++) {
+                this->active_set[i] = bound::lower;
+            }
+        }
+        for (int i = 0; i < m; i++) {
+            if (this->active_set[i] == bound::lower) {
+                this->tensions(i) = this->min_tension;
+            } else if (this->active_set[i] == bound::upper) {
+                this->tensions(i) = this->max_tension;
+            } else {
+                this->tensions(i) = std::min(std::max(this->tensions(i), this->min_tension), this->max_tension);
+            }
+        }
+
+        const double tol = 1e-12 * (1.0 + c.cwiseAbs().maxCoeff() + this->hessian.diagonal().maxCoeff());
+        const int max_iter = 4 * m + 8;
+
+        int free_index[max_solver_tendons];
+        hessian_matrix H_free;
+        tension_vector rhs, step;
+        Eigen::LDLT<hessian_matrix> ldlt;
+
+        int iter = 0;
+        while (iter < max_iter) {
+            iter++;
+
+            // Gradient of the objective at the current tensions
+            tension_vector gradient = this->hessian * this->tensions - c;
+
+            // Newton step restricted to the free tendons
+            int k = 0;
+            for (int i = 0; i < m; i++) {
+                if (this->active_set[i] == bound::free) {
+                    free_index[k++] = i;
+                }
+            }
+
+            double step_norm = 0.0;
+            if (k > 0) {
+                H_free.resize(k, k);
+                rhs.resize(k);
+                for (int a = 0; a < k; a++) {
+                    rhs(a) = -gradient(free_index[a]);
+                    for (int b = 0; b < k; b++) {
+                        H_free(a, b) = this->hessian(free_index[a], free_index[b]);
+                    }
+                }
+                ldlt.compute(H_free);
+                step = ldlt.solve(rhs);
+                step_norm = step.cwiseAbs().maxCoeff();
+            }
+
+            if (step_norm <= tol) {
+                // Stationary on the free set: release the bound tendon with the most negative multiplier
+                int release = -1;
+                double worst = tol;
+                for (int i = 0; i < m; i++) {
+                    double violation = 0.0;
+                    if (this->active_set[i] == bound::lower) {
+                        violation = -gradient(i);
+                    } else if (this->active_set[i] == bound::upper) {
+                        violation = gradient(i);
+                    }
+                    if (violation > worst) {
+                        worst = violation;
+                        release = i;
+                    }
+                }
+                if (release < 0) {
+                    break;
+                }
+                this->active_set[release] = bound::free;
+                continue;
+            }
+
+            // Take the longest feasible fraction of the step and bind the blocking tendon
+            double alpha = 1.0;
+            int blocking = -1;
+            bound blocking_bound = bound::free;
+            for (int a = 0; a < k; a++) {
+                int i = free_index[a];
+                if (step(a) < 0.0) {
+                    double limit = (this->min_tension - this->tensions(i)) / step(a);
+                    if (limit < alpha) {
+                        alpha = limit;
+                        blocking = i;
+                        blocking_bound = bound::lower;
+                    }
+                } else if (step(a) > 0.0 && std::isfinite(this->max_tension)) {
+                    double limit = (this->max_tension - this->tensions(i)) / step(a);
+                    if (limit < alpha) {
+                        alpha = limit;
+                        blocking = i;
+                        blocking_bound = bound::upper;
+                    }
+                }
+            }
+
+            alpha = std::max(alpha, 0.0);
+            for (int a = 0; a < k; a++) {
+                this->tensions(free_index[a]) += alpha * step(a);
+            }
+            if (blocking >= 0) {
+                this->active_set[blocking] = blocking_bound;
+                this->tensions(blocking) = blocking_bound == bound::lower ? this->min_tension : this->max_tension;
+            }
+        }
+
+        this->iterations = iter;
+        this->torque_residual = (this->routing * this->tensions - joint_torques).norm();
+        this->warm = true;
+        return this->tensions;
+    }
+
+}
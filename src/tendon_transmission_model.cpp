@@ -0,0 +1,224 @@
+#include "include/tendon_transmission_model.hpp"
+#include "include/tendon_tension_solver.hpp"
+#include <Eigen/Dense>
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+namespace fm {
+
+    /**
+     * @brief Constructor for the tendon_transmission_model class.
+     * @param tendon_routing_matrix Routing matrix R (joints x tendons), tau = R * f.
+     * @param tendons Physical parameters of every tendon.
+     */
+    tendon_transmission_model::tendon_transmission_model(const Eigen::MatrixXd& tendon_routing_matrix, const std::vector<tendon_parameters>& tendons)
+        : tendon_routing_matrix(tendon_routing_matrix),
+          tendons(tendons),
+          wrap_angles(Eigen::MatrixXd::Zero(tendon_routing_matrix.rows(), tendon_routing_matrix.cols())),
+          velocity_deadband(1e-4)
+    {
+        const int m = static_cast<int>(tendon_routing_matrix.cols());
+        if (tendon_routing_matrix.rows() < 1 || m < 1) {
+            throw std::invalid_argument("tendon_routing_matrix must not be empty");
+        }
+        if (static_cast<int>(tendons.size()) != m) {
+            throw std::invalid_argument("tendons must have one entry per routing matrix column");
+        }
+
+        this->stiffness.resize(m);
+        this->friction_coefficient.resize(m);
+        this->current_per_tension.resize(m);
+        for (int i = 0; i < m; i++) {
+            if (tendons[i].stiffness <= 0.0 || tendons[i].torque_constant <= 0.0) {
+                throw std::invalid_argument("tendon stiffness and motor torque constant must be positive");
+            }
+            this->stiffness(i) = tendons[i].stiffness;
+            this->friction_coefficient(i) = tendons[i].friction_coefficient;
+            this->current_per_tension(i) = tendons[i].spool_radius / tendons[i].torque_constant;
+        }
+
+        // Stretch d shortens the effective excursion, R^T dtheta = -d, so dtheta = -(R^T)^+ d
+        this->stretch_to_joint_error = -tendon_routing_matrix.transpose().completeOrthogonalDecomposition().pseudoInverse();
+    }
+
+    ////////////////////////////////////////////////////////////
+    // Setter functions
+    ////////////////////////////////////////////////////////////
+
+    /**
+     * @brief Set constant wrap angles at every routing point.
+     *
+     * When routing geometry is also set, these angles are added to the configuration-dependent wrap, e.g. for sheaths.
+     *
+     * @param wrap_angles Wrap angle of every tendon at every joint (joints x tendons).
+     */
+    void tendon_transmission_model::set_wrap_angles(const Eigen::MatrixXd& wrap_angles) {
+        if (wrap_angles.rows() != this->tendon_routing_matrix.rows() || wrap_angles.cols() != this->tendon_routing_matrix.cols()) {
+            throw std::invalid_argument("wrap_angles must have the same shape as the tendon routing matrix");
+        }
+        if ((wrap_angles.array() < 0.0).any()) {
+            throw std::invalid_argument("wrap_angles must be non-negative");
+        }
+        this->wrap_angles = wrap_angles;
+    }
+
+    /**
+     * @brief Use routing geometry to compute configuration-dependent wrap angles.
+     * @param routing Routing model with the same number of joints and tendons.
+     */
+    void tendon_transmission_model::set_routing_geometry(const tendon_routing_model& routing) {
+        const int n = static_cast<int>(this->tendon_routing_matrix.rows());
+        const int m = static_cast<int>(this->tendon_routing_matrix.cols());
+        if (routing.get_num_joints() != n || routing.get_num_tendons() != m) {
+            throw std::invalid_argument("routing geometry must match the tendon routing matrix shape");
+        }
+        this->routing_geometry.resize(n * m);
+        for (int j = 0; j < n; j++) {
+            for (int i = 0; i < m; i++) {
+                this->routing_geometry[j * m + i] = routing.get_joint_routing(j, i);
+            }
+        }
+    }
+
+    /**
+     * @brief Set the tendon velocity below which capstan friction is blended between its two directions.
+     * @param velocity_deadband Velocity scale in m/s.
+     */
+    void tendon_transmission_model::set_velocity_deadband(double velocity_deadband) {
+        if (velocity_deadband <= 0.0) {
+            throw std::invalid_argument("velocity_deadband must be positive");
+        }
+        this->velocity_deadband = velocity_deadband;
+    }
+
+    ////////////////////////////////////////////////////////////
+    // Getter functions
+    ////////////////////////////////////////////////////////////
+
+    /**
+     * @brief Get the tendon routing matrix.
+     * @return Routing matrix (joints x tendons).
+     */
+    const Eigen::MatrixXd& tendon_transmission_model::get_tendon_routing_matrix() const {
+        return tendon_routing_matrix;
+    }
+
+    /**
+     * @brief Get the tendon parameters.
+     * @return Vector of tendon parameters.
+     */
+    const std::vector<tendon_parameters>& tendon_transmission_model::get_tendon_parameters() const {
+        return tendons;
+    }
+
+    ////////////////////////////////////////////////////////////
+    // Member functions
+    ////////////////////////////////////////////////////////////
+
+    /**
+     * @brief Compute the total wrap angle of every tendon at every sample.
+     *
+     * Pulley routings wrap by their base angle plus the joint rotation in the tendon's pulling direction.
+     * Via-point routings bend where the tendon leaves the proximal link axis and where it joins the distal
+     * link axis; both bends are computed from the via-point geometry.
+     *
+     * @param joint_angles Joint angles (joints x samples).
+     * @param wrap_angles Output wrap angles (tendons x samples).
+     */
+    void tendon_transmission_model::compute_wrap_angles(const Eigen::Ref<const Eigen::MatrixXd>& joint_angles, Eigen::MatrixXd& wrap_angles) const {
+        const int n = static_cast<int>(this->tendon_routing_matrix.rows());
+        const int m = static_cast<int>(this->tendon_routing_matrix.cols());
+        const Eigen::Index N = joint_angles.cols();
+
+        // Constant wrap angles are the same for every sample
+        wrap_angles.resize(m, N);
+        wrap_angles.colwise() = this->wrap_angles.colwise().sum().transpose();
+        if (this->routing_geometry.empty()) {
+            return;
+        }
+
+        auto atan2_op = [](double y, double x) { return std::atan2(y, x); };
+        for (int j = 0; j < n; j++) {
+            Eigen::ArrayXXd theta = joint_angles.row(j).array();
+            Eigen::ArrayXXd c = theta.cos(), s = theta.sin();
+            for (int i = 0; i < m; i++) {
+                const tendon_joint_routing& r = this->routing_geometry[j * m + i];
+                if (r.kind == tendon_joint_routing::type::pulley) {
+                    double direction = r.pulley_radius >= 0.0 ? 1.0 : -1.0;
+                    wrap_angles.row(i).array() += (r.pulley_wrap_angle + direction * theta).max(0.0);
+                } else if (r.kind == tendon_joint_routing::type::via_points) {
+                    Eigen::ArrayXXd dx = c * r.distal_point(0) - s * r.distal_point(1) - r.proximal_point(0);
+                    Eigen::ArrayXXd dy = s * r.distal_point(0) + c * r.distal_point(1) - r.proximal_point(1);
+                    Eigen::ArrayXXd heading = dy.binaryExpr(dx, atan2_op);
+                    Eigen::ArrayXXd bend = theta - heading;
+                    wrap_angles.row(i).array() += heading.abs() + bend.sin().binaryExpr(bend.cos(), atan2_op).abs();
+                }
+            }
+        }
+    }
+
+    /**
+     * @brief Evaluate the transmission for a whole trajectory from the tensions delivered at the joints.
+     *
+     * Every quantity is computed for all tendons and samples with whole-matrix array operations. The motor
+     * tension follows the capstan equation f_motor = f_joint * exp(mu * phi * sgn(v)), where v is the rate
+     * at which the motor reels the tendon in, so friction adds to the motor effort while pulling and relieves
+     * it while paying out. The sign is blended with tanh over the velocity deadband.
+     *
+     * @param joint_angles Joint angles (joints x samples).
+     * @param joint_velocities Joint velocities (joints x samples).
+     * @param joint_tensions Tensions required at the joints (tendons x samples).
+     * @param effort Output transmission state.
+     */
+    void tendon_transmission_model::evaluate(const Eigen::Ref<const Eigen::MatrixXd>& joint_angles, const Eigen::Ref<const Eigen::MatrixXd>& joint_velocities,
+                                             const Eigen::Ref<const Eigen::MatrixXd>& joint_tensions, transmission_effort& effort) const {
+        const Eigen::Index n = this->tendon_routing_matrix.rows();
+        const Eigen::Index m = this->tendon_routing_matrix.cols();
+        const Eigen::Index N = joint_angles.cols();
+        if (joint_angles.rows() != n || joint_velocities.rows() != n || joint_velocities.cols() != N ||
+            joint_tensions.rows() != m || joint_tensions.cols() != N) {
+            throw std::invalid_argument("trajectory matrices must be joints x samples and tensions tendons x samples");
+        }
+
+        this->compute_wrap_angles(joint_angles, effort.wrap_angles);
+
+        // Capstan losses between the motor spool and the joints
+        Eigen::ArrayXXd reel_direction = ((this->tendon_routing_matrix.transpose() * joint_velocities).array() / this->velocity_deadband).tanh();
+        Eigen::ArrayXXd exponent = (effort.wrap_angles.array() * reel_direction).colwise() * this->friction_coefficient;
+        effort.joint_tensions = joint_tensions;
+        effort.motor_tensions = joint_tensions.array() * exponent.exp();
+
+        // Series elasticity, using the mean tension along the tendon
+        effort.tendon_stretch = (0.5 * (effort.joint_tensions.array() + effort.motor_tensions.array())).colwise() / this->stiffness;
+        effort.motor_currents = effort.motor_tensions.array().colwise() * this->current_per_tension;
+        effort.joint_errors.noalias() = this->stretch_to_joint_error * effort.tendon_stretch;
+    }
+
+    /**
+     * @brief Evaluate the transmission for a whole trajectory from the joint torques it requires.
+     *
+     * Tensions are found per sample with a warm-started tendon_tension_solver, then the trajectory is
+     * evaluated in one pass with evaluate().
+     *
+     * @param joint_angles Joint angles (joints x samples).
+     * @param joint_velocities Joint velocities (joints x samples).
+     * @param joint_torques Joint torques (joints x samples).
+     * @param min_tension Minimum tendon tension.
+     * @param effort Output transmission state.
+     */
+    void tendon_transmission_model::evaluate_torques(const Eigen::Ref<const Eigen::MatrixXd>& joint_angles, const Eigen::Ref<const Eigen::MatrixXd>& joint_velocities,
+                                                     const Eigen::Ref<const Eigen::MatrixXd>& joint_torques, double min_tension, transmission_effort& effort) const {
+        if (joint_torques.rows() != this->tendon_routing_matrix.rows() || joint_torques.cols() != joint_angles.cols()) {
+            throw std::invalid_argument("joint_torques must be joints x samples");
+        }
+
+        tendon_tension_solver solver(this->tendon_routing_matrix, min_tension);
+        Eigen::MatrixXd tensions(this->tendon_routing_matrix.cols(), joint_torques.cols());
+        for (Eigen::Index k = 0; k < joint_torques.cols(); k++) {
+            tensions.col(k) = solver.solve(joint_torques.col(k));
+        }
+        this->evaluate(joint_angles, joint_velocities, tensions, effort);
+    }
+
+}
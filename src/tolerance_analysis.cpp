@@ -0,0 +1,416 @@
+#include "include/tolerance_analysis.hpp"
+#include "include/open_chain_kinematics.hpp"
+#include <Eigen/Dense>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <thread>
+
+namespace fm {
+
+    namespace {
+
+        // Grid points evaluated together, so their sines and cosines are shared by every sample
+        constexpr int block_points = 64;
+
+        /**
+         * @brief Philox4x32-10 counter-based generator; the output depends only on the key and the counter.
+         * @param counter 128-bit counter.
+         * @param key 64-bit key.
+         * @return Four independent 32-bit words.
+         */
+        std::array<std::uint32_t, 4> philox(std::array<std::uint32_t, 4> counter, std::array<std::uint32_t, 2> key) {
+            for (int round = 0; round < 10; round++) {
+                std::uint64_t product0 = static_cast<std::uint64_t>(0xD2511F53u) * counter[0];
+                std::uint64_t product1 = static_cast<std::uint64_t>(0xCD9E8D57u) * counter[2];
+                counter = {static_cast<std::uint32_t>(product1 >> 32) ^ counter[1] ^ key[0], static_cast<std::uint32_t>(product1),
+                           static_cast<std::uint32_t>(product0 >> 32) ^ counter[3] ^ key[1], static_cast<std::uint32_t>(product0)};
+                key[0] += 0x9E3779B9u;
+                key[1] += 0xBB67AE85u;
+            }
+            return counter;
+        }
+
+        // Standard normal variates of one Monte Carlo sample, drawn two at a time by Box-Muller
+        class normal_stream
+        {
+        public:
+            normal_stream(std::uint64_t seed, long sample)
+                : key{static_cast<std::uint32_t>(seed), static_cast<std::uint32_t>(seed >> 32)},
+                  sample(static_cast<std::uint64_t>(sample)), draw(0), cached(false), spare(0.0) {}
+
+            double next() {
+                if (this->cached) {
+                    this->cached = false;
+                    return this->spare;
+                }
+                auto words = philox({static_cast<std::uint32_t>(this->sample), static_cast<std::uint32_t>(this->sample >> 32),
+                                     static_cast<std::uint32_t>(this->draw), static_cast<std::uint32_t>(this->draw >> 32)}, this->key);
+                this->draw++;
+                // 53-bit uniforms, the first in (0, 1] so its logarithm is finite
+                double u1 = ((static_cast<std::uint64_t>(words[0]) << 21 ^ words[1] >> 11) + 1) * 0x1.0p-53;
+                double u2 = (static_cast<std::uint64_t>(words[2]) << 21 ^ words[3] >> 11) * 0x1.0p-53;
+                double radius = std::sqrt(-2.0 * std::log(u1));
+                this->spare = radius * std::sin(2.0 * M_PI * u2);
+                this->cached = true;
+                return radius * std::cos(2.0 * M_PI * u2);
+            }
+
+        private:
+            std::array<std::uint32_t, 2> key;
+            std::uint64_t sample;
+            std::uint64_t draw;
+            bool cached;
+            double spare;
+        };
+
+        Eigen::Matrix4d translation(const Eigen::Vector3d& p) {
+            Eigen::Matrix4d T = Eigen::Matrix4d::Identity();
+            T.block<3, 1>(0, 3) = p;
+            return T;
+        }
+
+        bool is_revolute(const Eigen::Matrix<double, 6, 1>& S) {
+            return S.head<3>().norm() > 0.5;
+        }
+
+        Eigen::Vector3d axis_point(const Eigen::Matrix<double, 6, 1>& S) {
+            return is_revolute(S) ? Eigen::Vector3d(S.head<3>().cross(S.tail<3>())) : Eigen::Vector3d::Zero();
+        }
+
+        /**
+         * @brief Screw exponential with the sine and cosine of the angle supplied by the caller.
+         */
+        void multiply_exponential(Eigen::Matrix4d& T, const Eigen::Matrix<double, 6, 1>& S, double s, double c, double theta) {
+            Eigen::Vector3d w = S.head<3>(), v = S.tail<3>();
+            Eigen::Matrix3d W;
+            W << 0, -w(2), w(1),
+                 w(2), 0, -w(0),
+                 -w(1), w(0), 0;
+            Eigen::Matrix3d W2 = W * W;
+            Eigen::Matrix4d E = Eigen::Matrix4d::Identity();
+            E.block<3, 3>(0, 0) += s * W + (1 - c) * W2;
+            E.block<3, 1>(0, 3) = theta * v + (1 - c) * (W * v) + (theta - s) * (W2 * v);
+            T = T * E;
+        }
+
+    }
+
+    /**
+     * @brief Constructor for the tolerance_analysis class.
+     *
+     * A link length error translates everything distal to the link along its home link vector. All
+     * tolerances start at zero and 1000 samples are drawn.
+     *
+     * @param nominal Finger model with space screw axes and home frame set.
+     */
+    tolerance_analysis::tolerance_analysis(const finger_model<>& nominal)
+        : nominal(nominal),
+          home_frame(nominal.get_home_position_body_frame()),
+          axis_angle_tolerance(0.0),
+          axis_position_tolerance(0.0),
+          num_samples(1000),
+          seed(0)
+    {
+        const int n = nominal.get_num_joints();
+        for (int i = 0; i < n; i++) {
+            this->screw_axes.push_back(nominal.get_home_position_screw_axes_space().col(i));
+        }
+        this->link_length_tolerance = Eigen::VectorXd::Zero(n);
+        this->encoder_tolerance = Eigen::VectorXd::Zero(n);
+
+        this->link_directions = Eigen::Matrix3Xd::Zero(3, n);
+        const Eigen::Matrix3Xd links = home_link_vectors(nominal);
+        for (int i = 0; i < n; i++) {
+            if (links.col(i).norm() > 1e-9) {
+                this->link_directions.col(i) = links.col(i).normalized();
+            }
+        }
+    }
+
+    ////////////////////////////////////////////////////////////
+    // Setter functions
+    ////////////////////////////////////////////////////////////
+
+    /**
+     * @brief Set the standard deviation of every link length error.
+     * @param standard_deviations One entry per joint, in m.
+     */
+    void tolerance_analysis::set_link_length_tolerance(const Eigen::VectorXd& standard_deviations) {
+        if (standard_deviations.size() != static_cast<long>(this->screw_axes.size()) || (standard_deviations.array() < 0.0).any()) {
+            throw std::invalid_argument("link length tolerance must have one non-negative entry per joint");
+        }
+        this->link_length_tolerance = standard_deviations;
+    }
+
+    /**
+     * @brief Set the misalignment of every joint axis about its nominal location.
+     * @param angle_standard_deviation Standard deviation of each rotation component, in rad.
+     * @param position_standard_deviation Standard deviation of each translation component, in m.
+     */
+    void tolerance_analysis::set_axis_tolerance(double angle_standard_deviation, double position_standard_deviation) {
+        if (!(angle_standard_deviation >= 0.0) || !(position_standard_deviation >= 0.0)) {
+            throw std::invalid_argument("axis tolerances must be non-negative");
+        }
+        this->axis_angle_tolerance = angle_standard_deviation;
+        this->axis_position_tolerance = position_standard_deviation;
+    }
+
+    /**
+     * @brief Set the standard deviation of every encoder bias.
+     * @param standard_deviations One entry per joint, in rad (m for prismatic joints).
+     */
+    void tolerance_analysis::set_encoder_tolerance(const Eigen::VectorXd& standard_deviations) {
+        if (standard_deviations.size() != static_cast<long>(this->screw_axes.size()) || (standard_deviations.array() < 0.0).any()) {
+            throw std::invalid_argument("encoder tolerance must have one non-negative entry per joint");
+        }
+        this->encoder_tolerance = standard_deviations;
+    }
+
+    void tolerance_analysis::set_num_samples(long num_samples) {
+        if (num_samples < 1) {
+            throw std::invalid_argument("num_samples must be positive");
+        }
+        this->num_samples = num_samples;
+    }
+
+    void tolerance_analysis::set_seed(std::uint64_t seed) {
+        this->seed = seed;
+    }
+
+    ////////////////////////////////////////////////////////////
+    // Getter functions
+    ////////////////////////////////////////////////////////////
+
+    long tolerance_analysis::get_num_samples() const {
+        return this->num_samples;
+    }
+
+    /**
+     * @brief Get the grid of the last compute.
+     * @return Configuration grid.
+     */
+    configuration_grid tolerance_analysis::get_grid() const {
+        if (this->grid_samples.size() == 0) {
+            throw std::runtime_error("no analysis has been computed");
+        }
+        return configuration_grid(this->grid_min, this->grid_max, this->grid_samples);
+    }
+
+    /**
+     * @brief Mean fingertip position error over the samples at every grid point.
+     */
+    const Eigen::VectorXf& tolerance_analysis::get_mean_errors() const {
+        return this->mean_errors;
+    }
+
+    /**
+     * @brief Root mean square fingertip position error over the samples at every grid point.
+     */
+    const Eigen::VectorXf& tolerance_analysis::get_rms_errors() const {
+        return this->rms_errors;
+    }
+
+    /**
+     * @brief Largest fingertip position error over the samples at every grid point.
+     */
+    const Eigen::VectorXf& tolerance_analysis::get_max_errors() const {
+        return this->max_errors;
+    }
+
+    ////////////////////////////////////////////////////////////
+    // Member functions
+    ////////////////////////////////////////////////////////////
+
+    /**
+     * @brief Draw the perturbed geometry of one sample.
+     *
+     * The variates of sample k are the Philox outputs for counters (k, 0), (k, 1), ... under the seed,
+     * consumed in a fixed order: per joint the link length error, three axis rotation and three axis
+     * translation components and the encoder bias.
+     *
+     * @param sample Sample index.
+     * @return Perturbed screw axes, home frame and encoder biases.
+     */
+    tolerance_analysis::perturbed_finger tolerance_analysis::draw(long sample) const {
+        const int n = static_cast<int>(this->screw_axes.size());
+        normal_stream normal(this->seed, sample);
+        perturbed_finger finger;
+        for (int i = 0; i < n; i++) {
+            finger.screw_axes[i] = this->screw_axes[i];
+        }
+        finger.home_frame = this->home_frame;
+
+        for (int i = 0; i < n; i++) {
+            // Link length error moves every distal axis and the fingertip
+            double length_error = this->link_length_tolerance(i) * normal.next();
+            if (length_error != 0.0 && !this->link_directions.col(i).isZero()) {
+                Eigen::Matrix4d shift = translation(length_error * this->link_directions.col(i));
+                for (int j = i + 1; j < n; j++) {
+                    finger.screw_axes[j] = rigid_body_motion::Adjoint_Twist(shift, finger.screw_axes[j]);
+                }
+                finger.home_frame = shift * finger.home_frame;
+            }
+
+            // Axis misalignment rotates the axis about its own location and translates it
+            Eigen::Vector3d rotation, offset;
+            for (int k = 0; k < 3; k++) {
+                rotation(k) = this->axis_angle_tolerance * normal.next();
+            }
+            for (int k = 0; k < 3; k++) {
+                offset(k) = this->axis_position_tolerance * normal.next();
+            }
+            if (!rotation.isZero() || !offset.isZero()) {
+                Eigen::Vector3d q = axis_point(finger.screw_axes[i]);
+                Eigen::Matrix4d T = translation(q + offset);
+                if (rotation.norm() > 0.0) {
+                    T.block<3, 3>(0, 0) = Eigen::AngleAxisd(rotation.norm(), rotation.normalized()).toRotationMatrix();
+                }
+                finger.screw_axes[i] = rigid_body_motion::Adjoint_Twist(T * translation(-q), finger.screw_axes[i]);
+            }
+
+            finger.offsets[i] = this->encoder_tolerance(i) * normal.next();
+            finger.cos_offsets[i] = std::cos(finger.offsets[i]);
+            finger.sin_offsets[i] = std::sin(finger.offsets[i]);
+        }
+        return finger;
+    }
+
+    /**
+     * @brief Finger model of one Monte Carlo sample, taking the same joint angles as the nominal model.
+     *
+     * Encoder biases are folded into the geometry as S_i' = Ad_{E_i} S_i and M' = E_n M with
+     * E_i = prod_{j<=i} exp([S_j] delta_j), so the model reproduces the sampled finger exactly.
+     *
+     * @param sample Sample index.
+     * @return Perturbed finger model.
+     */
+    finger_model<> tolerance_analysis::sample_finger(long sample) const {
+        const int n = static_cast<int>(this->screw_axes.size());
+        perturbed_finger perturbed = this->draw(sample);
+        Eigen::Matrix<double, 6, Eigen::Dynamic> S(6, n), B(6, n);
+        Eigen::Matrix4d E = Eigen::Matrix4d::Identity();
+        for (int i = 0; i < n; i++) {
+            E = E * rigid_body_motion::Screw_Exponential(perturbed.screw_axes[i], perturbed.offsets[i]);
+            S.col(i) = rigid_body_motion::Adjoint_Twist(E, perturbed.screw_axes[i]);
+        }
+        Eigen::Matrix4d M = E * perturbed.home_frame;
+        Eigen::Matrix4d M_inv = rigid_body_motion::Transform_Inverse(M);
+        for (int i = 0; i < n; i++) {
+            B.col(i) = rigid_body_motion::Adjoint_Twist(M_inv, S.col(i));
+        }
+        finger_model<> finger(this->nominal);
+        finger.set_home_position_body_frame(M);
+        finger.set_home_position_screw_axes_space(S);
+        finger.set_home_position_screw_axes_body(B);
+        return finger;
+    }
+
+    /**
+     * @brief Run the Monte Carlo analysis over a configuration grid.
+     *
+     * All samples are drawn first; grid points are then split into contiguous chunks, one per thread,
+     * and every point accumulates its samples in index order. The statistics are therefore identical
+     * for any number of threads.
+     *
+     * @param grid Configuration grid.
+     * @param num_threads Number of threads, 0 for one per hardware thread.
+     */
+    void tolerance_analysis::compute(const configuration_grid& grid, int num_threads) {
+        if (grid.get_num_joints() != static_cast<int>(this->screw_axes.size())) {
+            throw std::invalid_argument("grid must have one dimension per joint");
+        }
+
+        std::vector<perturbed_finger> fingers(this->num_samples);
+        for (long k = 0; k < this->num_samples; k++) {
+            fingers[k] = this->draw(k);
+        }
+
+        const long points = grid.size();
+        this->grid_min = grid.get_joint_min();
+        this->grid_max = grid.get_joint_max();
+        this->grid_samples = grid.get_samples();
+        this->mean_errors.resize(points);
+        this->rms_errors.resize(points);
+        this->max_errors.resize(points);
+
+        if (num_threads <= 0) {
+            num_threads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+        }
+        num_threads = static_cast<int>(std::max(1L, std::min<long>(num_threads, points)));
+
+        std::vector<std::thread> workers;
+        for (int t = 0; t < num_threads; t++) {
+            long begin = points * t / num_threads;
+            long end = points * (t + 1) / num_threads;
+            workers.emplace_back([this, &grid, &fingers, begin, end]() {
+                this->evaluate(grid, fingers, begin, end);
+            });
+        }
+        for (auto& worker : workers) {
+            worker.join();
+        }
+    }
+
+    /**
+     * @brief Accumulate the error statistics of a range of grid points.
+     *
+     * Points are processed in blocks whose joint angles, sines and cosines are computed once; for each
+     * sample the biased angle uses sin(theta + delta) = sin(theta) cos(delta) + cos(theta) sin(delta),
+     * so the forward kinematics of a sample needs no trigonometric calls.
+     *
+     * @param grid Configuration grid.
+     * @param fingers Perturbed fingers of all samples.
+     * @param begin First grid point.
+     * @param end One past the last grid point.
+     */
+    void tolerance_analysis::evaluate(const configuration_grid& grid, const std::vector<perturbed_finger>& fingers, long begin, long end) {
+        const int n = static_cast<int>(this->screw_axes.size());
+        const Eigen::Vector3d home_tip = this->home_frame.block<3, 1>(0, 3);
+        Eigen::Matrix<double, max_finger_joints, block_points> theta, s, c;
+        Eigen::Matrix<double, 3, block_points> nominal_positions;
+        Eigen::VectorXd joint_angles(n);
+
+        for (long block = begin; block < end; block += block_points) {
+            const int count = static_cast<int>(std::min<long>(block_points, end - block));
+            for (int k = 0; k < count; k++) {
+                grid.point(block + k, joint_angles);
+                Eigen::Matrix4d T = Eigen::Matrix4d::Identity();
+                for (int i = 0; i < n; i++) {
+                    theta(i, k) = joint_angles(i);
+                    s(i, k) = std::sin(joint_angles(i));
+                    c(i, k) = std::cos(joint_angles(i));
+                    multiply_exponential(T, this->screw_axes[i], s(i, k), c(i, k), theta(i, k));
+                }
+                nominal_positions.col(k) = T.block<3, 3>(0, 0) * home_tip + T.block<3, 1>(0, 3);
+            }
+
+            Eigen::Array<double, block_points, 1> sum = Eigen::Array<double, block_points, 1>::Zero();
+            Eigen::Array<double, block_points, 1> sum_squares = sum, largest = sum;
+            for (const perturbed_finger& finger : fingers) {
+                const Eigen::Vector3d tip = finger.home_frame.block<3, 1>(0, 3);
+                for (int k = 0; k < count; k++) {
+                    Eigen::Matrix4d T = Eigen::Matrix4d::Identity();
+                    for (int i = 0; i < n; i++) {
+                        double sine = s(i, k) * finger.cos_offsets[i] + c(i, k) * finger.sin_offsets[i];
+                        double cosine = c(i, k) * finger.cos_offsets[i] - s(i, k) * finger.sin_offsets[i];
+                        multiply_exponential(T, finger.screw_axes[i], sine, cosine, theta(i, k) + finger.offsets[i]);
+                    }
+                    double error = (T.block<3, 3>(0, 0) * tip + T.block<3, 1>(0, 3) - nominal_positions.col(k)).norm();
+                    sum(k) += error;
+                    sum_squares(k) += error * error;
+                    largest(k) = std::max(largest(k), error);
+                }
+            }
+
+            const double samples = static_cast<double>(fingers.size());
+            for (int k = 0; k < count; k++) {
+                this->mean_errors(block + k) = static_cast<float>(sum(k) / samples);
+                this->rms_errors(block + k) = static_cast<float>(std::sqrt(sum_squares(k) / samples));
+                this->max_errors(block + k) = static_cast<float>(largest(k));
+            }
+        }
+    }
+
+}
@@ -0,0 +1,448 @@
+#include "include/workspace_force_map.hpp"
+#include <Eigen/Dense>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace fm {
+
+    namespace {
+
+        const char map_file_magic[8] = {'F', 'M', 'W', 'S', 'M', 'A', 'P', '\0'};
+        const std::uint32_t map_file_version = 1;
+        const int stiffness_entries = 6;
+
+        // Largest force searched for before a direction is reported as not limited by the tendons
+        const double force_search_limit = 1e6;
+
+        template <typename T>
+        void write_value(std::ofstream& file, const T& value) {
+            file.write(reinterpret_cast<const char*>(&value), sizeof(T));
+        }
+
+        template <typename T>
+        void read_value(std::ifstream& file, T& value) {
+            file.read(reinterpret_cast<char*>(&value), sizeof(T));
+        }
+
+    }
+
+    /**
+     * @brief Constructor for the workspace_force_map class.
+     *
+     * The finger model is copied, so the map does not depend on the caller's model afterwards. The default
+     * directions are the six signed coordinate axes.
+     *
+     * @param finger Finger model with screw axes, home frame and routing matrix set.
+     * @param tendon_stiffness Series stiffness of every tendon.
+     * @param min_tension Minimum tendon tension (pretension).
+     * @param max_tension Maximum tendon tension; must be finite so that forces are bounded.
+     */
+    workspace_force_map::workspace_force_map(const finger_model<>& finger, const Eigen::VectorXd& tendon_stiffness, double min_tension, double max_tension)
+        : finger(finger),
+          min_tension(min_tension),
+          max_tension(max_tension),
+          force_tolerance(1e-3)
+    {
+        const int n = finger.get_num_joints();
+        const auto& routing = finger.get_tendon_routing_matrix();
+        if (n > max_solver_joints || routing.rows() != n || routing.cols() > max_solver_tendons) {
+            throw std::invalid_argument("tendon_routing_matrix must have one row per joint and at most max_solver_tendons columns");
+        }
+        if (tendon_stiffness.size() != routing.cols() || (tendon_stiffness.array() < 0.0).any()) {
+            throw std::invalid_argument("tendon_stiffness must have one non-negative element per tendon");
+        }
+        if (!std::isfinite(max_tension) || max_tension <= min_tension) {
+            throw std::invalid_argument("max_tension must be finite and greater than min_tension");
+        }
+
+        // Tendons in series with their stiffness act on the joints as K_theta = R diag(k) R^T
+        this->joint_stiffness_matrix = routing * tendon_stiffness.asDiagonal() * routing.transpose();
+        this->joint_stiffness = Eigen::VectorXd::Zero(n);
+        this->joint_rest_angles = Eigen::VectorXd::Zero(n);
+        this->joint_compliance_matrix = this->joint_stiffness_matrix.completeOrthogonalDecomposition().pseudoInverse();
+
+        this->directions.resize(3, 6);
+        this->directions << 1, -1, 0, 0, 0, 0,
+                            0, 0, 1, -1, 0, 0,
+                            0, 0, 0, 0, 1, -1;
+    }
+
+    ////////////////////////////////////////////////////////////
+    // Setter functions
+    ////////////////////////////////////////////////////////////
+
+    /**
+     * @brief Set the return springs in parallel with the tendons.
+     *
+     * The springs add to the joint stiffness and their torque away from the rest angles has to be
+     * overcome by the tendons before any fingertip force is available.
+     *
+     * @param joint_stiffness Return spring stiffness of every joint.
+     * @param joint_rest_angles Joint angles at which the return springs are relaxed.
+     */
+    void workspace_force_map::set_joint_stiffness(const Eigen::VectorXd& joint_stiffness, const Eigen::VectorXd& joint_rest_angles) {
+        const int n = this->finger.get_num_joints();
+        if (joint_stiffness.size() != n || joint_rest_angles.size() != n || (joint_stiffness.array() < 0.0).any()) {
+            throw std::invalid_argument("joint_stiffness and joint_rest_angles must have one element per joint");
+        }
+        this->joint_stiffness_matrix.diagonal() += joint_stiffness - this->joint_stiffness;
+        this->joint_stiffness = joint_stiffness;
+        this->joint_rest_angles = joint_rest_angles;
+        this->joint_compliance_matrix = this->joint_stiffness_matrix.completeOrthogonalDecomposition().pseudoInverse();
+    }
+
+    /**
+     * @brief Set the fingertip force directions, one per column; they are normalized.
+     * @param directions 3xD matrix of directions in the space frame.
+     */
+    void workspace_force_map::set_directions(const Eigen::Matrix3Xd& directions) {
+        if (directions.cols() < 1 || (directions.colwise().norm().array() == 0.0).any()) {
+            throw std::invalid_argument("directions must contain at least one non-zero column");
+        }
+        this->directions = directions.colwise().normalized();
+    }
+
+    /**
+     * @brief Set the accuracy of the maximum force search.
+     * @param force_tolerance Tolerance in N.
+     */
+    void workspace_force_map::set_force_tolerance(double force_tolerance) {
+        if (force_tolerance <= 0.0) {
+            throw std::invalid_argument("force_tolerance must be positive");
+        }
+        this->force_tolerance = force_tolerance;
+    }
+
+    ////////////////////////////////////////////////////////////
+    // Getter functions
+    ////////////////////////////////////////////////////////////
+
+    /**
+     * @brief Get the fingertip force directions.
+     * @return 3xD matrix of unit directions.
+     */
+    const Eigen::Matrix3Xd& workspace_force_map::get_directions() const {
+        return directions;
+    }
+
+    /**
+     * @brief Get the grid of the last compute or read.
+     * @return Configuration grid.
+     */
+    configuration_grid workspace_force_map::get_grid() const {
+        if (this->grid_samples.size() == 0) {
+            throw std::runtime_error("no map has been computed or read");
+        }
+        return configuration_grid(this->grid_min, this->grid_max, this->grid_samples);
+    }
+
+    /**
+     * @brief Get the fingertip positions.
+     * @return 3xP matrix, one column per grid point.
+     */
+    const Eigen::MatrixXf& workspace_force_map::get_positions() const {
+        return positions;
+    }
+
+    /**
+     * @brief Get the maximum fingertip force along every direction.
+     *
+     * Infinity marks a direction whose load is carried by the structure rather than the tendons.
+     *
+     * @return DxP matrix, one column per grid point.
+     */
+    const Eigen::MatrixXf& workspace_force_map::get_max_forces() const {
+        return max_forces;
+    }
+
+    /**
+     * @brief Get the Cartesian stiffness in packed form.
+     * @return 6xP matrix holding xx, yy, zz, xy, xz, yz of K_x per grid point.
+     */
+    const Eigen::MatrixXf& workspace_force_map::get_stiffness() const {
+        return stiffness;
+    }
+
+    /**
+     * @brief Get the Cartesian stiffness of one grid point.
+     * @param index Grid point index.
+     * @return 3x3 stiffness matrix.
+     */
+    Eigen::Matrix3d workspace_force_map::get_stiffness(long index) const {
+        if (index < 0 || index >= this->stiffness.cols()) {
+            throw std::invalid_argument("index is outside the map");
+        }
+        Eigen::Matrix3d K;
+        K(0, 0) = this->stiffness(0, index);
+        K(1, 1) = this->stiffness(1, index);
+        K(2, 2) = this->stiffness(2, index);
+        K(0, 1) = K(1, 0) = this->stiffness(3, index);
+        K(0, 2) = K(2, 0) = this->stiffness(4, index);
+        K(1, 2) = K(2, 1) = this->stiffness(5, index);
+        return K;
+    }
+
+    ////////////////////////////////////////////////////////////
+    // Member functions
+    ////////////////////////////////////////////////////////////
+
+    /**
+     * @brief Evaluate the maps over a configuration grid.
+     *
+     * Grid points are split into contiguous chunks, one per thread, each with its own copy of the finger
+     * model and its own tension solver.
+     *
+     * @param grid Configuration grid.
+     * @param num_threads Number of threads, 0 for one per hardware thread.
+     */
+    void workspace_force_map::compute(const configuration_grid& grid, int num_threads) {
+        const int n = this->finger.get_num_joints();
+        if (grid.get_num_joints() != n) {
+            throw std::invalid_argument("grid must have one dimension per joint");
+        }
+
+        const long points = grid.size();
+        this->grid_min = grid.get_joint_min();
+        this->grid_max = grid.get_joint_max();
+        this->grid_samples = grid.get_samples();
+        this->positions.resize(3, points);
+        this->max_forces.resize(this->directions.cols(), points);
+        this->stiffness.resize(stiffness_entries, points);
+
+        if (num_threads <= 0) {
+            num_threads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+        }
+        num_threads = static_cast<int>(std::max(1L, std::min<long>(num_threads, points)));
+
+        std::vector<std::thread> workers;
+        for (int t = 0; t < num_threads; t++) {
+            long begin = points * t / num_threads;
+            long end = points * (t + 1) / num_threads;
+            workers.emplace_back([this, &grid, begin, end, n]() {
+                finger_model<> finger(this->finger);
+                tendon_tension_solver solver(finger.get_tendon_routing_matrix(), this->min_tension, this->max_tension);
+                Eigen::VectorXd joint_angles(n);
+                for (long k = begin; k < end; k++) {
+                    grid.point(k, joint_angles);
+                    this->evaluate(finger, joint_angles, solver, this->positions.col(k), this->max_forces.col(k), this->stiffness.col(k));
+                }
+            });
+        }
+        for (auto& worker : workers) {
+            worker.join();
+        }
+    }
+
+    /**
+     * @brief Evaluate the maps at one configuration.
+     *
+     * The fingertip Jacobian J_p (3xn) follows from the finger's space Jacobian and fingertip position,
+     * both fixed-capacity. The Cartesian compliance is C_x = J_p K_theta^+ J_p^T and the stiffness
+     * K_x its pseudo-inverse, taken through a closed-form 3x3 eigendecomposition so that directions the
+     * joints cannot move in (e.g. out of plane) report zero rather than an ill-conditioned value.
+     *
+     * @param finger Finger model the map was built from; each thread passes its own copy.
+     * @param joint_angles Joint angles.
+     * @param solver Tension solver for the finger's routing matrix and tension limits.
+     * @param position Output fingertip position.
+     * @param max_forces Output maximum force along every direction.
+     * @param stiffness Output packed Cartesian stiffness.
+     */
+    void workspace_force_map::evaluate(const finger_model<>& finger, const Eigen::Ref<const Eigen::VectorXd>& joint_angles, tendon_tension_solver& solver,
+                                       Eigen::Ref<Eigen::Vector3f> position, Eigen::Ref<Eigen::VectorXf> max_forces, Eigen::Ref<Eigen::VectorXf> stiffness) const {
+        const int n = finger.get_num_joints();
+        if (n != this->finger.get_num_joints() || joint_angles.size() != n) {
+            throw std::invalid_argument("joint_angles must have one element per joint");
+        }
+
+        // Space Jacobian columns and fingertip position
+        finger_model<>::jacobian_matrix space_jacobian;
+        Eigen::Matrix4d T;
+        finger.space_jacobian(joint_angles, space_jacobian, &T);
+        const Eigen::Vector3d p = T.block<3, 1>(0, 3);
+
+        jacobian_matrix J(3, n);
+        for (int i = 0; i < n; i++) {
+            J.col(i) = space_jacobian.block<3, 1>(3, i) + space_jacobian.block<3, 1>(0, i).cross(p);
+        }
+        position = p.cast<float>();
+
+        // Cartesian stiffness from the joint compliance
+        Eigen::Matrix3d C = J * this->joint_compliance_matrix * J.transpose();
+        Eigen::SelfAdjointEigenSolver<Eigen::Matrix3d> eigen;
+        eigen.computeDirect(C);
+        Eigen::Vector3d inverse_eigenvalues;
+        const double threshold = 1e-12 * std::max(1.0, eigen.eigenvalues().cwiseAbs().maxCoeff());
+        for (int i = 0; i < 3; i++) {
+            inverse_eigenvalues(i) = eigen.eigenvalues()(i) > threshold ? 1.0 / eigen.eigenvalues()(i) : 0.0;
+        }
+        Eigen::Matrix3d K = eigen.eigenvectors() * inverse_eigenvalues.asDiagonal() * eigen.eigenvectors().transpose();
+        stiffness << K(0, 0), K(1, 1), K(2, 2), K(0, 1), K(0, 2), K(1, 2);
+
+        // Maximum force per direction: the tendons must balance the springs and J_p^T F
+        joint_vector spring_torques = this->joint_stiffness.cwiseProduct(joint_angles - this->joint_rest_angles);
+        for (int d = 0; d < this->directions.cols(); d++) {
+            joint_vector direction_torques = J.transpose() * this->directions.col(d);
+            max_forces(d) = static_cast<float>(this->max_force(solver, spring_torques, direction_torques));
+        }
+    }
+
+    /**
+     * @brief Largest force magnitude along one direction the tendons can produce within their limits.
+     *
+     * Tensions f are feasible for a force alpha d when R f = tau_spring + alpha J_p^T d with f inside the
+     * limits. The feasible set of alpha is an interval containing zero when any force is feasible, so
+     * it is bracketed by doubling and then bisected to the force tolerance.
+     *
+     * @param solver Tension solver.
+     * @param spring_torques Torque the tendons must supply to hold the return springs.
+     * @param direction_torques J_p^T d for the direction of interest.
+     * @return Maximum force, 0 when not even the springs can be held, infinity when the tendons do not limit it.
+     */
+    double workspace_force_map::max_force(tendon_tension_solver& solver, const joint_vector& spring_torques, const joint_vector& direction_torques) const {
+        auto feasible = [&](double alpha) {
+            joint_vector torques = spring_torques + alpha * direction_torques;
+            solver.solve(torques);
+            return solver.get_torque_residual() <= 1e-6 * (1.0 + torques.norm());
+        };
+
+        if (direction_torques.norm() < 1e-12) {
+            return std::numeric_limits<double>::infinity();
+        }
+        if (!feasible(0.0)) {
+            return 0.0;
+        }
+
+        double low = 0.0;
+        double high = std::max(1.0, this->force_tolerance);
+        while (feasible(high)) {
+            low = high;
+            high *= 2.0;
+            if (high > force_search_limit) {
+                return std::numeric_limits<double>::infinity();
+            }
+        }
+        while (high - low > this->force_tolerance) {
+            double middle = 0.5 * (low + high);
+            if (feasible(middle)) {
+                low = middle;
+            } else {
+                high = middle;
+            }
+        }
+        return low;
+    }
+
+    /**
+     * @brief Write the maps to a compact binary file.
+     *
+     * The file holds an 8 byte magic, a uint32 version, uint32 joint and direction counts and a uint64
+     * point count, followed by the grid limits (double), samples (int32) and directions (double), and
+     * then one float32 record per grid point: position (3), maximum forces (D) and packed stiffness (6).
+     * Values are stored in the host byte order.
+     *
+     * @param path Output file path.
+     */
+    void workspace_force_map::write(const std::string& path) const {
+        if (this->grid_samples.size() == 0) {
+            throw std::runtime_error("no map has been computed");
+        }
+        std::ofstream file(path, std::ios::binary);
+        if (!file) {
+            throw std::runtime_error("could not open " + path + " for writing");
+        }
+
+        const std::uint32_t joints = static_cast<std::uint32_t>(this->grid_samples.size());
+        const std::uint32_t directions = static_cast<std::uint32_t>(this->directions.cols());
+        const std::uint64_t points = static_cast<std::uint64_t>(this->positions.cols());
+        file.write(map_file_magic, sizeof(map_file_magic));
+        write_value(file, map_file_version);
+        write_value(file, joints);
+        write_value(file, directions);
+        write_value(file, points);
+        for (std::uint32_t j = 0; j < joints; j++) write_value(file, this->grid_min(j));
+        for (std::uint32_t j = 0; j < joints; j++) write_value(file, this->grid_max(j));
+        for (std::uint32_t j = 0; j < joints; j++) write_value(file, static_cast<std::int32_t>(this->grid_samples(j)));
+        file.write(reinterpret_cast<const char*>(this->directions.data()), sizeof(double) * 3 * directions);
+
+        std::vector<float> record(3 + directions + stiffness_entries);
+        for (std::uint64_t k = 0; k < points; k++) {
+            Eigen::Map<Eigen::VectorXf> values(record.data(), record.size());
+            values << this->positions.col(k), this->max_forces.col(k), this->stiffness.col(k);
+            file.write(reinterpret_cast<const char*>(record.data()), sizeof(float) * record.size());
+        }
+        if (!file) {
+            throw std::runtime_error("failed writing " + path);
+        }
+    }
+
+    /**
+     * @brief Read maps written by write(), replacing the directions and results of this object.
+     * @param path Input file path.
+     */
+    void workspace_force_map::read(const std::string& path) {
+        std::ifstream file(path, std::ios::binary);
+        if (!file) {
+            throw std::runtime_error("could not open " + path + " for reading");
+        }
+
+        char magic[sizeof(map_file_magic)];
+        std::uint32_t version = 0, joints = 0, directions = 0;
+        std::uint64_t points = 0;
+        file.read(magic, sizeof(magic));
+        read_value(file, version);
+        read_value(file, joints);
+        read_value(file, directions);
+        read_value(file, points);
+        if (!file || std::memcmp(magic, map_file_magic, sizeof(magic)) != 0 || version != map_file_version) {
+            throw std::runtime_error(path + " is not a workspace force map of a supported version");
+        }
+        if (joints == 0 || joints > static_cast<std::uint32_t>(max_solver_joints) || directions == 0) {
+            throw std::runtime_error(path + " has an invalid header");
+        }
+
+        Eigen::VectorXd grid_min(joints), grid_max(joints);
+        Eigen::VectorXi grid_samples(joints);
+        for (std::uint32_t j = 0; j < joints; j++) read_value(file, grid_min(j));
+        for (std::uint32_t j = 0; j < joints; j++) read_value(file, grid_max(j));
+        for (std::uint32_t j = 0; j < joints; j++) {
+            std::int32_t samples = 0;
+            read_value(file, samples);
+            grid_samples(j) = samples;
+        }
+        Eigen::Matrix3Xd file_directions(3, directions);
+        file.read(reinterpret_cast<char*>(file_directions.data()), sizeof(double) * 3 * directions);
+        if (!file || static_cast<std::uint64_t>(configuration_grid(grid_min, grid_max, grid_samples).size()) != points) {
+            throw std::runtime_error(path + " has an inconsistent grid");
+        }
+
+        Eigen::MatrixXf positions(3, points), max_forces(directions, points), stiffness(stiffness_entries, points);
+        std::vector<float> record(3 + directions + stiffness_entries);
+        for (std::uint64_t k = 0; k < points; k++) {
+            file.read(reinterpret_cast<char*>(record.data()), sizeof(float) * record.size());
+            Eigen::Map<const Eigen::VectorXf> values(record.data(), record.size());
+            positions.col(k) = values.head(3);
+            max_forces.col(k) = values.segment(3, directions);
+            stiffness.col(k) = values.tail(stiffness_entries);
+        }
+        if (!file) {
+            throw std::runtime_error(path + " is truncated");
+        }
+
+        this->directions = file_directions;
+        this->grid_min = grid_min;
+        this->grid_max = grid_max;
+        this->grid_samples = grid_samples;
+        this->positions = std::move(positions);
+        this->max_forces = std::move(max_forces);
+        this->stiffness = std::move(stiffness);
+    }
+
+}
@@ -0,0 +1,64 @@
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include <Eigen/Dense>
+#include "../../src/include/actuation_map.hpp"
+#include "../../src/include/finger_description.hpp"
+
+// Spatial four joint finger with four tendons driven by four motor spools
+static const std::string test_finger_path = std::string(TEST_DATA_DIR) + "/tendon_test_finger.yaml";
+
+/**
+ * @brief Test the forward and inverse position chain.
+ */
+TEST(ActuationMapTest, PositionRoundTrip) {
+    fm::finger_model<> finger = fm::load_finger_description(test_finger_path);
+    fm::actuation_map map(finger);
+    Eigen::VectorXd offsets(4); offsets << 0.1, -0.2, 0.3, 0.0;
+    map.set_motor_offsets(offsets);
+
+    Eigen::VectorXd theta(4); theta << 0.1, 0.3, -0.2, 0.5;
+    Eigen::VectorXd phi = map.joint_to_motor(theta);
+
+    ASSERT_TRUE(phi.isApprox(map.tendon_to_motor(map.joint_to_tendon(theta))));
+    ASSERT_TRUE(map.motor_to_joint(phi).isApprox(theta, 1e-10));
+    ASSERT_TRUE(map.tendon_to_joint(map.motor_to_tendon(phi)).isApprox(theta, 1e-10));
+}
+
+/**
+ * @brief Test that the force mapping is the transpose of the velocity mapping (virtual work).
+ */
+TEST(ActuationMapTest, VirtualWork) {
+    fm::finger_model<> finger = fm::load_finger_description(test_finger_path);
+    fm::actuation_map map(finger);
+
+    Eigen::VectorXd theta_dot(4); theta_dot << -0.2, 0.4, 1.0, -0.7;
+    Eigen::VectorXd motor_torques(4); motor_torques << 0.01, 0.02, -0.005, 0.004;
+
+    Eigen::VectorXd phi_dot = map.get_motor_joint_jacobian() * theta_dot;
+    Eigen::VectorXd tau = map.joint_torques_from_motor_torques(motor_torques);
+    ASSERT_NEAR(phi_dot.dot(motor_torques), theta_dot.dot(tau), 1e-12);
+
+    Eigen::VectorXd f = map.tendon_tensions_from_motor_torques(motor_torques);
+    ASSERT_TRUE(map.motor_torques_from_tendon_tensions(f).isApprox(motor_torques));
+}
+
+/**
+ * @brief Test that the batched conversion matches the per-sample conversion.
+ */
+TEST(ActuationMapTest, BatchedTrajectory) {
+    fm::finger_model<> finger = fm::load_finger_description(test_finger_path);
+    fm::actuation_map map(finger);
+
+    Eigen::MatrixXd trajectory = Eigen::MatrixXd::Random(4, 50);
+    Eigen::MatrixXd motors(4, 50), joints(4, 50);
+    map.joint_to_motor(trajectory, motors);
+    map.motor_to_joint(motors, joints);
+
+    for (int k = 0; k < 50; k++) {
+        ASSERT_TRUE(motors.col(k).isApprox(map.joint_to_motor(Eigen::VectorXd(trajectory.col(k)))));
+    }
+    ASSERT_TRUE(joints.isApprox(trajectory, 1e-10));
+}
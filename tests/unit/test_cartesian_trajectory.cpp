@@ -0,0 +1,109 @@
+#include <cmath>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include <Eigen/Dense>
+#include "../../src/include/cartesian_trajectory.hpp"
+#include "../../src/include/open_chain_kinematics.hpp"
+#include "../../src/include/finger_description.hpp"
+
+// Spatial four joint finger: abduction about y, then three flexion joints about z
+static const std::string test_finger_path = std::string(TEST_DATA_DIR) + "/tendon_test_finger.yaml";
+
+/**
+ * @brief Fingertip pose at some joint angles.
+ */
+static Eigen::Matrix4d pose_at(fm::finger_model<> finger, const Eigen::Vector4d& joint_angles) {
+    finger.set_joint_angles(joint_angles);
+    return finger.get_fingertip_pose_space();
+}
+
+/**
+ * @brief Test the endpoints and the constant screw and straight line properties of the interpolation.
+ */
+TEST(CartesianTrajectoryTest, Interpolate) {
+    fm::finger_model<> finger = fm::load_finger_description(test_finger_path);
+    const Eigen::Matrix4d start = pose_at(finger, Eigen::Vector4d(0.1, 0.2, 0.3, 0.1));
+    const Eigen::Matrix4d goal = pose_at(finger, Eigen::Vector4d(-0.2, 0.9, 0.8, 0.6));
+    for (fm::cartesian_path path : {fm::cartesian_path::screw, fm::cartesian_path::straight_line}) {
+        ASSERT_TRUE(fm::cartesian_trajectory::interpolate(start, goal, 0.0, path).isApprox(start, 1e-12));
+        ASSERT_TRUE(fm::cartesian_trajectory::interpolate(start, goal, 1.0, path).isApprox(goal, 1e-9));
+    }
+
+    // Halfway along the screw, then halfway to the goal, is three quarters along it
+    const Eigen::Matrix4d half = fm::cartesian_trajectory::interpolate(start, goal, 0.5, fm::cartesian_path::screw);
+    ASSERT_TRUE(fm::cartesian_trajectory::interpolate(half, goal, 0.5, fm::cartesian_path::screw)
+                    .isApprox(fm::cartesian_trajectory::interpolate(start, goal, 0.75, fm::cartesian_path::screw), 1e-9));
+
+    // The straight line keeps the origin on the chord; the screw does not when the frame turns
+    const Eigen::Matrix4d line = fm::cartesian_trajectory::interpolate(start, goal, 0.3, fm::cartesian_path::straight_line);
+    const Eigen::Matrix4d screw = fm::cartesian_trajectory::interpolate(start, goal, 0.3, fm::cartesian_path::screw);
+    const Eigen::Vector3d p0 = start.topRightCorner(3, 1), p1 = goal.topRightCorner(3, 1);
+    ASSERT_TRUE(line.topRightCorner(3, 1).isApprox(0.7 * p0 + 0.3 * p1, 1e-12));
+    ASSERT_TRUE(line.topLeftCorner(3, 3).isApprox(screw.topLeftCorner(3, 3), 1e-9));
+    ASSERT_GT((half.topRightCorner(3, 1) - 0.5 * (p0 + p1)).norm(), 1e-3);
+}
+
+/**
+ * @brief Test a straight fingertip line: the tolerance holds densely between waypoints, and looser tolerances take fewer solves.
+ */
+TEST(CartesianTrajectoryTest, StraightLine) {
+    fm::finger_model<> finger = fm::load_finger_description(test_finger_path);
+    const Eigen::Vector4d start_angles(0.1, 0.3, 0.5, 0.3);
+    const Eigen::Matrix4d start = pose_at(finger, start_angles);
+    const Eigen::Matrix4d goal = pose_at(finger, Eigen::Vector4d(-0.1, 0.8, 0.7, 0.4));
+
+    fm::cartesian_trajectory trajectory(finger);
+    trajectory.set_path(fm::cartesian_path::straight_line);
+    trajectory.set_position_only(true);
+    long previous_solves = 0;
+    for (double tolerance : {1e-3, 1e-4, 1e-5}) {
+        trajectory.set_tolerance(tolerance);
+        const fm::cartesian_plan plan = trajectory.plan(start_angles, goal);
+        const long waypoints = plan.fractions.size();
+        ASSERT_EQ(plan.fractions(0), 0.0);
+        ASSERT_EQ(plan.fractions(waypoints - 1), 1.0);
+        ASSERT_EQ(plan.ik_solves, waypoints - 1 + plan.rejected_steps);
+        ASSERT_GT(plan.solves_per_second, 0.0);
+        ASSERT_LE(plan.max_deviation, tolerance);
+        ASSERT_GT(plan.ik_solves, previous_solves);
+        previous_solves = plan.ik_solves;
+
+        double dense = 0.0;
+        for (long k = 0; k + 1 < waypoints; k++) {
+            for (int j = 1; j < 16; j++) {
+                const double f = j / 16.0;
+                finger.set_joint_angles((1.0 - f) * plan.joint_angles.col(k) + f * plan.joint_angles.col(k + 1));
+                const double s = (1.0 - f) * plan.fractions(k) + f * plan.fractions(k + 1);
+                const Eigen::Vector3d ideal = (1.0 - s) * start.topRightCorner(3, 1) + s * goal.topRightCorner(3, 1);
+                dense = std::max(dense, (finger.fingertip_position_space() - ideal).norm());
+            }
+        }
+        ASSERT_LE(dense, 1.1 * tolerance);
+    }
+}
+
+/**
+ * @brief Test full pose solves along a planar screw, and paths out of reach.
+ */
+TEST(CartesianTrajectoryTest, ScrewAndErrors) {
+    fm::finger_model<> finger = fm::load_finger_description(test_finger_path);
+    const Eigen::Vector4d start_angles(0.0, 0.5, 0.7, 0.5);
+    const Eigen::Vector4d goal_angles(0.0, 1.1, 0.9, 0.8);
+    const Eigen::Matrix4d goal = pose_at(finger, goal_angles);
+
+    fm::cartesian_trajectory trajectory(finger);
+    ASSERT_EQ(trajectory.get_path(), fm::cartesian_path::screw);
+    trajectory.set_tolerance(1e-5);
+    const fm::cartesian_plan plan = trajectory.plan(start_angles, goal);
+    ASSERT_LE(plan.max_deviation, 1e-5);
+    ASSERT_TRUE(pose_at(finger, plan.joint_angles.rightCols(1)).isApprox(goal, 1e-8));
+    ASSERT_TRUE(plan.joint_angles.rightCols(1).isApprox(goal_angles, 1e-6));
+
+    Eigen::Matrix4d far = goal;
+    far(0, 3) += 0.1;
+    ASSERT_THROW(trajectory.plan(start_angles, far), std::runtime_error);
+    ASSERT_THROW(trajectory.plan(Eigen::Vector3d::Zero(), goal), std::invalid_argument);
+    ASSERT_THROW(trajectory.set_tolerance(0.0), std::invalid_argument);
+}
@@ -0,0 +1,208 @@
+#include <cmath>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include <Eigen/Dense>
+#include "../../src/include/collision_checker.hpp"
+
+/**
+ * @brief Build a spatial four joint finger with capsules on the three phalanges: abduction about y,
+ * then three flexion joints about z.
+ */
+static fm::finger_model<> capsule_finger() {
+    Eigen::VectorXd link_lengths(4); link_lengths << 0.0, 0.046, 0.032, 0.025;
+    fm::finger_model<> finger(link_lengths, Eigen::VectorXd::Zero(4));
+
+    std::vector<Eigen::VectorXd> S_list;
+    Eigen::VectorXd S1(6); S1 << 0, 1, 0, 0, 0, 0;                S_list.push_back(S1);
+    Eigen::VectorXd S2(6); S2 << 0, 0, 1, 0, 0, 0;                S_list.push_back(S2);
+    Eigen::VectorXd S3(6); S3 << 0, 0, 1, 0, -0.046, 0;           S_list.push_back(S3);
+    Eigen::VectorXd S4(6); S4 << 0, 0, 1, 0, -0.046 - 0.032, 0;   S_list.push_back(S4);
+    finger.set_home_position_screw_axes_space(S_list);
+
+    Eigen::MatrixXd M = Eigen::MatrixXd::Identity(4, 4);
+    M(0, 3) = 0.046 + 0.032 + 0.025;
+    finger.set_home_position_body_frame(M);
+
+    const double ends[4] = {0.0, 0.046, 0.078, 0.103};
+    const double radii[3] = {0.008, 0.007, 0.006};
+    for (int k = 1; k < 4; k++) {
+        fm::link_geometry geometry;
+        geometry.start = Eigen::Vector3d(ends[k - 1], 0, 0);
+        geometry.end = Eigen::Vector3d(ends[k], 0, 0);
+        geometry.radius = radii[k - 1];
+        finger.set_link_geometry(k, geometry);
+    }
+    return finger;
+}
+
+/**
+ * @brief Two fingers: one at the palm origin and one further out along the palm, turned to point along y
+ * so its tip reaches into the flexion fan of the first, plus a palm capsule.
+ */
+static fm::collision_checker two_fingers() {
+    fm::collision_checker checker;
+    checker.add_finger(capsule_finger());
+    Eigen::Matrix4d palm_to_base = Eigen::Matrix4d::Identity();
+    palm_to_base.block<3, 3>(0, 0) = Eigen::AngleAxisd(M_PI / 2, Eigen::Vector3d::UnitZ()).toRotationMatrix();
+    palm_to_base.block<3, 1>(0, 3) = Eigen::Vector3d(0.07, -0.12, 0.0);
+    checker.add_finger(capsule_finger(), palm_to_base);
+    fm::capsule palm;
+    palm.a = Eigen::Vector3d(-0.03, -0.02, 0.0);
+    palm.b = Eigen::Vector3d(-0.03, 0.02, 0.0);
+    palm.radius = 0.01;
+    checker.add_palm_capsule(palm);
+    return checker;
+}
+
+/**
+ * @brief Smallest surface distance over the pairs the checker does not ignore by default.
+ */
+static double brute_force_distance(const fm::collision_checker& checker) {
+    const auto& capsules = checker.get_body_capsules();
+    double smallest = std::numeric_limits<double>::infinity();
+    for (int a = 0; a < checker.get_num_bodies(); a++) {
+        for (int b = a + 1; b < checker.get_num_bodies(); b++) {
+            const int fa = checker.get_body_finger(a), fb = checker.get_body_finger(b);
+            if (fa < 0 && fb < 0) continue;
+            if (fa == fb && std::abs(checker.get_body_link(a) - checker.get_body_link(b)) <= 1) continue;
+            Eigen::Vector3d point, normal;
+            smallest = std::min(smallest, fm::geometry::capsule_capsule(capsules[a], capsules[b], point, normal));
+        }
+    }
+    return smallest;
+}
+
+/**
+ * @brief Test the hierarchy distance against every pair of capsules.
+ */
+TEST(CollisionCheckerTest, Distance) {
+    fm::collision_checker checker = two_fingers();
+    ASSERT_EQ(checker.get_num_fingers(), 2);
+    ASSERT_EQ(checker.get_num_joints(), 8);
+    ASSERT_EQ(checker.get_num_bodies(), 7);
+    ASSERT_EQ(checker.get_body_link(0), 1);
+    ASSERT_EQ(checker.get_body_finger(6), -1);
+
+    std::mt19937 generator(11);
+    std::uniform_real_distribution<double> angle(-1.2, 1.2);
+    int colliding = 0;
+    for (int trial = 0; trial < 300; trial++) {
+        Eigen::VectorXd q(8);
+        for (int j = 0; j < 8; j++) q(j) = angle(generator);
+        int a, b;
+        const double d = checker.distance(q, a, b);
+        ASSERT_NEAR(d, brute_force_distance(checker), 1e-12);
+        ASSERT_NE(a, b);
+        ASSERT_EQ(checker.in_collision(q), d <= 1e-4);
+        colliding += d <= 0.0 ? 1 : 0;
+    }
+    ASSERT_GT(colliding, 0);
+    ASSERT_LT(colliding, 300);
+}
+
+/**
+ * @brief Test that a segment sweeping through a contact between collision free endpoints is caught at
+ * the first contact found by dense sampling.
+ */
+TEST(CollisionCheckerTest, SweptContact) {
+    fm::collision_checker checker = two_fingers();
+    Eigen::VectorXd start = Eigen::VectorXd::Zero(8), end = Eigen::VectorXd::Zero(8);
+    start(1) = 0.5;
+    end(1) = -1.3;
+    ASSERT_FALSE(checker.in_collision(start));
+    ASSERT_FALSE(checker.in_collision(end));
+
+    double first_contact = -1.0;
+    for (int k = 0; k <= 20000; k++) {
+        const double t = k / 20000.0;
+        if (checker.in_collision((1.0 - t) * start + t * end)) {
+            first_contact = t;
+            break;
+        }
+    }
+    ASSERT_GT(first_contact, 0.0);
+
+    fm::collision_report report = checker.check_segment(start, end);
+    ASSERT_TRUE(report.collision);
+    ASSERT_EQ(report.segment, 0);
+    ASSERT_NEAR(report.time, first_contact, 1e-3);
+    ASSERT_LE(report.distance, 1e-4);
+    ASSERT_EQ(checker.get_body_finger(report.body_a) + checker.get_body_finger(report.body_b), 1);
+    ASSERT_LT(report.iterations, 200);
+
+    // The same motion stopped before the contact is free
+    fm::collision_report free = checker.check_segment(start, (1.0 - 0.9 * first_contact) * start + 0.9 * first_contact * end);
+    ASSERT_FALSE(free.collision);
+    ASSERT_EQ(free.segment, -1);
+
+    // Ignoring the pair leaves no contact on the way
+    checker.ignore_pair(report.body_a, report.body_b);
+    fm::collision_report ignored = checker.check_segment(start, end);
+    ASSERT_TRUE(!ignored.collision || ignored.time > report.time);
+}
+
+/**
+ * @brief Test a long densely sampled trajectory: a free one is crossed in far fewer steps than it has
+ * segments, and a contact late in it is found in the right segment.
+ */
+TEST(CollisionCheckerTest, LongTrajectory) {
+    fm::collision_checker checker = two_fingers();
+    const long samples = 60001;
+    Eigen::MatrixXd waypoints = Eigen::MatrixXd::Zero(8, samples);
+    for (long k = 0; k < samples; k++) {
+        const double time = k * 1e-3;
+        waypoints(1, k) = 0.6 + 0.3 * std::sin(0.5 * time);
+        waypoints(2, k) = 0.4 + 0.3 * std::sin(0.7 * time);
+        waypoints(5, k) = 0.3 * std::sin(0.3 * time);
+        waypoints(6, k) = 0.5 + 0.4 * std::sin(0.9 * time);
+    }
+    fm::collision_report report = checker.check_trajectory(waypoints);
+    ASSERT_FALSE(report.collision);
+    ASSERT_LT(report.iterations, samples / 10);
+
+    // Swing the first finger down through the second near the end
+    const long late = samples - 2000;
+    for (long k = late; k < samples; k++) {
+        waypoints(1, k) = waypoints(1, late) - 1.9 * std::min(1.0, (k - late) / 1000.0);
+    }
+    report = checker.check_trajectory(waypoints);
+    ASSERT_TRUE(report.collision);
+    ASSERT_GT(report.segment, late);
+    ASSERT_LT(report.segment, late + 1000);
+    ASSERT_TRUE(checker.in_collision((1.0 - report.time) * waypoints.col(report.segment) + report.time * waypoints.col(report.segment + 1)));
+}
+
+/**
+ * @brief Test invalid inputs.
+ */
+TEST(CollisionCheckerTest, InvalidInputs) {
+    fm::collision_checker checker;
+    ASSERT_THROW(checker.update(Eigen::VectorXd::Zero(0)), std::runtime_error);
+    checker = two_fingers();
+    ASSERT_THROW(checker.update(Eigen::VectorXd::Zero(4)), std::invalid_argument);
+    ASSERT_THROW(checker.check_trajectory(Eigen::MatrixXd::Zero(4, 3)), std::invalid_argument);
+    ASSERT_THROW(checker.ignore_pair(0, 7), std::invalid_argument);
+    ASSERT_THROW(checker.set_clearance(-1.0), std::invalid_argument);
+    ASSERT_THROW(checker.set_tolerance(0.0), std::invalid_argument);
+    ASSERT_THROW(checker.set_max_iterations(0), std::invalid_argument);
+    ASSERT_THROW(checker.add_palm_capsule(fm::capsule()), std::invalid_argument);
+
+    fm::finger_model<> prismatic = capsule_finger();
+    std::vector<Eigen::VectorXd> S_list(4, Eigen::VectorXd::Zero(6));
+    S_list[0](3) = 1.0;
+    for (int i = 1; i < 4; i++) S_list[i](2) = 1.0;
+    prismatic.set_home_position_screw_axes_space(S_list);
+    ASSERT_THROW(checker.add_finger(prismatic), std::invalid_argument);
+
+    // A clearance turns near misses into contacts
+    Eigen::VectorXd q = Eigen::VectorXd::Zero(8);
+    int a, b;
+    const double d = checker.distance(q, a, b);
+    ASSERT_FALSE(checker.in_collision(q));
+    checker.set_clearance(d + 1e-3);
+    ASSERT_TRUE(checker.in_collision(q));
+    ASSERT_NEAR(checker.distance(q, a, b), d, 1e-12);
+}
@@ -0,0 +1,107 @@
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include <Eigen/Dense>
+#include "../../src/include/contact_model.hpp"
+#include "../../src/include/finger_description.hpp"
+
+// Planar three link finger lying along the x axis
+static const std::string test_finger_path = std::string(TEST_DATA_DIR) + "/planar_test_finger.yaml";
+
+/**
+ * @brief Test the box signed distance and capsule-box query.
+ */
+TEST(ContactModelTest, BoxDistance) {
+    fm::box b;
+    b.half_extents << 0.01, 0.02, 0.03;
+    Eigen::Vector3d normal;
+
+    ASSERT_NEAR(fm::geometry::box_signed_distance(b, Eigen::Vector3d(0.03, 0, 0), normal), 0.02, 1e-12);
+    ASSERT_TRUE(normal.isApprox(Eigen::Vector3d::UnitX()));
+    ASSERT_NEAR(fm::geometry::box_signed_distance(b, Eigen::Vector3d(0, 0.015, 0), normal), -0.005, 1e-12);
+    ASSERT_TRUE(normal.isApprox(Eigen::Vector3d::UnitY()));
+
+    fm::capsule c;
+    c.a << -0.05, 0.025, 0.0;
+    c.b << 0.05, 0.025, 0.0;
+    c.radius = 0.01;
+    Eigen::Vector3d point;
+    ASSERT_NEAR(fm::geometry::capsule_box(c, b, point, normal), -0.005, 1e-9);
+    ASSERT_TRUE(normal.isApprox(Eigen::Vector3d::UnitY(), 1e-9));
+}
+
+/**
+ * @brief Test a fingertip pressing on a sphere and the resulting joint torques and load reading.
+ */
+TEST(ContactModelTest, FingertipOnSphere) {
+    fm::finger_model<> finger = fm::load_finger_description(test_finger_path);
+    fm::contact_model model(finger, Eigen::VectorXd::Constant(3, 0.005));
+
+    fm::sphere object;
+    object.center << 0.09, -0.02, 0.0;
+    object.radius = 0.016;
+    int id = model.add_sphere(object);
+
+    Eigen::VectorXd tau = model.evaluate(Eigen::VectorXd::Zero(3), Eigen::VectorXd::Zero(3));
+    ASSERT_EQ(model.get_contacts().size(), 1u);
+    ASSERT_EQ(model.get_contacts()[0].link, 2);
+    ASSERT_NEAR(model.get_contacts()[0].depth, 0.001, 1e-12);
+
+    // 20 N pushing the distal link up in +y, applied 0.09 m from the base joint
+    ASSERT_TRUE(model.get_object_force(id).isApprox(Eigen::Vector3d(0, -20.0, 0), 1e-9));
+    ASSERT_NEAR(tau(0), 20.0 * 0.09, 1e-9);
+    ASSERT_NEAR(tau(1), 20.0 * (0.09 - 0.046), 1e-9);
+    ASSERT_NEAR(tau(2), 20.0 * (0.09 - 0.078), 1e-9);
+}
+
+/**
+ * @brief Test Coulomb friction and broad phase culling.
+ */
+TEST(ContactModelTest, FrictionAndCulling) {
+    fm::finger_model<> finger = fm::load_finger_description(test_finger_path);
+    fm::contact_parameters parameters;
+    parameters.damping = 0.0;
+    fm::contact_model model(finger, Eigen::VectorXd::Constant(3, 0.005), parameters);
+
+    fm::plane table;
+    table.normal << 0, 1, 0;
+    table.offset = -0.004;
+    model.add_plane(table);
+
+    fm::sphere far_object;
+    far_object.center << 1.0, 1.0, 1.0;
+    far_object.radius = 0.01;
+    model.add_sphere(far_object);
+
+    Eigen::VectorXd q = Eigen::VectorXd::Zero(3);
+    Eigen::VectorXd qd = Eigen::VectorXd::Zero(3);
+    model.evaluate(q, qd);
+    ASSERT_EQ(model.get_num_narrow_phase_tests(), 3);
+    ASSERT_EQ(model.get_contacts().size(), 3u);
+    for (const auto& c : model.get_contacts()) {
+        ASSERT_NEAR(c.force(1), 20.0, 1e-9);
+    }
+
+    // Fingertip pressed 3 mm into a wall and swept sideways: friction saturates at mu * F_n
+    fm::plane wall;
+    wall.normal << -1, 0, 0;
+    wall.offset = -0.105;
+    fm::contact_model tip_model(finger, Eigen::VectorXd::Constant(3, 0.005), parameters);
+    int wall_id = tip_model.add_plane(wall);
+    qd(0) = 1.0;
+    tip_model.evaluate(q, qd);
+    ASSERT_EQ(tip_model.get_contacts().size(), 1u);
+    const fm::contact_point& tip = tip_model.get_contacts()[0];
+    ASSERT_NEAR(tip.force(0), -60.0, 1e-9);
+    ASSERT_NEAR(tip.force(1), -0.5 * 60.0, 1e-2);
+    ASSERT_TRUE(tip_model.get_object_force(wall_id).isApprox(-tip.force));
+
+    fm::box platen;
+    platen.center << 0.2, 0.0, 0.0;
+    platen.half_extents << 0.01, 0.01, 0.01;
+    model.add_box(platen);
+    model.evaluate(q, qd);
+    ASSERT_EQ(model.get_num_narrow_phase_tests(), 3);
+}
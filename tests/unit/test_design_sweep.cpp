@@ -0,0 +1,109 @@
+#include <cstdio>
+#include <fstream>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include <Eigen/Dense>
+#include "../../src/include/design_sweep.hpp"
+#include "../../src/include/finger_description.hpp"
+
+// Planar three link finger with four tendons
+static const std::string test_finger_path = std::string(TEST_DATA_DIR) + "/planar_test_finger.yaml";
+
+/**
+ * @brief Configure a small enumerated sweep over two link lengths and one moment arm.
+ */
+static void configure(fm::design_sweep& sweep) {
+    sweep.set_joint_range(Eigen::Vector3d(-0.3, 0.0, 0.0), Eigen::Vector3d(1.5, 1.7, 1.4));
+    sweep.set_link_length_range(Eigen::Vector3d(0.035, 0.032, 0.015), Eigen::Vector3d(0.055, 0.032, 0.035));
+    Eigen::MatrixXd min_arms = fm::load_finger_description(test_finger_path).get_tendon_routing_matrix(), max_arms = min_arms;
+    min_arms(0, 3) = -0.012;
+    max_arms(0, 3) = -0.004;
+    sweep.set_moment_arm_range(min_arms, max_arms);
+    sweep.set_enumeration(3);
+    sweep.set_grid_samples(8, 3);
+}
+
+/**
+ * @brief Test that candidates are built with the requested geometry.
+ */
+TEST(DesignSweepTest, BuildsCandidates) {
+    fm::design_sweep sweep(fm::load_finger_description(test_finger_path), 1.0, 40.0);
+    configure(sweep);
+    ASSERT_EQ(sweep.get_num_candidates(), 27);
+
+    // Index digits run over the first link length fastest
+    fm::design_candidate candidate = sweep.candidate(5);
+    ASSERT_DOUBLE_EQ(candidate.link_lengths(0), 0.055);
+    ASSERT_DOUBLE_EQ(candidate.link_lengths(2), 0.025);
+    ASSERT_DOUBLE_EQ(candidate.tendon_routing_matrix(0, 3), -0.012);
+
+    fm::finger_model<> finger = sweep.build_finger(candidate);
+    ASSERT_NEAR(finger.get_home_position_body_frame()(0, 3), 0.055 + 0.032 + 0.025, 1e-12);
+    ASSERT_NEAR(finger.get_home_position_screw_axes_space()(4, 2), -(0.055 + 0.032), 1e-12);
+    ASSERT_DOUBLE_EQ(finger.get_tendon_routing_matrix()(0, 3), -0.012);
+
+    // Random candidates stay inside the ranges and depend only on the seed and index
+    sweep.set_random_samples(100, 3);
+    for (long k = 0; k < 100; k++) {
+        fm::design_candidate sample = sweep.candidate(k);
+        ASSERT_GE(sample.link_lengths(0), 0.035);
+        ASSERT_LE(sample.link_lengths(0), 0.055);
+        ASSERT_EQ(sample.link_lengths(1), 0.032);
+    }
+    ASSERT_EQ(sweep.candidate(42).link_lengths, sweep.candidate(42).link_lengths);
+    ASSERT_THROW(sweep.candidate(100), std::out_of_range);
+    ASSERT_THROW(sweep.set_link_length_range(Eigen::Vector3d(0.05, 0.03, 0.02), Eigen::Vector3d(0.04, 0.03, 0.02)), std::invalid_argument);
+}
+
+/**
+ * @brief Test that the front with early rejection is exactly the non-dominated set of the fully scored candidates.
+ */
+TEST(DesignSweepTest, ParetoFront) {
+    fm::design_sweep sweep(fm::load_finger_description(test_finger_path), 1.0, 40.0);
+    configure(sweep);
+
+    std::vector<fm::design_scores> scores;
+    for (long k = 0; k < sweep.get_num_candidates(); k++) {
+        scores.push_back(sweep.score(sweep.candidate(k)));
+        ASSERT_GT(scores.back().workspace_area, 0.0);
+        ASSERT_GT(scores.back().dexterity, 0.0);
+        ASSERT_GT(scores.back().tension_peak, 1.0);
+    }
+    std::set<long> expected;
+    for (long a = 0; a < static_cast<long>(scores.size()); a++) {
+        bool dominated = false;
+        for (long b = 0; b < static_cast<long>(scores.size()); b++) {
+            dominated = dominated || fm::dominates(scores[b], scores[a]);
+        }
+        if (!dominated) {
+            expected.insert(a);
+        }
+    }
+
+    for (int threads : {1, 3}) {
+        sweep.run(threads);
+        std::set<long> front;
+        for (const fm::design_candidate& member : sweep.get_pareto_front()) {
+            front.insert(member.index);
+            ASSERT_DOUBLE_EQ(member.scores.tension_peak, scores[member.index].tension_peak);
+        }
+        ASSERT_EQ(front, expected);
+        ASSERT_LE(sweep.get_num_rejected() + static_cast<long>(front.size()), sweep.get_num_candidates());
+    }
+
+    const std::string path = "test_design_sweep_front.csv";
+    sweep.write_pareto_front(path);
+    std::ifstream file(path);
+    std::string line;
+    std::getline(file, line);
+    ASSERT_EQ(line.substr(0, 20), "index,link_length_0,");
+    long rows = 0;
+    while (std::getline(file, line)) {
+        rows++;
+    }
+    ASSERT_EQ(rows, static_cast<long>(expected.size()));
+    std::remove(path.c_str());
+}
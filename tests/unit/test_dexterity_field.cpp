@@ -0,0 +1,161 @@
+#include <cmath>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include <Eigen/Dense>
+#include "../../src/include/dexterity_field.hpp"
+#include "../../src/include/finger_description.hpp"
+
+// Spatial four joint finger: abduction about y, then three flexion joints about z
+static const std::string test_finger_path = std::string(TEST_DATA_DIR) + "/tendon_test_finger.yaml";
+
+/**
+ * @brief Build a planar two joint finger.
+ */
+static fm::finger_model<> planar_finger() {
+    Eigen::VectorXd link_lengths(2); link_lengths << 0.05, 0.03;
+    fm::finger_model<> finger(link_lengths, Eigen::VectorXd::Zero(2));
+
+    std::vector<Eigen::VectorXd> S_list;
+    Eigen::VectorXd S1(6); S1 << 0, 0, 1, 0, 0, 0;     S_list.push_back(S1);
+    Eigen::VectorXd S2(6); S2 << 0, 0, 1, 0, -0.05, 0; S_list.push_back(S2);
+    finger.set_home_position_screw_axes_space(S_list);
+
+    Eigen::MatrixXd M = Eigen::MatrixXd::Identity(4, 4);
+    M(0, 3) = 0.08;
+    finger.set_home_position_body_frame(M);
+    return finger;
+}
+
+/**
+ * @brief Test the closed-form eigenvalues against Eigen's symmetric eigensolver.
+ */
+TEST(DexterityFieldTest, SymmetricEigenvalues) {
+    std::srand(7);
+    fm::dexterity_field::lane_array a[6];
+    std::vector<Eigen::Matrix3d> matrices;
+    for (int l = 0; l < fm::dexterity_field::lanes; l++) {
+        Eigen::Matrix3d B = Eigen::Matrix3d::Random();
+        Eigen::Matrix3d A = B * B.transpose();
+        if (l == 0) {
+            A = 2.5 * Eigen::Matrix3d::Identity();
+        } else if (l == 1) {
+            A = Eigen::Vector3d(1.0, 2.0, 0.0).normalized() * Eigen::Vector3d(1.0, 2.0, 0.0).normalized().transpose();
+        }
+        matrices.push_back(A);
+        a[0](l) = A(0, 0); a[1](l) = A(1, 1); a[2](l) = A(2, 2);
+        a[3](l) = A(0, 1); a[4](l) = A(0, 2); a[5](l) = A(1, 2);
+    }
+    fm::dexterity_field::lane_array eigenvalues[3];
+    fm::dexterity_field::symmetric_eigenvalues(a[0], a[1], a[2], a[3], a[4], a[5], eigenvalues);
+    for (int l = 0; l < fm::dexterity_field::lanes; l++) {
+        Eigen::Vector3d expected = Eigen::SelfAdjointEigenSolver<Eigen::Matrix3d>(matrices[l], Eigen::EigenvaluesOnly).eigenvalues();
+        ASSERT_NEAR(eigenvalues[0](l), expected(2), 1e-9);
+        ASSERT_NEAR(eigenvalues[1](l), expected(1), 1e-9);
+        ASSERT_NEAR(eigenvalues[2](l), expected(0), 1e-9);
+    }
+}
+
+/**
+ * @brief Test the fields against the singular values of the finger model's Jacobian.
+ */
+TEST(DexterityFieldTest, MatchesSingularValues) {
+    fm::finger_model<> finger = fm::load_finger_description(test_finger_path);
+    fm::dexterity_field field(finger);
+    ASSERT_EQ(field.get_task_dimension(), 3);
+
+    fm::configuration_grid grid(Eigen::Vector4d(-0.3, -0.2, 0.0, 0.0), Eigen::Vector4d(0.3, 1.4, 1.6, 1.2), Eigen::Vector4i(3, 4, 3, 3));
+    field.compute(grid, 2);
+    ASSERT_EQ(field.get_num_points(), grid.size());
+
+    for (long k = 0; k < grid.size(); k++) {
+        finger.set_joint_angles(grid.point(k));
+        const auto& J = finger.get_finger_space_jacobian();
+        const Eigen::Vector3d p = finger.get_fingertip_pose_space().block<3, 1>(0, 3);
+        Eigen::Matrix<double, 3, 4> J_p;
+        for (int i = 0; i < 4; i++) {
+            J_p.col(i) = J.block<3, 1>(3, i) + J.block<3, 1>(0, i).cross(p);
+        }
+        Eigen::Vector3d sigma = Eigen::JacobiSVD<Eigen::Matrix<double, 3, 4>>(J_p).singularValues();
+
+        ASSERT_TRUE(field.get_positions().col(k).cast<double>().isApprox(p, 1e-6));
+        ASSERT_NEAR(field.get_manipulability()(k), sigma.prod(), 1e-6 * sigma(0) * sigma(0) * sigma(0) + 1e-12);
+        ASSERT_NEAR(field.get_min_singular_value()(k), sigma(2), 1e-5 * sigma(0));
+        if (sigma(2) > 1e-3 * sigma(0)) {
+            ASSERT_NEAR(field.get_condition_number()(k), sigma(0) / sigma(2), 1e-3 * sigma(0) / sigma(2));
+        }
+    }
+
+    // Thread count does not change the result
+    Eigen::VectorXf manipulability = field.get_manipulability();
+    field.compute(grid, 1);
+    ASSERT_EQ(field.get_manipulability(), manipulability);
+}
+
+/**
+ * @brief Test that refinement adds points where the field changes steeply and nowhere else.
+ */
+TEST(DexterityFieldTest, Refinement) {
+    fm::dexterity_field field(planar_finger());
+    ASSERT_EQ(field.get_task_dimension(), 2);
+
+    // Manipulability l1 l2 |sin(theta_2)| has its steepest change at the straight finger
+    fm::configuration_grid grid(Eigen::Vector2d(-1.0, -1.5), Eigen::Vector2d(1.0, 1.5), Eigen::Vector2i(5, 7));
+    field.compute(grid, 1);
+    ASSERT_EQ(field.get_num_points(), grid.size());
+    for (long k = 0; k < grid.size(); k++) {
+        ASSERT_NEAR(field.get_manipulability()(k), 0.05 * 0.03 * std::abs(std::sin(grid.point(k)(1))), 1e-7);
+    }
+
+    field.set_refinement(2, 0.2);
+    field.compute(grid, 2);
+    ASSERT_EQ(field.get_num_grid_points(), grid.size());
+    ASSERT_GT(field.get_num_points(), grid.size());
+    const Eigen::MatrixXd& angles = field.get_joint_angles();
+    double finest = 1.0;
+    for (long k = grid.size(); k < field.get_num_points(); k++) {
+        ASSERT_NEAR(field.get_manipulability()(k), 0.05 * 0.03 * std::abs(std::sin(angles(1, k))), 1e-7);
+        ASSERT_LE(std::abs(angles(1, k)), 1.0 + 1e-12);
+        // Refinement points lie on the lattice of the finest level
+        double steps = (angles(1, k) + 1.5) / (0.5 / 4.0);
+        ASSERT_NEAR(steps, std::round(steps), 1e-9);
+        if (std::abs(std::fmod(steps, 2.0)) > 0.5) {
+            finest = std::min(finest, std::abs(angles(1, k)));
+        }
+    }
+    ASSERT_LT(finest, 0.2);
+
+    // Refinement is deterministic across thread counts
+    Eigen::MatrixXd refined = angles;
+    field.compute(grid, 1);
+    ASSERT_EQ(field.get_joint_angles(), refined);
+}
+
+/**
+ * @brief Test the Cartesian map and invalid inputs.
+ */
+TEST(DexterityFieldTest, CartesianMap) {
+    fm::dexterity_field field(planar_finger());
+    fm::configuration_grid grid(Eigen::Vector2d(0.0, 0.0), Eigen::Vector2d(1.5, 2.0), Eigen::Vector2i(16, 21));
+    field.compute(grid);
+
+    fm::cartesian_dexterity map = field.cartesian_map(0.01);
+    ASSERT_GT(map.cell_centers.cols(), 10);
+    ASSERT_LT(map.cell_centers.cols(), grid.size());
+    for (long c = 0; c < map.cell_centers.cols(); c++) {
+        ASSERT_NEAR(map.cell_centers(2, c), 0.005, 1e-6);
+        ASSERT_LE(map.manipulability(c), 0.05 * 0.03 + 1e-7);
+        ASSERT_GE(map.condition_number(c), 1.0f - 1e-4f);
+    }
+    float best = 0.0f;
+    for (long k = 0; k < field.get_num_points(); k++) {
+        best = std::max(best, field.get_manipulability()(k));
+    }
+    ASSERT_FLOAT_EQ(map.manipulability.maxCoeff(), best);
+
+    ASSERT_THROW(field.cartesian_map(0.0), std::invalid_argument);
+    ASSERT_THROW(field.set_task_dimension(3), std::invalid_argument);
+    ASSERT_THROW(field.set_refinement(2, 0.0), std::invalid_argument);
+    ASSERT_THROW(field.compute(fm::configuration_grid(Eigen::Vector3d::Zero(), Eigen::Vector3d::Ones(), Eigen::Vector3i(2, 2, 2))), std::invalid_argument);
+}
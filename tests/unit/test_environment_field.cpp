@@ -0,0 +1,160 @@
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <random>
+#include <string>
+
+#include <gtest/gtest.h>
+#include <Eigen/Dense>
+#include "../../src/include/environment_field.hpp"
+
+/**
+ * @brief Testbed with a table plane, a load cell box and a ball.
+ */
+static fm::environment_model testbed() {
+    fm::environment_model environment;
+    fm::plane table;
+    table.normal = Eigen::Vector3d(0, 0, 2);
+    table.offset = -0.08;
+    environment.add_plane(table);
+    fm::box load_cell;
+    load_cell.center = Eigen::Vector3d(0.06, -0.03, -0.02);
+    load_cell.rotation = Eigen::AngleAxisd(0.4, Eigen::Vector3d::UnitZ()).toRotationMatrix();
+    load_cell.half_extents = Eigen::Vector3d(0.015, 0.01, 0.02);
+    environment.add_box(load_cell);
+    fm::sphere ball;
+    ball.center = Eigen::Vector3d(0.08, 0.04, 0.0);
+    ball.radius = 0.02;
+    environment.add_sphere(ball);
+    return environment;
+}
+
+/**
+ * @brief Test that the mapped field matches the exact distances to within the grid resolution.
+ */
+TEST(EnvironmentFieldTest, PrimitiveField) {
+    fm::environment_model environment = testbed();
+    ASSERT_EQ(environment.get_num_objects(), 3);
+    ASSERT_NEAR(environment.signed_distance(Eigen::Vector3d(0.0, 0.0, 0.0)), 0.04, 1e-12);
+    ASSERT_NEAR(environment.signed_distance(Eigen::Vector3d(0.08, 0.04, 0.0)), -0.02, 1e-12);
+
+    fm::aabb region;
+    region.min = Eigen::Vector3d(-0.02, -0.08, -0.05);
+    region.max = Eigen::Vector3d(0.12, 0.08, 0.05);
+    const double spacing = 0.002;
+    const std::string path = "test_environment_field.sdf";
+    environment.write_distance_field(path, region, spacing, 2);
+    fm::signed_distance_field field(path);
+    ASSERT_FALSE(field.is_planar());
+    ASSERT_EQ(field.get_dimensions(), Eigen::Vector3i(71, 81, 51));
+    ASSERT_DOUBLE_EQ(field.get_spacing(), spacing);
+
+    std::mt19937 generator(7);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    for (int trial = 0; trial < 2000; trial++) {
+        Eigen::Vector3d point = region.min + (region.max - region.min).cwiseProduct(Eigen::Vector3d(unit(generator), unit(generator), unit(generator)));
+        Eigen::Vector3d gradient;
+        const double d = field.distance(point, gradient);
+        ASSERT_NEAR(d, environment.signed_distance(point), spacing);
+
+        // Away from the edges of the distance function the gradient is the unit direction of steepest ascent
+        const double h = 1e-3;
+        Eigen::Vector3d difference;
+        for (int r = 0; r < 3; r++) {
+            difference(r) = (environment.signed_distance(point + h * Eigen::Vector3d::Unit(r)) -
+                             environment.signed_distance(point - h * Eigen::Vector3d::Unit(r))) / (2 * h);
+        }
+        if (std::abs(difference.norm() - 1.0) < 1e-6 && (point - Eigen::Vector3d(0.08, 0.04, 0.0)).norm() > 0.01) {
+            ASSERT_GT(gradient.normalized().dot(difference), 0.9);
+        }
+    }
+
+    // Outside the grid the value stays a lower bound
+    const Eigen::Vector3d far(0.3, 0.0, 0.0);
+    ASSERT_LE(field.distance(far), environment.signed_distance(far));
+    std::remove(path.c_str());
+}
+
+/**
+ * @brief Test a closed mesh against the equivalent box, and a planar field.
+ */
+TEST(EnvironmentFieldTest, MeshAndPlanarField) {
+    fm::box block;
+    block.center = Eigen::Vector3d(0.01, 0.02, 0.0);
+    block.half_extents = Eigen::Vector3d(0.02, 0.01, 0.015);
+    fm::environment_model boxed;
+    boxed.add_box(block);
+
+    Eigen::Matrix3Xd vertices(3, 8);
+    for (int k = 0; k < 8; k++) {
+        vertices.col(k) = block.center + Eigen::Vector3d((k & 1) ? 1 : -1, (k & 2) ? 1 : -1, (k & 4) ? 1 : -1).cwiseProduct(block.half_extents);
+    }
+    Eigen::Matrix3Xi triangles(3, 12);
+    triangles << 0, 0, 4, 4, 0, 0, 2, 2, 0, 0, 1, 1,
+                 2, 3, 5, 7, 1, 5, 6, 7, 4, 6, 3, 7,
+                 3, 1, 7, 6, 5, 4, 7, 3, 6, 2, 7, 5;
+    fm::environment_model meshed;
+    meshed.add_mesh(vertices, triangles);
+
+    std::mt19937 generator(9);
+    std::uniform_real_distribution<double> coordinate(-0.05, 0.05);
+    int inside = 0;
+    for (int trial = 0; trial < 1000; trial++) {
+        Eigen::Vector3d point(coordinate(generator), coordinate(generator), coordinate(generator));
+        const double d = boxed.signed_distance(point);
+        ASSERT_NEAR(meshed.signed_distance(point), d, 1e-12);
+        inside += d < 0.0 ? 1 : 0;
+    }
+    ASSERT_GT(inside, 0);
+
+    fm::aabb region;
+    region.min = Eigen::Vector3d(-0.04, -0.04, 0.0);
+    region.max = Eigen::Vector3d(0.06, 0.06, 0.0);
+    const std::string path = "test_environment_planar.sdf";
+    meshed.write_distance_field(path, region, 0.001);
+    fm::signed_distance_field field(path);
+    ASSERT_TRUE(field.is_planar());
+    ASSERT_EQ(field.get_dimensions()(2), 1);
+    Eigen::Vector3d gradient;
+    const double d = field.distance(Eigen::Vector3d(0.045, 0.02, 0.3), gradient);
+    ASSERT_NEAR(d, 0.015, 1e-6);
+    ASSERT_TRUE(gradient.isApprox(Eigen::Vector3d::UnitX(), 1e-4));
+    std::remove(path.c_str());
+}
+
+/**
+ * @brief Test link clearance against the field, and invalid inputs.
+ */
+TEST(EnvironmentFieldTest, CapsuleClearance) {
+    fm::environment_model environment = testbed();
+    fm::aabb region;
+    region.min = Eigen::Vector3d(-0.02, -0.08, -0.05);
+    region.max = Eigen::Vector3d(0.12, 0.08, 0.05);
+    const std::string path = "test_environment_capsule.sdf";
+    environment.write_distance_field(path, region, 0.002);
+    fm::signed_distance_field field(path);
+
+    // A link hovering over the ball
+    fm::capsule link;
+    link.a = Eigen::Vector3d(0.04, 0.04, 0.035);
+    link.b = Eigen::Vector3d(0.11, 0.04, 0.035);
+    link.radius = 0.005;
+    Eigen::Vector3d point, gradient;
+    const double d = field.capsule_distance(link, point, gradient);
+    ASSERT_NEAR(d, 0.01, 0.002);
+    ASSERT_NEAR(point(0), 0.08, 0.003);
+    ASSERT_NEAR(point(2), 0.03, 0.002);
+    ASSERT_GT(gradient.normalized()(2), 0.95);
+
+    std::ofstream(path, std::ios::binary) << "not a distance field";
+    ASSERT_THROW(fm::signed_distance_field bad(path), std::runtime_error);
+    std::remove(path.c_str());
+    ASSERT_THROW(fm::signed_distance_field missing(path), std::runtime_error);
+
+    fm::environment_model empty;
+    ASSERT_THROW(empty.signed_distance(Eigen::Vector3d::Zero()), std::runtime_error);
+    ASSERT_THROW(environment.write_distance_field(path, region, 0.0), std::invalid_argument);
+    ASSERT_THROW(empty.add_sphere(fm::sphere()), std::invalid_argument);
+    ASSERT_THROW(empty.add_plane(fm::plane{Eigen::Vector3d::Zero(), 0.0}), std::invalid_argument);
+    ASSERT_THROW(empty.add_mesh(Eigen::Matrix3Xd::Zero(3, 3), Eigen::Matrix3Xi::Constant(3, 1, 3)), std::invalid_argument);
+}
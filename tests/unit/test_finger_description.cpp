@@ -0,0 +1,190 @@
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+#include <gtest/gtest.h>
+#include <Eigen/Dense>
+#include "../../src/include/finger_description.hpp"
+#include "../../src/include/finger_model.hpp"
+#include "../../src/include/open_chain_kinematics.hpp"
+
+static const std::string finger_yaml = R"(
+format_version: 1
+name: test_finger
+home_position_body_frame:
+  - [1, 0, 0, 0.103]
+  - [0, 1, 0, 0]
+  - [0, 0, 1, 0]
+  - [0, 0, 0, 1]
+joints:
+  - name: mcp
+    screw_axis: [0, 0, 1, 0, 0, 0]
+    length: 0.046
+    limits: [-0.35, 1.57]
+    inertia:
+      mass: 0.012
+      center_of_mass: [0.023, 0, 0]
+      rotational_inertia: [2.0e-7, 2.3e-6, 2.3e-6, 0, 0, 0]
+  - name: pip
+    axis: [0, 0, 1]
+    point: [0.046, 0, 0]
+    length: 0.032
+    angle: 0.2
+    capsule:
+      start: [0.046, 0, 0]
+      end: [0.078, 0, 0]
+      radius: 0.008
+  - name: dip
+    axis: [0, 0, 1]
+    point: [0.078, 0, 0]
+    length: 0.025
+    limits: [0.1, 1.4]
+tendons:
+  - moment_arms: [0.008, 0.006, 0.004]
+  - moment_arms: [-0.008, -0.006, -0.004]
+motors:
+  - tendon_coefficients: [100, -100]
+)";
+
+/**
+ * @brief Temporary directory removed at the end of a test.
+ */
+struct scratch_directory
+{
+    std::filesystem::path path;
+    explicit scratch_directory(const std::string& name) : path(std::filesystem::temp_directory_path() / name) {
+        std::filesystem::remove_all(path);
+        std::filesystem::create_directories(path);
+    }
+    ~scratch_directory() { std::filesystem::remove_all(path); }
+};
+
+/**
+ * @brief Replace the first occurrence of a string in the test description.
+ */
+static std::string edited(const std::string& from, const std::string& to) {
+    std::string text = finger_yaml;
+    text.replace(text.find(from), from.size(), to);
+    return text;
+}
+
+/**
+ * @brief Test that a description is parsed into the expected model with derived body screw axes.
+ */
+TEST(FingerDescriptionTest, ParseDescription) {
+    fm::finger_model<> finger = fm::parse_finger_description(finger_yaml);
+    ASSERT_EQ(finger.get_num_joints(), 3);
+    ASSERT_TRUE(finger.get_link_lengths().isApprox(Eigen::Vector3d(0.046, 0.032, 0.025)));
+
+    // Unset angles default to zero clamped into the limits
+    ASSERT_TRUE(finger.get_joint_angles().isApprox(Eigen::Vector3d(0.0, 0.2, 0.1)));
+    ASSERT_EQ(finger.get_joint_upper_limits()(0), 1.57);
+    ASSERT_TRUE(std::isinf(finger.get_joint_upper_limits()(1)));
+
+    Eigen::Matrix<double, 6, 1> S3;
+    S3 << 0, 0, 1, 0, -0.078, 0;
+    ASSERT_TRUE(finger.get_home_position_screw_axes_space().col(2).isApprox(S3));
+    ASSERT_TRUE(finger.get_fingertip_pose_body().isApprox(finger.get_fingertip_pose_space()));
+
+    ASSERT_DOUBLE_EQ(finger.get_link_inertia(0).mass, 0.012);
+    ASSERT_DOUBLE_EQ(finger.get_link_inertia(0).rotational_inertia(1, 1), 2.3e-6);
+    ASSERT_EQ(finger.get_link_inertia(1).mass, 0.0);
+    ASSERT_DOUBLE_EQ(finger.get_link_geometry(1).radius, 0.008);
+    ASSERT_TRUE(finger.get_link_geometry(1).end.isApprox(Eigen::Vector3d(0.078, 0, 0)));
+    ASSERT_EQ(finger.get_link_geometry(0).radius, 0.0);
+    ASSERT_EQ(finger.get_tendon_routing_matrix().cols(), 2);
+    ASSERT_DOUBLE_EQ(finger.get_tendon_routing_matrix()(1, 1), -0.006);
+    ASSERT_EQ(finger.get_motor_shaft_matrix().rows(), 1);
+}
+
+/**
+ * @brief Test that invalid descriptions are rejected with the offending key in the message.
+ */
+TEST(FingerDescriptionTest, RejectInvalidDescriptions) {
+    auto expect_error = [](const std::string& text, const std::string& key) {
+        try {
+            fm::parse_finger_description(text);
+            FAIL() << "accepted a description with a bad " << key;
+        } catch (const std::invalid_argument& e) {
+            EXPECT_NE(std::string(e.what()).find(key), std::string::npos) << e.what();
+        }
+    };
+    expect_error(edited("format_version: 1", "format_version: 2"), "format_version");
+    expect_error(edited("[0, 0, 1, 0, 0, 0]", "[0, 0, 2, 0, 0, 0]"), "joints[0]");
+    expect_error(edited("limits: [-0.35, 1.57]", "limits: [1.0, 0.5]"), "joints[0].limits");
+    expect_error(edited("angle: 0.2", "angel: 0.2"), "unknown key 'angel'");
+    expect_error(edited("length: 0.032", "length: short"), "joints[1].length");
+    expect_error(edited("[0.008, 0.006, 0.004]", "[0.008, 0.006]"), "tendons[0].moment_arms");
+    expect_error(edited("[2.0e-7, 2.3e-6, 2.3e-6, 0, 0, 0]", "[1.0e-6, 1.0e-7, 1.0e-7, 0, 0, 0]"), "rotational_inertia");
+    expect_error(edited("radius: 0.008", "radius: -0.008"), "joints[1].capsule.radius");
+    expect_error(edited("[0, 1, 0, 0]", "[0, 2, 0, 0]"), "home_position_body_frame");
+    expect_error("format_version: [", "finger description");
+    ASSERT_THROW(fm::load_finger_description("/nonexistent/finger.yaml"), std::runtime_error);
+}
+
+/**
+ * @brief Test that compiled models round trip, carry derived tables and are reused by content hash.
+ */
+TEST(FingerDescriptionTest, CompiledModelCache) {
+    scratch_directory scratch("fm_test_finger_description");
+    const std::filesystem::path description = scratch.path / "finger.yaml";
+    const std::filesystem::path cache = scratch.path / "cache";
+    std::ofstream(description) << finger_yaml;
+
+    fm::finger_model<> parsed = fm::parse_finger_description(finger_yaml);
+    fm::finger_model<> loaded = fm::load_finger_model(description.string(), cache.string());
+    ASSERT_TRUE(loaded.get_fingertip_pose_space().isApprox(parsed.get_fingertip_pose_space()));
+
+    // The compiled file is named by the content hash and maps back to an identical model
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.fmodel", static_cast<unsigned long long>(fm::finger_description_hash(finger_yaml)));
+    const std::filesystem::path compiled_path = cache / name;
+    ASSERT_TRUE(std::filesystem::exists(compiled_path));
+    {
+        fm::compiled_finger_model compiled(compiled_path.string());
+        ASSERT_EQ(compiled.get_content_hash(), fm::finger_description_hash(finger_yaml));
+        fm::finger_model<> mapped = compiled.get_finger_model();
+        ASSERT_TRUE(mapped.get_home_position_screw_axes_body().isApprox(parsed.get_home_position_screw_axes_body()));
+        ASSERT_TRUE(mapped.get_tendon_routing_matrix().isApprox(parsed.get_tendon_routing_matrix()));
+        ASSERT_TRUE(mapped.get_motor_shaft_matrix().isApprox(parsed.get_motor_shaft_matrix()));
+        ASSERT_TRUE((mapped.get_joint_lower_limits().array() == parsed.get_joint_lower_limits().array()).all());
+        ASSERT_TRUE(mapped.get_link_inertia(0).rotational_inertia.isApprox(parsed.get_link_inertia(0).rotational_inertia));
+        ASSERT_TRUE(mapped.get_link_geometry(1).start.isApprox(parsed.get_link_geometry(1).start));
+        ASSERT_DOUBLE_EQ(mapped.get_link_geometry(1).radius, 0.008);
+    }
+
+    // A second load is served from the compiled file
+    fm::finger_model<> cached = fm::load_finger_model(description.string(), cache.string());
+    ASSERT_TRUE(cached.get_joint_angles().isApprox(parsed.get_joint_angles()));
+
+    // Editing the description compiles a new entry
+    std::ofstream(description) << edited("length: 0.025", "length: 0.03");
+    ASSERT_DOUBLE_EQ(fm::load_finger_model(description.string(), cache.string()).get_link_lengths()(2), 0.03);
+    ASSERT_EQ(std::distance(std::filesystem::directory_iterator(cache), std::filesystem::directory_iterator()), 2);
+
+    // Derived tables are stored aligned and returned in place
+    std::vector<fm::compiled_table> tables(2);
+    tables[0].tag = 7;
+    tables[0].data.assign(13, 'a');
+    tables[1].tag = 9;
+    tables[1].data.resize(sizeof(double) * 4);
+    double values[4] = {1.0, 2.0, 3.0, 4.0};
+    std::memcpy(tables[1].data.data(), values, sizeof(values));
+    const std::string with_tables = (scratch.path / "tables.fmodel").string();
+    fm::compiled_finger_model::write(with_tables, parsed, 42, tables);
+    fm::compiled_finger_model compiled(with_tables);
+    std::size_t size;
+    const double* mapped_values = static_cast<const double*>(compiled.get_table(9, size));
+    ASSERT_EQ(size, sizeof(values));
+    ASSERT_EQ(reinterpret_cast<std::uintptr_t>(mapped_values) % 16, 0u);
+    ASSERT_EQ(mapped_values[3], 4.0);
+    ASSERT_NE(compiled.get_table(7, size), nullptr);
+    ASSERT_EQ(size, 13u);
+    ASSERT_EQ(compiled.get_table(8, size), nullptr);
+
+    // Truncated or foreign files are refused
+    std::filesystem::resize_file(with_tables, 100);
+    ASSERT_THROW(fm::compiled_finger_model bad(with_tables), std::runtime_error);
+    ASSERT_THROW(fm::compiled_finger_model bad(description.string()), std::runtime_error);
+}
@@ -0,0 +1,191 @@
+#include <iostream>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include <Eigen/Dense>
+#include "../../src/include/finger_model.hpp"
+#include "../../src/include/open_chain_kinematics.hpp"
+
+/**
+ * @brief Build the space screw axes and home frame of a planar finger with the given link lengths.
+ */
+static void planar_chain(const Eigen::VectorXd& link_lengths, Eigen::MatrixXd& M, std::vector<Eigen::VectorXd>& S_list, std::vector<Eigen::VectorXd>& B_list) {
+    M = Eigen::MatrixXd::Identity(4, 4);
+    M(0, 3) = link_lengths.sum();
+
+    S_list.clear();
+    B_list.clear();
+    double x = 0.0;
+    for (int i = 0; i < link_lengths.size(); i++) {
+        Eigen::VectorXd S(6); S << 0, 0, 1, 0, -x, 0;
+        S_list.push_back(S);
+        B_list.push_back(rigid_body_motion::Adjoint(M.inverse()) * S);
+        x += link_lengths(i);
+    }
+}
+
+/**
+ * @brief Build a planar finger with space and body screw axes set.
+ */
+template <int N = Eigen::Dynamic>
+static fm::finger_model<N> planar_finger_model(const Eigen::VectorXd& link_lengths) {
+    fm::finger_model<N> finger(link_lengths, Eigen::VectorXd::Zero(link_lengths.size()));
+    Eigen::MatrixXd M;
+    std::vector<Eigen::VectorXd> S_list, B_list;
+    planar_chain(link_lengths, M, S_list, B_list);
+    finger.set_home_position_screw_axes_space(S_list);
+    finger.set_home_position_screw_axes_body(B_list);
+    finger.set_home_position_body_frame(M);
+    return finger;
+}
+
+/**
+ * @brief Test that cached kinematics match the open chain functions and follow the joint angles.
+ */
+TEST(FingerModelTest, CachedKinematics) {
+    Eigen::Vector3d link_lengths(0.046, 0.032, 0.025);
+    Eigen::MatrixXd M;
+    std::vector<Eigen::VectorXd> S_list, B_list;
+    planar_chain(link_lengths, M, S_list, B_list);
+
+    fm::finger_model<> finger = planar_finger_model(link_lengths);
+    Eigen::VectorXd theta(3);
+    theta << 0.3, 0.5, -0.2;
+    finger.set_joint_angles(theta);
+
+    const fm::finger_model<>::jacobian_matrix& J_s = finger.get_finger_space_jacobian();
+    Eigen::MatrixXd T = open_chain_kinematics::FKin_Space(M, S_list, theta);
+    ASSERT_TRUE(J_s.isApprox(open_chain_kinematics::Jacobian_Space(S_list, theta)));
+    ASSERT_TRUE(finger.get_finger_body_jacobian().isApprox(open_chain_kinematics::Jacobian_Body(B_list, theta)));
+    ASSERT_TRUE(finger.get_fingertip_pose_space().isApprox(T));
+    ASSERT_TRUE(finger.get_fingertip_pose_body().isApprox(T));
+    ASSERT_EQ(&finger.get_finger_space_jacobian(), &J_s);
+
+    // A new pose invalidates the caches, which are refreshed in place
+    theta << -0.1, 0.8, 0.4;
+    finger.set_joint_angles(theta);
+    ASSERT_TRUE(finger.get_finger_space_jacobian().isApprox(open_chain_kinematics::Jacobian_Space(S_list, theta)));
+    ASSERT_EQ(&finger.get_finger_space_jacobian(), &J_s);
+    ASSERT_TRUE(finger.fingertip_position_space().isApprox(open_chain_kinematics::FKin_Space(M, S_list, theta).block<3, 1>(0, 3)));
+
+    // Geometry changes invalidate the caches as well
+    M(1, 3) = 0.01;
+    finger.set_home_position_body_frame(M);
+    ASSERT_TRUE(finger.get_fingertip_pose_space().isApprox(open_chain_kinematics::FKin_Space(M, S_list, theta)));
+}
+
+/**
+ * @brief Test that const queries only read the cache, so an updated model can be shared between threads.
+ */
+TEST(FingerModelTest, ConstQueriesArePure) {
+    Eigen::Vector3d link_lengths(0.046, 0.032, 0.025);
+    Eigen::MatrixXd M;
+    std::vector<Eigen::VectorXd> S_list, B_list;
+    planar_chain(link_lengths, M, S_list, B_list);
+
+    fm::finger_model<> finger = planar_finger_model(link_lengths);
+    const fm::finger_model<>& shared = finger;
+    Eigen::Vector3d theta(0.3, 0.5, -0.2);
+    finger.set_joint_angles(theta);
+    ASSERT_THROW(shared.get_finger_space_jacobian(), std::runtime_error);
+    ASSERT_THROW(shared.get_fingertip_pose_body(), std::runtime_error);
+
+    // Values that are not returned by reference are computed without touching the cache
+    ASSERT_TRUE(shared.fingertip_position_space().isApprox(open_chain_kinematics::FKin_Space(M, S_list, theta).block<3, 1>(0, 3)));
+    ASSERT_THROW(shared.get_fingertip_pose_space(), std::runtime_error);
+
+    finger.update();
+    ASSERT_TRUE(shared.get_finger_space_jacobian().isApprox(open_chain_kinematics::Jacobian_Space(S_list, theta)));
+    ASSERT_TRUE(shared.get_finger_body_jacobian().isApprox(open_chain_kinematics::Jacobian_Body(B_list, theta)));
+    ASSERT_TRUE(shared.get_fingertip_pose_space().isApprox(open_chain_kinematics::FKin_Space(M, S_list, theta)));
+
+    // Kernels at other joint angles leave the cache alone
+    Eigen::Vector3d other(-0.4, 0.2, 0.7);
+    fm::finger_model<>::jacobian_matrix J;
+    Eigen::Matrix4d T;
+    shared.space_jacobian(other, J, &T);
+    ASSERT_TRUE(J.isApprox(open_chain_kinematics::Jacobian_Space(S_list, other)));
+    ASSERT_TRUE(T.isApprox(open_chain_kinematics::FKin_Space(M, S_list, other)));
+    fm::finger_model<>::link_frames frames;
+    shared.link_frames_space(other, frames);
+    ASSERT_TRUE((frames[2] * M).isApprox(T));
+    Eigen::Vector3d force(0.3, -1.2, 0.5);
+    fm::finger_model<>::joint_matrix H;
+    shared.fingertip_force_hessian(other, force, H);
+    ASSERT_TRUE(H.isApprox(open_chain_kinematics::Position_Hessian_Space(M, S_list, other, force)));
+    ASSERT_TRUE(shared.get_fingertip_pose_space().isApprox(open_chain_kinematics::FKin_Space(M, S_list, theta)));
+}
+
+/**
+ * @brief Test that fixed-size fingers agree with the dynamic one and convert to it.
+ */
+TEST(FingerModelTest, FixedSizeMatchesDynamic) {
+    Eigen::Vector3d link_lengths(0.046, 0.032, 0.025);
+    fm::finger_model<3> fixed = planar_finger_model<3>(link_lengths);
+    fm::finger_model<> dynamic = planar_finger_model(link_lengths);
+
+    Eigen::Vector3d theta(0.4, -0.3, 0.9);
+    fixed.set_joint_angles(theta);
+    dynamic.set_joint_angles(theta);
+    ASSERT_TRUE(fixed.get_finger_space_jacobian().isApprox(dynamic.get_finger_space_jacobian()));
+    ASSERT_TRUE(fixed.get_finger_body_jacobian().isApprox(dynamic.get_finger_body_jacobian()));
+    ASSERT_TRUE(fixed.get_fingertip_pose_body().isApprox(dynamic.get_fingertip_pose_space()));
+
+    fm::finger_model<> converted(fixed);
+    ASSERT_EQ(converted.get_num_joints(), 3);
+    ASSERT_TRUE(converted.get_fingertip_pose_space().isApprox(dynamic.get_fingertip_pose_space()));
+    ASSERT_THROW(fm::finger_model<2> wrong(dynamic), std::invalid_argument);
+    ASSERT_THROW(fixed.set_joint_angles(Eigen::Vector2d::Zero()), std::invalid_argument);
+}
+
+/**
+ * @brief Test the inverse kinematics on a five joint thumb, beyond the former four link cap.
+ */
+TEST(FingerModelTest, FiveJointInverseKinematics) {
+    Eigen::VectorXd link_lengths(5);
+    link_lengths << 0.03, 0.025, 0.02, 0.02, 0.015;
+    fm::finger_model<5> thumb = planar_finger_model<5>(link_lengths);
+
+    // Give the thumb an out of plane base joint so that full poses are reachable in 3D
+    Eigen::Matrix<double, 6, 5> S = thumb.get_home_position_screw_axes_space();
+    S.col(0) << 1, 0, 0, 0, 0, 0;
+    thumb.set_home_position_screw_axes_space(S);
+
+    Eigen::Matrix<double, 5, 1> target_angles;
+    target_angles << 0.3, 0.4, 0.2, 0.5, 0.3;
+    thumb.set_joint_angles(target_angles);
+    Eigen::Vector3d target_position = thumb.fingertip_position_space();
+    Eigen::Matrix4d target_pose = thumb.get_fingertip_pose_space();
+
+    thumb.set_joint_angles(Eigen::Matrix<double, 5, 1>::Constant(0.1));
+    fm::finger_model<5>::joint_vector theta = thumb.inverse_kinematics_position(target_position);
+    thumb.set_joint_angles(theta);
+    ASSERT_LT((thumb.fingertip_position_space() - target_position).norm(), 1e-9);
+
+    thumb.set_joint_angles(Eigen::Matrix<double, 5, 1>::Constant(0.2));
+    theta = thumb.inverse_kinematics_space(target_pose);
+    thumb.set_joint_angles(theta);
+    ASSERT_TRUE(thumb.get_fingertip_pose_space().isApprox(target_pose, 1e-8));
+
+    fm::finger_model<> planar = planar_finger_model(link_lengths);
+    planar.set_joint_angles(target_angles);
+    target_pose = planar.get_fingertip_pose_body();
+    planar.set_joint_angles(Eigen::VectorXd::Constant(5, 0.1));
+    planar.set_joint_angles(planar.inverse_kinematics_body(target_pose));
+    ASSERT_TRUE(planar.get_fingertip_pose_body().isApprox(target_pose, 1e-8));
+}
+
+/**
+ * @brief Test that kinematics queries on an incomplete model are rejected.
+ */
+TEST(FingerModelTest, IncompleteModel) {
+    fm::finger_model<> finger(Eigen::Vector3d(0.046, 0.032, 0.025), Eigen::Vector3d::Zero());
+    ASSERT_THROW(finger.get_finger_space_jacobian(), std::runtime_error);
+
+    fm::finger_model<> planar = planar_finger_model(Eigen::Vector3d(0.046, 0.032, 0.025));
+    planar.set_joint_angles(Eigen::Vector2d::Zero());
+    ASSERT_THROW(planar.get_fingertip_pose_space(), std::runtime_error);
+    std::vector<Eigen::VectorXd> bad_axes(3, Eigen::VectorXd::Zero(5));
+    ASSERT_THROW(planar.set_home_position_screw_axes_space(bad_axes), std::invalid_argument);
+    ASSERT_THROW(fm::finger_model<>(Eigen::VectorXd::Ones(6), Eigen::VectorXd::Zero(6)), std::invalid_argument);
+}
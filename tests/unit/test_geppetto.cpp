@@ -0,0 +1,178 @@
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include <Eigen/Dense>
+#include "../../src/include/geppetto.hpp"
+#include "../../src/include/finger_description.hpp"
+
+// Spatial four joint finger: abduction about y, then three flexion joints about z
+static const std::string test_finger_path = std::string(TEST_DATA_DIR) + "/tendon_test_finger.yaml";
+
+/**
+ * @brief Test that tokens are views into the text with line numbers, and lexer errors.
+ */
+TEST(GeppettoTest, Lexer) {
+    const std::string text = "joint 2 -1.5e-1  # comment\n\n  tip +0.08 0 .02";
+    fm::geppetto::lexer tokens(text);
+    std::vector<fm::geppetto::token> all;
+    for (fm::geppetto::token t = tokens.next(); t.kind != fm::geppetto::token_kind::end; t = tokens.next()) {
+        all.push_back(t);
+        ASSERT_GE(t.text.data(), text.data());
+        ASSERT_LE(t.text.data() + t.text.size(), text.data() + text.size());
+    }
+    ASSERT_EQ(all.size(), 9u);
+    ASSERT_EQ(all[0].kind, fm::geppetto::token_kind::word);
+    ASSERT_EQ(all[0].text, "joint");
+    ASSERT_EQ(all[2].kind, fm::geppetto::token_kind::number);
+    ASSERT_DOUBLE_EQ(all[2].value, -0.15);
+    ASSERT_EQ(all[3].kind, fm::geppetto::token_kind::newline);
+    ASSERT_EQ(all[5].text, "tip");
+    ASSERT_EQ(all[5].line, 3u);
+    ASSERT_DOUBLE_EQ(all[6].value, 0.08);
+    ASSERT_DOUBLE_EQ(all[8].value, 0.02);
+
+    fm::geppetto::lexer bad_number("wait 1.2.3");
+    bad_number.next();
+    ASSERT_THROW(bad_number.next(), std::invalid_argument);
+    fm::geppetto::lexer bad_character("wait $");
+    bad_character.next();
+    ASSERT_THROW(bad_character.next(), std::invalid_argument);
+}
+
+/**
+ * @brief Test the bytecode of a script and compile errors with their lines.
+ */
+TEST(GeppettoTest, Compile) {
+    ASSERT_EQ(sizeof(fm::geppetto::instruction), 8u);
+    const std::string text =
+        "duration 0.5\n"
+        "repeat 3\n"
+        "  joints 0 0.2 0.3 0.4\n"
+        "  joint 3 0.1\n"
+        "end\n"
+        "tip 0.09 0.03 0\n"
+        "wait 2\n"
+        "home\n";
+    fm::geppetto::program code = fm::geppetto::compile(text, 4);
+    ASSERT_EQ(code.code.size(), 8u);
+    ASSERT_EQ(code.constants.size(), 1u + 4u + 1u + 3u + 1u);
+    ASSERT_EQ(code.code[1].op, fm::geppetto::opcode::repeat);
+    ASSERT_EQ(code.code[1].operand, 3u);
+    ASSERT_EQ(code.code[3].joint, 3);
+    ASSERT_DOUBLE_EQ(code.constants[code.code[3].operand], 0.1);
+    ASSERT_EQ(code.code[4].op, fm::geppetto::opcode::end_repeat);
+    ASSERT_EQ(code.code[4].operand, 2u);
+    ASSERT_EQ(code.lines[5], 6u);
+
+    auto expect_error = [](const std::string& script, const std::string& fragment) {
+        try {
+            fm::geppetto::compile(script, 4);
+            FAIL() << "expected an error containing " << fragment;
+        } catch (const std::invalid_argument& error) {
+            ASSERT_NE(std::string(error.what()).find(fragment), std::string::npos) << error.what();
+        }
+    };
+    expect_error("home\njoints 0 1 2\n", "line 2: 'joints' takes 4 numbers");
+    expect_error("home\n\nflex 1\n", "line 3: unknown command 'flex'");
+    expect_error("joint 4 0.1\n", "line 1: joint index");
+    expect_error("repeat 2\nhome\n", "line 1: 'repeat' without 'end'");
+    expect_error("end\n", "'end' without 'repeat'");
+    expect_error("repeat 0\nend\n", "repeat count");
+    expect_error("wait -1\n", "non-negative");
+    expect_error("home home\n", "unexpected 'home'");
+    expect_error("1 2\n", "expected a command");
+}
+
+/**
+ * @brief Test that the machine drives the finger model and produces the waypoints of the script.
+ */
+TEST(GeppettoTest, Run) {
+    fm::finger_model<> finger = fm::load_finger_description(test_finger_path);
+    fm::geppetto::virtual_machine machine(finger);
+    const std::string text =
+        "duration 0.5\n"
+        "repeat 3\n"
+        "  joints 0 0.2 0.3 0.4\n"
+        "  joint 3 0.1\n"
+        "end\n"
+        "tip 0.09 0.03 0\n"
+        "wait 2\n"
+        "home\n";
+    std::vector<double> times;
+    std::vector<Eigen::VectorXd> angles;
+    const double end = machine.run(fm::geppetto::compile(text, 4), [&](double time, const Eigen::Ref<const Eigen::VectorXd>& q) {
+        times.push_back(time);
+        angles.push_back(q);
+    });
+    ASSERT_EQ(machine.get_num_waypoints(), 10);
+    ASSERT_EQ(times.size(), 10u);
+    ASSERT_DOUBLE_EQ(end, 6.0);
+    ASSERT_DOUBLE_EQ(machine.get_time(), 6.0);
+    ASSERT_DOUBLE_EQ(times[0], 0.0);
+    ASSERT_DOUBLE_EQ(times[6], 3.0);
+    ASSERT_DOUBLE_EQ(times[7], 3.5);
+    ASSERT_DOUBLE_EQ(times[8], 5.5);
+    ASSERT_TRUE(angles[0].isZero());
+    ASSERT_TRUE(angles[5].isApprox(Eigen::Vector4d(0, 0.2, 0.3, 0.4)));
+    ASSERT_TRUE(angles[6].isApprox(Eigen::Vector4d(0, 0.2, 0.3, 0.1)));
+    ASSERT_TRUE(angles[7].isApprox(angles[8]));
+    ASSERT_TRUE(angles[9].isZero());
+
+    finger.set_joint_angles(angles[7]);
+    ASSERT_LT((finger.fingertip_position_space() - Eigen::Vector3d(0.09, 0.03, 0)).norm(), 1e-4);
+
+    // Runtime errors carry the script line
+    finger.set_joint_angles(Eigen::Vector4d::Zero());
+    auto sink = [](double, const Eigen::Ref<const Eigen::VectorXd>&) {};
+    try {
+        machine.run(fm::geppetto::compile("home\njoint 1 2.0\n", 4), sink);
+        FAIL() << "expected a joint limit error";
+    } catch (const std::runtime_error& error) {
+        ASSERT_NE(std::string(error.what()).find("line 2"), std::string::npos);
+    }
+    ASSERT_THROW(machine.run(fm::geppetto::compile("tip 0.5 0 0\n", 4), sink), std::runtime_error);
+    ASSERT_THROW(machine.run(fm::geppetto::compile("home\n", 3), sink), std::invalid_argument);
+
+    // Malformed bytecode is rejected before the first instruction runs
+    fm::geppetto::program bad_constant = fm::geppetto::compile("wait 1\n", 4);
+    bad_constant.code[0].operand = 1;
+    ASSERT_THROW(machine.run(bad_constant, sink), std::invalid_argument);
+    fm::geppetto::program bad_loop = fm::geppetto::compile("repeat 2\nhome\nend\n", 4);
+    bad_loop.code.erase(bad_loop.code.begin());
+    bad_loop.lines.erase(bad_loop.lines.begin());
+    ASSERT_THROW(fm::geppetto::validate(bad_loop, 4), std::invalid_argument);
+    ASSERT_THROW(machine.set_tip_tolerance(0.0), std::invalid_argument);
+}
+
+/**
+ * @brief Test compiling a long mapped script file.
+ */
+TEST(GeppettoTest, ScriptFile) {
+    const std::string path = "test_geppetto.gep";
+    std::string text = "# generated sweep\nduration 0.01\n";
+    for (int k = 0; k < 20000; k++) {
+        text += "joints 0 " + std::to_string(0.5 + 0.5 * std::sin(0.01 * k)) + " 0.3 0.2\n";
+    }
+    std::ofstream(path, std::ios::binary) << text;
+    fm::geppetto::program from_file = fm::geppetto::compile_file(path, 4);
+    fm::geppetto::program from_text = fm::geppetto::compile(text, 4);
+    ASSERT_EQ(from_file.code.size(), 20001u);
+    ASSERT_EQ(from_file.constants, from_text.constants);
+
+    fm::finger_model<> finger = fm::load_finger_description(test_finger_path);
+    fm::geppetto::virtual_machine machine(finger);
+    long count = 0;
+    ASSERT_NEAR(machine.run(from_file, [&](double, const Eigen::Ref<const Eigen::VectorXd>&) { count++; }), 200.0, 1e-9);
+    ASSERT_EQ(count, 20001);
+
+    std::ofstream(path, std::ios::binary) << "";
+    ASSERT_TRUE(fm::geppetto::compile_file(path, 4).code.empty());
+    std::ofstream(path, std::ios::binary) << "home\nbend\n";
+    ASSERT_THROW(fm::geppetto::compile_file(path, 4), std::invalid_argument);
+    std::remove(path.c_str());
+    ASSERT_THROW(fm::geppetto::compile_file(path, 4), std::runtime_error);
+}
@@ -0,0 +1,130 @@
+#include <iostream>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include <Eigen/Dense>
+#include "../../src/include/hand_model.hpp"
+#include "../../src/include/finger_model.hpp"
+#include "../../src/include/open_chain_kinematics.hpp"
+
+/**
+ * @brief Build a finger with space screw axes whose first joint abducts about x and the rest flex about z.
+ */
+static fm::finger_model<> spatial_finger_model(const Eigen::VectorXd& link_lengths) {
+    fm::finger_model<> finger(link_lengths, Eigen::VectorXd::Zero(link_lengths.size()));
+    Eigen::Matrix4d M = Eigen::Matrix4d::Identity();
+    M(0, 3) = link_lengths.sum();
+
+    Eigen::Matrix<double, 6, Eigen::Dynamic> S(6, link_lengths.size());
+    double x = 0.0;
+    for (int i = 0; i < link_lengths.size(); i++) {
+        S.col(i) << 0, 0, 1, 0, -x, 0;
+        x += link_lengths(i);
+    }
+    S.col(0) << 1, 0, 0, 0, 0, 0;
+    finger.set_home_position_screw_axes_space(S);
+    finger.set_home_position_body_frame(M);
+    return finger;
+}
+
+/**
+ * @brief Pose of a finger base on the palm.
+ */
+static Eigen::Matrix4d palm_mount(double yaw, double x, double y) {
+    Eigen::Matrix4d T = Eigen::Matrix4d::Identity();
+    T.block<3, 3>(0, 0) = Eigen::AngleAxisd(yaw, Eigen::Vector3d::UnitZ()).toRotationMatrix() * Eigen::AngleAxisd(0.2, Eigen::Vector3d::UnitY()).toRotationMatrix();
+    T(0, 3) = x;
+    T(1, 3) = y;
+    T(2, 3) = 0.01;
+    return T;
+}
+
+/**
+ * @brief Test that the batched kinematics of every finger match the finger models mapped into the palm frame.
+ */
+TEST(HandModelTest, MatchesFingerModels) {
+    std::vector<Eigen::VectorXd> lengths(4);
+    lengths[0] = Eigen::Vector3d(0.046, 0.032, 0.025);
+    lengths[1] = Eigen::Vector4d(0.05, 0.035, 0.025, 0.02);
+    lengths[2] = Eigen::VectorXd(5);
+    lengths[2] << 0.03, 0.025, 0.02, 0.02, 0.015;
+    lengths[3] = Eigen::Vector2d(0.04, 0.03);
+
+    fm::hand_model hand;
+    std::vector<fm::finger_model<>> fingers;
+    std::vector<Eigen::Matrix4d> mounts;
+    for (int f = 0; f < 4; f++) {
+        fingers.push_back(spatial_finger_model(lengths[f]));
+        mounts.push_back(palm_mount(0.3 * f - 0.4, 0.02 * f, 0.01 * f));
+        ASSERT_EQ(hand.add_finger(fingers[f], mounts[f]), f);
+    }
+    ASSERT_EQ(hand.get_num_fingers(), 4);
+    ASSERT_EQ(hand.get_num_joints(), 14);
+
+    Eigen::VectorXd theta(14);
+    theta << 0.1, 0.5, 0.3, -0.2, 0.4, 0.6, 0.1, 0.3, 0.2, 0.5, 0.4, 0.1, 0.7, -0.3;
+    hand.set_joint_angles(theta);
+
+    int k = 0;
+    for (int f = 0; f < 4; f++) {
+        const int n = fingers[f].get_num_joints();
+        fingers[f].set_joint_angles(theta.segment(k, n));
+        k += n;
+        ASSERT_TRUE(hand.get_joint_angles(f).isApprox(fingers[f].get_joint_angles()));
+
+        Eigen::Matrix4d T = mounts[f] * fingers[f].get_fingertip_pose_space();
+        ASSERT_TRUE(hand.get_fingertip_pose(f).isApprox(T, 1e-12));
+        ASSERT_TRUE(hand.get_fingertip_position(f).isApprox(T.block<3, 1>(0, 3), 1e-12));
+
+        fm::hand_model::jacobian_matrix J_s = hand.get_space_jacobian(f);
+        fm::hand_model::jacobian_matrix J_b = hand.get_body_jacobian(f);
+        ASSERT_EQ(J_s.cols(), n);
+        for (int j = 0; j < n; j++) {
+            Eigen::Matrix<double, 6, 1> expected = rigid_body_motion::Adjoint_Twist(mounts[f], fingers[f].get_finger_space_jacobian().col(j));
+            ASSERT_TRUE(J_s.col(j).isApprox(expected, 1e-12));
+        }
+
+        // The body Jacobian does not depend on where the finger sits on the palm
+        Eigen::Matrix4d T_inv = rigid_body_motion::Transform_Inverse(fingers[f].get_fingertip_pose_space());
+        for (int j = 0; j < n; j++) {
+            Eigen::Matrix<double, 6, 1> expected = rigid_body_motion::Adjoint_Twist(T_inv, fingers[f].get_finger_space_jacobian().col(j));
+            ASSERT_TRUE(J_b.col(j).isApprox(expected, 1e-12));
+        }
+    }
+
+    // Updating one finger leaves the others untouched
+    Eigen::Matrix4d before = hand.get_fingertip_pose(0);
+    hand.set_joint_angles(2, Eigen::VectorXd::Constant(5, 0.2));
+    fingers[2].set_joint_angles(Eigen::VectorXd::Constant(5, 0.2));
+    ASSERT_TRUE(hand.get_fingertip_pose(0).isApprox(before));
+    ASSERT_TRUE(hand.get_fingertip_pose(2).isApprox(mounts[2] * fingers[2].get_fingertip_pose_space(), 1e-12));
+
+    // Const queries only read the cache
+    const fm::hand_model& view = hand;
+    hand.set_joint_angles(1, Eigen::VectorXd::Constant(hand.get_num_joints(1), 0.1));
+    ASSERT_THROW(view.get_fingertip_pose(1), std::runtime_error);
+    ASSERT_THROW(view.get_body_jacobian(1), std::runtime_error);
+    hand.update();
+    ASSERT_TRUE(view.get_fingertip_pose(0).isApprox(before));
+    ASSERT_TRUE(view.get_space_jacobian(1).isApprox(hand.get_space_jacobian(1)));
+}
+
+/**
+ * @brief Test that invalid fingers and joint vectors are rejected.
+ */
+TEST(HandModelTest, InvalidInput) {
+    fm::hand_model hand;
+    ASSERT_THROW(hand.get_fingertip_pose(0), std::invalid_argument);
+
+    fm::finger_model<> incomplete(Eigen::Vector3d(0.046, 0.032, 0.025), Eigen::Vector3d::Zero());
+    ASSERT_THROW(hand.add_finger(incomplete), std::runtime_error);
+
+    fm::finger_model<> finger = spatial_finger_model(Eigen::Vector3d(0.046, 0.032, 0.025));
+    for (int f = 0; f < fm::max_hand_fingers; f++) {
+        hand.add_finger(finger);
+    }
+    ASSERT_THROW(hand.add_finger(finger), std::invalid_argument);
+    ASSERT_THROW(hand.set_joint_angles(0, Eigen::Vector2d::Zero()), std::invalid_argument);
+    ASSERT_THROW(hand.set_joint_angles(Eigen::VectorXd::Zero(14)), std::invalid_argument);
+    ASSERT_THROW(hand.get_space_jacobian(fm::max_hand_fingers), std::invalid_argument);
+}
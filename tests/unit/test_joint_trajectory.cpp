@@ -0,0 +1,95 @@
+#include <cmath>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include <Eigen/Dense>
+#include "../../src/include/joint_trajectory.hpp"
+
+/**
+ * @brief Test that every profile is synchronized, meets the limits and that the batches match pointwise evaluation.
+ */
+TEST(JointTrajectoryTest, Profiles) {
+    fm::trajectory_generator generator(3);
+    generator.set_velocity_limits(Eigen::Vector3d(2.0, 1.0, 4.0));
+    generator.set_acceleration_limits(Eigen::Vector3d(10.0, 4.0, 20.0));
+    generator.set_jerk_limits(Eigen::Vector3d(100.0, 40.0, 200.0));
+    const Eigen::Vector3d start(0.1, -0.4, 0.3);
+    const Eigen::Vector3d goal(0.5, 1.2, 0.3);
+
+    const double period = 1e-4;
+    for (fm::profile_type profile : {fm::profile_type::trapezoidal, fm::profile_type::s_curve, fm::profile_type::quintic}) {
+        generator.set_profile(profile);
+        const fm::trajectory_segment segment = generator.plan(start, goal);
+        const long count = fm::trajectory_generator::count_samples(segment, 0.0, period);
+        Eigen::MatrixXd q(count, 3), qd(count, 3);
+        ASSERT_EQ(fm::trajectory_generator::sample(segment, 0.0, period, q, qd), count);
+
+        Eigen::VectorXd position(3), velocity(3);
+        for (long k = 0; k < count; k += 37) {
+            fm::trajectory_generator::evaluate(segment, k * period, position, velocity);
+            ASSERT_TRUE(q.row(k).transpose().isApprox(position, 1e-12)) << k;
+            ASSERT_LT((qd.row(k).transpose() - velocity).norm(), 1e-9) << k;
+        }
+        fm::trajectory_generator::evaluate(segment, segment.duration, position, velocity);
+        ASSERT_TRUE(position.isApprox(goal, 1e-12));
+        ASSERT_LT(velocity.norm(), 1e-9);
+        ASSERT_TRUE(q.row(0).transpose().isApprox(start, 1e-12));
+
+        // Finite differences stay within the limits
+        const Eigen::MatrixXd acceleration = (qd.bottomRows(count - 1) - qd.topRows(count - 1)) / period;
+        for (int i = 0; i < 3; i++) {
+            ASSERT_LE(qd.col(i).cwiseAbs().maxCoeff(), generator.get_velocity_limits()(i) * (1.0 + 1e-9));
+            ASSERT_LE(acceleration.col(i).cwiseAbs().maxCoeff(), generator.get_acceleration_limits()(i) * 1.01);
+            ASSERT_TRUE((q.col(i).array() >= std::min(start(i), goal(i)) - 1e-12).all());
+            ASSERT_TRUE((q.col(i).array() <= std::max(start(i), goal(i)) + 1e-12).all());
+        }
+        // Joint 2 sets the time; its peaks reach the limits
+        if (profile == fm::profile_type::trapezoidal) {
+            ASSERT_NEAR(segment.duration, 1.6 / 1.0 + 1.0 / 4.0, 1e-12);
+        }
+        if (profile != fm::profile_type::quintic) {
+            ASSERT_NEAR(qd.col(1).maxCoeff(), 1.0, 1e-6);
+        }
+    }
+
+    // A longer commanded duration stretches the same shape
+    generator.set_profile(fm::profile_type::trapezoidal);
+    const fm::trajectory_segment slow = generator.plan(start, goal, 4.0);
+    ASSERT_DOUBLE_EQ(slow.duration, 4.0);
+    ASSERT_NEAR(slow.acceleration_fraction, 0.25 / 1.85, 1e-12);
+}
+
+/**
+ * @brief Test sampling in batches, zero length segments and argument checks.
+ */
+TEST(JointTrajectoryTest, Batches) {
+    fm::trajectory_generator generator(2, fm::profile_type::s_curve);
+    const fm::trajectory_segment segment = generator.plan(Eigen::Vector2d(0.0, 1.0), Eigen::Vector2d(1.0, -1.0), 0.1);
+    ASSERT_DOUBLE_EQ(segment.duration, 0.1);
+    const double period = 1e-3;
+    const long count = fm::trajectory_generator::count_samples(segment, 0.0005, period);
+    ASSERT_EQ(count, 100);
+    Eigen::MatrixXd all(count, 2);
+    ASSERT_EQ(fm::trajectory_generator::sample(segment, 0.0005, period, all), count);
+
+    Eigen::MatrixXd batch(7, 2);
+    long k = 0;
+    for (long written = 7; written == 7; k += written) {
+        written = fm::trajectory_generator::sample(segment, 0.0005 + k * period, period, batch);
+        ASSERT_TRUE(batch.topRows(written).isApprox(all.middleRows(k, written), 1e-12));
+    }
+    ASSERT_EQ(k, count);
+
+    const fm::trajectory_segment still = generator.plan(Eigen::Vector2d(0.2, 0.3), Eigen::Vector2d(0.2, 0.3));
+    ASSERT_EQ(still.duration, 0.0);
+    ASSERT_EQ(fm::trajectory_generator::sample(still, 0.0, period, batch), 1);
+    ASSERT_TRUE(batch.row(0).isApprox(Eigen::RowVector2d(0.2, 0.3)));
+
+    ASSERT_THROW(fm::trajectory_generator(0), std::invalid_argument);
+    ASSERT_THROW(generator.set_velocity_limits(Eigen::Vector2d(1.0, 0.0)), std::invalid_argument);
+    ASSERT_THROW(generator.set_jerk_limits(Eigen::Vector3d(1.0, 1.0, 1.0)), std::invalid_argument);
+    ASSERT_THROW(generator.plan(Eigen::Vector2d(0.0, 0.0), Eigen::Vector2d(1.0, NAN)), std::invalid_argument);
+    Eigen::MatrixXd wide(4, 3);
+    ASSERT_THROW(fm::trajectory_generator::sample(segment, 0.0, period, wide), std::invalid_argument);
+    ASSERT_THROW(fm::trajectory_generator::count_samples(segment, 0.0, 0.0), std::invalid_argument);
+}
@@ -0,0 +1,145 @@
+#include <filesystem>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include <Eigen/Dense>
+#include "../../src/include/finger_description.hpp"
+#include "../../src/include/finger_model.hpp"
+#include "../../src/include/kinematic_calibration.hpp"
+#include "../../src/include/open_chain_kinematics.hpp"
+
+/**
+ * @brief Synthetic measurements from a "true" finger that differs from the nominal description.
+ */
+struct calibration_data
+{
+    Eigen::MatrixXd joint_readings;
+    Eigen::Matrix3Xd positions;
+};
+
+/**
+ * @brief Measure fingertip positions of the nominal finger with perturbed axes, encoder offsets and base frame.
+ */
+static calibration_data measure(const fm::finger_model<>& nominal, const Eigen::VectorXd& offsets, const Eigen::Matrix4d& base,
+                                double axis_error, long samples, unsigned seed) {
+    const int n = nominal.get_num_joints();
+    std::mt19937 generator(1);
+    std::normal_distribution<double> error(0.0, 1.0);
+    std::vector<Eigen::VectorXd> S_list;
+    for (int i = 0; i < n; i++) {
+        // Rigid displacement of each axis by axis_error radians and axis_error metres
+        Eigen::Vector3d rotation(error(generator), error(generator), error(generator));
+        Eigen::Matrix4d T = Eigen::Matrix4d::Identity();
+        T.block<3, 3>(0, 0) = Eigen::AngleAxisd(axis_error, rotation.normalized()).toRotationMatrix();
+        T.block<3, 1>(0, 3) = axis_error * Eigen::Vector3d(error(generator), error(generator), error(generator)).normalized();
+        S_list.push_back(rigid_body_motion::Adjoint_Twist(T, nominal.get_home_position_screw_axes_space().col(i)));
+    }
+    Eigen::Matrix4d M = nominal.get_home_position_body_frame();
+    M(1, 3) += 0.2 * axis_error;
+
+    std::mt19937 sampler(seed);
+    std::uniform_real_distribution<double> angle(-1.0, 1.0);
+    calibration_data data;
+    data.joint_readings.resize(n, samples);
+    data.positions.resize(3, samples);
+    for (long k = 0; k < samples; k++) {
+        Eigen::VectorXd theta(n);
+        for (int i = 0; i < n; i++) {
+            // The prismatic joint slides within its 0 to 0.01 limits
+            theta(i) = S_list[i].head<3>().norm() > 0.5 ? angle(sampler) : 0.005 + 0.005 * angle(sampler);
+        }
+        data.joint_readings.col(k) = theta;
+        Eigen::MatrixXd T = base * open_chain_kinematics::FKin_Space(M, S_list, theta + offsets);
+        data.positions.col(k) = T.block<3, 1>(0, 3);
+    }
+    return data;
+}
+
+/**
+ * @brief Test that calibration recovers a finger whose predictions match the measurements.
+ */
+TEST(KinematicCalibrationTest, RecoversPerturbedFinger) {
+    fm::finger_model<> nominal = fm::load_finger_description(std::string(TEST_DATA_DIR) + "/spatial_test_finger.yaml");
+    Eigen::VectorXd offsets(4);
+    offsets << 0.02, -0.03, 0.0005, 0.04;
+    Eigen::Matrix4d base = Eigen::Matrix4d::Identity();
+    base.block<3, 3>(0, 0) = Eigen::AngleAxisd(0.05, Eigen::Vector3d(0.3, 0.2, 0.9).normalized()).toRotationMatrix();
+    base.block<3, 1>(0, 3) << 0.01, -0.02, 0.005;
+    calibration_data data = measure(nominal, offsets, base, 0.01, 20000, 2);
+
+    fm::kinematic_calibration calibration(nominal);
+    calibration.set_estimate_base_frame(true);
+    double rms = calibration.calibrate(data.joint_readings, data.positions);
+    ASSERT_GT(calibration.get_initial_rms_error(), 1e-3);
+    ASSERT_LT(rms, 1e-9);
+    ASSERT_EQ(calibration.get_num_samples(), 20000);
+
+    // The corrected model takes raw readings and predicts unseen measurements in the measurement frame
+    fm::finger_model<> calibrated = calibration.get_finger_model();
+    calibration_data check = measure(nominal, offsets, base, 0.01, 50, 3);
+    for (long k = 0; k < check.joint_readings.cols(); k++) {
+        calibrated.set_joint_angles(check.joint_readings.col(k));
+        ASSERT_LT((calibrated.get_fingertip_pose_space().block<3, 1>(0, 3) - check.positions.col(k)).norm(), 1e-9);
+    }
+
+    // Written back as a description, the corrected model parses to the same kinematics
+    const std::filesystem::path path = std::filesystem::temp_directory_path() / "fm_test_calibrated_finger.yaml";
+    fm::write_finger_description(path.string(), calibrated, "calibrated");
+    fm::finger_model<> reloaded = fm::load_finger_description(path.string());
+    std::filesystem::remove(path);
+    reloaded.set_joint_angles(check.joint_readings.col(0));
+    calibrated.set_joint_angles(check.joint_readings.col(0));
+    ASSERT_TRUE(reloaded.get_fingertip_pose_space().isApprox(calibrated.get_fingertip_pose_space(), 1e-12));
+    ASSERT_TRUE(reloaded.get_link_lengths().isApprox(calibrated.get_link_lengths()));
+    ASSERT_TRUE((reloaded.get_joint_upper_limits().array() == calibrated.get_joint_upper_limits().array()).all());
+}
+
+/**
+ * @brief Test that streaming a log in chunks on several threads matches calibrating in memory.
+ */
+TEST(KinematicCalibrationTest, StreamsLog) {
+    fm::finger_model<> nominal = fm::load_finger_description(std::string(TEST_DATA_DIR) + "/spatial_test_finger.yaml");
+    Eigen::VectorXd offsets(4);
+    offsets << -0.05, 0.02, 0.0, 0.01;
+    calibration_data data = measure(nominal, offsets, Eigen::Matrix4d::Identity(), 0.0, 5000, 4);
+
+    const std::filesystem::path path = std::filesystem::temp_directory_path() / "fm_test_calibration.log";
+    {
+        fm::calibration_log log(path.string(), 4);
+        for (long k = 0; k < data.joint_readings.cols(); k++) {
+            log.append(data.joint_readings.col(k), data.positions.col(k));
+        }
+        ASSERT_THROW(log.append(Eigen::Vector3d::Zero(), Eigen::Vector3d::Zero()), std::invalid_argument);
+    }
+
+    // With exact axes and home frame only the encoder offsets are unknown, and they are recovered
+    fm::kinematic_calibration streamed(nominal);
+    streamed.set_estimate_screw_axes(false);
+    streamed.set_estimate_home_frame(false);
+    streamed.set_chunk_size(700);
+    streamed.set_num_threads(3);
+    ASSERT_LT(streamed.calibrate(path.string()), 1e-10);
+    ASSERT_EQ(streamed.get_num_samples(), 5000);
+    ASSERT_TRUE(streamed.get_encoder_offsets().isApprox(offsets, 1e-8));
+
+    fm::kinematic_calibration in_memory(nominal);
+    in_memory.set_estimate_screw_axes(false);
+    in_memory.set_estimate_home_frame(false);
+    in_memory.set_num_threads(1);
+    in_memory.calibrate(data.joint_readings, data.positions);
+    ASSERT_TRUE(in_memory.get_encoder_offsets().isApprox(streamed.get_encoder_offsets(), 1e-10));
+    ASSERT_NEAR(in_memory.get_initial_rms_error(), streamed.get_initial_rms_error(), 1e-12);
+
+    // Logs for another finger, foreign files and empty parameter sets are refused
+    fm::finger_model<> three_joints = fm::load_finger_description(std::string(TEST_DATA_DIR) + "/../../config/index_finger.yaml");
+    ASSERT_THROW(fm::kinematic_calibration(three_joints).calibrate(path.string()), std::runtime_error);
+    ASSERT_THROW(fm::kinematic_calibration(nominal).calibrate(std::string(TEST_DATA_DIR) + "/spatial_test_finger.yaml"), std::runtime_error);
+    std::filesystem::remove(path);
+    fm::kinematic_calibration nothing(nominal);
+    nothing.set_estimate_encoder_offsets(false);
+    nothing.set_estimate_screw_axes(false);
+    nothing.set_estimate_home_frame(false);
+    ASSERT_THROW(nothing.calibrate(data.joint_readings, data.positions), std::invalid_argument);
+}
@@ -66,6 +66,97 @@ TEST(KinematicsTest, IKin_Body) {
     ASSERT_TRUE(theta_list.isZero());
 }
 
+/**
+ * @brief Build the screw axes and home configuration of a planar three link finger.
+ */
+static void planar_finger(Eigen::MatrixXd& M, std::vector<Eigen::VectorXd>& S_list) {
+    std::vector<double> l = {0.046, 0.032, 0.025};
+    M = Eigen::MatrixXd::Identity(4, 4);
+    M(0, 3) = l[0] + l[1] + l[2];
+
+    S_list.clear();
+    Eigen::VectorXd S1(6);  S1 << 0, 0, 1, 0, 0, 0;             S_list.push_back(S1);
+    Eigen::VectorXd S2(6);  S2 << 0, 0, 1, 0, -l[0], 0;         S_list.push_back(S2);
+    Eigen::VectorXd S3(6);  S3 << 0, 0, 1, 0, -l[0]-l[1], 0;    S_list.push_back(S3);
+}
+
+/**
+ * @brief Test the space Jacobian against finite differences of the fingertip position.
+ */
+TEST(KinematicsTest, Jacobian_Space) {
+    Eigen::MatrixXd M;
+    std::vector<Eigen::VectorXd> S_list;
+    planar_finger(M, S_list);
+
+    Eigen::VectorXd theta_list(3);
+    theta_list << 0.3, 0.5, -0.2;
+
+    Eigen::MatrixXd J = open_chain_kinematics::Jacobian_Space(S_list, theta_list);
+    Eigen::MatrixXd T = open_chain_kinematics::FKin_Space(M, S_list, theta_list);
+    Eigen::Vector3d p = T.block<3, 1>(0, 3);
+
+    double h = 1e-6;
+    for (int i = 0; i < 3; i++) {
+        Eigen::VectorXd theta_h = theta_list;
+        theta_h(i) += h;
+        Eigen::Vector3d p_h = open_chain_kinematics::FKin_Space(M, S_list, theta_h).block<3, 1>(0, 3);
+        Eigen::Vector3d p_dot = J.block<3, 1>(3, i) + Eigen::Vector3d(J.block<3, 1>(0, i)).cross(p);
+        ASSERT_TRUE(((p_h - p) / h).isApprox(p_dot, 1e-4));
+    }
+}
+
+/**
+ * @brief Test that the body Jacobian is the space Jacobian expressed in the end-effector frame.
+ */
+TEST(KinematicsTest, Jacobian_Body) {
+    Eigen::MatrixXd M;
+    std::vector<Eigen::VectorXd> S_list, B_list;
+    planar_finger(M, S_list);
+    for (const auto& S : S_list) {
+        B_list.push_back(rigid_body_motion::Adjoint(M.inverse()) * S);
+    }
+
+    Eigen::VectorXd theta_list(3);
+    theta_list << -0.4, 0.9, 0.6;
+
+    Eigen::MatrixXd T = open_chain_kinematics::FKin_Space(M, S_list, theta_list);
+    Eigen::MatrixXd J_s = open_chain_kinematics::Jacobian_Space(S_list, theta_list);
+    Eigen::MatrixXd J_b = open_chain_kinematics::Jacobian_Body(B_list, theta_list);
+    ASSERT_TRUE(J_b.isApprox(rigid_body_motion::Adjoint(T.inverse()) * J_s, 1e-9));
+}
+
+/**
+ * @brief Test the fingertip position Hessian against finite differences.
+ */
+TEST(KinematicsTest, Position_Hessian_Space) {
+    Eigen::MatrixXd M;
+    std::vector<Eigen::VectorXd> S_list;
+    planar_finger(M, S_list);
+
+    Eigen::VectorXd theta_list(3);
+    theta_list << 0.2, 0.7, 0.4;
+    Eigen::Vector3d force(1.5, -2.0, 0.5);
+
+    auto tip_force_torques = [&](const Eigen::VectorXd& theta) {
+        Eigen::MatrixXd J = open_chain_kinematics::Jacobian_Space(S_list, theta);
+        Eigen::Vector3d p = open_chain_kinematics::FKin_Space(M, S_list, theta).block<3, 1>(0, 3);
+        Eigen::VectorXd tau(3);
+        for (int i = 0; i < 3; i++) {
+            tau(i) = force.dot(J.block<3, 1>(3, i) + Eigen::Vector3d(J.block<3, 1>(0, i)).cross(p));
+        }
+        return tau;
+    };
+
+    Eigen::MatrixXd H = open_chain_kinematics::Position_Hessian_Space(M, S_list, theta_list, force);
+    double h = 1e-6;
+    for (int j = 0; j < 3; j++) {
+        Eigen::VectorXd theta_h = theta_list;
+        theta_h(j) += h;
+        Eigen::VectorXd column = (tip_force_torques(theta_h) - tip_force_torques(theta_list)) / h;
+        ASSERT_TRUE(column.isApprox(H.col(j), 1e-4));
+    }
+}
+
 int main(int argc, char **argv) {
     ::testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();
@@ -0,0 +1,72 @@
+#include <string>
+
+#include <gtest/gtest.h>
+#include <Eigen/Dense>
+#include "../../src/include/finger_description.hpp"
+#include "../../src/include/finger_model.hpp"
+#include "../../src/include/kinematics_codegen.hpp"
+#include "spatial_test_finger_kinematics.hpp"
+
+namespace generated = generated_kinematics::spatial_test_finger;
+
+/**
+ * @brief Test that the code generated at build time matches the finger model it was generated from.
+ */
+TEST(KinematicsCodegenTest, GeneratedMatchesFingerModel) {
+    fm::finger_model<> finger = fm::load_finger_description(std::string(TEST_DATA_DIR) + "/spatial_test_finger.yaml");
+    ASSERT_EQ(generated::num_joints, finger.get_num_joints());
+
+    const double angles[3][4] = {{0.0, 0.0, 0.0, 0.0}, {0.3, -0.7, 0.004, 1.1}, {-1.2, 2.5, 0.009, -0.4}};
+    for (const auto& a : angles) {
+        generated::joint_vector theta(a[0], a[1], a[2], a[3]);
+        finger.set_joint_angles(theta);
+        ASSERT_TRUE(generated::FKin_Space(theta).isApprox(finger.get_fingertip_pose_space(), 1e-12));
+        ASSERT_TRUE(generated::FKin_Body(theta).isApprox(finger.get_fingertip_pose_body(), 1e-12));
+        ASSERT_TRUE(generated::Jacobian_Space(theta).isApprox(finger.get_finger_space_jacobian(), 1e-12));
+        ASSERT_TRUE(generated::Jacobian_Body(theta).isApprox(finger.get_finger_body_jacobian(), 1e-12));
+
+        generated::wrench_vector F;
+        F << 0.01, -0.02, 0.005, 1.0, -2.0, 0.5;
+        ASSERT_TRUE(generated::Jacobian_Transpose_Space(theta, F).isApprox(finger.get_finger_space_jacobian().transpose() * F, 1e-12));
+        ASSERT_TRUE(generated::Jacobian_Transpose_Body(theta, F).isApprox(finger.get_finger_body_jacobian().transpose() * F, 1e-12));
+    }
+
+    generated::joint_vector target(0.2, -0.4, 0.006, 0.7);
+    Eigen::Matrix4d T = generated::FKin_Space(target);
+    generated::joint_vector guess(0.1, -0.2, 0.002, 0.5);
+    ASSERT_TRUE(generated::FKin_Space(generated::IKin_Space(T, guess)).isApprox(T, 1e-7));
+    ASSERT_TRUE(generated::FKin_Body(generated::IKin_Body(T, guess)).isApprox(T, 1e-7));
+}
+
+/**
+ * @brief Test that zero terms of a planar finger fold away and shared terms are emitted once.
+ */
+TEST(KinematicsCodegenTest, FoldsPlanarChain) {
+    fm::finger_model<> finger(Eigen::Vector2d(0.04, 0.03), Eigen::Vector2d::Zero());
+    Eigen::Matrix<double, 6, 2> S;
+    S << 0, 0,
+         0, 0,
+         1, 1,
+         0, 0,
+         0, -0.04,
+         0, 0;
+    Eigen::Matrix4d M = Eigen::Matrix4d::Identity();
+    M(0, 3) = 0.07;
+    finger.set_home_position_screw_axes_space(S);
+    finger.set_home_position_screw_axes_body(S);
+    finger.set_home_position_body_frame(M);
+
+    fm::generated_kinematics code = fm::generate_kinematics(finger, "planar", "planar_kinematics.hpp");
+    ASSERT_NE(code.header.find("namespace planar"), std::string::npos);
+    ASSERT_NE(code.source.find("T(2, 2) = 1.0;"), std::string::npos);
+    ASSERT_NE(code.source.find("J(2, 1) = 1.0;"), std::string::npos);
+    ASSERT_NE(code.source.find("T(0, 2) = 0.0;"), std::string::npos);
+
+    // The first space Jacobian column is a constant screw, so that function needs no trigonometry for it
+    std::size_t jacobian = code.source.find("Jacobian_Space(");
+    std::size_t next = code.source.find("Jacobian_Body(", jacobian);
+    ASSERT_EQ(code.source.substr(jacobian, next - jacobian).find("std::sin(theta_list(1))"), std::string::npos);
+    ASSERT_LT(code.operation_count, 150);
+
+    ASSERT_THROW(fm::generate_kinematics(finger, "not-an-identifier", "x.hpp"), std::invalid_argument);
+}
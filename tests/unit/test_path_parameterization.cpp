@@ -0,0 +1,132 @@
+#include <cmath>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include <Eigen/Dense>
+#include "../../src/include/finger_description.hpp"
+#include "../../src/include/path_parameterization.hpp"
+#include "../../src/include/tendon_tension_solver.hpp"
+
+// Spatial four joint finger with link masses and five tendons, n + 1 routing
+static const std::string test_finger_path = std::string(TEST_DATA_DIR) + "/massive_test_finger.yaml";
+
+/**
+ * @brief Test inverse dynamics against a pendulum and the power balance of the whole finger.
+ */
+TEST(PathParameterizationTest, InverseDynamics) {
+    fm::finger_model<> pendulum(Eigen::VectorXd::Constant(1, 0.1), Eigen::VectorXd::Zero(1));
+    std::vector<Eigen::VectorXd> axis(1, Eigen::VectorXd::Zero(6));
+    axis[0](2) = 1.0;
+    pendulum.set_home_position_screw_axes_space(axis);
+    fm::link_inertia inertia;
+    inertia.mass = 0.3;
+    inertia.center_of_mass = Eigen::Vector3d(0.1, 0.0, 0.0);
+    inertia.rotational_inertia = Eigen::Vector3d(1e-4, 2e-4, 3e-4).asDiagonal();
+    pendulum.set_link_inertia(0, inertia);
+    const Eigen::Vector3d gravity(0.0, -9.81, 0.0);
+    const double q = 0.7, qd = 1.3, qdd = -2.1;
+    const Eigen::VectorXd tau = fm::inverse_dynamics(pendulum, Eigen::VectorXd::Constant(1, q), Eigen::VectorXd::Constant(1, qd),
+                                                     Eigen::VectorXd::Constant(1, qdd), gravity);
+    ASSERT_NEAR(tau(0), (3e-4 + 0.3 * 0.01) * qdd + 0.3 * 9.81 * 0.1 * std::cos(q), 1e-12);
+
+    // Without gravity the joint power is the rate of change of kinetic energy 0.5 qd^T M qd
+    fm::finger_model<> finger = fm::load_finger_description(test_finger_path);
+    const Eigen::Vector4d angles(0.1, 0.4, 0.6, 0.3), velocities(0.5, -1.0, 2.0, 1.5), accelerations(1.0, 2.0, -3.0, 0.5);
+    auto energy = [&](const Eigen::VectorXd& q, const Eigen::VectorXd& v) {
+        Eigen::MatrixXd mass(4, 4);
+        const Eigen::VectorXd tau0 = fm::inverse_dynamics(finger, q, Eigen::VectorXd::Zero(4), Eigen::VectorXd::Zero(4), Eigen::Vector3d::Zero());
+        for (int j = 0; j < 4; j++) {
+            mass.col(j) = fm::inverse_dynamics(finger, q, Eigen::VectorXd::Zero(4), Eigen::VectorXd::Unit(4, j), Eigen::Vector3d::Zero()) - tau0;
+        }
+        return 0.5 * v.dot(mass * v);
+    };
+    const double dt = 1e-6;
+    const double rate = (energy(angles + dt * velocities, velocities + dt * accelerations) -
+                         energy(angles - dt * velocities, velocities - dt * accelerations)) / (2.0 * dt);
+    const double power = velocities.dot(fm::inverse_dynamics(finger, angles, velocities, accelerations, Eigen::Vector3d::Zero()));
+    ASSERT_NEAR(power, rate, 1e-6 * std::abs(rate));
+}
+
+/**
+ * @brief Test the bang-bang timing of a single joint against the analytic minimum time.
+ */
+TEST(PathParameterizationTest, SingleJoint) {
+    fm::finger_model<> finger(Eigen::VectorXd::Constant(1, 0.05), Eigen::VectorXd::Zero(1));
+    std::vector<Eigen::VectorXd> axis(1, Eigen::VectorXd::Zero(6));
+    axis[0](2) = 1.0;
+    finger.set_home_position_screw_axes_space(axis);
+    fm::link_inertia inertia;
+    inertia.mass = 0.02;
+    inertia.center_of_mass = Eigen::Vector3d(0.025, 0.0, 0.0);
+    finger.set_link_inertia(0, inertia);
+    finger.set_tendon_routing_matrix(Eigen::RowVector2d(0.006, -0.006));
+
+    // 2 A at 0.1 A/N is 20 N, or 0.12 Nm on the 12.5 g cm^2 link
+    fm::path_parameterizer parameterizer(finger, std::vector<fm::tendon_parameters>(2));
+    ASSERT_EQ(parameterizer.get_current_limit(), 2.0);
+    parameterizer.set_gravity(Eigen::Vector3d::Zero());
+    const double acceleration = 0.006 * 20.0 / (0.02 * 0.025 * 0.025);
+    const double distance = 1.5;
+    const Eigen::MatrixXd path = Eigen::RowVectorXd::LinSpaced(2001, 0.0, distance);
+    fm::path_timing timing = parameterizer.parameterize(path);
+    ASSERT_NEAR(timing.duration, 2.0 * std::sqrt(distance / acceleration), 2e-3 * timing.duration);
+    ASSERT_EQ(timing.path_velocities(0), 0.0);
+    ASSERT_EQ(timing.path_velocities(2000), 0.0);
+    ASSERT_NEAR(timing.path_accelerations.maxCoeff() * distance, acceleration, 1e-6 * acceleration);
+
+    // A speed limit gives a trapezoid
+    parameterizer.set_velocity_limits(Eigen::VectorXd::Constant(1, 10.0));
+    timing = parameterizer.parameterize(path);
+    ASSERT_NEAR(timing.duration, distance / 10.0 + 10.0 / acceleration, 2e-3 * timing.duration);
+    ASSERT_LE(timing.path_velocities.maxCoeff() * distance, 10.0 * (1.0 + 1e-9));
+}
+
+/**
+ * @brief Test that a four joint path under gravity stays within the tendon limits and saturates a motor.
+ */
+TEST(PathParameterizationTest, TendonLimits) {
+    fm::finger_model<> finger = fm::load_finger_description(test_finger_path);
+    fm::path_parameterizer parameterizer(finger, std::vector<fm::tendon_parameters>(5));
+    parameterizer.set_tension_limits(1.0, 15.0);
+    parameterizer.set_velocity_limits(Eigen::Vector4d::Constant(30.0));
+
+    const long N = 1000;
+    Eigen::MatrixXd path(4, N + 1);
+    for (long i = 0; i <= N; i++) {
+        const double s = static_cast<double>(i) / N;
+        path.col(i) << 0.2 * std::sin(3.0 * s), 0.1 + 1.2 * s, 0.2 + 1.0 * s * s, 0.1 + 0.9 * s;
+    }
+    const fm::path_timing timing = parameterizer.parameterize(path);
+    ASSERT_GT(timing.duration, 0.0);
+    ASSERT_TRUE((timing.times.tail(N).array() > timing.times.head(N).array()).all());
+
+    // Tensions at the torques of every grid point: within [1, min(15, 20)] N, one at a limit somewhere
+    fm::tendon_tension_solver solver(finger.get_tendon_routing_matrix(), 1.0, 15.0, 1e-12);
+    const double h = 1.0 / N;
+    double tightest = 0.0;
+    for (long i = 1; i < N; i++) {
+        const Eigen::VectorXd dq = (path.col(i + 1) - path.col(i - 1)) / (2.0 * h);
+        const Eigen::VectorXd ddq = (path.col(i + 1) - 2.0 * path.col(i) + path.col(i - 1)) / (h * h);
+        const double sd = timing.path_velocities(i), sdd = timing.path_accelerations(i);
+        const Eigen::VectorXd tau = fm::inverse_dynamics(finger, path.col(i), dq * sd, dq * sdd + ddq * sd * sd, parameterizer.get_gravity());
+        solver.solve(tau);
+        ASSERT_LT(solver.get_torque_residual(), 1e-6) << i;
+        ASSERT_LE((dq * sd).cwiseAbs().maxCoeff(), 30.0 * (1.0 + 1e-9));
+        tightest = std::max(tightest, (dq * sd).cwiseAbs().maxCoeff() / 30.0);
+        Eigen::VectorXd stricter = tau * 1.02;
+        solver.solve(stricter);
+        tightest = std::max(tightest, solver.get_torque_residual() > 1e-9 ? 1.0 : 0.0);
+    }
+    ASSERT_GT(tightest, 0.99);
+
+    // Less current takes longer; too little cannot hold the finger up
+    parameterizer.set_current_limit(1.0);
+    ASSERT_GT(parameterizer.parameterize(path).duration, timing.duration);
+    ASSERT_THROW(parameterizer.set_current_limit(0.0), std::invalid_argument);
+    parameterizer.set_tension_limits(0.0, 15.0);
+    parameterizer.set_current_limit(1e-4);
+    ASSERT_THROW(parameterizer.parameterize(path), std::runtime_error);
+    ASSERT_THROW(parameterizer.parameterize(path.leftCols(2)), std::invalid_argument);
+    ASSERT_THROW(fm::path_parameterizer(finger, std::vector<fm::tendon_parameters>(3)), std::invalid_argument);
+}
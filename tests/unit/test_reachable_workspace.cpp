@@ -0,0 +1,113 @@
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include <Eigen/Dense>
+#include "../../src/include/reachable_workspace.hpp"
+#include "../../src/include/finger_description.hpp"
+
+// Spatial four joint finger: abduction about y, then three flexion joints about z
+static const std::string test_finger_path = std::string(TEST_DATA_DIR) + "/tendon_test_finger.yaml";
+
+static const Eigen::Vector4d joint_min(-0.3, -0.2, 0.0, 0.0);
+static const Eigen::Vector4d joint_max(0.3, 1.4, 1.6, 1.2);
+
+/**
+ * @brief Test the batched fingertip positions against the finger model.
+ */
+TEST(ReachableWorkspaceTest, FingertipPositions) {
+    fm::finger_model<> finger = fm::load_finger_description(test_finger_path);
+    fm::reachable_workspace workspace(finger);
+
+    Eigen::MatrixXd angles = Eigen::MatrixXd::Random(4, 21);
+    Eigen::Matrix3Xd positions(3, 21);
+    workspace.fingertip_positions(angles, positions);
+    for (long k = 0; k < angles.cols(); k++) {
+        finger.set_joint_angles(angles.col(k));
+        ASSERT_TRUE(positions.col(k).isApprox(finger.get_fingertip_pose_space().block<3, 1>(0, 3), 1e-12));
+    }
+}
+
+/**
+ * @brief Test that sampled fingertip positions are reachable and distant points are not.
+ */
+TEST(ReachableWorkspaceTest, Queries) {
+    fm::finger_model<> finger = fm::load_finger_description(test_finger_path);
+    fm::reachable_workspace workspace(finger);
+    workspace.set_voxel_size(0.004);
+    workspace.set_refinement_depth(0);
+    fm::configuration_grid grid(joint_min, joint_max, Eigen::Vector4i(9, 12, 12, 10));
+    workspace.build(grid, 2);
+    const double coarse_volume = workspace.reachable_volume();
+    ASSERT_EQ(workspace.get_num_boundary_voxels(), 0);
+    ASSERT_EQ(workspace.get_num_samples(), grid.size());
+
+    workspace.set_refinement_depth(2);
+    workspace.build(grid, 2);
+    ASSERT_GT(workspace.get_num_samples(), grid.size());
+    ASSERT_GT(workspace.get_num_boundary_voxels(), 0);
+    ASSERT_LT(workspace.get_num_boundary_voxels(), workspace.get_num_occupied_voxels());
+    ASSERT_LT(workspace.reachable_volume(), coarse_volume);
+    ASSERT_GT(workspace.reachable_volume(), 0.3 * coarse_volume);
+
+    // Random configurations land in reached voxels or leaves almost always
+    std::mt19937 generator(3);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    const int trials = 2000;
+    int reached = 0;
+    Eigen::MatrixXd angles(4, 1);
+    Eigen::Matrix3Xd tip(3, 1);
+    for (int t = 0; t < trials; t++) {
+        for (int j = 0; j < 4; j++) {
+            angles(j, 0) = joint_min(j) + unit(generator) * (joint_max(j) - joint_min(j));
+        }
+        workspace.fingertip_positions(angles, tip);
+        reached += workspace.reachable(tip.col(0)) ? 1 : 0;
+    }
+    ASSERT_GT(reached, 0.97 * trials);
+
+    ASSERT_FALSE(workspace.reachable(Eigen::Vector3d(0.2, 0.0, 0.0)));
+    ASSERT_FALSE(workspace.reachable(Eigen::Vector3d(-0.1, 0.0, 0.0)));
+    ASSERT_FALSE(workspace.reachable(Eigen::Vector3d(0.0, 0.0, 0.0)));
+
+    // Thread count does not change the result
+    const double volume = workspace.reachable_volume();
+    workspace.build(grid, 1);
+    ASSERT_EQ(workspace.reachable_volume(), volume);
+}
+
+/**
+ * @brief Test that a written workspace reads back with identical queries, and invalid inputs.
+ */
+TEST(ReachableWorkspaceTest, WriteRead) {
+    fm::reachable_workspace workspace(fm::load_finger_description(test_finger_path));
+    ASSERT_THROW(workspace.write("unused.bin"), std::runtime_error);
+    workspace.set_voxel_size(0.005);
+    workspace.build(fm::configuration_grid(joint_min, joint_max, Eigen::Vector4i(5, 8, 8, 6)));
+
+    const std::string path = "test_reachable_workspace.bin";
+    workspace.write(path);
+    fm::reachable_workspace loaded(fm::load_finger_description(test_finger_path));
+    loaded.read(path);
+    ASSERT_EQ(loaded.get_dimensions(), workspace.get_dimensions());
+    ASSERT_EQ(loaded.get_num_boundary_voxels(), workspace.get_num_boundary_voxels());
+    ASSERT_DOUBLE_EQ(loaded.reachable_volume(), workspace.reachable_volume());
+    std::mt19937 generator(5);
+    std::uniform_real_distribution<double> coordinate(-0.11, 0.11);
+    for (int t = 0; t < 20000; t++) {
+        Eigen::Vector3d point(coordinate(generator), coordinate(generator), coordinate(generator));
+        ASSERT_EQ(loaded.reachable(point), workspace.reachable(point));
+    }
+
+    std::ofstream(path, std::ios::binary) << "not a workspace";
+    ASSERT_THROW(loaded.read(path), std::runtime_error);
+    std::remove(path.c_str());
+
+    ASSERT_THROW(workspace.set_voxel_size(0.0), std::invalid_argument);
+    ASSERT_THROW(workspace.set_refinement_depth(5), std::invalid_argument);
+    ASSERT_THROW(workspace.build(fm::configuration_grid(Eigen::Vector2d::Zero(), Eigen::Vector2d::Ones(), Eigen::Vector2i(2, 2))), std::invalid_argument);
+}
@@ -0,0 +1,165 @@
+#include <cmath>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include <Eigen/Dense>
+#include "../../src/include/script_pipeline.hpp"
+#include "../../src/include/finger_description.hpp"
+
+// Spatial four joint finger with four tendons driven by four motor spools
+static const std::string test_finger_path = std::string(TEST_DATA_DIR) + "/tendon_test_finger.yaml";
+
+/**
+ * @brief Test FIFO order and capacity of the ring between two threads.
+ */
+TEST(ScriptPipelineTest, Ring) {
+    ASSERT_THROW(fm::spsc_ring<int>(3), std::invalid_argument);
+    fm::spsc_ring<long> ring(8);
+    for (long k = 0; k < 8; k++) {
+        ASSERT_TRUE(ring.try_push(k));
+    }
+    ASSERT_FALSE(ring.try_push(8));
+    ASSERT_EQ(ring.size(), 8u);
+    long value;
+    ASSERT_TRUE(ring.try_pop(value));
+    ASSERT_EQ(value, 0);
+    while (ring.try_pop(value)) {}
+    ASSERT_EQ(value, 7);
+
+    const long count = 200000;
+    std::thread producer([&]() {
+        for (long k = 0; k < count; k++) {
+            while (!ring.try_push(k)) {
+                std::this_thread::yield();
+            }
+        }
+    });
+    for (long k = 0; k < count; k++) {
+        while (!ring.try_pop(value)) {
+            std::this_thread::yield();
+        }
+        ASSERT_EQ(value, k);
+    }
+    producer.join();
+}
+
+/**
+ * @brief Test that the stream is the script sampled at the sample period and mapped to the motors.
+ */
+TEST(ScriptPipelineTest, Stream) {
+    fm::finger_model<> finger = fm::load_finger_description(test_finger_path);
+    fm::actuation_map map(finger);
+    const std::string text =
+        "duration 0.05\n"
+        "joints 0 0.4 0.3 0.2\n"
+        "repeat 4\n"
+        "  tip 0.085 0.045 0\n"
+        "  joint 1 0.2\n"
+        "end\n"
+        "wait 0.0125\n"
+        "home\n";
+    fm::geppetto::program code = fm::geppetto::compile(text, 4);
+
+    // The virtual machine gives the reference waypoints
+    std::vector<double> times;
+    std::vector<Eigen::VectorXd> angles;
+    fm::finger_model<> reference = finger;
+    fm::geppetto::virtual_machine machine(reference);
+    const double end = machine.run(code, [&](double time, const Eigen::Ref<const Eigen::VectorXd>& q) {
+        times.push_back(time);
+        angles.push_back(q);
+    });
+
+    fm::script_pipeline pipeline(finger, 64);
+    ASSERT_EQ(pipeline.get_num_motors(), 4);
+    pipeline.start(code);
+    ASSERT_THROW(pipeline.start(code), std::runtime_error);
+    std::vector<fm::motor_setpoint> stream;
+    const long underruns = pipeline.stream([&](const fm::motor_setpoint& setpoint) { stream.push_back(setpoint); }, false);
+    ASSERT_EQ(underruns, 0);
+    ASSERT_EQ(static_cast<long>(stream.size()), std::lround(std::ceil(end / 1e-3)) + 1);
+    for (std::size_t k = 0; k < stream.size(); k++) {
+        ASSERT_NEAR(stream[k].time, k * 1e-3, 1e-12);
+        Eigen::Map<const Eigen::Vector4d> q(stream[k].joint_angles.data());
+        ASSERT_TRUE(Eigen::Map<const Eigen::Vector4d>(stream[k].motor_angles.data()).isApprox(map.joint_to_motor(q), 1e-12));
+    }
+    // Waypoint times fall on ticks except after the wait; the last sample holds the final target
+    for (std::size_t w = 0; w + 2 < times.size(); w++) {
+        const long k = std::lround(times[w] / 1e-3);
+        ASSERT_TRUE(Eigen::Map<const Eigen::Vector4d>(stream[k].joint_angles.data()).isApprox(angles[w], 1e-9)) << w;
+    }
+    ASSERT_TRUE(Eigen::Map<const Eigen::Vector4d>(stream.back().joint_angles.data()).isZero());
+
+    const fm::stage_counters ik = pipeline.get_counters(fm::script_pipeline::ik_stage);
+    ASSERT_EQ(ik.items, static_cast<long>(times.size()) - 1);
+    ASSERT_GT(ik.busy_seconds, 0.0);
+    ASSERT_GE(ik.max_item_seconds * ik.items, ik.busy_seconds - 1e-12);
+    ASSERT_EQ(pipeline.get_counters(fm::script_pipeline::motor_stage).items, static_cast<long>(stream.size()));
+    ASSERT_LE(pipeline.get_counters(fm::script_pipeline::motor_stage).max_input_depth, 64u);
+    ASSERT_TRUE(pipeline.finished());
+}
+
+/**
+ * @brief Test that joint limits stretch the commanded durations and hold in the stream.
+ */
+TEST(ScriptPipelineTest, TrajectoryLimits) {
+    fm::finger_model<> finger = fm::load_finger_description(test_finger_path);
+    fm::trajectory_generator trajectory(4, fm::profile_type::trapezoidal);
+    trajectory.set_velocity_limits(Eigen::Vector4d::Constant(2.0));
+    trajectory.set_acceleration_limits(Eigen::Vector4d::Constant(20.0));
+    fm::script_pipeline pipeline(finger);
+    pipeline.set_trajectory(trajectory);
+    ASSERT_EQ(pipeline.get_trajectory().get_profile(), fm::profile_type::trapezoidal);
+    ASSERT_THROW(pipeline.set_trajectory(fm::trajectory_generator(3)), std::invalid_argument);
+
+    pipeline.start(fm::geppetto::compile("duration 0.05\njoints 0 0.4 0.3 0.2\njoints 0 1.4 1.6 1.2\nhome\n", 4));
+    std::vector<fm::motor_setpoint> stream;
+    pipeline.stream([&](const fm::motor_setpoint& setpoint) { stream.push_back(setpoint); }, false);
+    // Every segment is longer than commanded, cruising at 2 rad/s on its longest travel: 0.4, 1.3 and 1.6
+    const double expected = (0.4 + 1.3 + 1.6) / 2.0 + 3.0 * 2.0 / 20.0;
+    ASSERT_NEAR(stream.back().time, expected, 1e-3 + 1e-9);
+    for (std::size_t k = 1; k < stream.size(); k++) {
+        for (int i = 0; i < 4; i++) {
+            ASSERT_LE(std::abs(stream[k].joint_angles[i] - stream[k - 1].joint_angles[i]), 2.0 * 1e-3 + 1e-12);
+        }
+    }
+    ASSERT_TRUE(Eigen::Map<const Eigen::Vector4d>(stream.back().joint_angles.data()).isZero());
+}
+
+/**
+ * @brief Test a short real time stream, restarting the pipeline, and stage errors.
+ */
+TEST(ScriptPipelineTest, RealTimeAndErrors) {
+    fm::finger_model<> finger = fm::load_finger_description(test_finger_path);
+    fm::script_pipeline pipeline(finger, 256);
+    pipeline.start(fm::geppetto::compile("duration 0.1\njoints 0 0.4 0.3 0.2\ntip 0.085 0.045 0\nhome\n", 4));
+    long count = 0;
+    double last = -1.0;
+    const long underruns = pipeline.stream([&](const fm::motor_setpoint& setpoint) {
+        count++;
+        last = setpoint.time;
+    });
+    ASSERT_GE(count, 301);
+    ASSERT_NEAR(last, 0.3, 1e-12);
+    ASSERT_LE(underruns, count - 301);
+
+    pipeline.start(fm::geppetto::compile("home\njoint 1 2.0\nhome\n", 4));
+    try {
+        pipeline.stream([](const fm::motor_setpoint&) {}, false);
+        FAIL() << "expected a joint limit error";
+    } catch (const std::runtime_error& error) {
+        ASSERT_NE(std::string(error.what()).find("line 2"), std::string::npos);
+    }
+
+    ASSERT_THROW(pipeline.start(fm::geppetto::compile("home\n", 3)), std::invalid_argument);
+    fm::geppetto::program bad_loop = fm::geppetto::compile("repeat 2\nhome\nend\n", 4);
+    bad_loop.code.erase(bad_loop.code.begin());
+    bad_loop.lines.erase(bad_loop.lines.begin());
+    ASSERT_THROW(pipeline.start(bad_loop), std::invalid_argument);
+    ASSERT_THROW(pipeline.stream([](const fm::motor_setpoint&) {}), std::runtime_error);
+    ASSERT_THROW(pipeline.set_sample_period(0.0), std::invalid_argument);
+    ASSERT_THROW(pipeline.get_counters(4), std::invalid_argument);
+    ASSERT_THROW(fm::script_pipeline(finger, 100), std::invalid_argument);
+}
@@ -0,0 +1,102 @@
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include <Eigen/Dense>
+#include "../../src/include/setpoint_table.hpp"
+#include "../../src/include/script_pipeline.hpp"
+#include "../../src/include/finger_description.hpp"
+
+// Spatial four joint finger with four tendons driven by four motor spools
+static const std::string test_finger_path = std::string(TEST_DATA_DIR) + "/tendon_test_finger.yaml";
+
+static const std::string script_text =
+    "duration 0.05\n"
+    "joints 0 0.4 0.3 0.2\n"
+    "repeat 3\n"
+    "  tip 0.085 0.045 0\n"
+    "  joint 1 0.2\n"
+    "end\n"
+    "home\n";
+
+/**
+ * @brief Test that the table holds the pipeline's stream and that unchanged inputs reuse it.
+ */
+TEST(SetpointTableTest, CompileAndReuse) {
+    const std::string directory = "test_setpoint_cache";
+    std::filesystem::remove_all(directory);
+    const std::string script_path = "test_setpoint_table.gep";
+    std::ofstream(script_path, std::ios::binary) << script_text;
+    fm::finger_model<> finger = fm::load_finger_description(test_finger_path);
+    fm::trajectory_generator trajectory(4);
+
+    const std::string path = fm::compile_setpoint_table(script_path, finger, trajectory, directory);
+    fm::setpoint_table table(path);
+    ASSERT_EQ(table.get_key(), fm::setpoint_table_key(script_text, finger, trajectory, 1e-3));
+    ASSERT_EQ(table.get_num_joints(), 4);
+    ASSERT_EQ(table.get_num_motors(), 4);
+    ASSERT_DOUBLE_EQ(table.get_sample_period(), 1e-3);
+
+    std::vector<fm::motor_setpoint> stream;
+    fm::script_pipeline pipeline(finger);
+    pipeline.start(fm::geppetto::compile(script_text, 4));
+    pipeline.stream([&](const fm::motor_setpoint& setpoint) { stream.push_back(setpoint); }, false);
+    ASSERT_EQ(table.get_num_samples(), static_cast<long>(stream.size()));
+    ASSERT_NEAR(table.get_duration(), stream.back().time, 1e-12);
+    long played = 0;
+    table.play([&](long k, const double* motors) {
+        ASSERT_EQ(k, played++);
+        for (int m = 0; m < 4; m++) {
+            ASSERT_EQ(motors[m], stream[k].motor_angles[m]);
+        }
+        for (int i = 0; i < 4; i++) {
+            ASSERT_EQ(table.get_joint_angles(k)[i], stream[k].joint_angles[i]);
+        }
+    }, false);
+    ASSERT_EQ(played, table.get_num_samples());
+
+    // Unchanged inputs reuse the file; any change gives a new key
+    const auto written = std::filesystem::last_write_time(path);
+    ASSERT_EQ(fm::compile_setpoint_table(script_path, finger, trajectory, directory), path);
+    ASSERT_EQ(std::filesystem::last_write_time(path), written);
+    ASSERT_NE(fm::compile_setpoint_table(script_path, finger, trajectory, directory, 2e-3), path);
+    fm::finger_model<> longer = finger;
+    Eigen::Vector4d lengths(0.0, 0.047, 0.032, 0.025);
+    longer.set_link_lengths(lengths);
+    ASSERT_NE(fm::setpoint_table_key(script_text, longer, trajectory, 1e-3), table.get_key());
+    ASSERT_NE(fm::setpoint_table_key(script_text + "wait 1\n", finger, trajectory, 1e-3), table.get_key());
+
+    trajectory.set_profile(fm::profile_type::s_curve);
+    ASSERT_NE(fm::setpoint_table_key(script_text, finger, trajectory, 1e-3), table.get_key());
+
+    ASSERT_THROW(table.get_motor_angles(table.get_num_samples()), std::invalid_argument);
+    std::remove(script_path.c_str());
+    std::filesystem::remove_all(directory);
+}
+
+/**
+ * @brief Test that a failing script leaves nothing in the cache, and damaged tables.
+ */
+TEST(SetpointTableTest, Errors) {
+    const std::string directory = "test_setpoint_errors";
+    std::filesystem::remove_all(directory);
+    const std::string script_path = "test_setpoint_errors.gep";
+    std::ofstream(script_path, std::ios::binary) << "home\njoint 1 2.0\n";
+    fm::finger_model<> finger = fm::load_finger_description(test_finger_path);
+    fm::trajectory_generator trajectory(4);
+    ASSERT_THROW(fm::compile_setpoint_table(script_path, finger, trajectory, directory), std::runtime_error);
+    ASSERT_TRUE(std::filesystem::is_empty(directory));
+
+    std::ofstream(script_path, std::ios::binary) << "bend\n";
+    ASSERT_THROW(fm::compile_setpoint_table(script_path, finger, trajectory, directory), std::invalid_argument);
+
+    const std::string table_path = directory + "/damaged.fsetpt";
+    std::ofstream(table_path, std::ios::binary) << "not a setpoint table, but long enough to hold a header record";
+    ASSERT_THROW(fm::setpoint_table damaged(table_path), std::runtime_error);
+    std::remove(script_path.c_str());
+    std::filesystem::remove_all(directory);
+}
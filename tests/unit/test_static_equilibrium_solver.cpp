@@ -0,0 +1,116 @@
+#include <iostream>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include <Eigen/Dense>
+#include "../../src/include/static_equilibrium_solver.hpp"
+#include "../../src/include/finger_description.hpp"
+
+/**
+ * @brief Load the planar three joint finger and drive it by a single flexor tendon and motor.
+ */
+static fm::finger_model<> underactuated_finger() {
+    fm::finger_model<> finger = fm::load_finger_description(std::string(TEST_DATA_DIR) + "/planar_test_finger.yaml");
+
+    Eigen::MatrixXd R(3, 1);
+    R << 0.008, 0.006, 0.004;
+    finger.set_tendon_routing_matrix(R);
+    finger.set_motor_shaft_matrix(Eigen::MatrixXd::Constant(1, 1, 1.0 / 0.005));
+    return finger;
+}
+
+/**
+ * @brief Test the unloaded equilibrium against the linear closed-form solution.
+ */
+TEST(StaticEquilibriumSolverTest, UnloadedEquilibrium) {
+    fm::finger_model<> finger = underactuated_finger();
+    Eigen::VectorXd k_t = Eigen::VectorXd::Constant(1, 2e4);
+    Eigen::VectorXd k_s(3); k_s << 0.05, 0.03, 0.02;
+    fm::static_equilibrium_solver solver(finger, k_t, k_s, Eigen::VectorXd::Zero(3));
+
+    Eigen::VectorXd motor(1); motor << 2.0;
+    Eigen::VectorXd theta = solver.solve(motor, Eigen::VectorXd::Zero(6));
+    ASSERT_TRUE(solver.get_converged());
+
+    Eigen::MatrixXd R = finger.get_tendon_routing_matrix();
+    Eigen::MatrixXd A = Eigen::MatrixXd(k_s.asDiagonal()) + 2e4 * R * R.transpose();
+    Eigen::VectorXd expected = A.ldlt().solve(R * 2e4 * (2.0 * 0.005));
+    ASSERT_TRUE(theta.isApprox(expected, 1e-8));
+    ASSERT_GT(solver.get_tendon_tensions()(0), 0.0);
+}
+
+/**
+ * @brief Test that a loaded equilibrium is a stationary point of the energy and warm starts converge quickly.
+ */
+TEST(StaticEquilibriumSolverTest, LoadedEquilibrium) {
+    fm::finger_model<> finger = underactuated_finger();
+    fm::static_equilibrium_solver solver(finger, Eigen::VectorXd::Constant(1, 2e4), Eigen::VectorXd::Constant(3, 0.05), Eigen::VectorXd::Zero(3));
+
+    Eigen::VectorXd motor(1); motor << 3.0;
+    Eigen::VectorXd wrench = Eigen::VectorXd::Zero(6);
+    wrench(4) = -0.5;
+    Eigen::VectorXd theta = solver.solve(motor, wrench);
+    ASSERT_TRUE(solver.get_converged());
+
+    double h = 1e-6;
+    for (int i = 0; i < 3; i++) {
+        Eigen::VectorXd plus = theta, minus = theta;
+        plus(i) += h;
+        minus(i) -= h;
+        double derivative = (solver.energy(plus, motor, wrench) - solver.energy(minus, motor, wrench)) / (2 * h);
+        ASSERT_NEAR(derivative, 0.0, 1e-6);
+    }
+
+    motor(0) += 0.01;
+    solver.solve(motor, wrench);
+    ASSERT_TRUE(solver.get_converged());
+    ASSERT_LE(solver.get_iterations(), 4);
+}
+
+/**
+ * @brief Test that non-finite inputs end the solve unconverged and leave the previous equilibrium.
+ */
+TEST(StaticEquilibriumSolverTest, NonFiniteInput) {
+    fm::finger_model<> finger = underactuated_finger();
+    fm::static_equilibrium_solver solver(finger, Eigen::VectorXd::Constant(1, 2e4), Eigen::VectorXd::Constant(3, 0.05), Eigen::VectorXd::Zero(3));
+
+    Eigen::VectorXd motor(1); motor << 2.0;
+    Eigen::VectorXd theta = solver.solve(motor, Eigen::VectorXd::Zero(6));
+    ASSERT_TRUE(solver.get_converged());
+
+    Eigen::VectorXd wrench = Eigen::VectorXd::Zero(6);
+    wrench(4) = std::numeric_limits<double>::quiet_NaN();
+    solver.solve(motor, wrench);
+    ASSERT_FALSE(solver.get_converged());
+    ASSERT_TRUE(solver.get_joint_angles().isApprox(theta));
+
+    motor(0) = std::numeric_limits<double>::infinity();
+    solver.solve(motor, Eigen::VectorXd::Zero(6));
+    ASSERT_FALSE(solver.get_converged());
+    ASSERT_TRUE(solver.get_joint_angles().isApprox(theta));
+}
+
+/**
+ * @brief Test that the threaded grid mode matches individual solves.
+ */
+TEST(StaticEquilibriumSolverTest, Grid) {
+    fm::finger_model<> finger = underactuated_finger();
+    fm::static_equilibrium_solver solver(finger, Eigen::VectorXd::Constant(1, 2e4), Eigen::VectorXd::Constant(3, 0.05), Eigen::VectorXd::Zero(3));
+
+    Eigen::MatrixXd grid(1, 40);
+    for (int k = 0; k < 40; k++) {
+        grid(0, k) = 0.1 * k;
+    }
+    Eigen::VectorXd wrench = Eigen::VectorXd::Zero(6);
+    wrench(3) = 0.2;
+
+    Eigen::MatrixXd surface = solver.solve_grid(grid, wrench, 4);
+    for (int k = 0; k < 40; k += 7) {
+        fm::static_equilibrium_solver single(finger, Eigen::VectorXd::Constant(1, 2e4), Eigen::VectorXd::Constant(3, 0.05), Eigen::VectorXd::Zero(3));
+        ASSERT_TRUE(surface.col(k).isApprox(single.solve(grid.col(k), wrench), 1e-6));
+    }
+    ASSERT_THROW(solver.solve_grid(grid, Eigen::VectorXd::Zero(3), 4), std::invalid_argument);
+    ASSERT_THROW(solver.solve_grid(Eigen::MatrixXd::Zero(2, 40), wrench, 4), std::invalid_argument);
+}
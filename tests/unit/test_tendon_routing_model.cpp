@@ -0,0 +1,93 @@
+#include <iostream>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include <Eigen/Dense>
+#include "../../src/include/tendon_routing_model.hpp"
+
+/**
+ * @brief Build a two joint, two tendon model with one pulley and one via-point routing.
+ */
+static fm::tendon_routing_model two_joint_model() {
+    fm::tendon_routing_model model(2, 2);
+
+    fm::tendon_joint_routing pulley;
+    pulley.kind = fm::tendon_joint_routing::type::pulley;
+    pulley.pulley_radius = 0.006;
+    model.set_joint_routing(0, 0, pulley);
+    model.set_joint_routing(1, 0, pulley);
+
+    fm::tendon_joint_routing via;
+    via.kind = fm::tendon_joint_routing::type::via_points;
+    via.proximal_point << -0.010, 0.005;
+    via.distal_point << 0.010, 0.005;
+    model.set_joint_routing(1, 1, via);
+
+    model.compile(Eigen::Vector2d(-0.2, -0.2), Eigen::Vector2d(1.6, 1.6), 1e-8);
+    return model;
+}
+
+/**
+ * @brief Test that the interpolated moment arms match the exact geometry.
+ */
+TEST(TendonRoutingModelTest, MomentArms) {
+    fm::tendon_routing_model model = two_joint_model();
+    ASSERT_LE(model.get_interpolation_error(), 1e-8);
+
+    for (double theta = -0.2; theta <= 1.6; theta += 0.0371) {
+        Eigen::Vector2d q(0.3, theta);
+        Eigen::MatrixXd R(2, 2), dR(2, 2);
+        model.evaluate(q, R, dR);
+
+        double r, dr;
+        fm::tendon_routing_model::exact_moment_arm(model.get_joint_routing(1, 1), theta, r, dr);
+        ASSERT_NEAR(R(0, 0), 0.006, 1e-12);
+        ASSERT_NEAR(R(0, 1), 0.0, 1e-12);
+        ASSERT_NEAR(R(1, 1), r, 1e-8);
+        ASSERT_NEAR(dR(1, 1), dr, 1e-5);
+    }
+}
+
+/**
+ * @brief Test that the excursion equals the change in via-point distance.
+ */
+TEST(TendonRoutingModelTest, Excursions) {
+    fm::tendon_routing_model model = two_joint_model();
+    const fm::tendon_joint_routing& via = model.get_joint_routing(1, 1);
+
+    double theta = 1.1;
+    Eigen::Vector2d q(0.5, theta);
+    Eigen::VectorXd excursions(2);
+    model.tendon_excursions(q, excursions);
+
+    Eigen::Rotation2Dd rotation(theta);
+    double L0 = (via.distal_point - via.proximal_point).norm();
+    double L = (rotation * via.distal_point - via.proximal_point).norm();
+
+    ASSERT_NEAR(excursions(0), 0.006 * (0.5 + theta), 1e-10);
+    ASSERT_NEAR(excursions(1), L0 - L, 1e-8);
+}
+
+/**
+ * @brief Test that a joint no tendon crosses contributes nothing.
+ */
+TEST(TendonRoutingModelTest, UnroutedJoint) {
+    fm::tendon_routing_model model(3, 1);
+    fm::tendon_joint_routing pulley;
+    pulley.kind = fm::tendon_joint_routing::type::pulley;
+    pulley.pulley_radius = 0.006;
+    model.set_joint_routing(0, 0, pulley);
+    model.set_joint_routing(1, 0, pulley);
+    model.compile(Eigen::Vector3d::Constant(-0.2), Eigen::Vector3d::Constant(1.6), 1e-8);
+
+    Eigen::Vector3d q(0.3, 0.7, 1.2);
+    Eigen::MatrixXd R(3, 1), dR(3, 1);
+    model.evaluate(q, R, dR);
+    ASSERT_NEAR(R(1, 0), 0.006, 1e-12);
+    ASSERT_EQ(R(2, 0), 0.0);
+    ASSERT_EQ(dR(2, 0), 0.0);
+
+    Eigen::VectorXd excursions(1);
+    model.tendon_excursions(q, excursions);
+    ASSERT_NEAR(excursions(0), 0.006 * (0.3 + 0.7), 1e-10);
+}
@@ -0,0 +1,81 @@
+#include <iostream>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include <Eigen/Dense>
+#include "../../src/include/tendon_tension_solver.hpp"
+
+/**
+ * @brief Build the routing matrix of a three joint finger with four tendons (N+1 routing).
+ */
+static Eigen::MatrixXd routing_matrix_3x4() {
+    Eigen::MatrixXd R(3, 4);
+    R <<  0.008, -0.008,  0.006, -0.006,
+          0.000,  0.000,  0.006, -0.006,
+          0.004,  0.000,  0.000, -0.004;
+    return R;
+}
+
+/**
+ * @brief Test that reachable joint torques are reproduced with tensions above the minimum.
+ */
+TEST(TendonTensionSolverTest, ReachableTorques) {
+    Eigen::MatrixXd R = routing_matrix_3x4();
+    fm::tendon_tension_solver solver(R, 1.0);
+
+    Eigen::VectorXd tau(3);
+    tau << 0.02, -0.01, 0.005;
+    Eigen::VectorXd f = solver.solve(tau);
+
+    ASSERT_EQ(f.size(), 4);
+    ASSERT_TRUE((f.array() >= 1.0 - 1e-12).all());
+    ASSERT_TRUE((R * f).isApprox(tau, 1e-6));
+    ASSERT_LT(solver.get_torque_residual(), 1e-6);
+}
+
+/**
+ * @brief Test that the solution is optimal for the bounded least squares problem when the torque is unreachable.
+ */
+TEST(TendonTensionSolverTest, TensionLimits) {
+    Eigen::MatrixXd R = routing_matrix_3x4();
+    fm::tendon_tension_solver solver(R, 0.5, 2.0);
+
+    Eigen::VectorXd tau(3);
+    tau << 1.0, 1.0, 1.0;
+    Eigen::VectorXd f = solver.solve(tau);
+
+    ASSERT_TRUE((f.array() >= 0.5 - 1e-12).all());
+    ASSERT_TRUE((f.array() <= 2.0 + 1e-12).all());
+    ASSERT_GT(solver.get_torque_residual(), 0.0);
+
+    // KKT: the projected gradient vanishes at the solution
+    Eigen::VectorXd gradient = R.transpose() * (R * f - tau);
+    for (int i = 0; i < f.size(); i++) {
+        if (f(i) > 0.5 + 1e-9 && f(i) < 2.0 - 1e-9) {
+            ASSERT_NEAR(gradient(i), 0.0, 1e-8);
+        } else if (f(i) <= 0.5 + 1e-9) {
+            ASSERT_GE(gradient(i), -1e-8);
+        } else {
+            ASSERT_LE(gradient(i), 1e-8);
+        }
+    }
+}
+
+/**
+ * @brief Test that a repeated solve with the same torques reuses the active set.
+ */
+TEST(TendonTensionSolverTest, WarmStart) {
+    fm::tendon_tension_solver solver(routing_matrix_3x4(), 1.0);
+
+    Eigen::VectorXd tau(3);
+    tau << 0.02, -0.01, 0.005;
+    Eigen::VectorXd cold = solver.solve(tau);
+    int cold_iterations = solver.get_iterations();
+
+    tau(0) += 1e-4;
+    Eigen::VectorXd warm = solver.solve(tau);
+
+    ASSERT_LE(solver.get_iterations(), 2);
+    ASSERT_LE(solver.get_iterations(), cold_iterations);
+    ASSERT_TRUE(warm.isApprox(cold, 1e-1));
+}
@@ -0,0 +1,71 @@
+#include <iostream>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include <Eigen/Dense>
+#include "../../src/include/tendon_transmission_model.hpp"
+
+/**
+ * @brief Test capstan losses, stretch and motor currents for a single pulled tendon.
+ */
+TEST(TendonTransmissionModelTest, CapstanAndStretch) {
+    Eigen::MatrixXd R(1, 2);
+    R << 0.01, -0.01;
+
+    std::vector<fm::tendon_parameters> tendons(2);
+    tendons[0].stiffness = 2e4;
+    tendons[0].friction_coefficient = 0.2;
+    tendons[1] = tendons[0];
+
+    fm::tendon_transmission_model model(R, tendons);
+    Eigen::MatrixXd wraps(1, 2);
+    wraps << M_PI / 2, M_PI / 2;
+    model.set_wrap_angles(wraps);
+
+    // Sample 0 flexes the joint (tendon 0 reeled in), sample 1 extends it
+    Eigen::MatrixXd q(1, 2), qd(1, 2), f(2, 2);
+    q << 0.1, 0.1;
+    qd << 1.0, -1.0;
+    f << 10.0, 10.0,
+         2.0, 2.0;
+
+    fm::transmission_effort effort;
+    model.evaluate(q, qd, f, effort);
+
+    double gain = exp(0.2 * M_PI / 2);
+    ASSERT_NEAR(effort.motor_tensions(0, 0), 10.0 * gain, 1e-9);
+    ASSERT_NEAR(effort.motor_tensions(0, 1), 10.0 / gain, 1e-9);
+    ASSERT_NEAR(effort.motor_tensions(1, 0), 2.0 / gain, 1e-9);
+    ASSERT_NEAR(effort.tendon_stretch(0, 0), 0.5 * (10.0 + 10.0 * gain) / 2e4, 1e-12);
+    ASSERT_NEAR(effort.motor_currents(0, 0), 10.0 * gain * 0.005 / 0.05, 1e-9);
+
+    // Stretch of the flexor lets the joint lag behind its command
+    ASSERT_LT(effort.joint_errors(0, 0), 0.0);
+}
+
+/**
+ * @brief Test that via-point routing produces configuration-dependent wrap angles.
+ */
+TEST(TendonTransmissionModelTest, RoutingGeometryWrap) {
+    fm::tendon_routing_model routing(1, 1);
+    fm::tendon_joint_routing via;
+    via.kind = fm::tendon_joint_routing::type::via_points;
+    via.proximal_point << -0.01, 0.004;
+    via.distal_point << 0.01, 0.004;
+    routing.set_joint_routing(0, 0, via);
+
+    Eigen::MatrixXd R(1, 1);
+    R << 0.004;
+    fm::tendon_transmission_model model(R, std::vector<fm::tendon_parameters>(1));
+    model.set_routing_geometry(routing);
+
+    Eigen::MatrixXd q(1, 3), qd = Eigen::MatrixXd::Zero(1, 3), f = Eigen::MatrixXd::Ones(1, 3);
+    q << 0.0, 0.5, 1.0;
+    fm::transmission_effort effort;
+    model.evaluate(q, qd, f, effort);
+
+    // A straight tendon does not wrap; flexing the joint bends it by the joint angle in total
+    ASSERT_NEAR(effort.wrap_angles(0, 0), 0.0, 1e-12);
+    ASSERT_NEAR(effort.wrap_angles(0, 1), 0.5, 1e-9);
+    ASSERT_NEAR(effort.wrap_angles(0, 2), 1.0, 1e-9);
+}
@@ -0,0 +1,85 @@
+#include <cmath>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include <Eigen/Dense>
+#include "../../src/include/tolerance_analysis.hpp"
+#include "../../src/include/finger_description.hpp"
+
+// Planar three link finger lying along the x axis
+static const std::string test_finger_path = std::string(TEST_DATA_DIR) + "/planar_test_finger.yaml";
+
+/**
+ * @brief Test that the statistics match direct evaluation of the sampled fingers and do not depend on the thread count.
+ */
+TEST(ToleranceAnalysisTest, ReproducibleAcrossThreads) {
+    fm::finger_model<> finger = fm::load_finger_description(test_finger_path);
+    fm::tolerance_analysis analysis(finger);
+    analysis.set_link_length_tolerance(Eigen::Vector3d(2e-4, 1e-4, 1e-4));
+    analysis.set_axis_tolerance(0.005, 1e-4);
+    analysis.set_encoder_tolerance(Eigen::Vector3d(0.01, 0.01, 0.02));
+    analysis.set_num_samples(300);
+    analysis.set_seed(7);
+
+    fm::configuration_grid grid(Eigen::Vector3d(-0.3, 0.0, 0.0), Eigen::Vector3d(1.5, 1.7, 1.2), Eigen::Vector3i(6, 5, 7));
+    analysis.compute(grid, 1);
+    Eigen::VectorXf mean = analysis.get_mean_errors(), rms = analysis.get_rms_errors(), largest = analysis.get_max_errors();
+    analysis.compute(grid, 5);
+    ASSERT_TRUE((analysis.get_mean_errors().array() == mean.array()).all());
+    ASSERT_TRUE((analysis.get_rms_errors().array() == rms.array()).all());
+    ASSERT_TRUE((analysis.get_max_errors().array() == largest.array()).all());
+    ASSERT_EQ(analysis.get_grid().size(), 210);
+
+    // Every statistic agrees with the sampled finger models evaluated one by one
+    for (long point : {0L, 57L, 209L}) {
+        Eigen::VectorXd theta = grid.point(point);
+        finger.set_joint_angles(theta);
+        Eigen::Vector3d nominal = finger.get_fingertip_pose_space().block<3, 1>(0, 3);
+        double sum = 0.0, sum_squares = 0.0, max_error = 0.0;
+        for (long k = 0; k < analysis.get_num_samples(); k++) {
+            fm::finger_model<> sampled = analysis.sample_finger(k);
+            sampled.set_joint_angles(theta);
+            double error = (sampled.get_fingertip_pose_space().block<3, 1>(0, 3) - nominal).norm();
+            sum += error;
+            sum_squares += error * error;
+            max_error = std::max(max_error, error);
+        }
+        ASSERT_NEAR(mean(point), sum / 300, 1e-8);
+        ASSERT_NEAR(rms(point), std::sqrt(sum_squares / 300), 1e-8);
+        ASSERT_NEAR(largest(point), max_error, 1e-8);
+        ASSERT_GT(largest(point), mean(point));
+    }
+
+    // A different seed gives different samples
+    analysis.set_seed(8);
+    analysis.compute(grid, 2);
+    ASSERT_NE(analysis.get_mean_errors()(0), mean(0));
+}
+
+/**
+ * @brief Test the error distribution of a tolerance with a known effect on the fingertip.
+ */
+TEST(ToleranceAnalysisTest, LinkLengthError) {
+    fm::finger_model<> finger = fm::load_finger_description(test_finger_path);
+    fm::tolerance_analysis analysis(finger);
+    fm::configuration_grid grid(Eigen::Vector3d(0.0, 0.0, 0.0), Eigen::Vector3d(1.0, 1.0, 1.0), Eigen::Vector3i(3, 3, 3));
+
+    // Without tolerances every sample is the nominal finger
+    analysis.compute(grid);
+    ASSERT_EQ(analysis.get_max_errors().maxCoeff(), 0.0f);
+
+    // A distal link length error moves the fingertip along the link by exactly that amount, so the
+    // RMS error is the standard deviation and the mean error that of a half-normal distribution
+    analysis.set_link_length_tolerance(Eigen::Vector3d(0.0, 0.0, 1e-3));
+    analysis.set_num_samples(20000);
+    analysis.compute(grid);
+    for (long point = 0; point < grid.size(); point++) {
+        ASSERT_NEAR(analysis.get_rms_errors()(point), 1e-3, 2e-5);
+        ASSERT_NEAR(analysis.get_mean_errors()(point), 1e-3 * std::sqrt(2.0 / M_PI), 2e-5);
+    }
+
+    ASSERT_THROW(analysis.set_encoder_tolerance(Eigen::Vector2d(0.1, 0.1)), std::invalid_argument);
+    ASSERT_THROW(analysis.set_axis_tolerance(-1.0, 0.0), std::invalid_argument);
+    ASSERT_THROW(analysis.compute(fm::configuration_grid(Eigen::Vector2d::Zero(), Eigen::Vector2d::Ones(), Eigen::Vector2i(2, 2))), std::invalid_argument);
+}
@@ -0,0 +1,155 @@
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include <Eigen/Dense>
+#include "../../src/include/workspace_force_map.hpp"
+#include "../../src/include/finger_description.hpp"
+
+/**
+ * @brief Build a single joint finger with an antagonistic tendon pair on a 10 mm pulley.
+ */
+static fm::finger_model<> single_joint_finger() {
+    Eigen::VectorXd link_lengths(1); link_lengths << 0.05;
+    fm::finger_model<> finger(link_lengths, Eigen::VectorXd::Zero(1));
+
+    std::vector<Eigen::VectorXd> S_list;
+    Eigen::VectorXd S1(6); S1 << 0, 0, 1, 0, 0, 0; S_list.push_back(S1);
+    finger.set_home_position_screw_axes_space(S_list);
+
+    Eigen::MatrixXd M = Eigen::MatrixXd::Identity(4, 4);
+    M(0, 3) = 0.05;
+    finger.set_home_position_body_frame(M);
+
+    Eigen::MatrixXd R(1, 2); R << 0.01, -0.01;
+    finger.set_tendon_routing_matrix(R);
+    return finger;
+}
+
+// Planar three link finger with four tendons
+static const std::string test_finger_path = std::string(TEST_DATA_DIR) + "/planar_test_finger.yaml";
+
+/**
+ * @brief Test the grid numbering.
+ */
+TEST(WorkspaceForceMapTest, ConfigurationGrid) {
+    fm::configuration_grid grid(Eigen::Vector2d(0.0, -1.0), Eigen::Vector2d(1.0, 1.0), Eigen::Vector2i(3, 5));
+    ASSERT_EQ(grid.size(), 15);
+    ASSERT_TRUE(grid.point(0).isApprox(Eigen::Vector2d(0.0, -1.0)));
+    ASSERT_TRUE(grid.point(4).isApprox(Eigen::Vector2d(0.5, -0.5)));
+    ASSERT_TRUE(grid.point(14).isApprox(Eigen::Vector2d(1.0, 1.0)));
+    ASSERT_THROW(fm::configuration_grid(Eigen::Vector2d(0.0, 0.0), Eigen::Vector2d(1.0, 1.0), Eigen::Vector2i(0, 2)), std::invalid_argument);
+}
+
+/**
+ * @brief Test the force and stiffness of a single joint against the closed form.
+ */
+TEST(WorkspaceForceMapTest, SingleJointClosedForm) {
+    fm::finger_model<> finger = single_joint_finger();
+    fm::workspace_force_map map(finger, Eigen::Vector2d(1000.0, 1000.0), 0.0, 10.0);
+    map.set_joint_stiffness(Eigen::VectorXd::Constant(1, 0.1), Eigen::VectorXd::Constant(1, -0.5));
+    map.set_force_tolerance(1e-6);
+
+    fm::configuration_grid grid(Eigen::VectorXd::Zero(1), Eigen::VectorXd::Constant(1, M_PI / 2), Eigen::VectorXi::Constant(1, 3));
+    map.compute(grid, 1);
+
+    // At zero the spring needs 0.05 Nm and the pair supplies +-0.1 Nm through a 0.05 m lever
+    ASSERT_TRUE(map.get_positions().col(0).isApprox(Eigen::Vector3f(0.05f, 0.0f, 0.0f)));
+    ASSERT_TRUE(std::isinf(map.get_max_forces()(0, 0)));
+    ASSERT_NEAR(map.get_max_forces()(2, 0), 1.0, 1e-4);
+    ASSERT_NEAR(map.get_max_forces()(3, 0), 3.0, 1e-4);
+    ASSERT_TRUE(std::isinf(map.get_max_forces()(4, 0)));
+
+    // K_theta = 1000 * 2e-4 + 0.1, K_y = K_theta / L^2; x and z are held by the structure
+    Eigen::Matrix3d K = map.get_stiffness(0);
+    ASSERT_NEAR(K(1, 1), 0.3 / 0.0025, 1e-3);
+    ASSERT_NEAR(K(0, 0), 0.0, 1e-9);
+    ASSERT_NEAR(K(2, 2), 0.0, 1e-9);
+
+    // From 45 degrees on the spring needs more than the 0.1 Nm the pair can supply, so no force is available
+    ASSERT_NEAR(map.get_positions()(1, 2), 0.05, 1e-6);
+    ASSERT_EQ(map.get_max_forces()(1, 1), 0.0f);
+    ASSERT_EQ(map.get_max_forces()(1, 2), 0.0f);
+}
+
+/**
+ * @brief Test that the multithreaded map matches the single threaded one and the bounds are tight.
+ */
+TEST(WorkspaceForceMapTest, ThreadsAndFeasibility) {
+    fm::finger_model<> finger = fm::load_finger_description(test_finger_path);
+    fm::workspace_force_map map(finger, Eigen::Vector4d::Constant(2000.0), 1.0, 40.0);
+    Eigen::Matrix3Xd directions(3, 2);
+    directions << 1, 0,
+                  0, -1,
+                  0, 0;
+    map.set_directions(directions);
+
+    fm::configuration_grid grid(Eigen::Vector3d(-0.2, 0.0, 0.0), Eigen::Vector3d(0.6, 1.2, 1.0), Eigen::Vector3i(5, 4, 3));
+    map.compute(grid, 1);
+    Eigen::MatrixXf forces = map.get_max_forces();
+    Eigen::MatrixXf stiffness = map.get_stiffness();
+    map.compute(grid, 4);
+    ASSERT_TRUE(map.get_max_forces() == forces);
+    ASSERT_TRUE(map.get_stiffness() == stiffness);
+
+    // Check a point against the tension solver directly
+    const long k = 37;
+    Eigen::VectorXd q = grid.point(k);
+    finger.set_joint_angles(q);
+    finger.calculate_finger_space_jacobian();
+    Eigen::MatrixXd Js = finger.get_finger_space_jacobian();
+    Eigen::Vector3d p = finger.fingertip_position_space();
+    Eigen::MatrixXd J(3, 3);
+    for (int i = 0; i < 3; i++) {
+        J.col(i) = Js.block<3, 1>(3, i) + Js.block<3, 1>(0, i).cross(p);
+    }
+    ASSERT_TRUE(map.get_positions().col(k).cast<double>().isApprox(p, 1e-6));
+
+    fm::tendon_tension_solver solver(finger.get_tendon_routing_matrix(), 1.0, 40.0);
+    for (int d = 0; d < 2; d++) {
+        double F = forces(d, k);
+        ASSERT_GT(F, 0.0);
+        Eigen::VectorXd tau = J.transpose() * directions.col(d) * (F - 1e-2);
+        solver.solve(tau);
+        ASSERT_LT(solver.get_torque_residual(), 1e-6 * (1.0 + tau.norm()));
+        tau = J.transpose() * directions.col(d) * (F + 1e-2);
+        solver.solve(tau);
+        ASSERT_GT(solver.get_torque_residual(), 1e-6 * (1.0 + tau.norm()));
+    }
+
+    // In-plane stiffness inverts the in-plane compliance J K_theta^-1 J^T
+    Eigen::MatrixXd R = finger.get_tendon_routing_matrix();
+    Eigen::MatrixXd K_theta = 2000.0 * R * R.transpose();
+    Eigen::Matrix2d C = (J * K_theta.inverse() * J.transpose()).topLeftCorner<2, 2>();
+    Eigen::Matrix2d K = map.get_stiffness(k).topLeftCorner<2, 2>();
+    ASSERT_TRUE(K.isApprox(C.inverse(), 1e-4));
+}
+
+/**
+ * @brief Test writing and reading the binary map file.
+ */
+TEST(WorkspaceForceMapTest, FileRoundTrip) {
+    fm::finger_model<> finger = fm::load_finger_description(test_finger_path);
+    fm::workspace_force_map map(finger, Eigen::Vector4d::Constant(2000.0), 1.0, 40.0);
+    fm::configuration_grid grid(Eigen::Vector3d::Zero(), Eigen::Vector3d::Constant(1.0), Eigen::Vector3i(3, 3, 2));
+    map.compute(grid);
+
+    const std::string path = "workspace_force_map_test.bin";
+    map.write(path);
+
+    fm::workspace_force_map loaded(finger, Eigen::Vector4d::Constant(1.0), 0.0, 1.0);
+    loaded.read(path);
+    std::remove(path.c_str());
+
+    ASSERT_EQ(loaded.get_grid().size(), grid.size());
+    ASSERT_TRUE(loaded.get_grid().get_samples() == grid.get_samples());
+    ASSERT_TRUE(loaded.get_directions() == map.get_directions());
+    ASSERT_TRUE(loaded.get_positions() == map.get_positions());
+    ASSERT_TRUE(loaded.get_max_forces() == map.get_max_forces());
+    ASSERT_TRUE(loaded.get_stiffness() == map.get_stiffness());
+
+    ASSERT_THROW(loaded.read("does_not_exist.bin"), std::runtime_error);
+}